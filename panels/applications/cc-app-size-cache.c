@@ -0,0 +1,751 @@
+/* cc-app-size-cache.c
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _GNU_SOURCE
+
+#include <config.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "cc-app-size-cache.h"
+#include "cc-flatpak-index.h"
+#include "utils.h"
+
+#define PORTAL_SNAP_PREFIX "snap."
+
+/* Larger trees are walked again each time, to not run out of inotify
+ * watches */
+#define MAX_MONITORED_DIRS 512
+
+/*
+ * CcAppSizeCache computes the installed, data and cache sizes of apps in
+ * a thread, and keeps the results around so that selecting an app again
+ * doesn't spawn flatpak, talk to snapd or walk its directories again.
+ *
+ * A cached size is reused as long as what it was computed from didn't
+ * change. For the installed size, that is the deployment of the app. For
+ * the data and cache sizes, those are the modification times of all the
+ * directories walked, which are checked again in the thread, and all of
+ * these directories are also monitored to drop the size as soon as any
+ * file in them changes, including files growing in place. Concurrent
+ * requests for the same size share the computation, which is cancelled
+ * once all of them are, and reports the size found so far with the
+ * ::progress signal while walking directories.
+ *
+ * The cancellables of the requests are expected to be cancelled from the
+ * main thread.
+ */
+
+struct _CcAppSizeCache
+{
+  GObject     parent;
+
+  GHashTable *entries; /* "kind:app_id" → SizeEntry */
+};
+
+G_DEFINE_TYPE (CcAppSizeCache, cc_app_size_cache, G_TYPE_OBJECT)
+
+enum {
+  PROGRESS,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+typedef struct
+{
+  CcAppSizeKind  kind;
+  gchar         *app_id;
+
+  gboolean       valid;
+  guint          generation;
+  guint64        size;
+  gint64         stamp;
+  GPtrArray     *dirs;
+
+  /* Monitors of the directories in monitored_dirs */
+  GPtrArray     *monitors;
+  GPtrArray     *monitored_dirs;
+
+  /* Requests waiting for the size being computed */
+  GPtrArray     *waiting;
+  GCancellable  *cancellable;
+} SizeEntry;
+
+typedef struct
+{
+  GTask        *task;
+  GCancellable *cancellable;
+  gulong        cancelled_id;
+} Waiter;
+
+typedef struct
+{
+  CcAppSizeKind  kind;
+  gchar         *app_id;
+  gchar         *key;
+  guint          generation;
+
+  /* The size from the last time, if it's still valid */
+  gboolean       valid;
+  guint64        size;
+  gint64         stamp;
+  GPtrArray     *dirs;
+
+  CcAppSizeCache *cache;
+  GMainContext  *context;
+  GCancellable  *cancellable;
+} SizeJob;
+
+typedef struct
+{
+  guint64    size;
+  gint64     stamp;
+  GPtrArray *dirs;
+  gboolean   cancelled;
+} SizeResult;
+
+typedef struct
+{
+  CcAppSizeCache *cache;
+  gchar          *key;
+  guint64         size;
+} SizeProgress;
+
+static void start_job (CcAppSizeCache *self,
+                       const gchar    *key,
+                       SizeEntry      *entry);
+
+static void
+waiter_free (gpointer data)
+{
+  Waiter *waiter = data;
+
+  if (waiter->cancellable != NULL)
+    g_cancellable_disconnect (waiter->cancellable, waiter->cancelled_id);
+
+  g_clear_object (&waiter->cancellable);
+  g_clear_object (&waiter->task);
+  g_free (waiter);
+}
+
+static void
+clear_monitors (SizeEntry *entry)
+{
+  guint i;
+
+  for (i = 0; entry->monitors != NULL && i < entry->monitors->len; i++)
+    {
+      GFileMonitor *monitor = g_ptr_array_index (entry->monitors, i);
+
+      g_signal_handlers_disconnect_by_data (monitor, entry);
+      g_file_monitor_cancel (monitor);
+    }
+
+  g_clear_pointer (&entry->monitors, g_ptr_array_unref);
+  g_clear_pointer (&entry->monitored_dirs, g_ptr_array_unref);
+}
+
+static void
+size_entry_free (gpointer data)
+{
+  SizeEntry *entry = data;
+
+  g_assert (entry->waiting == NULL);
+  g_assert (entry->cancellable == NULL);
+
+  clear_monitors (entry);
+  g_clear_pointer (&entry->dirs, g_ptr_array_unref);
+  g_free (entry->app_id);
+  g_free (entry);
+}
+
+static void
+size_job_free (gpointer data)
+{
+  SizeJob *job = data;
+
+  g_clear_pointer (&job->dirs, g_ptr_array_unref);
+  g_clear_pointer (&job->context, g_main_context_unref);
+  g_clear_object (&job->cancellable);
+  g_clear_object (&job->cache);
+  g_free (job->app_id);
+  g_free (job->key);
+  g_free (job);
+}
+
+static void
+size_result_free (gpointer data)
+{
+  SizeResult *result = data;
+
+  g_clear_pointer (&result->dirs, g_ptr_array_unref);
+  g_free (result);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SizeResult, size_result_free)
+
+static void
+size_progress_free (gpointer data)
+{
+  SizeProgress *progress = data;
+
+  g_object_unref (progress->cache);
+  g_free (progress->key);
+  g_free (progress);
+}
+
+static gchar *
+get_app_dir_path (const gchar   *app_id,
+                  CcAppSizeKind  kind)
+{
+  return g_build_filename (g_get_home_dir (), ".var", "app", app_id,
+                           kind == CC_APP_SIZE_DATA ? "data" : "cache",
+                           NULL);
+}
+
+static gint64
+get_mtime (const gchar *path)
+{
+  struct stat buf;
+
+  if (stat (path, &buf) != 0)
+    return 0;
+
+  return (gint64) buf.st_mtim.tv_sec * G_USEC_PER_SEC + buf.st_mtim.tv_nsec / 1000;
+}
+
+/* The deployment of the app, which is replaced when it gets updated */
+static gint64
+get_installed_stamp (const gchar *app_id)
+{
+  GPtrArray *installations;
+  guint i;
+
+  if (g_str_has_prefix (app_id, PORTAL_SNAP_PREFIX))
+    {
+      g_autofree gchar *path = NULL;
+
+      path = g_build_filename ("/snap", app_id + strlen (PORTAL_SNAP_PREFIX), "current", NULL);
+      return get_mtime (path);
+    }
+
+  /* The first installation the app is found in, like the index does */
+  installations = cc_flatpak_index_get_installations (cc_flatpak_index_get_default ());
+  for (i = 0; i < installations->len; i++)
+    {
+      g_autofree gchar *path = NULL;
+      gint64 stamp;
+
+      path = g_build_filename (g_ptr_array_index (installations, i), "app", app_id, "current", "active", NULL);
+      stamp = get_mtime (path);
+      if (stamp != 0)
+        return stamp;
+    }
+
+  return 0;
+}
+
+/* Changes whenever an entry is added to or removed from any of @dirs.
+ * The modification times are mixed in order rather than summed, so that
+ * one going up and another one down don't cancel each other out.
+ */
+static gint64
+get_dirs_stamp (GPtrArray *dirs)
+{
+  guint64 stamp = 0;
+  guint i;
+
+  for (i = 0; i < dirs->len; i++)
+    {
+      gint64 mtime = get_mtime (g_ptr_array_index (dirs, i));
+
+      /* A directory went away */
+      if (mtime == 0)
+        return -1;
+
+      stamp = stamp * 1000003 + (guint64) mtime;
+    }
+
+  return (gint64) (stamp & G_MAXINT64);
+}
+
+static gboolean
+emit_progress_cb (gpointer user_data)
+{
+  SizeProgress *progress = user_data;
+  SizeEntry *entry;
+
+  /* Drop the progress arriving after the size itself */
+  entry = g_hash_table_lookup (progress->cache->entries, progress->key);
+  if (entry == NULL || entry->waiting == NULL)
+    return G_SOURCE_REMOVE;
+
+  g_signal_emit (progress->cache, signals[PROGRESS], 0, entry->app_id, entry->kind, progress->size);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs in the walking threads */
+static void
+dir_size_progress_cb (guint64  size,
+                      gpointer user_data)
+{
+  SizeJob *job = user_data;
+  SizeProgress *progress;
+
+  progress = g_new0 (SizeProgress, 1);
+  progress->cache = g_object_ref (job->cache);
+  progress->key = g_strdup (job->key);
+  progress->size = size;
+
+  g_main_context_invoke_full (job->context,
+                              G_PRIORITY_DEFAULT,
+                              emit_progress_cb,
+                              progress,
+                              size_progress_free);
+}
+
+static void
+compute_size_thread_func (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  SizeJob *job = task_data;
+  SizeResult *result;
+
+  result = g_new0 (SizeResult, 1);
+
+  if (job->kind == CC_APP_SIZE_INSTALLED)
+    {
+      result->stamp = get_installed_stamp (job->app_id);
+
+      if (job->valid && job->stamp == result->stamp)
+        result->size = job->size;
+      else if (g_str_has_prefix (job->app_id, PORTAL_SNAP_PREFIX))
+        result->size = get_snap_app_size (job->app_id + strlen (PORTAL_SNAP_PREFIX));
+      else
+        result->size = get_flatpak_app_size (job->app_id);
+    }
+  else if (job->valid &&
+           job->dirs != NULL &&
+           job->dirs->len > 0 &&
+           get_dirs_stamp (job->dirs) == job->stamp)
+    {
+      result->size = job->size;
+      result->stamp = job->stamp;
+      result->dirs = g_ptr_array_ref (job->dirs);
+    }
+  else
+    {
+      g_autofree gchar *path = get_app_dir_path (job->app_id, job->kind);
+
+      result->dirs = g_ptr_array_new_with_free_func (g_free);
+      result->size = get_dir_size (path, result->dirs, job->cancellable, dir_size_progress_cb, job);
+      result->stamp = get_dirs_stamp (result->dirs);
+    }
+
+  result->cancelled = g_cancellable_is_cancelled (job->cancellable);
+
+  g_task_return_pointer (task, result, size_result_free);
+}
+
+static void
+on_dir_changed_cb (GFileMonitor      *monitor,
+                   GFile             *file,
+                   GFile             *other_file,
+                   GFileMonitorEvent  event_type,
+                   SizeEntry         *entry)
+{
+  entry->valid = FALSE;
+  entry->generation++;
+}
+
+static gboolean
+add_monitor (SizeEntry   *entry,
+             const gchar *path)
+{
+  g_autoptr(GFile) dir = NULL;
+  GFileMonitor *monitor;
+
+  dir = g_file_new_for_path (path);
+  monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+  if (monitor == NULL)
+    return FALSE;
+
+  g_signal_connect (monitor, "changed", G_CALLBACK (on_dir_changed_cb), entry);
+  g_ptr_array_add (entry->monitors, monitor);
+
+  return TRUE;
+}
+
+/* Monitors every directory the size was computed from. The size isn't
+ * kept if they can't all be monitored, since files growing in place
+ * would go unnoticed. Without any directory, there's nothing to walk
+ * the next time anyway.
+ */
+static void
+update_monitors (SizeEntry *entry)
+{
+  gboolean monitored = TRUE;
+  guint i;
+
+  if (entry->kind == CC_APP_SIZE_INSTALLED ||
+      (entry->monitored_dirs != NULL && entry->monitored_dirs == entry->dirs))
+    return;
+
+  clear_monitors (entry);
+
+  if (entry->dirs == NULL || entry->dirs->len > MAX_MONITORED_DIRS)
+    {
+      entry->valid = FALSE;
+      return;
+    }
+
+  entry->monitors = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (i = 0; monitored && i < entry->dirs->len; i++)
+    monitored = add_monitor (entry, g_ptr_array_index (entry->dirs, i));
+
+  if (!monitored)
+    {
+      clear_monitors (entry);
+      entry->valid = FALSE;
+      return;
+    }
+
+  entry->monitored_dirs = g_ptr_array_ref (entry->dirs);
+}
+
+static void
+on_size_computed_cb (GObject      *source_object,
+                     GAsyncResult *res,
+                     gpointer      user_data)
+{
+  CcAppSizeCache *self = CC_APP_SIZE_CACHE (source_object);
+  g_autoptr(SizeResult) result = NULL;
+  g_autoptr(GPtrArray) waiting = NULL;
+  SizeJob *job;
+  SizeEntry *entry;
+  guint i;
+
+  job = g_task_get_task_data (G_TASK (res));
+  result = g_task_propagate_pointer (G_TASK (res), NULL);
+
+  entry = g_hash_table_lookup (self->entries, job->key);
+  g_assert (entry != NULL);
+
+  waiting = g_steal_pointer (&entry->waiting);
+  g_clear_object (&entry->cancellable);
+
+  if (result->cancelled)
+    {
+      /* Requests that came in after the others were cancelled still
+       * want the size, so start over for them
+       */
+      i = 0;
+      while (i < waiting->len)
+        {
+          Waiter *waiter = g_ptr_array_index (waiting, i);
+
+          if (!g_cancellable_is_cancelled (waiter->cancellable))
+            {
+              if (entry->waiting == NULL)
+                entry->waiting = g_ptr_array_new_with_free_func (waiter_free);
+              g_ptr_array_add (entry->waiting, g_ptr_array_steal_index (waiting, i));
+            }
+          else
+            {
+              g_task_return_new_error (waiter->task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                       "Operation was cancelled");
+              i++;
+            }
+        }
+
+      if (entry->waiting != NULL)
+        start_job (self, job->key, entry);
+
+      return;
+    }
+
+  /* Only keep the size if nothing changed while it was computed */
+  entry->valid = entry->generation == job->generation;
+  entry->size = result->size;
+  entry->stamp = result->stamp;
+  g_clear_pointer (&entry->dirs, g_ptr_array_unref);
+  entry->dirs = g_steal_pointer (&result->dirs);
+
+  update_monitors (entry);
+
+  for (i = 0; i < waiting->len; i++)
+    {
+      Waiter *waiter = g_ptr_array_index (waiting, i);
+
+      g_task_return_pointer (waiter->task, g_memdup2 (&entry->size, sizeof (guint64)), g_free);
+    }
+}
+
+static void
+on_waiter_cancelled_cb (GCancellable *cancellable,
+                        SizeEntry    *entry)
+{
+  guint i;
+
+  if (entry->waiting == NULL || entry->cancellable == NULL)
+    return;
+
+  /* The size is still computed as long as someone wants it */
+  for (i = 0; i < entry->waiting->len; i++)
+    {
+      Waiter *waiter = g_ptr_array_index (entry->waiting, i);
+
+      if (!g_cancellable_is_cancelled (waiter->cancellable))
+        return;
+    }
+
+  g_cancellable_cancel (entry->cancellable);
+}
+
+static void
+add_waiter (SizeEntry *entry,
+            GTask     *task)
+{
+  GCancellable *cancellable = g_task_get_cancellable (task);
+  Waiter *waiter;
+
+  waiter = g_new0 (Waiter, 1);
+  waiter->task = g_object_ref (task);
+
+  if (entry->waiting == NULL)
+    entry->waiting = g_ptr_array_new_with_free_func (waiter_free);
+  g_ptr_array_add (entry->waiting, waiter);
+
+  if (cancellable != NULL)
+    {
+      waiter->cancellable = g_object_ref (cancellable);
+      waiter->cancelled_id = g_cancellable_connect (cancellable,
+                                                    G_CALLBACK (on_waiter_cancelled_cb),
+                                                    entry,
+                                                    NULL);
+    }
+}
+
+static void
+start_job (CcAppSizeCache *self,
+           const gchar    *key,
+           SizeEntry      *entry)
+{
+  g_autoptr(GTask) size_task = NULL;
+  SizeJob *job;
+
+  entry->cancellable = g_cancellable_new ();
+
+  job = g_new0 (SizeJob, 1);
+  job->kind = entry->kind;
+  job->app_id = g_strdup (entry->app_id);
+  job->key = g_strdup (key);
+  job->generation = entry->generation;
+  job->valid = entry->valid;
+  job->size = entry->size;
+  job->stamp = entry->stamp;
+  job->dirs = entry->dirs ? g_ptr_array_ref (entry->dirs) : NULL;
+  job->cache = g_object_ref (self);
+  job->context = g_main_context_ref_thread_default ();
+  job->cancellable = g_object_ref (entry->cancellable);
+
+  size_task = g_task_new (self, NULL, on_size_computed_cb, NULL);
+  g_task_set_source_tag (size_task, start_job);
+  g_task_set_task_data (size_task, job, size_job_free);
+  g_task_run_in_thread (size_task, compute_size_thread_func);
+}
+
+static void
+cc_app_size_cache_finalize (GObject *object)
+{
+  CcAppSizeCache *self = CC_APP_SIZE_CACHE (object);
+
+  g_clear_pointer (&self->entries, g_hash_table_unref);
+
+  G_OBJECT_CLASS (cc_app_size_cache_parent_class)->finalize (object);
+}
+
+static void
+cc_app_size_cache_class_init (CcAppSizeCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_app_size_cache_finalize;
+
+  /**
+   * CcAppSizeCache::progress:
+   * @self: a #CcAppSizeCache
+   * @app_id: the portal app ID of the app
+   * @kind: the #CcAppSizeKind being computed
+   * @size: the size found so far
+   *
+   * Emitted from time to time while the data or cache size of an app is
+   * being computed.
+   */
+  signals[PROGRESS] = g_signal_new ("progress",
+                                    G_TYPE_FROM_CLASS (klass),
+                                    G_SIGNAL_RUN_LAST,
+                                    0,
+                                    NULL, NULL,
+                                    NULL,
+                                    G_TYPE_NONE,
+                                    3,
+                                    G_TYPE_STRING,
+                                    G_TYPE_UINT,
+                                    G_TYPE_UINT64);
+}
+
+static void
+cc_app_size_cache_init (CcAppSizeCache *self)
+{
+  self->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, size_entry_free);
+}
+
+CcAppSizeCache *
+cc_app_size_cache_new (void)
+{
+  return CC_APP_SIZE_CACHE (g_object_new (CC_TYPE_APP_SIZE_CACHE, NULL));
+}
+
+/**
+ * cc_app_size_cache_get_default:
+ *
+ * Retrieves the cache shared by the applications panel, which is kept
+ * around when the panel is closed.
+ *
+ * Returns: (transfer none): the default #CcAppSizeCache
+ */
+CcAppSizeCache *
+cc_app_size_cache_get_default (void)
+{
+  static CcAppSizeCache *default_cache = NULL;
+
+  if (default_cache == NULL)
+    default_cache = cc_app_size_cache_new ();
+
+  return default_cache;
+}
+
+/**
+ * cc_app_size_cache_get_size_async:
+ * @self: a #CcAppSizeCache
+ * @app_id: the portal app ID of the app
+ * @kind: which size to get
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: the function to call when the size is known
+ * @user_data: data for @callback
+ *
+ * Gets the @kind size of @app_id, from the cache if it's still valid, or
+ * computing it in a thread otherwise.
+ */
+void
+cc_app_size_cache_get_size_async (CcAppSizeCache      *self,
+                                  const gchar         *app_id,
+                                  CcAppSizeKind        kind,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  g_autofree gchar *key = NULL;
+  SizeEntry *entry;
+
+  g_return_if_fail (CC_IS_APP_SIZE_CACHE (self));
+  g_return_if_fail (app_id != NULL);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cc_app_size_cache_get_size_async);
+
+  key = g_strdup_printf ("%d:%s", kind, app_id);
+  entry = g_hash_table_lookup (self->entries, key);
+  if (entry == NULL)
+    {
+      entry = g_new0 (SizeEntry, 1);
+      entry->kind = kind;
+      entry->app_id = g_strdup (app_id);
+      g_hash_table_insert (self->entries, g_strdup (key), entry);
+    }
+
+  /* Already being computed */
+  if (entry->waiting != NULL)
+    {
+      add_waiter (entry, task);
+      return;
+    }
+
+  add_waiter (entry, task);
+  start_job (self, key, entry);
+
+  /* The request might have been cancelled already */
+  on_waiter_cancelled_cb (cancellable, entry);
+}
+
+gboolean
+cc_app_size_cache_get_size_finish (CcAppSizeCache  *self,
+                                   GAsyncResult    *result,
+                                   guint64         *size,
+                                   GError         **error)
+{
+  g_autofree guint64 *data = NULL;
+
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+  data = g_task_propagate_pointer (G_TASK (result), error);
+  if (data == NULL)
+    return FALSE;
+  if (size != NULL)
+    *size = *data;
+  return TRUE;
+}
+
+/**
+ * cc_app_size_cache_invalidate:
+ * @self: a #CcAppSizeCache
+ * @app_id: the portal app ID of the app
+ *
+ * Drops the cached sizes of @app_id, for instance after clearing its
+ * cache, so that they are computed again the next time.
+ */
+void
+cc_app_size_cache_invalidate (CcAppSizeCache *self,
+                              const gchar    *app_id)
+{
+  CcAppSizeKind kind;
+
+  g_return_if_fail (CC_IS_APP_SIZE_CACHE (self));
+  g_return_if_fail (app_id != NULL);
+
+  for (kind = CC_APP_SIZE_INSTALLED; kind <= CC_APP_SIZE_CACHE; kind++)
+    {
+      g_autofree gchar *key = g_strdup_printf ("%d:%s", kind, app_id);
+      SizeEntry *entry = g_hash_table_lookup (self->entries, key);
+
+      if (entry == NULL)
+        continue;
+
+      entry->valid = FALSE;
+      entry->generation++;
+    }
+}
@@ -0,0 +1,56 @@
+/* cc-app-size-cache.h
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+  CC_APP_SIZE_INSTALLED,
+  CC_APP_SIZE_DATA,
+  CC_APP_SIZE_CACHE,
+} CcAppSizeKind;
+
+#define CC_TYPE_APP_SIZE_CACHE (cc_app_size_cache_get_type())
+G_DECLARE_FINAL_TYPE (CcAppSizeCache, cc_app_size_cache, CC, APP_SIZE_CACHE, GObject)
+
+CcAppSizeCache *cc_app_size_cache_new              (void);
+
+CcAppSizeCache *cc_app_size_cache_get_default      (void);
+
+void            cc_app_size_cache_get_size_async   (CcAppSizeCache       *self,
+                                                    const gchar          *app_id,
+                                                    CcAppSizeKind         kind,
+                                                    GCancellable         *cancellable,
+                                                    GAsyncReadyCallback   callback,
+                                                    gpointer              user_data);
+
+gboolean        cc_app_size_cache_get_size_finish  (CcAppSizeCache       *self,
+                                                    GAsyncResult         *result,
+                                                    guint64              *size,
+                                                    GError              **error);
+
+void            cc_app_size_cache_invalidate       (CcAppSizeCache       *self,
+                                                    const gchar          *app_id);
+
+G_END_DECLS
@@ -29,11 +29,14 @@
 
 #include <gio/gdesktopappinfo.h>
 
+#include "cc-app-size-cache.h"
 #include "cc-applications-panel.h"
 #include "cc-applications-row.h"
 #include "cc-list-row-info-button.h"
 #include "cc-list-row.h"
 #include "cc-default-apps-page.h"
+#include "cc-flatpak-index.h"
+#include "cc-mime-index.h"
 #include "cc-removable-media-settings.h"
 #include "cc-applications-resources.h"
 #ifdef HAVE_SNAP
@@ -41,7 +44,6 @@
 #include "cc-snap-row.h"
 #endif
 #include "cc-util.h"
-#include "globs.h"
 #include "search.h"
 #include "utils.h"
 
@@ -80,7 +82,6 @@ struct _CcApplicationsPanel
   GAppInfo        *current_app_info;
   gchar           *current_portal_app_id;
 
-  GHashTable      *globs;
   GHashTable      *search_providers;
 
   GtkImage        *app_icon_image;
@@ -121,6 +122,7 @@ struct _CcApplicationsPanel
   AdwPreferencesPage *builtin_page;
   GtkListBox      *builtin_list;
   GList           *snap_permission_rows;
+  GCancellable    *snap_cancellable;
 
   AdwButtonRow    *handler_reset_button_row;
   AdwPreferencesPage *handler_page;
@@ -139,6 +141,7 @@ struct _CcApplicationsPanel
   AdwActionRow    *storage_page_total_row;
   AdwButtonRow    *clear_cache_button_row;
 
+  GCancellable    *size_cancellable;
   guint64          app_size;
   guint64          cache_size;
   guint64          data_size;
@@ -701,36 +704,36 @@ remove_snap_permissions (CcApplicationsPanel *self)
 {
   GList *l;
 
+  g_cancellable_cancel (self->snap_cancellable);
+  g_clear_object (&self->snap_cancellable);
+
   for (l = self->snap_permission_rows; l; l = l->next)
     adw_preferences_group_remove (self->permissions_group, l->data);
   g_clear_pointer (&self->snap_permission_rows, g_list_free);
 }
 
-static gboolean
-add_snap_permissions (CcApplicationsPanel *self,
-                      GAppInfo            *info,
-                      const gchar         *app_id)
+static void
+snap_connections_cb (GObject      *object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
 {
+  CcApplicationsPanel *self;
   const gchar *snap_name;
-  g_autoptr(CcSnapdClient) client = NULL;
   g_autoptr(JsonArray) plugs = NULL;
   g_autoptr(JsonArray) slots = NULL;
   gint added = 0;
   g_autoptr(GError) error = NULL;
-  g_autoptr(GError) interfaces_error = NULL;
-
-  if (!g_str_has_prefix (app_id, PORTAL_SNAP_PREFIX))
-    return FALSE;
-  snap_name = app_id + strlen (PORTAL_SNAP_PREFIX);
 
-  client = cc_snapd_client_new ();
-
-  if (!cc_snapd_client_get_all_connections_sync (client, &plugs, &slots, cc_panel_get_cancellable (CC_PANEL (self)), &error))
+  if (!cc_snapd_client_get_all_connections_finish (CC_SNAPD_CLIENT (object), result, &plugs, &slots, &error))
     {
-      g_warning ("Failed to get snap connections: %s", error->message);
-      return FALSE;
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to get snap connections: %s", error->message);
+      return;
     }
 
+  self = CC_APPLICATIONS_PANEL (user_data);
+  snap_name = self->current_portal_app_id + strlen (PORTAL_SNAP_PREFIX);
+
   for (guint i = 0; i < json_array_get_length (plugs); i++)
     {
       JsonObject *plug = json_array_get_object_element (plugs, i);
@@ -761,16 +764,35 @@ add_snap_permissions (CcApplicationsPanel *self,
           if (g_strcmp0 (plug_interface, json_object_get_string_member (slot, "interface")) != 0)
             continue;
 
-          json_array_add_object_element (available_slots, slot);
+          /* The connections are shared with other callers, so don't steal them */
+          json_array_add_object_element (available_slots, json_object_ref (slot));
         }
 
-      row = cc_snap_row_new (cc_panel_get_cancellable (CC_PANEL (self)), plug, available_slots);
+      row = cc_snap_row_new (self->snap_cancellable, plug, available_slots);
       adw_preferences_group_add (self->permissions_group, GTK_WIDGET (row));
       self->snap_permission_rows = g_list_prepend (self->snap_permission_rows, row);
       added++;
     }
 
-    return added > 0;
+  if (added > 0)
+    gtk_widget_set_visible (GTK_WIDGET (self->permissions_group), TRUE);
+}
+
+/* The rows are added once snapd replied, which is also when the permissions
+ * group is shown if the app has no other permissions. */
+static void
+add_snap_permissions (CcApplicationsPanel *self,
+                      GAppInfo            *info,
+                      const gchar         *app_id)
+{
+  if (!g_str_has_prefix (app_id, PORTAL_SNAP_PREFIX))
+    return;
+
+  self->snap_cancellable = g_cancellable_new ();
+  cc_snapd_client_get_all_connections_async (cc_snapd_client_get_default (),
+                                             self->snap_cancellable,
+                                             snap_connections_cb,
+                                             self);
 }
 #endif
 
@@ -994,7 +1016,7 @@ update_permissions_group (CcApplicationsPanel *self,
       has_any |= set;
 
 #ifdef HAVE_SNAP
-      has_any |= add_snap_permissions (self, info, portal_app_id);
+      add_snap_permissions (self, info, portal_app_id);
 #endif
     }
   else
@@ -1032,6 +1054,7 @@ unset_cb (CcApplicationsPanel *self,
   type = (const gchar *)g_object_get_data (G_OBJECT (button), "type");
 
   g_app_info_remove_supports_type (self->current_app_info, type, NULL);
+  cc_mime_index_invalidate (cc_mime_index_get_default ());
   update_handler_dialog (self, self->current_app_info);
 }
 
@@ -1075,7 +1098,7 @@ add_file_type (CcApplicationsPanel *self,
   GtkWidget *button;
   GtkWidget *row;
 
-  glob = g_hash_table_lookup (self->globs, type);
+  glob = cc_mime_index_get_glob (cc_mime_index_get_default (), type);
 
   desc = g_content_type_get_description (type);
   row = adw_action_row_new ();
@@ -1110,30 +1133,6 @@ add_handler_row (CcApplicationsPanel *self,
     add_file_type (self, type);
 }
 
-static gboolean
-app_info_recommended_for (GAppInfo    *info,
-                          const gchar *type)
-{
-  /* this is horribly inefficient. I blame the mime system */
-  g_autolist(GObject) list = NULL;
-  GList *l;
-  gboolean ret = FALSE;
-
-  list = g_app_info_get_recommended_for_type (type);
-  for (l = list; l; l = l->next)
-    {
-      GAppInfo *ri = l->data;
-
-      if (g_app_info_equal (info, ri))
-        {
-          ret = TRUE;
-          break;
-        }
-    }
-
-  return ret;
-}
-
 static void
 handler_reset_cb (CcApplicationsPanel *self)
 {
@@ -1175,6 +1174,7 @@ update_handler_dialog (CcApplicationsPanel *self,
 {
   g_autofree gchar *header_title = NULL;
   g_autoptr(GHashTable) hash = NULL;
+  CcMimeIndex *index = cc_mime_index_get_default ();
   const gchar **types;
   guint n_associations = 0;
   gint i;
@@ -1199,7 +1199,7 @@ update_handler_dialog (CcApplicationsPanel *self,
       if (g_hash_table_contains (hash, ctype))
         continue;
 
-      if (!app_info_recommended_for (info, ctype))
+      if (!cc_mime_index_is_recommended_for (index, info, ctype))
         {
           gtk_widget_set_sensitive (GTK_WIDGET (self->handler_reset_button_row), TRUE);
           continue;
@@ -1292,7 +1292,7 @@ set_cache_size (GObject      *source,
   guint64 size;
   g_autoptr(GError) error = NULL;
 
-  if (!file_size_finish (G_FILE (source), res, &size, &error))
+  if (!cc_app_size_cache_get_size_finish (CC_APP_SIZE_CACHE (source), res, &size, &error))
     {
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         g_warning ("Failed to get flatpak cache size: %s", error->message);
@@ -1312,11 +1312,14 @@ static void
 update_cache_row (CcApplicationsPanel *self,
                   const gchar         *app_id)
 {
-  g_autoptr(GFile) dir = get_flatpak_app_dir (app_id, "cache");
-
   adw_action_row_set_subtitle (self->storage_page_cache_row, "…");
 
-  file_size_async (dir, cc_panel_get_cancellable (CC_PANEL (self)), set_cache_size, self);
+  cc_app_size_cache_get_size_async (cc_app_size_cache_get_default (),
+                                    app_id,
+                                    CC_APP_SIZE_CACHE,
+                                    self->size_cancellable,
+                                    set_cache_size,
+                                    self);
 }
 
 static void
@@ -1329,7 +1332,7 @@ set_data_size (GObject      *source,
   guint64 size;
   g_autoptr(GError) error = NULL;
 
-  if (!file_size_finish (G_FILE (source), res, &size, &error))
+  if (!cc_app_size_cache_get_size_finish (CC_APP_SIZE_CACHE (source), res, &size, &error))
     {
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         g_warning ("Failed to get flatpak data size: %s", error->message);
@@ -1347,11 +1350,14 @@ static void
 update_data_row (CcApplicationsPanel *self,
                  const gchar          *app_id)
 {
-  g_autoptr(GFile) dir = get_flatpak_app_dir (app_id, "data");
-
   adw_action_row_set_subtitle (self->storage_page_data_row, "…");
 
-  file_size_async (dir, cc_panel_get_cancellable (CC_PANEL (self)), set_data_size, self);
+  cc_app_size_cache_get_size_async (cc_app_size_cache_get_default (),
+                                    app_id,
+                                    CC_APP_SIZE_DATA,
+                                    self->size_cancellable,
+                                    set_data_size,
+                                    self);
 }
 
 static void
@@ -1369,7 +1375,8 @@ cache_cleared (GObject      *source,
       return;
     }
 
-  update_cache_row (self, self->current_app_id);
+  cc_app_size_cache_invalidate (cc_app_size_cache_get_default (), self->current_portal_app_id);
+  update_cache_row (self, self->current_portal_app_id);
 }
 
 static void
@@ -1385,15 +1392,22 @@ clear_cache_cb (CcApplicationsPanel *self)
 }
 
 static void
-update_app_row (CcApplicationsPanel *self,
-                const gchar         *app_id)
+set_app_size (GObject      *source,
+              GAsyncResult *res,
+              gpointer      data)
 {
+  CcApplicationsPanel *self = data;
   g_autofree gchar *formatted_size = NULL;
+  guint64 size;
+  g_autoptr(GError) error = NULL;
 
-  if (g_str_has_prefix (app_id, PORTAL_SNAP_PREFIX))
-    self->app_size = get_snap_app_size (app_id + strlen (PORTAL_SNAP_PREFIX));
-  else
-    self->app_size = get_flatpak_app_size (app_id);
+  if (!cc_app_size_cache_get_size_finish (CC_APP_SIZE_CACHE (source), res, &size, &error))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to get app size: %s", error->message);
+      return;
+    }
+  self->app_size = size;
 
   formatted_size = g_format_size (self->app_size);
   adw_action_row_set_subtitle (self->storage_page_app_row, formatted_size);
@@ -1401,12 +1415,52 @@ update_app_row (CcApplicationsPanel *self,
   update_total_size (self);
 }
 
+static void
+update_app_row (CcApplicationsPanel *self,
+                const gchar         *app_id)
+{
+  adw_action_row_set_subtitle (self->storage_page_app_row, "…");
+
+  cc_app_size_cache_get_size_async (cc_app_size_cache_get_default (),
+                                    app_id,
+                                    CC_APP_SIZE_INSTALLED,
+                                    self->size_cancellable,
+                                    set_app_size,
+                                    self);
+}
+
+static void
+on_app_size_progress_cb (CcApplicationsPanel *self,
+                         const gchar         *app_id,
+                         CcAppSizeKind        kind,
+                         guint64              size)
+{
+  g_autofree gchar *formatted_size = NULL;
+  g_autofree gchar *subtitle = NULL;
+
+  if (g_strcmp0 (app_id, self->current_portal_app_id) != 0)
+    return;
+
+  formatted_size = g_format_size (size);
+  subtitle = g_strdup_printf ("%s…", formatted_size);
+
+  if (kind == CC_APP_SIZE_DATA)
+    adw_action_row_set_subtitle (self->storage_page_data_row, subtitle);
+  else if (kind == CC_APP_SIZE_CACHE)
+    adw_action_row_set_subtitle (self->storage_page_cache_row, subtitle);
+}
+
 static void
 update_app_sizes (CcApplicationsPanel *self,
                   const gchar         *app_id)
 {
   gtk_widget_set_sensitive (GTK_WIDGET (self->clear_cache_button_row), FALSE);
 
+  /* Drop the sizes still coming in for the previous app */
+  g_cancellable_cancel (self->size_cancellable);
+  g_clear_object (&self->size_cancellable);
+  self->size_cancellable = g_cancellable_new ();
+
   self->app_size = self->data_size = self->cache_size = 0;
 
   update_app_row (self, app_id);
@@ -1433,6 +1487,14 @@ update_usage_section (CcApplicationsPanel *self,
   update_storage_page (self, info);
 }
 
+static void
+on_flatpak_index_changed_cb (CcApplicationsPanel *self)
+{
+  /* The permissions and size of the app might have changed with an update */
+  if (self->current_app_info != NULL)
+    update_usage_section (self, self->current_app_info);
+}
+
 /* --- panel setup --- */
 
 static void
@@ -1479,33 +1541,13 @@ update_panel (CcApplicationsPanel *self,
 }
 
 
-static gint
-compare_rows (gconstpointer  a,
-              gconstpointer  b,
-              gpointer       data)
-{
-  GAppInfo *item1 = (GAppInfo *) a;
-  GAppInfo *item2 = (GAppInfo *) b;
-
-  g_autofree gchar *key1 = NULL;
-  g_autofree gchar *key2 = NULL;
-
-  key1 = g_utf8_casefold (g_app_info_get_display_name (item1), -1);
-  key2 = g_utf8_casefold (g_app_info_get_display_name (item2), -1);
-
-  const gchar *sort_key1 = g_utf8_collate_key (key1, -1);
-  const gchar *sort_key2 = g_utf8_collate_key (key2, -1);
-
-  return strcmp (sort_key1, sort_key2);
-}
-
 static void
 populate_applications (CcApplicationsPanel *self)
 {
   g_autolist(GObject) infos = NULL;
+  g_autoptr(GList) shown_infos = NULL;
   GList *l;
 
-  g_list_store_remove_all (G_LIST_STORE (self->app_model));
 #ifdef HAVE_MALCONTENT
   g_signal_handler_block (self->manager, self->app_filter_id);
 #endif
@@ -1515,8 +1557,6 @@ populate_applications (CcApplicationsPanel *self)
   for (l = infos; l; l = l->next)
     {
       GAppInfo *info = l->data;
-      GtkWidget *row;
-      g_autofree gchar *id = NULL;
 
       if (!g_app_info_should_show (info))
         continue;
@@ -1526,13 +1566,12 @@ populate_applications (CcApplicationsPanel *self)
         continue;
 #endif
 
-      row = GTK_WIDGET (cc_applications_row_new (info));
-      g_list_store_insert_sorted (G_LIST_STORE (self->app_model), info, compare_rows, NULL);
-
-      id = get_app_id (info);
-      if (g_strcmp0 (id, self->current_app_id) == 0)
-        gtk_list_box_select_row (self->app_listbox, GTK_LIST_BOX_ROW (row));
+      shown_infos = g_list_prepend (shown_infos, info);
     }
+
+  /* Only the apps that changed get their rows created again */
+  update_app_list (G_LIST_STORE (self->app_model), shown_infos);
+
 #ifdef HAVE_MALCONTENT
   g_signal_handler_unblock (self->manager, self->app_filter_id);
 #endif
@@ -1699,6 +1738,9 @@ cc_applications_panel_dispose (GObject *object)
   g_clear_object (&self->monitor);
   g_clear_object (&self->perm_store);
 
+  g_cancellable_cancel (self->size_cancellable);
+  g_clear_object (&self->size_cancellable);
+
   G_OBJECT_CLASS (cc_applications_panel_parent_class)->dispose (object);
 }
 
@@ -1725,7 +1767,6 @@ cc_applications_panel_finalize (GObject *object)
   g_clear_object (&self->current_app_info);
   g_clear_pointer (&self->current_app_id, g_free);
   g_clear_pointer (&self->current_portal_app_id, g_free);
-  g_clear_pointer (&self->globs, g_hash_table_unref);
   g_clear_pointer (&self->search_providers, g_hash_table_unref);
 
   G_OBJECT_CLASS (cc_applications_panel_parent_class)->finalize (object);
@@ -1774,11 +1815,48 @@ cc_applications_panel_constructed (GObject *object)
   G_OBJECT_CLASS (cc_applications_panel_parent_class)->constructed (object);
 }
 
+static void
+cc_applications_panel_suspend (CcPanel *panel)
+{
+  CcApplicationsPanel *self = CC_APPLICATIONS_PANEL (panel);
+
+  if (self->monitor_id != 0)
+    g_signal_handler_block (self->monitor, self->monitor_id);
+#ifdef HAVE_MALCONTENT
+  if (self->app_filter_id != 0)
+    g_signal_handler_block (self->manager, self->app_filter_id);
+#endif
+
+  g_signal_handlers_block_by_func (cc_app_size_cache_get_default (), on_app_size_progress_cb, self);
+  g_signal_handlers_block_by_func (cc_flatpak_index_get_default (), on_flatpak_index_changed_cb, self);
+}
+
+/* Apps may have been installed, removed or updated while hidden */
+static void
+cc_applications_panel_resume (CcPanel *panel)
+{
+  CcApplicationsPanel *self = CC_APPLICATIONS_PANEL (panel);
+
+  if (self->monitor_id != 0)
+    g_signal_handler_unblock (self->monitor, self->monitor_id);
+#ifdef HAVE_MALCONTENT
+  if (self->app_filter_id != 0)
+    g_signal_handler_unblock (self->manager, self->app_filter_id);
+#endif
+
+  g_signal_handlers_unblock_by_func (cc_app_size_cache_get_default (), on_app_size_progress_cb, self);
+  g_signal_handlers_unblock_by_func (cc_flatpak_index_get_default (), on_flatpak_index_changed_cb, self);
+
+  populate_applications (self);
+  on_flatpak_index_changed_cb (self);
+}
+
 static void
 cc_applications_panel_class_init (CcApplicationsPanelClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+  CcPanelClass *panel_class = CC_PANEL_CLASS (klass);
 
   g_type_ensure (CC_TYPE_DEFAULT_APPS_PAGE);
   g_type_ensure (CC_TYPE_REMOVABLE_MEDIA_SETTINGS);
@@ -1789,6 +1867,9 @@ cc_applications_panel_class_init (CcApplicationsPanelClass *klass)
   object_class->constructed = cc_applications_panel_constructed;
   object_class->set_property = cc_applications_panel_set_property;
 
+  panel_class->suspend = cc_applications_panel_suspend;
+  panel_class->resume = cc_applications_panel_resume;
+
   g_object_class_override_property (object_class, PROP_PARAMETERS, "parameters");
 
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gnome/control-center/applications/cc-applications-panel.ui");
@@ -1895,6 +1976,18 @@ cc_applications_panel_init (CcApplicationsPanel *self)
                            self,
                            G_CONNECT_SWAPPED);
 
+  g_signal_connect_object (cc_app_size_cache_get_default (),
+                           "progress",
+                           G_CALLBACK (on_app_size_progress_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
+  g_signal_connect_object (cc_flatpak_index_get_default (),
+                           "changed",
+                           G_CALLBACK (on_flatpak_index_changed_cb),
+                           self,
+                           G_CONNECT_SWAPPED);
+
   self->filter = GTK_FILTER (gtk_custom_filter_new ((GtkCustomFilterFunc) filter_app_rows,
                                                     self, NULL));
 
@@ -1961,6 +2054,5 @@ cc_applications_panel_init (CcApplicationsPanel *self)
                             on_perm_store_ready,
                             self);
 
-  self->globs = parse_globs ();
   self->search_providers = parse_search_providers ();
 }
@@ -0,0 +1,428 @@
+/* cc-flatpak-index.c
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <config.h>
+
+#include "cc-flatpak-index.h"
+
+/*
+ * CcFlatpakIndex reads the metadata and installed size of all the apps of
+ * the Flatpak installations in one pass over their deploy directories,
+ * instead of running `flatpak info` for every app.
+ *
+ * The index is loaded the first time it's needed, and loaded again after
+ * flatpak touches the .changed file of one of the installations, which it
+ * does whenever it installs, updates or removes something. The ::changed
+ * signal is emitted then. The index can be used from any thread.
+ */
+
+#define DEFAULT_CONFIG_DIR "/etc/flatpak/installations.d"
+
+/* The format of active/deploy, see flatpak-dir.h */
+#define DEPLOY_DATA_VARIANT_TYPE "(ssasta{sv})"
+
+struct _CcFlatpakIndex
+{
+  GObject     parent;
+
+  GPtrArray  *installations;
+  GPtrArray  *monitors;
+
+  GMutex      mutex;
+  GHashTable *apps; /* app ID → FlatpakApp, NULL until loaded */
+};
+
+G_DEFINE_TYPE (CcFlatpakIndex, cc_flatpak_index, G_TYPE_OBJECT)
+
+enum {
+  CHANGED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+typedef struct
+{
+  GKeyFile *metadata;
+  gboolean  has_installed_size;
+  guint64   installed_size;
+} FlatpakApp;
+
+static void
+flatpak_app_free (gpointer data)
+{
+  FlatpakApp *app = data;
+
+  g_key_file_unref (app->metadata);
+  g_free (app);
+}
+
+static void
+add_installations_from_config (GPtrArray   *installations,
+                               const gchar *config_dir)
+{
+  g_autoptr(GDir) dir = NULL;
+  const gchar *name;
+
+  dir = g_dir_open (config_dir, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree gchar *filename = NULL;
+      g_autoptr(GKeyFile) keyfile = NULL;
+      g_auto(GStrv) groups = NULL;
+      guint i;
+
+      if (!g_str_has_suffix (name, ".conf"))
+        continue;
+
+      filename = g_build_filename (config_dir, name, NULL);
+      keyfile = g_key_file_new ();
+      if (!g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, NULL))
+        continue;
+
+      groups = g_key_file_get_groups (keyfile, NULL);
+      for (i = 0; groups[i] != NULL; i++)
+        {
+          gchar *path;
+
+          if (!g_str_has_prefix (groups[i], "Installation "))
+            continue;
+
+          path = g_key_file_get_string (keyfile, groups[i], "Path", NULL);
+          if (path != NULL)
+            g_ptr_array_add (installations, path);
+        }
+    }
+}
+
+/* The user installation first, as flatpak itself looks it up first */
+static GPtrArray *
+get_installations (const gchar *config_dir)
+{
+  GPtrArray *installations;
+  const gchar *path;
+
+  installations = g_ptr_array_new_with_free_func (g_free);
+
+  path = g_getenv ("FLATPAK_USER_DIR");
+  if (path != NULL && *path != '\0')
+    g_ptr_array_add (installations, g_strdup (path));
+  else
+    g_ptr_array_add (installations, g_build_filename (g_get_user_data_dir (), "flatpak", NULL));
+
+  path = g_getenv ("FLATPAK_SYSTEM_DIR");
+  if (path != NULL && *path != '\0')
+    g_ptr_array_add (installations, g_strdup (path));
+  else
+    g_ptr_array_add (installations, g_strdup ("/var/lib/flatpak"));
+
+  add_installations_from_config (installations, config_dir);
+
+  return installations;
+}
+
+static gboolean
+read_installed_size (const gchar *deploy_dir,
+                     guint64     *size)
+{
+  g_autofree gchar *filename = NULL;
+  g_autoptr(GVariant) deploy_data = NULL;
+  gchar *contents;
+  gsize length;
+
+  filename = g_build_filename (deploy_dir, "deploy", NULL);
+  if (!g_file_get_contents (filename, &contents, &length, NULL))
+    return FALSE;
+
+  deploy_data = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE (DEPLOY_DATA_VARIANT_TYPE),
+                                                             contents, length,
+                                                             FALSE,
+                                                             g_free, contents));
+  if (!g_variant_is_normal_form (deploy_data))
+    return FALSE;
+
+  /* Stored in big endian */
+  g_variant_get_child (deploy_data, 3, "t", size);
+  *size = GUINT64_FROM_BE (*size);
+
+  return TRUE;
+}
+
+static void
+load_installation (GHashTable  *apps,
+                   const gchar *installation)
+{
+  g_autofree gchar *apps_dir = NULL;
+  g_autoptr(GDir) dir = NULL;
+  const gchar *app_id;
+
+  apps_dir = g_build_filename (installation, "app", NULL);
+  dir = g_dir_open (apps_dir, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((app_id = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree gchar *deploy_dir = NULL;
+      g_autofree gchar *metadata_path = NULL;
+      g_autoptr(GKeyFile) metadata = NULL;
+      FlatpakApp *app;
+
+      /* Installed in an installation looked up before */
+      if (g_hash_table_contains (apps, app_id))
+        continue;
+
+      deploy_dir = g_build_filename (apps_dir, app_id, "current", "active", NULL);
+      metadata_path = g_build_filename (deploy_dir, "metadata", NULL);
+
+      metadata = g_key_file_new ();
+      if (!g_key_file_load_from_file (metadata, metadata_path, G_KEY_FILE_NONE, NULL))
+        continue;
+
+      app = g_new0 (FlatpakApp, 1);
+      app->metadata = g_steal_pointer (&metadata);
+      app->has_installed_size = read_installed_size (deploy_dir, &app->installed_size);
+
+      g_hash_table_insert (apps, g_strdup (app_id), app);
+    }
+}
+
+/* Must be called with the mutex held */
+static void
+ensure_loaded_locked (CcFlatpakIndex *self)
+{
+  guint i;
+
+  if (self->apps != NULL)
+    return;
+
+  self->apps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, flatpak_app_free);
+
+  for (i = 0; i < self->installations->len; i++)
+    load_installation (self->apps, g_ptr_array_index (self->installations, i));
+
+  g_debug ("Indexed %u Flatpak apps", g_hash_table_size (self->apps));
+}
+
+static void
+on_installation_changed_cb (CcFlatpakIndex    *self,
+                            GFile             *file,
+                            GFile             *other_file,
+                            GFileMonitorEvent  event_type)
+{
+  if (event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT &&
+      event_type != G_FILE_MONITOR_EVENT_CREATED &&
+      event_type != G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED)
+    return;
+
+  /* Loaded again the next time it's needed */
+  g_mutex_lock (&self->mutex);
+  g_clear_pointer (&self->apps, g_hash_table_unref);
+  g_mutex_unlock (&self->mutex);
+
+  g_signal_emit (self, signals[CHANGED], 0);
+}
+
+static void
+cc_flatpak_index_finalize (GObject *object)
+{
+  CcFlatpakIndex *self = CC_FLATPAK_INDEX (object);
+
+  g_clear_pointer (&self->monitors, g_ptr_array_unref);
+  g_clear_pointer (&self->installations, g_ptr_array_unref);
+  g_clear_pointer (&self->apps, g_hash_table_unref);
+  g_mutex_clear (&self->mutex);
+
+  G_OBJECT_CLASS (cc_flatpak_index_parent_class)->finalize (object);
+}
+
+static void
+cc_flatpak_index_class_init (CcFlatpakIndexClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_flatpak_index_finalize;
+
+  /**
+   * CcFlatpakIndex::changed:
+   * @self: a #CcFlatpakIndex
+   *
+   * Emitted when apps were installed, updated or removed.
+   */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0,
+                                   NULL, NULL,
+                                   NULL,
+                                   G_TYPE_NONE,
+                                   0);
+}
+
+static void
+cc_flatpak_index_init (CcFlatpakIndex *self)
+{
+  g_mutex_init (&self->mutex);
+  self->monitors = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+/**
+ * cc_flatpak_index_new:
+ * @config_dir: (nullable): the directory listing the extra installations
+ *
+ * Creates an index of the user and system installations, and of the
+ * installations configured in @config_dir, or in
+ * /etc/flatpak/installations.d if %NULL.
+ *
+ * Returns: (transfer full): a new #CcFlatpakIndex
+ */
+CcFlatpakIndex *
+cc_flatpak_index_new (const gchar *config_dir)
+{
+  CcFlatpakIndex *self;
+  guint i;
+
+  if (config_dir == NULL)
+    config_dir = DEFAULT_CONFIG_DIR;
+
+  self = g_object_new (CC_TYPE_FLATPAK_INDEX, NULL);
+  self->installations = get_installations (config_dir);
+
+  for (i = 0; i < self->installations->len; i++)
+    {
+      g_autofree gchar *path = NULL;
+      g_autoptr(GFile) file = NULL;
+      GFileMonitor *monitor;
+
+      path = g_build_filename (g_ptr_array_index (self->installations, i), ".changed", NULL);
+      file = g_file_new_for_path (path);
+
+      monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, NULL);
+      if (monitor == NULL)
+        continue;
+
+      g_signal_connect_object (monitor, "changed", G_CALLBACK (on_installation_changed_cb), self, G_CONNECT_SWAPPED);
+      g_ptr_array_add (self->monitors, monitor);
+    }
+
+  return self;
+}
+
+/**
+ * cc_flatpak_index_get_default:
+ *
+ * Retrieves the index shared by the applications panel. It must be
+ * created in the main thread, so that it gets notified of changes.
+ *
+ * Returns: (transfer none): the default #CcFlatpakIndex
+ */
+CcFlatpakIndex *
+cc_flatpak_index_get_default (void)
+{
+  static CcFlatpakIndex *default_index = NULL;
+
+  if (g_once_init_enter (&default_index))
+    g_once_init_leave (&default_index, cc_flatpak_index_new (NULL));
+
+  return default_index;
+}
+
+/**
+ * cc_flatpak_index_get_metadata:
+ * @self: a #CcFlatpakIndex
+ * @app_id: the ID of the app
+ *
+ * Returns: (transfer full) (nullable): the metadata of @app_id, or %NULL
+ *   if it isn't installed
+ */
+GKeyFile *
+cc_flatpak_index_get_metadata (CcFlatpakIndex *self,
+                               const gchar    *app_id)
+{
+  g_autoptr(GMutexLocker) locker = NULL;
+  FlatpakApp *app;
+
+  g_return_val_if_fail (CC_IS_FLATPAK_INDEX (self), NULL);
+  g_return_val_if_fail (app_id != NULL, NULL);
+
+  locker = g_mutex_locker_new (&self->mutex);
+
+  ensure_loaded_locked (self);
+
+  app = g_hash_table_lookup (self->apps, app_id);
+  if (app == NULL)
+    return NULL;
+
+  return g_key_file_ref (app->metadata);
+}
+
+/**
+ * cc_flatpak_index_get_installed_size:
+ * @self: a #CcFlatpakIndex
+ * @app_id: the ID of the app
+ * @size: (out): return location for the installed size
+ *
+ * Returns: %TRUE if the installed size of @app_id is known
+ */
+gboolean
+cc_flatpak_index_get_installed_size (CcFlatpakIndex *self,
+                                     const gchar    *app_id,
+                                     guint64        *size)
+{
+  g_autoptr(GMutexLocker) locker = NULL;
+  FlatpakApp *app;
+
+  g_return_val_if_fail (CC_IS_FLATPAK_INDEX (self), FALSE);
+  g_return_val_if_fail (app_id != NULL, FALSE);
+
+  locker = g_mutex_locker_new (&self->mutex);
+
+  ensure_loaded_locked (self);
+
+  app = g_hash_table_lookup (self->apps, app_id);
+  if (app == NULL || !app->has_installed_size)
+    return FALSE;
+
+  if (size != NULL)
+    *size = app->installed_size;
+
+  return TRUE;
+}
+
+/**
+ * cc_flatpak_index_get_installations:
+ * @self: a #CcFlatpakIndex
+ *
+ * Retrieves the paths of the Flatpak installations, in the order apps
+ * are looked up in them. They don't change over the lifetime of @self,
+ * so they can be used from any thread.
+ *
+ * Returns: (transfer none) (element-type utf8): the installation paths
+ */
+GPtrArray *
+cc_flatpak_index_get_installations (CcFlatpakIndex *self)
+{
+  g_return_val_if_fail (CC_IS_FLATPAK_INDEX (self), NULL);
+
+  return self->installations;
+}
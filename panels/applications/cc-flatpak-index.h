@@ -0,0 +1,43 @@
+/* cc-flatpak-index.h
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_FLATPAK_INDEX (cc_flatpak_index_get_type())
+G_DECLARE_FINAL_TYPE (CcFlatpakIndex, cc_flatpak_index, CC, FLATPAK_INDEX, GObject)
+
+CcFlatpakIndex *cc_flatpak_index_new                 (const gchar    *config_dir);
+
+CcFlatpakIndex *cc_flatpak_index_get_default         (void);
+
+GKeyFile       *cc_flatpak_index_get_metadata        (CcFlatpakIndex *self,
+                                                      const gchar    *app_id);
+
+gboolean        cc_flatpak_index_get_installed_size  (CcFlatpakIndex *self,
+                                                      const gchar    *app_id,
+                                                      guint64        *size);
+
+GPtrArray      *cc_flatpak_index_get_installations   (CcFlatpakIndex *self);
+
+G_END_DECLS
@@ -0,0 +1,453 @@
+/* cc-mime-index.c
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <config.h>
+
+#include <gio/gdesktopappinfo.h>
+#include <string.h>
+
+#include "cc-mime-index.h"
+
+/*
+ * CcMimeIndex answers the questions the handlers page asks for every type
+ * an app supports, without asking GIO, which loads every app recommended
+ * for a type to answer them.
+ *
+ * An app is recommended for the types it supports, unless a mimeapps.list
+ * file removed the association. So only the mimeapps.list files are read,
+ * in the order GIO reads them: the user configuration, the user data, the
+ * system configuration and the system data directories. The first file that
+ * adds or removes an association wins, but as in GIO, the types listed in
+ * the desktop file of an app count as added in its directory, after the
+ * mimeapps.list files of that directory. They are read again after GIO
+ * notices apps or associations changed.
+ *
+ * The globs of the types are read once, from the mapped globs2 files of
+ * shared-mime-info.
+ *
+ * The index must only be used from the main thread.
+ */
+
+typedef enum
+{
+  ASSOCIATION_ADDED = 1,
+  ASSOCIATION_REMOVED,
+} Association;
+
+/* Associations are stored along with the index of the directory they're from */
+#define ASSOCIATION_PACK(association, dir) GUINT_TO_POINTER ((dir) << 2 | (association))
+#define ASSOCIATION_GET_KIND(value)        (GPOINTER_TO_UINT (value) & 3)
+#define ASSOCIATION_GET_DIR(value)         (GPOINTER_TO_UINT (value) >> 2)
+
+struct _CcMimeIndex
+{
+  GObject          parent;
+
+  GAppInfoMonitor *monitor;
+
+  GHashTable      *globs;        /* type → glob, NULL until loaded */
+  GHashTable      *associations; /* type → (desktop ID → packed Association), NULL until loaded */
+  GPtrArray       *dirs;         /* directories the associations were read from, in order */
+};
+
+G_DEFINE_TYPE (CcMimeIndex, cc_mime_index, G_TYPE_OBJECT)
+
+/* Lines are weight:type:glob[:flags] */
+static void
+add_glob_from_line (GHashTable  *globs,
+                    const gchar *line,
+                    const gchar *line_end)
+{
+  const gchar *type, *type_end, *glob, *glob_end;
+  g_autofree gchar *key = NULL;
+
+  if (line == line_end || *line == '#')
+    return;
+
+  type = memchr (line, ':', line_end - line);
+  if (type == NULL)
+    return;
+  type++;
+
+  type_end = memchr (type, ':', line_end - type);
+  if (type_end == NULL)
+    return;
+
+  glob = type_end + 1;
+  glob_end = memchr (glob, ':', line_end - glob);
+  if (glob_end == NULL)
+    glob_end = line_end;
+
+  /* The lines are sorted by decreasing weight, and the first glob is kept */
+  key = g_strndup (type, type_end - type);
+  if (!g_hash_table_contains (globs, key))
+    g_hash_table_insert (globs, g_steal_pointer (&key), g_strndup (glob, glob_end - glob));
+}
+
+static void
+add_globs_from_file (GHashTable  *globs,
+                     const gchar *data_dir)
+{
+  g_autofree gchar *filename = NULL;
+  g_autoptr(GMappedFile) file = NULL;
+  const gchar *line, *end;
+
+  filename = g_build_filename (data_dir, "mime", "globs2", NULL);
+  file = g_mapped_file_new (filename, FALSE, NULL);
+  if (file == NULL)
+    return;
+
+  line = g_mapped_file_get_contents (file);
+  end = line + g_mapped_file_get_length (file);
+
+  while (line < end)
+    {
+      const gchar *line_end = memchr (line, '\n', end - line);
+
+      if (line_end == NULL)
+        line_end = end;
+
+      add_glob_from_line (globs, line, line_end);
+      line = line_end + 1;
+    }
+}
+
+static void
+ensure_globs (CcMimeIndex *self)
+{
+  const gchar * const *dirs;
+  guint i;
+
+  if (self->globs != NULL)
+    return;
+
+  self->globs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  add_globs_from_file (self->globs, g_get_user_data_dir ());
+
+  dirs = g_get_system_data_dirs ();
+  for (i = 0; dirs[i] != NULL; i++)
+    add_globs_from_file (self->globs, dirs[i]);
+}
+
+static void
+add_associations_from_group (GHashTable  *associations,
+                             GKeyFile    *keyfile,
+                             const gchar *group,
+                             Association  association,
+                             guint        dir)
+{
+  g_auto(GStrv) keys = NULL;
+  guint i;
+
+  keys = g_key_file_get_keys (keyfile, group, NULL, NULL);
+  if (keys == NULL)
+    return;
+
+  for (i = 0; keys[i] != NULL; i++)
+    {
+      g_autofree gchar *type = NULL;
+      g_auto(GStrv) desktop_ids = NULL;
+      GHashTable *apps;
+      guint j;
+
+      desktop_ids = g_key_file_get_string_list (keyfile, group, keys[i], NULL, NULL);
+      if (desktop_ids == NULL)
+        continue;
+
+      /* Unaliased, as the types of the apps are */
+      type = g_content_type_from_mime_type (keys[i]);
+      if (type == NULL)
+        continue;
+
+      apps = g_hash_table_lookup (associations, type);
+      if (apps == NULL)
+        {
+          apps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+          g_hash_table_insert (associations, g_strdup (type), apps);
+        }
+
+      for (j = 0; desktop_ids[j] != NULL; j++)
+        {
+          if (!g_hash_table_contains (apps, desktop_ids[j]))
+            g_hash_table_insert (apps, g_strdup (desktop_ids[j]), ASSOCIATION_PACK (association, dir));
+        }
+    }
+}
+
+static void
+add_associations_from_dir (CcMimeIndex         *self,
+                           gchar               *dir,
+                           const gchar * const *desktops)
+{
+  guint index = self->dirs->len;
+  guint i;
+
+  g_ptr_array_add (self->dirs, dir);
+
+  /* The desktop specific files first, then the common one */
+  for (i = 0; desktops[i] != NULL; i++)
+    {
+      g_autofree gchar *basename = g_strdup_printf ("%s-mimeapps.list", desktops[i]);
+      g_autofree gchar *filename = g_build_filename (dir, basename, NULL);
+      g_autoptr(GKeyFile) keyfile = g_key_file_new ();
+
+      if (!g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, NULL))
+        continue;
+
+      /* Within a file, additions take precedence over removals */
+      add_associations_from_group (self->associations, keyfile, "Added Associations", ASSOCIATION_ADDED, index);
+      add_associations_from_group (self->associations, keyfile, "Removed Associations", ASSOCIATION_REMOVED, index);
+    }
+
+  {
+    g_autofree gchar *filename = g_build_filename (dir, "mimeapps.list", NULL);
+    g_autoptr(GKeyFile) keyfile = g_key_file_new ();
+
+    if (g_key_file_load_from_file (keyfile, filename, G_KEY_FILE_NONE, NULL))
+      {
+        add_associations_from_group (self->associations, keyfile, "Added Associations", ASSOCIATION_ADDED, index);
+        add_associations_from_group (self->associations, keyfile, "Removed Associations", ASSOCIATION_REMOVED, index);
+      }
+  }
+}
+
+static GStrv
+get_current_desktops (void)
+{
+  const gchar *current_desktop;
+  GStrv desktops;
+  guint i;
+
+  current_desktop = g_getenv ("XDG_CURRENT_DESKTOP");
+  if (current_desktop == NULL)
+    return g_new0 (gchar *, 1);
+
+  desktops = g_strsplit (current_desktop, ":", 0);
+  for (i = 0; desktops[i] != NULL; i++)
+    {
+      gchar *lower = g_ascii_strdown (desktops[i], -1);
+
+      g_free (desktops[i]);
+      desktops[i] = lower;
+    }
+
+  return desktops;
+}
+
+static void
+ensure_associations (CcMimeIndex *self)
+{
+  g_auto(GStrv) desktops = NULL;
+  const gchar * const *dirs;
+  guint i;
+
+  if (self->associations != NULL)
+    return;
+
+  self->associations = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+  self->dirs = g_ptr_array_new_with_free_func (g_free);
+  desktops = get_current_desktops ();
+
+  add_associations_from_dir (self, g_strdup (g_get_user_config_dir ()), (const gchar * const *) desktops);
+  add_associations_from_dir (self, g_build_filename (g_get_user_data_dir (), "applications", NULL), (const gchar * const *) desktops);
+
+  dirs = g_get_system_config_dirs ();
+  for (i = 0; dirs[i] != NULL; i++)
+    add_associations_from_dir (self, g_strdup (dirs[i]), (const gchar * const *) desktops);
+
+  dirs = g_get_system_data_dirs ();
+  for (i = 0; dirs[i] != NULL; i++)
+    add_associations_from_dir (self, g_build_filename (dirs[i], "applications", NULL), (const gchar * const *) desktops);
+}
+
+/* The index of the directory the desktop file of @info is in, or G_MAXUINT */
+static guint
+get_app_dir (CcMimeIndex *self,
+             GAppInfo    *info)
+{
+  const gchar *filename;
+  guint i;
+
+  if (!G_IS_DESKTOP_APP_INFO (info))
+    return G_MAXUINT;
+
+  filename = g_desktop_app_info_get_filename (G_DESKTOP_APP_INFO (info));
+  if (filename == NULL)
+    return G_MAXUINT;
+
+  /* Desktop files can be in subdirectories, with a prefixed desktop ID */
+  for (i = 0; i < self->dirs->len; i++)
+    {
+      const gchar *dir = g_ptr_array_index (self->dirs, i);
+      gsize len = strlen (dir);
+
+      if (strncmp (filename, dir, len) == 0 && filename[len] == G_DIR_SEPARATOR)
+        return i;
+    }
+
+  return G_MAXUINT;
+}
+
+static void
+cc_mime_index_finalize (GObject *object)
+{
+  CcMimeIndex *self = CC_MIME_INDEX (object);
+
+  g_clear_object (&self->monitor);
+  g_clear_pointer (&self->globs, g_hash_table_unref);
+  g_clear_pointer (&self->associations, g_hash_table_unref);
+  g_clear_pointer (&self->dirs, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (cc_mime_index_parent_class)->finalize (object);
+}
+
+static void
+cc_mime_index_class_init (CcMimeIndexClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_mime_index_finalize;
+}
+
+static void
+cc_mime_index_init (CcMimeIndex *self)
+{
+  self->monitor = g_app_info_monitor_get ();
+  g_signal_connect_object (self->monitor, "changed", G_CALLBACK (cc_mime_index_invalidate), self, G_CONNECT_SWAPPED);
+}
+
+CcMimeIndex *
+cc_mime_index_new (void)
+{
+  return CC_MIME_INDEX (g_object_new (CC_TYPE_MIME_INDEX, NULL));
+}
+
+/**
+ * cc_mime_index_get_default:
+ *
+ * Returns: (transfer none): the #CcMimeIndex shared by the panel
+ */
+CcMimeIndex *
+cc_mime_index_get_default (void)
+{
+  static CcMimeIndex *default_index = NULL;
+
+  if (default_index == NULL)
+    default_index = cc_mime_index_new ();
+
+  return default_index;
+}
+
+/**
+ * cc_mime_index_get_glob:
+ * @self: a #CcMimeIndex
+ * @content_type: a content type
+ *
+ * Returns: (nullable): the glob that matches files of @content_type with
+ *   the highest weight, or %NULL if there's none
+ */
+const gchar *
+cc_mime_index_get_glob (CcMimeIndex *self,
+                        const gchar *content_type)
+{
+  g_return_val_if_fail (CC_IS_MIME_INDEX (self), NULL);
+  g_return_val_if_fail (content_type != NULL, NULL);
+
+  ensure_globs (self);
+
+  return g_hash_table_lookup (self->globs, content_type);
+}
+
+/**
+ * cc_mime_index_is_recommended_for:
+ * @self: a #CcMimeIndex
+ * @info: a #GAppInfo
+ * @content_type: one of the content types @info supports
+ *
+ * Gets whether @info is recommended for @content_type, as
+ * g_app_info_get_recommended_for_type() would tell.
+ *
+ * Returns: %TRUE unless the association of @info with @content_type was
+ *   removed
+ */
+gboolean
+cc_mime_index_is_recommended_for (CcMimeIndex *self,
+                                  GAppInfo    *info,
+                                  const gchar *content_type)
+{
+  const gchar *desktop_id;
+  GHashTable *apps;
+  gpointer value;
+
+  g_return_val_if_fail (CC_IS_MIME_INDEX (self), FALSE);
+  g_return_val_if_fail (G_IS_APP_INFO (info), FALSE);
+  g_return_val_if_fail (content_type != NULL, FALSE);
+
+  desktop_id = g_app_info_get_id (info);
+
+  /* Not an installed app, so only GIO knows */
+  if (desktop_id == NULL)
+    {
+      g_autolist(GObject) recommended = g_app_info_get_recommended_for_type (content_type);
+      GList *l;
+
+      for (l = recommended; l != NULL; l = l->next)
+        {
+          if (g_app_info_equal (info, l->data))
+            return TRUE;
+        }
+
+      return FALSE;
+    }
+
+  ensure_associations (self);
+
+  apps = g_hash_table_lookup (self->associations, content_type);
+  if (apps == NULL)
+    return TRUE;
+
+  value = g_hash_table_lookup (apps, desktop_id);
+  if (value == NULL)
+    return TRUE;
+
+  /* A directory read after the one of the app can't remove the types of its desktop file */
+  if (ASSOCIATION_GET_DIR (value) > get_app_dir (self, info))
+    return TRUE;
+
+  return ASSOCIATION_GET_KIND (value) != ASSOCIATION_REMOVED;
+}
+
+/**
+ * cc_mime_index_invalidate:
+ * @self: a #CcMimeIndex
+ *
+ * Reads the associations again the next time they're needed, after they
+ * were changed with g_app_info_add_supports_type() or similar, before GIO
+ * notices it.
+ */
+void
+cc_mime_index_invalidate (CcMimeIndex *self)
+{
+  g_return_if_fail (CC_IS_MIME_INDEX (self));
+
+  g_clear_pointer (&self->associations, g_hash_table_unref);
+  g_clear_pointer (&self->dirs, g_ptr_array_unref);
+}
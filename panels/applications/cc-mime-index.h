@@ -1,6 +1,6 @@
-/* globs.h
+/* cc-mime-index.h
  *
- * Copyright 2018 Matthias Clasen <matthias.clasen@gmail.com>
+ * Copyright 2026 The GNOME Settings contributors
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -24,6 +24,20 @@
 
 G_BEGIN_DECLS
 
-GHashTable* parse_globs (void);
+#define CC_TYPE_MIME_INDEX (cc_mime_index_get_type())
+G_DECLARE_FINAL_TYPE (CcMimeIndex, cc_mime_index, CC, MIME_INDEX, GObject)
+
+CcMimeIndex *cc_mime_index_new                 (void);
+
+CcMimeIndex *cc_mime_index_get_default         (void);
+
+const gchar *cc_mime_index_get_glob            (CcMimeIndex *self,
+                                                const gchar *content_type);
+
+gboolean     cc_mime_index_is_recommended_for  (CcMimeIndex *self,
+                                                GAppInfo    *info,
+                                                const gchar *content_type);
+
+void         cc_mime_index_invalidate          (CcMimeIndex *self);
 
 G_END_DECLS
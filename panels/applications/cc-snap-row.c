@@ -37,7 +37,6 @@ struct _CcSnapRow
 
   GCancellable  *cancellable;
 
-  CcSnapdClient *client;
   JsonObject    *plug;
   JsonObject    *connected_slot;
   JsonArray     *slots;
@@ -91,7 +90,6 @@ enable_controls (CcSnapRow *self)
 static void
 change_complete (CcSnapRow *self)
 {
-  g_clear_object (&self->client);
   g_clear_pointer (&self->target_slot, json_object_unref);
   g_clear_pointer (&self->change_id, g_free);
   g_clear_handle_id (&self->change_timeout, g_source_remove);
@@ -100,19 +98,28 @@ change_complete (CcSnapRow *self)
   enable_controls (self);
 }
 
-static gboolean
-poll_change_cb (gpointer user_data)
+static gboolean poll_change_cb (gpointer user_data);
+
+static void
+get_change_cb (GObject      *object,
+               GAsyncResult *result,
+               gpointer      user_data)
 {
-  CcSnapRow *self = user_data;
+  CcSnapRow *self;
   g_autoptr(JsonObject) change = NULL;
   g_autoptr(GError) error = NULL;
 
-  change = cc_snapd_client_get_change_sync (self->client, self->change_id, self->cancellable, &error);
+  change = cc_snapd_client_get_change_finish (CC_SNAPD_CLIENT (object), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_SNAP_ROW (user_data);
+
   if (change == NULL)
     {
       g_warning ("Failed to monitor change %s: %s", self->change_id, error->message);
       change_complete (self);
-      return G_SOURCE_REMOVE;
+      return;
     }
 
   if (json_object_get_boolean_member (change, "ready"))
@@ -130,10 +137,26 @@ poll_change_cb (gpointer user_data)
         }
 
       change_complete (self);
-      return G_SOURCE_REMOVE;
+      return;
     }
 
-  return G_SOURCE_CONTINUE;
+  self->change_timeout = g_timeout_add (CHANGE_POLL_TIME, poll_change_cb, self);
+}
+
+static gboolean
+poll_change_cb (gpointer user_data)
+{
+  CcSnapRow *self = user_data;
+
+  /* Polled again once snapd replied */
+  self->change_timeout = 0;
+  cc_snapd_client_get_change_async (cc_snapd_client_get_default (),
+                                    self->change_id,
+                                    self->cancellable,
+                                    get_change_cb,
+                                    self);
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
@@ -145,20 +168,34 @@ monitor_change (CcSnapRow *self, const gchar *change_id)
   self->change_timeout = g_timeout_add (CHANGE_POLL_TIME, poll_change_cb, self);
 }
 
-static CcSnapdClient *
-get_client(CcSnapRow *self)
+static void
+connect_interface_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
 {
-  if (self->client == NULL)
-    self->client = cc_snapd_client_new ();
-  return self->client;
+  CcSnapRow *self;
+  g_autofree gchar *change_id = NULL;
+  g_autoptr(GError) error = NULL;
+
+  change_id = cc_snapd_client_connect_interface_finish (CC_SNAPD_CLIENT (object), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_SNAP_ROW (user_data);
+
+  if (change_id == NULL)
+    {
+      g_warning ("Failed to connect plug: %s", error->message);
+      change_complete (self);
+      return;
+    }
+
+  monitor_change (self, change_id);
 }
 
 static void
 connect_plug (CcSnapRow *self, JsonObject *slot)
 {
-  g_autofree gchar *change_id = NULL;
-  g_autoptr(GError) error = NULL;
-
   /* already connected */
   if (self->connected_slot != NULL &&
       g_strcmp0 (json_object_get_string_member (self->connected_slot, "snap"),
@@ -169,42 +206,34 @@ connect_plug (CcSnapRow *self, JsonObject *slot)
 
   disable_controls (self);
 
-  change_id = cc_snapd_client_connect_interface_sync (get_client (self),
-                                                      json_object_get_string_member (self->plug, "snap"),
-                                                      json_object_get_string_member (self->plug, "plug"),
-                                                      json_object_get_string_member (slot, "snap"),
-                                                      json_object_get_string_member (slot, "slot"),
-                                                      self->cancellable,
-                                                      &error);
-  if (change_id == NULL)
-    {
-      g_warning ("Failed to connect plug: %s", error->message);
-      change_complete (self);
-      return;
-    }
-
   g_clear_pointer (&self->target_slot, json_object_unref);
   self->target_slot = json_object_ref (slot);
-  monitor_change (self, change_id);
+
+  cc_snapd_client_connect_interface_async (cc_snapd_client_get_default (),
+                                           json_object_get_string_member (self->plug, "snap"),
+                                           json_object_get_string_member (self->plug, "plug"),
+                                           json_object_get_string_member (slot, "snap"),
+                                           json_object_get_string_member (slot, "slot"),
+                                           self->cancellable,
+                                           connect_interface_cb,
+                                           self);
 }
 
 static void
-disconnect_plug (CcSnapRow *self)
+disconnect_interface_cb (GObject      *object,
+                         GAsyncResult *result,
+                         gpointer      user_data)
 {
+  CcSnapRow *self;
   g_autofree gchar *change_id = NULL;
   g_autoptr(GError) error = NULL;
 
-  /* already disconnected */
-  if (self->connected_slot == NULL)
+  change_id = cc_snapd_client_disconnect_interface_finish (CC_SNAPD_CLIENT (object), result, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
     return;
 
-  disable_controls (self);
+  self = CC_SNAP_ROW (user_data);
 
-  change_id = cc_snapd_client_disconnect_interface_sync (get_client (self),
-                                                         json_object_get_string_member (self->plug, "snap"),
-                                                         json_object_get_string_member (self->plug, "plug"),
-                                                         "", "",
-                                                         self->cancellable, &error);
   if (change_id == NULL)
     {
       g_warning ("Failed to disconnect plug: %s", error->message);
@@ -212,10 +241,29 @@ disconnect_plug (CcSnapRow *self)
       return;
     }
 
-  g_clear_pointer (&self->target_slot, json_object_unref);
   monitor_change (self, change_id);
 }
 
+static void
+disconnect_plug (CcSnapRow *self)
+{
+  /* already disconnected */
+  if (self->connected_slot == NULL)
+    return;
+
+  disable_controls (self);
+
+  g_clear_pointer (&self->target_slot, json_object_unref);
+
+  cc_snapd_client_disconnect_interface_async (cc_snapd_client_get_default (),
+                                              json_object_get_string_member (self->plug, "snap"),
+                                              json_object_get_string_member (self->plug, "plug"),
+                                              "", "",
+                                              self->cancellable,
+                                              disconnect_interface_cb,
+                                              self);
+}
+
 static void
 switch_changed_cb (CcSnapRow *self)
 {
@@ -367,8 +415,8 @@ cc_snap_row_finalize (GObject *object)
   CcSnapRow *self = CC_SNAP_ROW (object);
 
   g_clear_object (&self->cancellable);
-  g_clear_object (&self->client);
   g_clear_pointer (&self->plug, json_object_unref);
+  g_clear_pointer (&self->connected_slot, json_object_unref);
   g_clear_pointer (&self->slots, json_array_unref);
   g_clear_pointer (&self->target_slot, json_object_unref);
   g_clear_pointer (&self->change_id, g_free);
@@ -428,7 +476,7 @@ cc_snap_row_new (GCancellable *cancellable, JsonObject *plug, JsonArray *slots)
                          json_object_get_string_member (connected_slot_ref, "snap")) == 0 &&
               g_strcmp0 (json_object_get_string_member (slot, "slot"),
                          json_object_get_string_member (connected_slot_ref, "slot")) == 0)
-            self->connected_slot = slot;
+            self->connected_slot = json_object_ref (slot);
         }
     }
 
@@ -25,16 +25,41 @@
 // Unix socket that snapd communicates on.
 #define SNAPD_SOCKET_PATH "/var/run/snapd.socket"
 
+// How long a response to /v2/connections is reused for.
+#define CONNECTIONS_CACHE_TIME (2 * G_USEC_PER_SEC)
+
 struct _CcSnapdClient
 {
   GObject parent;
 
-  // HTTP connection to snapd.
+  gchar *socket_path;
+
+  // HTTP connection to snapd. The session keeps its connections alive, so
+  // that requests following each other don't have to connect again.
   SoupSession *session;
+
+  // Last response to /v2/connections and when it was received.
+  JsonObject *connections;
+  gint64 connections_time;
+
+  // Tasks waiting for the /v2/connections request in flight, if any.
+  GPtrArray *connections_waiters;
+
+  // Changed each time the interface connections may have changed.
+  guint connections_generation;
+  guint connections_request_generation;
 };
 
 G_DEFINE_TYPE (CcSnapdClient, cc_snapd_client, G_TYPE_OBJECT)
 
+enum {
+  PROP_0,
+  PROP_SOCKET_PATH,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
 // Make an HTTP request to send to snapd.
 static SoupMessage *
 make_message (const gchar *method, const gchar *path, JsonNode *request_body)
@@ -129,17 +154,155 @@ call_sync (CcSnapdClient *self,
   return process_body (msg, response_body, error);
 }
 
-// Perform a snap interface action.
-static gchar *
-call_interfaces_sync (CcSnapdClient *self,
-                      const gchar *action,
+static void
+send_and_read_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  SoupMessage *msg = g_task_get_task_data (task);
+  g_autoptr(GBytes) response_body = NULL;
+  JsonObject *response;
+  GError *error = NULL;
+
+  response_body = soup_session_send_and_read_finish (SOUP_SESSION (object), result, &error);
+  if (response_body == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  response = process_body (msg, response_body, &error);
+  if (response == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task, response, (GDestroyNotify) json_object_unref);
+}
+
+// Send an HTTP request to snapd without waiting for the response. Requests
+// made while others are in flight are queued on the connections of the
+// session.
+static void
+call_async (CcSnapdClient *self,
+            const gchar *method, const gchar *path, JsonNode *request_body,
+            GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  SoupMessage *msg;
+
+  msg = make_message (method, path, request_body);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, call_async);
+  g_task_set_task_data (task, msg, g_object_unref);
+
+  soup_session_send_and_read_async (self->session, msg, G_PRIORITY_DEFAULT, cancellable,
+                                    send_and_read_cb, g_steal_pointer (&task));
+}
+
+static JsonObject *
+call_finish (CcSnapdClient *self, GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+// Get the result member of a response.
+static JsonObject *
+get_result (JsonObject *response, const gchar *path, GError **error)
+{
+  JsonObject *result;
+
+  result = json_object_get_object_member (response, "result");
+  if (result == NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Invalid response to %s", path);
+      return NULL;
+    }
+
+  return json_object_ref (result);
+}
+
+static void
+get_result_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  g_autoptr(JsonObject) response = NULL;
+  JsonObject *response_result = NULL;
+  GError *error = NULL;
+
+  response = call_finish (CC_SNAPD_CLIENT (object), result, &error);
+  if (response != NULL)
+    response_result = get_result (response, g_task_get_task_data (task), &error);
+  if (response == NULL || response_result == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task, response_result, (GDestroyNotify) json_object_unref);
+}
+
+// Send a GET request to snapd and return the result member of the response.
+static void
+get_result_async (CcSnapdClient *self, const gchar *path, gpointer source_tag,
+                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, g_strdup (path), g_free);
+
+  call_async (self, "GET", path, NULL, cancellable, get_result_cb, g_steal_pointer (&task));
+}
+
+// Forget the state of the interface connections, as it may have changed.
+static void
+invalidate_connections (CcSnapdClient *self)
+{
+  g_clear_pointer (&self->connections, json_object_unref);
+  self->connections_generation++;
+}
+
+static JsonObject *
+lookup_connections (CcSnapdClient *self)
+{
+  if (self->connections == NULL ||
+      g_get_monotonic_time () - self->connections_time >= CONNECTIONS_CACHE_TIME)
+    return NULL;
+
+  return json_object_ref (self->connections);
+}
+
+static void
+store_connections (CcSnapdClient *self, guint generation, JsonObject *connections)
+{
+  // The connections may have changed while the request was in flight
+  if (generation != self->connections_generation)
+    return;
+
+  g_clear_pointer (&self->connections, json_object_unref);
+  self->connections = json_object_ref (connections);
+  self->connections_time = g_get_monotonic_time ();
+}
+
+static gboolean
+change_is_ready (JsonObject *change)
+{
+  return json_object_has_member (change, "ready") &&
+         json_object_get_boolean_member (change, "ready");
+}
+
+// Build the body of a snap interface action.
+static JsonNode *
+make_interfaces_body (const gchar *action,
                       const gchar *plug_snap, const gchar *plug_name,
-                      const gchar *slot_snap, const gchar *slot_name,
-                      GCancellable *cancellable, GError **error)
+                      const gchar *slot_snap, const gchar *slot_name)
 {
   g_autoptr(JsonBuilder) builder = NULL;
-  g_autoptr(JsonObject) response = NULL;
-  const gchar *change_id;
 
   builder = json_builder_new();
   json_builder_begin_object (builder);
@@ -165,8 +328,25 @@ call_interfaces_sync (CcSnapdClient *self,
   json_builder_end_array (builder);
   json_builder_end_object (builder);
 
-  response = call_sync (self, "POST", "/v2/interfaces",
-                        json_builder_get_root (builder), cancellable, error);
+  return json_builder_get_root (builder);
+}
+
+// Perform a snap interface action.
+static gchar *
+call_interfaces_sync (CcSnapdClient *self,
+                      const gchar *action,
+                      const gchar *plug_snap, const gchar *plug_name,
+                      const gchar *slot_snap, const gchar *slot_name,
+                      GCancellable *cancellable, GError **error)
+{
+  g_autoptr(JsonNode) body = NULL;
+  g_autoptr(JsonObject) response = NULL;
+  const gchar *change_id;
+
+  invalidate_connections (self);
+
+  body = make_interfaces_body (action, plug_snap, plug_name, slot_snap, slot_name);
+  response = call_sync (self, "POST", "/v2/interfaces", body, cancellable, error);
   if (response == NULL)
     return NULL;
 
@@ -175,6 +355,94 @@ call_interfaces_sync (CcSnapdClient *self,
   return g_strdup (change_id);
 }
 
+static void
+call_interfaces_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  g_autoptr(JsonObject) response = NULL;
+  GError *error = NULL;
+
+  response = call_finish (CC_SNAPD_CLIENT (object), result, &error);
+  if (response == NULL)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task, g_strdup (json_object_get_string_member (response, "change")), g_free);
+}
+
+// Perform a snap interface action without waiting for snapd to accept it.
+static void
+call_interfaces_async (CcSnapdClient *self,
+                       const gchar *action,
+                       const gchar *plug_snap, const gchar *plug_name,
+                       const gchar *slot_snap, const gchar *slot_name,
+                       gpointer source_tag,
+                       GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_autoptr(JsonNode) body = NULL;
+  g_autoptr(GTask) task = NULL;
+
+  invalidate_connections (self);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+
+  body = make_interfaces_body (action, plug_snap, plug_name, slot_snap, slot_name);
+  call_async (self, "POST", "/v2/interfaces", body, cancellable, call_interfaces_cb, g_steal_pointer (&task));
+}
+
+static void
+cc_snapd_client_get_property (GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  CcSnapdClient *self = CC_SNAPD_CLIENT (object);
+
+  switch (prop_id)
+    {
+    case PROP_SOCKET_PATH:
+      g_value_set_string (value, self->socket_path);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+cc_snapd_client_set_property (GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  CcSnapdClient *self = CC_SNAPD_CLIENT (object);
+
+  switch (prop_id)
+    {
+    case PROP_SOCKET_PATH:
+      self->socket_path = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+cc_snapd_client_constructed (GObject *object)
+{
+  CcSnapdClient *self = CC_SNAPD_CLIENT (object);
+  g_autoptr(GSocketAddress) address = NULL;
+
+  G_OBJECT_CLASS (cc_snapd_client_parent_class)->constructed (object);
+
+  address = g_unix_socket_address_new (self->socket_path);
+  self->session = soup_session_new_with_options ("remote-connectable", address, NULL);
+}
+
 static void
 cc_snapd_client_dispose (GObject *object)
 {
@@ -185,19 +453,41 @@ cc_snapd_client_dispose (GObject *object)
   G_OBJECT_CLASS (cc_snapd_client_parent_class)->dispose (object);
 }
 
+static void
+cc_snapd_client_finalize (GObject *object)
+{
+  CcSnapdClient *self = CC_SNAPD_CLIENT (object);
+
+  g_clear_pointer (&self->socket_path, g_free);
+  g_clear_pointer (&self->connections, json_object_unref);
+  g_clear_pointer (&self->connections_waiters, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (cc_snapd_client_parent_class)->finalize (object);
+}
+
 static void
 cc_snapd_client_class_init (CcSnapdClientClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  object_class->get_property = cc_snapd_client_get_property;
+  object_class->set_property = cc_snapd_client_set_property;
+  object_class->constructed = cc_snapd_client_constructed;
   object_class->dispose = cc_snapd_client_dispose;
+  object_class->finalize = cc_snapd_client_finalize;
+
+  properties[PROP_SOCKET_PATH] =
+    g_param_spec_string ("socket-path", NULL, NULL,
+                         SNAPD_SOCKET_PATH,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
 static void
 cc_snapd_client_init (CcSnapdClient *self)
 {
-  g_autoptr(GSocketAddress) address = g_unix_socket_address_new (SNAPD_SOCKET_PATH);
-  self->session = soup_session_new_with_options ("remote-connectable", address, NULL);
+  self->connections_waiters = g_ptr_array_new_with_free_func (g_object_unref);
 }
 
 CcSnapdClient *
@@ -206,25 +496,57 @@ cc_snapd_client_new (void)
   return CC_SNAPD_CLIENT (g_object_new (CC_TYPE_SNAPD_CLIENT, NULL));
 }
 
+CcSnapdClient *
+cc_snapd_client_new_for_socket (const gchar *socket_path)
+{
+  return CC_SNAPD_CLIENT (g_object_new (CC_TYPE_SNAPD_CLIENT, "socket-path", socket_path, NULL));
+}
+
+CcSnapdClient *
+cc_snapd_client_get_default (void)
+{
+  static CcSnapdClient *default_client = NULL;
+
+  if (default_client == NULL)
+    default_client = cc_snapd_client_new ();
+
+  return default_client;
+}
+
 JsonObject *
 cc_snapd_client_get_snap_sync (CcSnapdClient *self, const gchar *name, GCancellable *cancellable, GError **error)
 {
   g_autofree gchar *path = NULL;
   g_autoptr(JsonObject) response = NULL;
-  JsonObject *result;
 
   path = g_strdup_printf ("/v2/snaps/%s", name);
   response = call_sync (self, "GET", path, NULL, cancellable, error);
   if (response == NULL)
     return NULL;
-  result = json_object_get_object_member (response, "result");
-  if (result == NULL)
-    {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Invalid response to %s", path);
-      return NULL;
-    }
 
-  return json_object_ref (result);
+  return get_result (response, path, error);
+}
+
+void
+cc_snapd_client_get_snap_async (CcSnapdClient *self, const gchar *name,
+                                GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_autofree gchar *path = NULL;
+
+  g_return_if_fail (CC_IS_SNAPD_CLIENT (self));
+  g_return_if_fail (name != NULL);
+
+  path = g_strdup_printf ("/v2/snaps/%s", name);
+  get_result_async (self, path, cc_snapd_client_get_snap_async, cancellable, callback, user_data);
+}
+
+JsonObject *
+cc_snapd_client_get_snap_finish (CcSnapdClient *self, GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == cc_snapd_client_get_snap_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 JsonObject *
@@ -238,14 +560,42 @@ cc_snapd_client_get_change_sync (CcSnapdClient *self, const gchar *change_id, GC
   response = call_sync (self, "GET", path, NULL, cancellable, error);
   if (response == NULL)
     return NULL;
-  result = json_object_get_object_member (response, "result");
-  if (result == NULL)
-    {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Invalid response to %s", path);
-      return NULL;
-    }
 
-  return json_object_ref (result);
+  result = get_result (response, path, error);
+  if (result != NULL && change_is_ready (result))
+    invalidate_connections (self);
+
+  return result;
+}
+
+void
+cc_snapd_client_get_change_async (CcSnapdClient *self, const gchar *change_id,
+                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_autofree gchar *path = NULL;
+
+  g_return_if_fail (CC_IS_SNAPD_CLIENT (self));
+  g_return_if_fail (change_id != NULL);
+
+  path = g_strdup_printf ("/v2/changes/%s", change_id);
+  get_result_async (self, path, cc_snapd_client_get_change_async, cancellable, callback, user_data);
+}
+
+JsonObject *
+cc_snapd_client_get_change_finish (CcSnapdClient *self, GAsyncResult *result, GError **error)
+{
+  JsonObject *change;
+
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == cc_snapd_client_get_change_async, NULL);
+
+  change = g_task_propagate_pointer (G_TASK (result), error);
+
+  // A change that completed may have connected or disconnected interfaces
+  if (change != NULL && change_is_ready (change))
+    invalidate_connections (self);
+
+  return change;
 }
 
 gboolean
@@ -254,16 +604,20 @@ cc_snapd_client_get_all_connections_sync (CcSnapdClient *self,
                                           GCancellable *cancellable, GError **error)
 {
   g_autoptr(JsonObject) response = NULL;
-  JsonObject *result;
+  g_autoptr(JsonObject) result = NULL;
+  guint generation = self->connections_generation;
 
-  response = call_sync (self, "GET", "/v2/connections?select=all", NULL, cancellable, error);
-  if (response == NULL)
-    return FALSE;
-  result = json_object_get_object_member (response, "result");
+  result = lookup_connections (self);
   if (result == NULL)
     {
-      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "Invalid response to /v2/connections");
-      return FALSE;
+      response = call_sync (self, "GET", "/v2/connections?select=all", NULL, cancellable, error);
+      if (response == NULL)
+        return FALSE;
+      result = get_result (response, "/v2/connections", error);
+      if (result == NULL)
+        return FALSE;
+
+      store_connections (self, generation, result);
     }
 
   *plugs = json_array_ref (json_object_get_array_member (result, "plugs"));
@@ -271,6 +625,84 @@ cc_snapd_client_get_all_connections_sync (CcSnapdClient *self,
   return TRUE;
 }
 
+static void
+get_all_connections_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+  CcSnapdClient *self = CC_SNAPD_CLIENT (object);
+  g_autoptr(GPtrArray) waiters = NULL;
+  g_autoptr(JsonObject) response = NULL;
+  g_autoptr(JsonObject) connections = NULL;
+  g_autoptr(GError) error = NULL;
+
+  waiters = g_steal_pointer (&self->connections_waiters);
+  self->connections_waiters = g_ptr_array_new_with_free_func (g_object_unref);
+
+  response = call_finish (self, result, &error);
+  if (response != NULL)
+    connections = get_result (response, "/v2/connections", &error);
+  if (connections != NULL)
+    store_connections (self, self->connections_request_generation, connections);
+
+  for (guint i = 0; i < waiters->len; i++)
+    {
+      GTask *task = g_ptr_array_index (waiters, i);
+
+      if (connections != NULL)
+        g_task_return_pointer (task, json_object_ref (connections), (GDestroyNotify) json_object_unref);
+      else
+        g_task_return_error (task, g_error_copy (error));
+    }
+}
+
+void
+cc_snapd_client_get_all_connections_async (CcSnapdClient *self,
+                                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  g_autoptr(JsonObject) connections = NULL;
+
+  g_return_if_fail (CC_IS_SNAPD_CLIENT (self));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cc_snapd_client_get_all_connections_async);
+
+  connections = lookup_connections (self);
+  if (connections != NULL)
+    {
+      g_task_return_pointer (task, g_steal_pointer (&connections), (GDestroyNotify) json_object_unref);
+      return;
+    }
+
+  // Wait for the request in flight, if there's one already
+  g_ptr_array_add (self->connections_waiters, g_steal_pointer (&task));
+  if (self->connections_waiters->len > 1)
+    return;
+
+  // Shared by all the waiters, so it can't be cancelled by any of them
+  self->connections_request_generation = self->connections_generation;
+  call_async (self, "GET", "/v2/connections?select=all", NULL, NULL, get_all_connections_cb, NULL);
+}
+
+gboolean
+cc_snapd_client_get_all_connections_finish (CcSnapdClient *self,
+                                            GAsyncResult *result,
+                                            JsonArray **plugs, JsonArray **slots,
+                                            GError **error)
+{
+  g_autoptr(JsonObject) connections = NULL;
+
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == cc_snapd_client_get_all_connections_async, FALSE);
+
+  connections = g_task_propagate_pointer (G_TASK (result), error);
+  if (connections == NULL)
+    return FALSE;
+
+  *plugs = json_array_ref (json_object_get_array_member (connections, "plugs"));
+  *slots = json_array_ref (json_object_get_array_member (connections, "slots"));
+  return TRUE;
+}
+
 gchar *
 cc_snapd_client_connect_interface_sync (CcSnapdClient *self,
                                         const gchar *plug_snap, const gchar *plug_name,
@@ -280,6 +712,28 @@ cc_snapd_client_connect_interface_sync (CcSnapdClient *self,
   return call_interfaces_sync (self, "connect", plug_snap, plug_name, slot_snap, slot_name, cancellable, error);
 }
 
+void
+cc_snapd_client_connect_interface_async (CcSnapdClient *self,
+                                         const gchar *plug_snap, const gchar *plug_name,
+                                         const gchar *slot_snap, const gchar *slot_name,
+                                         GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_return_if_fail (CC_IS_SNAPD_CLIENT (self));
+
+  call_interfaces_async (self, "connect", plug_snap, plug_name, slot_snap, slot_name,
+                         cc_snapd_client_connect_interface_async,
+                         cancellable, callback, user_data);
+}
+
+gchar *
+cc_snapd_client_connect_interface_finish (CcSnapdClient *self, GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == cc_snapd_client_connect_interface_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 gchar *
 cc_snapd_client_disconnect_interface_sync (CcSnapdClient *self,
                                            const gchar *plug_snap, const gchar *plug_name,
@@ -288,3 +742,25 @@ cc_snapd_client_disconnect_interface_sync (CcSnapdClient *self,
 {
   return call_interfaces_sync (self, "disconnect", plug_snap, plug_name, slot_snap, slot_name, cancellable, error);
 }
+
+void
+cc_snapd_client_disconnect_interface_async (CcSnapdClient *self,
+                                            const gchar *plug_snap, const gchar *plug_name,
+                                            const gchar *slot_snap, const gchar *slot_name,
+                                            GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+  g_return_if_fail (CC_IS_SNAPD_CLIENT (self));
+
+  call_interfaces_async (self, "disconnect", plug_snap, plug_name, slot_snap, slot_name,
+                         cc_snapd_client_disconnect_interface_async,
+                         cancellable, callback, user_data);
+}
+
+gchar *
+cc_snapd_client_disconnect_interface_finish (CcSnapdClient *self, GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == cc_snapd_client_disconnect_interface_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
@@ -30,25 +30,63 @@ G_DECLARE_FINAL_TYPE (CcSnapdClient, cc_snapd_client, CC, SNAPD_CLIENT, GObject)
 // Creates a client to contact snapd.
 CcSnapdClient *cc_snapd_client_new                       (void);
 
+// Creates a client to contact snapd on another socket than its own.
+CcSnapdClient *cc_snapd_client_new_for_socket            (const gchar        *socket_path);
+
+// Gets the client shared by the main thread, so that its connection to snapd is reused.
+CcSnapdClient *cc_snapd_client_get_default               (void);
+
 // Get information on an installed snap.
 JsonObject    *cc_snapd_client_get_snap_sync             (CcSnapdClient      *client,
                                                           const gchar        *name,
                                                           GCancellable       *cancellable,
                                                           GError            **error);
 
+void           cc_snapd_client_get_snap_async            (CcSnapdClient      *client,
+                                                          const gchar        *name,
+                                                          GCancellable       *cancellable,
+                                                          GAsyncReadyCallback callback,
+                                                          gpointer            user_data);
+
+JsonObject    *cc_snapd_client_get_snap_finish           (CcSnapdClient      *client,
+                                                          GAsyncResult       *result,
+                                                          GError            **error);
+
 // Get information on a snap change.
 JsonObject    *cc_snapd_client_get_change_sync           (CcSnapdClient      *client,
                                                           const gchar        *change_id,
                                                           GCancellable       *cancellable,
                                                           GError            **error);
 
-// Get the state of the snap interface connections.
+void           cc_snapd_client_get_change_async          (CcSnapdClient      *client,
+                                                          const gchar        *change_id,
+                                                          GCancellable       *cancellable,
+                                                          GAsyncReadyCallback callback,
+                                                          gpointer            user_data);
+
+JsonObject    *cc_snapd_client_get_change_finish         (CcSnapdClient      *client,
+                                                          GAsyncResult       *result,
+                                                          GError            **error);
+
+// Get the state of the snap interface connections. The state is reused for a
+// couple of seconds, unless interfaces are connected or disconnected meanwhile.
 gboolean       cc_snapd_client_get_all_connections_sync  (CcSnapdClient      *client,
                                                           JsonArray         **plugs,
                                                           JsonArray         **slots,
                                                           GCancellable       *cancellable,
                                                           GError            **error);
 
+void           cc_snapd_client_get_all_connections_async (CcSnapdClient      *client,
+                                                          GCancellable       *cancellable,
+                                                          GAsyncReadyCallback callback,
+                                                          gpointer            user_data);
+
+gboolean       cc_snapd_client_get_all_connections_finish (CcSnapdClient     *client,
+                                                          GAsyncResult       *result,
+                                                          JsonArray         **plugs,
+                                                          JsonArray         **slots,
+                                                          GError            **error);
+
 // Connect a plug to a slot. Returns the change ID to monitor for completion of this task.
 gchar         *cc_snapd_client_connect_interface_sync    (CcSnapdClient      *client,
                                                           const gchar        *plug_snap,
@@ -58,6 +96,19 @@ gchar         *cc_snapd_client_connect_interface_sync    (CcSnapdClient      *cl
                                                           GCancellable       *cancellable,
                                                           GError            **error);
 
+void           cc_snapd_client_connect_interface_async   (CcSnapdClient      *client,
+                                                          const gchar        *plug_snap,
+                                                          const gchar        *plug_name,
+                                                          const gchar        *slot_snap,
+                                                          const gchar        *slot_name,
+                                                          GCancellable       *cancellable,
+                                                          GAsyncReadyCallback callback,
+                                                          gpointer            user_data);
+
+gchar         *cc_snapd_client_connect_interface_finish  (CcSnapdClient      *client,
+                                                          GAsyncResult       *result,
+                                                          GError            **error);
+
 // Disconnect a plug to a slot. Returns the change ID to monitor for completion of this task.
 gchar         *cc_snapd_client_disconnect_interface_sync (CcSnapdClient      *client,
                                                           const gchar        *plug_snap,
@@ -67,4 +118,17 @@ gchar         *cc_snapd_client_disconnect_interface_sync (CcSnapdClient      *cl
                                                           GCancellable       *cancellable,
                                                           GError            **error);
 
+void           cc_snapd_client_disconnect_interface_async (CcSnapdClient     *client,
+                                                          const gchar        *plug_snap,
+                                                          const gchar        *plug_name,
+                                                          const gchar        *slot_snap,
+                                                          const gchar        *slot_name,
+                                                          GCancellable       *cancellable,
+                                                          GAsyncReadyCallback callback,
+                                                          gpointer            user_data);
+
+gchar         *cc_snapd_client_disconnect_interface_finish (CcSnapdClient    *client,
+                                                          GAsyncResult       *result,
+                                                          GError            **error);
+
 G_END_DECLS
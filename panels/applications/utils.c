@@ -19,16 +19,23 @@
  */
 
 #ifndef _XOPEN_SOURCE
-#define _XOPEN_SOURCE 600
+#define _XOPEN_SOURCE 700
 #endif
 
 #include <config.h>
+#include <gio/gdesktopappinfo.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <ftw.h>
+#include <string.h>
+#include <unistd.h>
 
+#include "cc-flatpak-index.h"
 #include "utils.h"
 #ifdef HAVE_SNAP
 #include "cc-snapd-client.h"
@@ -79,67 +86,268 @@ file_remove_finish (GFile        *file,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-static GPrivate size_key = G_PRIVATE_INIT (g_free);
+/* Directories are walked by a few threads taking the subdirectories
+ * found by the others from a shared queue. Threads are only started when
+ * more subdirectories are pending than there are threads to take them,
+ * so that deep trees with few directories at the top still get walked in
+ * parallel. Files with several hard links are only counted once.
+ */
+#define WALK_MAX_THREADS 8
+#define WALK_PROGRESS_INTERVAL (100 * G_TIME_SPAN_MILLISECOND)
 
-static gint
-ftw_size_cb (const gchar       *path,
-             const struct stat *sb,
-             gint               typeflags,
-             struct FTW        *ftwbuf)
+typedef struct
 {
-  guint64 *size = (guint64*)g_private_get (&size_key);
-  if (typeflags == FTW_F)
-    *size += sb->st_size;
-  return 0;
+  GMutex               mutex;
+  GCond                cond;
+  GQueue               pending;
+  guint                n_walking;
+  GPtrArray           *threads;
+  guint                n_threads;
+  guint                max_threads;
+  guint64              size;
+  GHashTable          *inodes;
+  GPtrArray           *dirs;
+  GCancellable        *cancellable;
+  DirSizeProgressFunc  progress_func;
+  gpointer             progress_data;
+  gint64               last_progress;
+} DirWalk;
+
+typedef struct
+{
+  dev_t dev;
+  ino_t ino;
+} FileId;
+
+static guint
+file_id_hash (gconstpointer key)
+{
+  const FileId *id = key;
+
+  return (guint) id->ino ^ (guint) id->dev;
 }
 
+static gboolean
+file_id_equal (gconstpointer a,
+               gconstpointer b)
+{
+  const FileId *id_a = a;
+  const FileId *id_b = b;
+
+  return id_a->ino == id_b->ino && id_a->dev == id_b->dev;
+}
+
+static gpointer walk_thread_func (gpointer data);
+
+/* Must be called with the walk mutex held */
 static void
-file_size_thread_func (GTask        *task,
-                       gpointer      source_object,
-                       gpointer      task_data,
-                       GCancellable *cancellable)
+maybe_start_walkers (DirWalk *walk)
 {
-  GFile *file = source_object;
-  g_autofree gchar *path = g_file_get_path (file);
-  guint64 *total;
+  /* The thread walking the current directory takes one of the pending
+   * ones next, and so do the idle threads
+   */
+  while (walk->threads->len < walk->max_threads &&
+         !g_cancellable_is_cancelled (walk->cancellable) &&
+         g_queue_get_length (&walk->pending) > walk->n_threads - walk->n_walking + 1)
+    {
+      GThread *thread = g_thread_try_new ("dir-size", walk_thread_func, walk, NULL);
 
-  g_private_replace (&size_key, g_new0 (guint64, 1));
+      if (thread == NULL)
+        {
+          walk->max_threads = walk->threads->len;
+          break;
+        }
 
-  nftw (path, ftw_size_cb, 20, FTW_PHYS | FTW_DEPTH);
+      g_ptr_array_add (walk->threads, thread);
+      walk->n_threads++;
+    }
+}
 
-  total = g_new0 (guint64, 1);
-  *total = *(guint64*)g_private_get (&size_key);
+/* Must be called with the walk mutex held */
+static gboolean
+claim_inode (DirWalk           *walk,
+             const struct stat *buf)
+{
+  FileId *id;
 
-  if (g_task_set_return_on_cancel (task, FALSE))
-    g_task_return_pointer (task, total, g_free);
+  id = g_new (FileId, 1);
+  id->dev = buf->st_dev;
+  id->ino = buf->st_ino;
+
+  return g_hash_table_add (walk->inodes, id);
 }
 
-void
-file_size_async (GFile               *file,
-                 GCancellable        *cancellable,
-                 GAsyncReadyCallback  callback,
-                 gpointer             data)
+static void
+walk_dir (DirWalk *walk,
+          gchar   *path)
 {
-  g_autoptr(GTask) task = g_task_new (file, cancellable, callback, data);
-  g_task_set_return_on_cancel (task, TRUE);
-  g_task_run_in_thread (task, file_size_thread_func);
+  g_autoptr(GPtrArray) subdirs = NULL;
+  g_autoptr(GPtrArray) links = NULL;
+  struct dirent *entry;
+  guint64 progress = 0;
+  guint64 size = 0;
+  DIR *dir;
+  gint fd;
+  guint i;
+
+  subdirs = g_ptr_array_new ();
+  links = g_ptr_array_new_with_free_func (g_free);
+
+  fd = open (path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  dir = fd >= 0 ? fdopendir (fd) : NULL;
+  if (dir == NULL && fd >= 0)
+    close (fd);
+
+  while (dir != NULL && (entry = readdir (dir)) != NULL)
+    {
+      struct stat buf;
+
+      if (g_cancellable_is_cancelled (walk->cancellable))
+        break;
+
+      if (strcmp (entry->d_name, ".") == 0 || strcmp (entry->d_name, "..") == 0)
+        continue;
+
+      if (fstatat (dirfd (dir), entry->d_name, &buf, AT_SYMLINK_NOFOLLOW) != 0)
+        continue;
+
+      if (S_ISDIR (buf.st_mode))
+        g_ptr_array_add (subdirs, g_build_filename (path, entry->d_name, NULL));
+      else if (S_ISLNK (buf.st_mode))
+        continue;
+      else if (buf.st_nlink > 1)
+        g_ptr_array_add (links, g_memdup2 (&buf, sizeof (buf)));
+      else
+        size += buf.st_size;
+    }
+
+  if (dir != NULL)
+    closedir (dir);
+
+  g_mutex_lock (&walk->mutex);
+
+  for (i = 0; i < links->len; i++)
+    {
+      const struct stat *buf = g_ptr_array_index (links, i);
+
+      if (claim_inode (walk, buf))
+        size += buf->st_size;
+    }
+
+  walk->size += size;
+
+  for (i = 0; i < subdirs->len; i++)
+    g_queue_push_tail (&walk->pending, g_ptr_array_index (subdirs, i));
+  if (subdirs->len > 0)
+    {
+      maybe_start_walkers (walk);
+      g_cond_broadcast (&walk->cond);
+    }
+
+  if (dir != NULL && walk->dirs != NULL)
+    g_ptr_array_add (walk->dirs, g_steal_pointer (&path));
+
+  if (walk->progress_func != NULL &&
+      g_get_monotonic_time () - walk->last_progress >= WALK_PROGRESS_INTERVAL)
+    {
+      walk->last_progress = g_get_monotonic_time ();
+      progress = walk->size;
+    }
+
+  g_mutex_unlock (&walk->mutex);
+
+  g_free (path);
+
+  if (progress > 0)
+    walk->progress_func (progress, walk->progress_data);
 }
 
-gboolean
-file_size_finish (GFile        *file,
-                  GAsyncResult *result,
-                  guint64      *size,
-                  GError      **error)
+static gpointer
+walk_thread_func (gpointer data)
 {
-  g_autofree guint64 *data = NULL;
+  DirWalk *walk = data;
 
-  g_return_val_if_fail (g_task_is_valid (result, file), FALSE);
-  data = g_task_propagate_pointer (G_TASK (result), error);
-  if (data == NULL)
-    return FALSE;
-  if (size != NULL)
-    *size = *data;
-  return TRUE;
+  g_mutex_lock (&walk->mutex);
+
+  while (TRUE)
+    {
+      gchar *path;
+
+      while (g_queue_is_empty (&walk->pending) &&
+             walk->n_walking > 0 &&
+             !g_cancellable_is_cancelled (walk->cancellable))
+        g_cond_wait (&walk->cond, &walk->mutex);
+
+      /* Either everything was walked, or the walk was cancelled */
+      if (g_queue_is_empty (&walk->pending) || g_cancellable_is_cancelled (walk->cancellable))
+        break;
+
+      path = g_queue_pop_head (&walk->pending);
+      walk->n_walking++;
+
+      g_mutex_unlock (&walk->mutex);
+      walk_dir (walk, path);
+      g_mutex_lock (&walk->mutex);
+
+      walk->n_walking--;
+
+      if ((walk->n_walking == 0 && g_queue_is_empty (&walk->pending)) ||
+          g_cancellable_is_cancelled (walk->cancellable))
+        g_cond_broadcast (&walk->cond);
+    }
+
+  g_mutex_unlock (&walk->mutex);
+
+  return NULL;
+}
+
+guint64
+get_dir_size (const gchar         *path,
+              GPtrArray           *dirs,
+              GCancellable        *cancellable,
+              DirSizeProgressFunc  progress_func,
+              gpointer             progress_data)
+{
+  struct stat buf;
+  DirWalk walk = { 0, };
+  guint i;
+
+  if (lstat (path, &buf) != 0 || S_ISLNK (buf.st_mode))
+    return 0;
+
+  if (!S_ISDIR (buf.st_mode))
+    return buf.st_size;
+
+  g_mutex_init (&walk.mutex);
+  g_cond_init (&walk.cond);
+  g_queue_init (&walk.pending);
+  walk.inodes = g_hash_table_new_full (file_id_hash, file_id_equal, g_free, NULL);
+  walk.dirs = dirs;
+  walk.cancellable = cancellable;
+  walk.progress_func = progress_func;
+  walk.progress_data = progress_data;
+  walk.last_progress = g_get_monotonic_time ();
+  walk.threads = g_ptr_array_new ();
+  walk.max_threads = CLAMP (g_get_num_processors (), 1, WALK_MAX_THREADS) - 1;
+
+  /* This thread walks too. Small trees are walked without any other */
+  walk.n_threads = 1;
+  g_queue_push_tail (&walk.pending, g_strdup (path));
+  walk_thread_func (&walk);
+
+  /* Threads are only started while directories are being walked and
+   * the walk isn't cancelled, so none is started once this thread is done
+   */
+  for (i = 0; i < walk.threads->len; i++)
+    g_thread_join (g_ptr_array_index (walk.threads, i));
+
+  g_ptr_array_unref (walk.threads);
+  g_queue_clear_full (&walk.pending, g_free);
+  g_hash_table_unref (walk.inodes);
+  g_cond_clear (&walk.cond);
+  g_mutex_clear (&walk.mutex);
+
+  return walk.size;
 }
 
 static gchar *
@@ -171,6 +379,11 @@ get_flatpak_metadata (const gchar *app_id)
   g_autoptr(GError) error = NULL;
   g_autoptr(GKeyFile) keyfile = NULL;
 
+  keyfile = cc_flatpak_index_get_metadata (cc_flatpak_index_get_default (), app_id);
+  if (keyfile != NULL)
+    return g_steal_pointer (&keyfile);
+
+  /* Not in any of the installations known to the index */
   argv[3] = app_id;
 
   data = get_output_of (argv);
@@ -193,8 +406,12 @@ get_flatpak_app_size (const gchar *app_id)
   const gchar *argv[5] = { "flatpak", "info", "-s", "app", NULL };
   g_autofree gchar *data = NULL;
   guint64 factor;
+  guint64 size;
   double val;
 
+  if (cc_flatpak_index_get_installed_size (cc_flatpak_index_get_default (), app_id, &size))
+    return size;
+
   argv[3] = app_id;
 
   data = get_output_of (argv);
@@ -255,3 +472,201 @@ get_app_id (GAppInfo *info)
 
   return app_id;
 }
+
+/* The collation key of the display name of @info, computed only once */
+static const gchar *
+get_sort_key (GAppInfo *info)
+{
+  static GQuark sort_key_quark = 0;
+  gchar *sort_key;
+
+  if (G_UNLIKELY (sort_key_quark == 0))
+    sort_key_quark = g_quark_from_static_string ("cc-applications-sort-key");
+
+  sort_key = g_object_get_qdata (G_OBJECT (info), sort_key_quark);
+  if (sort_key == NULL)
+    {
+      g_autofree gchar *casefolded = NULL;
+
+      casefolded = g_utf8_casefold (g_app_info_get_display_name (info), -1);
+      sort_key = g_utf8_collate_key (casefolded, -1);
+      g_object_set_qdata_full (G_OBJECT (info), sort_key_quark, sort_key, g_free);
+    }
+
+  return sort_key;
+}
+
+gint
+compare_app_infos (gconstpointer a,
+                   gconstpointer b,
+                   gpointer      user_data)
+{
+  GAppInfo *info1 = (GAppInfo *) a;
+  GAppInfo *info2 = (GAppInfo *) b;
+  gint result;
+
+  result = strcmp (get_sort_key (info1), get_sort_key (info2));
+  if (result != 0)
+    return result;
+
+  /* Apps with the same name are kept in a stable order */
+  return g_strcmp0 (g_app_info_get_id (info1), g_app_info_get_id (info2));
+}
+
+static gint
+compare_app_info_pointers (gconstpointer a,
+                           gconstpointer b,
+                           gpointer      user_data)
+{
+  return compare_app_infos (*(GAppInfo **) a, *(GAppInfo **) b, user_data);
+}
+
+/* The desktop file of @info with its size and modification time,
+ * taken the first time it's asked for, or "" if it has no file */
+static const gchar *
+get_file_stamp (GAppInfo *info)
+{
+  static GQuark file_stamp_quark = 0;
+  gchar *file_stamp;
+
+  if (G_UNLIKELY (file_stamp_quark == 0))
+    file_stamp_quark = g_quark_from_static_string ("cc-applications-file-stamp");
+
+  file_stamp = g_object_get_qdata (G_OBJECT (info), file_stamp_quark);
+  if (file_stamp == NULL)
+    {
+      const gchar *filename = NULL;
+      GStatBuf buf;
+
+      if (G_IS_DESKTOP_APP_INFO (info))
+        filename = g_desktop_app_info_get_filename (G_DESKTOP_APP_INFO (info));
+
+      if (filename != NULL && g_stat (filename, &buf) == 0)
+        file_stamp = g_strdup_printf ("%s:%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT ".%09ld",
+                                      filename,
+                                      (gint64) buf.st_size,
+                                      (gint64) buf.st_mtim.tv_sec,
+                                      (glong) buf.st_mtim.tv_nsec);
+      else
+        file_stamp = g_strdup ("");
+
+      g_object_set_qdata_full (G_OBJECT (info), file_stamp_quark, file_stamp, g_free);
+    }
+
+  return file_stamp;
+}
+
+/* Whether @old_info has to be replaced by @new_info, which is the case
+ * unless both were loaded from the same, unchanged desktop file */
+static gboolean
+app_info_changed (GAppInfo *old_info,
+                  GAppInfo *new_info)
+{
+  const gchar *old_stamp;
+
+  if (old_info == new_info)
+    return FALSE;
+
+  old_stamp = get_file_stamp (old_info);
+
+  return *old_stamp == '\0' || g_strcmp0 (old_stamp, get_file_stamp (new_info)) != 0;
+}
+
+/**
+ * update_app_list:
+ * @store: a #GListStore of #GAppInfo, sorted with compare_app_infos()
+ * @infos: (element-type GAppInfo): the apps to list
+ *
+ * Makes @store list @infos, in order. An empty store is filled at once.
+ * Otherwise the apps that are already listed and whose desktop file
+ * didn't change since are kept, and only the apps around them are
+ * removed, added or replaced, so that the rows of the unchanged apps
+ * don't have to be created again.
+ */
+void
+update_app_list (GListStore *store,
+                 GList      *infos)
+{
+  g_autoptr(GPtrArray) old_infos = NULL;
+  g_autoptr(GPtrArray) new_infos = NULL;
+  g_autoptr(GPtrArray) additions = NULL;
+  guint n_old, i, j;
+  guint position = 0;
+  guint n_removals = 0;
+  gboolean pending = FALSE;
+  GList *l;
+
+  g_return_if_fail (G_IS_LIST_STORE (store));
+
+  /* Stamp the apps as they were loaded, to tell later if they changed */
+  new_infos = g_ptr_array_new ();
+  for (l = infos; l != NULL; l = l->next)
+    {
+      get_file_stamp (l->data);
+      g_ptr_array_add (new_infos, l->data);
+    }
+  g_ptr_array_sort_with_data (new_infos, compare_app_info_pointers, NULL);
+
+  n_old = g_list_model_get_n_items (G_LIST_MODEL (store));
+  if (n_old == 0)
+    {
+      g_list_store_splice (store, 0, 0, new_infos->pdata, new_infos->len);
+      return;
+    }
+
+  old_infos = g_ptr_array_new_full (n_old, g_object_unref);
+  for (i = 0; i < n_old; i++)
+    g_ptr_array_add (old_infos, g_list_model_get_item (G_LIST_MODEL (store), i));
+
+  /* Both lists are sorted, so walk them side by side. The removals and
+   * additions between two unchanged apps are done in a single splice.
+   */
+  additions = g_ptr_array_new ();
+  i = j = 0;
+  while (i < old_infos->len || j < new_infos->len)
+    {
+      GAppInfo *old_info = i < old_infos->len ? g_ptr_array_index (old_infos, i) : NULL;
+      GAppInfo *new_info = j < new_infos->len ? g_ptr_array_index (new_infos, j) : NULL;
+      gint cmp;
+
+      if (old_info == NULL)
+        cmp = 1;
+      else if (new_info == NULL)
+        cmp = -1;
+      else
+        cmp = compare_app_infos (old_info, new_info, NULL);
+
+      if (cmp == 0 && !app_info_changed (old_info, new_info))
+        {
+          if (pending)
+            {
+              g_list_store_splice (store, position, n_removals, additions->pdata, additions->len);
+              position += additions->len;
+              g_ptr_array_set_size (additions, 0);
+              n_removals = 0;
+              pending = FALSE;
+            }
+
+          position++;
+          i++;
+          j++;
+          continue;
+        }
+
+      pending = TRUE;
+
+      if (cmp <= 0)
+        {
+          n_removals++;
+          i++;
+        }
+      if (cmp >= 0)
+        {
+          g_ptr_array_add (additions, new_info);
+          j++;
+        }
+    }
+
+  if (pending)
+    g_list_store_splice (store, position, n_removals, additions->pdata, additions->len);
+}
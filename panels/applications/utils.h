@@ -25,6 +25,9 @@
 
 G_BEGIN_DECLS
 
+typedef void (*DirSizeProgressFunc) (guint64  size,
+                                     gpointer user_data);
+
 void      file_remove_async    (GFile               *file,
                                 GCancellable        *cancellable,
                                 GAsyncReadyCallback  callback,
@@ -34,15 +37,11 @@ gboolean  file_remove_finish   (GFile               *file,
                                 GAsyncResult        *result,
                                 GError             **error);
 
-void      file_size_async      (GFile               *file,
+guint64   get_dir_size         (const gchar         *path,
+                                GPtrArray           *dirs,
                                 GCancellable        *cancellable,
-                                GAsyncReadyCallback  callback,
-                                gpointer             data);
-
-gboolean  file_size_finish     (GFile               *file,
-                                GAsyncResult        *result,
-                                guint64             *size,
-                                GError             **error);
+                                DirSizeProgressFunc  progress_func,
+                                gpointer             progress_data);
 
 GKeyFile* get_flatpak_metadata (const gchar         *app_id);
 
@@ -52,4 +51,11 @@ guint64   get_snap_app_size    (const gchar         *snap_name);
 
 gchar*    get_app_id           (GAppInfo            *info);
 
+gint      compare_app_infos    (gconstpointer        a,
+                                gconstpointer        b,
+                                gpointer             user_data);
+
+void      update_app_list      (GListStore          *store,
+                                GList               *infos);
+
 G_END_DECLS
@@ -94,6 +94,17 @@ item_added (BgWallpapersSource *self,
   load_wallpapers (NULL, item, self);
 }
 
+static void
+item_removed (BgWallpapersSource *self,
+              CcBackgroundItem   *item)
+{
+  GListStore *store = bg_source_get_liststore (BG_SOURCE (self));
+  guint position;
+
+  if (g_list_store_find (store, item, &position))
+    g_list_store_remove (store, position);
+}
+
 static void
 load_default_bg (BgWallpapersSource *self)
 {
@@ -124,6 +135,8 @@ bg_wallpapers_source_constructed (GObject *object)
 
   g_signal_connect_object (G_OBJECT (self->xml), "added",
                            G_CALLBACK (item_added), self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (G_OBJECT (self->xml), "removed",
+                           G_CALLBACK (item_removed), self, G_CONNECT_SWAPPED);
 
   /* Try adding the default background first */
   load_default_bg (self);
@@ -37,14 +37,21 @@ struct _CcBackgroundChooser
 {
   GtkBox              parent;
 
-  GtkFlowBox         *flowbox;
-  GtkWidget          *recent_box;
-  GtkFlowBox         *recent_flowbox;
-
-  gboolean            recent_selected;
+  GtkGridView        *grid_view;
 
   BgWallpapersSource *wallpapers_source;
   BgRecentSource     *recent_source;
+  GListModel         *model;
+
+  /* Placeholders completing the last row of recent wallpapers, so
+   * that the system ones start on a row of their own */
+  GListStore         *placeholders;
+  guint               system_start;
+  guint               n_columns;
+  guint               columns_tick_id;
+
+  /* Tiles currently bound to an item */
+  GHashTable         *bound_tiles;
 
   CcBackgroundItem   *active_item;
 
@@ -62,70 +69,129 @@ enum
 static guint signals [N_SIGNALS];
 
 static void
-emit_background_chosen (CcBackgroundChooser *self)
+update_tile_active_state (CcBackgroundChooser *self,
+                          GtkWidget           *tile)
 {
-  g_autoptr(GList) list = NULL;
   CcBackgroundItem *item;
-  GtkFlowBox *flowbox;
+  gboolean active;
 
-  flowbox = self->recent_selected ? self->recent_flowbox : self->flowbox;
-  list = gtk_flow_box_get_selected_children (flowbox);
-  g_assert (g_list_length (list) == 1);
+  item = g_object_get_data (G_OBJECT (tile), "item");
+  active = self->active_item && item && cc_background_item_compare (item, self->active_item);
 
-  item = g_object_get_data (list->data, "item");
+  if (active)
+    gtk_widget_add_css_class (tile, "active-item");
+  else
+    gtk_widget_remove_css_class (tile, "active-item");
 
-  g_signal_emit (self, signals[BACKGROUND_CHOSEN], 0, item);
+  gtk_accessible_update_state (GTK_ACCESSIBLE (tile),
+                               GTK_ACCESSIBLE_STATE_CHECKED, active,
+                               -1);
 }
 
+/* The first row of system wallpapers is separated from the recent ones */
 static void
-on_delete_background_clicked_cb (GtkButton *button,
-                                 BgRecentSource  *source)
+update_tile_section (CcBackgroundChooser *self,
+                     GtkWidget           *tile)
 {
-  GtkWidget *parent;
-  CcBackgroundItem *item;
+  GtkListItem *list_item;
+  GtkWidget *cell;
+  guint position;
 
-  parent = gtk_widget_get_parent (gtk_widget_get_parent (GTK_WIDGET (button)));
-  g_assert (GTK_IS_FLOW_BOX_CHILD (parent));
+  list_item = g_object_get_data (G_OBJECT (tile), "list-item");
+  cell = gtk_widget_get_parent (tile);
+  position = gtk_list_item_get_position (list_item);
 
-  item = g_object_get_data (G_OBJECT (parent), "item");
+  if (cell == NULL)
+    return;
 
-  bg_recent_source_remove_item (source, item);
+  if (self->system_start > 0 &&
+      position >= self->system_start &&
+      position < self->system_start + self->n_columns)
+    gtk_widget_add_css_class (cell, "section-start");
+  else
+    gtk_widget_remove_css_class (cell, "section-start");
 }
 
-static GtkWidget*
-create_widget_func (gpointer model_item,
-                    gpointer user_data)
+static void
+update_sections (CcBackgroundChooser *self)
 {
-  g_autoptr(CcBackgroundPaintable) paintable = NULL;
+  GListModel *recent;
+  GHashTableIter iter;
+  gpointer tile;
+  guint n_recent;
+  guint n_placeholders;
+  guint old_n_placeholders;
+
+  recent = G_LIST_MODEL (bg_source_get_liststore (BG_SOURCE (self->recent_source)));
+  n_recent = g_list_model_get_n_items (recent);
+  n_placeholders = n_recent > 0 ? (self->n_columns - n_recent % self->n_columns) % self->n_columns : 0;
+  old_n_placeholders = g_list_model_get_n_items (G_LIST_MODEL (self->placeholders));
+
+  if (n_placeholders != old_n_placeholders)
+    {
+      g_autoptr(GPtrArray) items = g_ptr_array_new_with_free_func (g_object_unref);
+      guint i;
+
+      for (i = 0; i < n_placeholders; i++)
+        g_ptr_array_add (items, g_object_new (G_TYPE_OBJECT, NULL));
+
+      g_list_store_splice (self->placeholders, 0, old_n_placeholders, items->pdata, items->len);
+    }
+
+  self->system_start = n_recent + n_placeholders;
+
+  g_hash_table_iter_init (&iter, self->bound_tiles);
+  while (g_hash_table_iter_next (&iter, &tile, NULL))
+    update_tile_section (self, tile);
+}
+
+static void
+on_list_item_position_changed_cb (GtkListItem         *list_item,
+                                  GParamSpec          *pspec,
+                                  CcBackgroundChooser *self)
+{
+  GtkWidget *tile = gtk_list_item_get_child (list_item);
+
+  if (g_hash_table_contains (self->bound_tiles, tile))
+    update_tile_section (self, tile);
+}
+
+static void
+on_delete_background_clicked_cb (GtkButton *button)
+{
+  g_autoptr(CcBackgroundItem) item = NULL;
   CcBackgroundChooser *self;
-  CcBackgroundItem *item;
+  GtkWidget *tile;
+
+  self = CC_BACKGROUND_CHOOSER (gtk_widget_get_ancestor (GTK_WIDGET (button), CC_TYPE_BACKGROUND_CHOOSER));
+  tile = gtk_widget_get_parent (GTK_WIDGET (button));
+
+  /* The tile is unbound while the item is removed */
+  item = g_object_ref (g_object_get_data (G_OBJECT (tile), "item"));
+
+  bg_recent_source_remove_item (self->recent_source, item);
+}
+
+/* Only the tiles in view own widgets and paintables: they are created
+ * once by the factory, then recycled for the items scrolled into view.
+ */
+static void
+on_factory_setup_cb (GtkSignalListItemFactory *factory,
+                     GtkListItem              *list_item,
+                     CcBackgroundChooser      *self)
+{
   GtkWidget *overlay;
-  GtkWidget *child;
   GtkWidget *picture;
   GtkWidget *icon;
   GtkWidget *check;
-  GtkWidget *button = NULL;
-  BgSource *source;
-
-  source = BG_SOURCE (user_data);
-  item = CC_BACKGROUND_ITEM (model_item);
+  GtkWidget *button;
 
-  self = g_object_get_data (G_OBJECT (source), "background-chooser");
-
-  paintable = cc_background_paintable_new (self->thumbnail_factory,
-                                           item,
-                                           CC_BACKGROUND_PAINT_LIGHT_DARK,
-                                           THUMBNAIL_WIDTH,
-                                           THUMBNAIL_HEIGHT,
-                                           GTK_WIDGET (self));
-
-  picture = gtk_picture_new_for_paintable (GDK_PAINTABLE (paintable));
+  picture = gtk_picture_new ();
   gtk_picture_set_can_shrink (GTK_PICTURE (picture), FALSE);
 
   icon = gtk_image_new_from_icon_name ("slideshow-symbolic");
   gtk_widget_set_halign (icon, GTK_ALIGN_START);
   gtk_widget_set_valign (icon, GTK_ALIGN_END);
-  gtk_widget_set_visible (icon, cc_background_item_changes_with_time (item));
   gtk_widget_add_css_class (icon, "slideshow-icon");
 
   check = gtk_image_new_from_icon_name ("background-selected-symbolic");
@@ -133,111 +199,163 @@ create_widget_func (gpointer model_item,
   gtk_widget_set_valign (check, GTK_ALIGN_END);
   gtk_widget_add_css_class (check, "selected-check");
 
-  if (BG_IS_RECENT_SOURCE (source))
-    {
-      button = gtk_button_new_from_icon_name ("cross-small-symbolic");
-      gtk_widget_set_halign (button, GTK_ALIGN_END);
-      gtk_widget_set_valign (button, GTK_ALIGN_START);
+  button = gtk_button_new_from_icon_name ("cross-small-symbolic");
+  gtk_widget_set_halign (button, GTK_ALIGN_END);
+  gtk_widget_set_valign (button, GTK_ALIGN_START);
 
-      gtk_widget_add_css_class (button, "osd");
-      gtk_widget_add_css_class (button, "circular");
-      gtk_widget_add_css_class (button, "remove-button");
+  gtk_widget_add_css_class (button, "osd");
+  gtk_widget_add_css_class (button, "circular");
+  gtk_widget_add_css_class (button, "remove-button");
 
-     gtk_widget_set_tooltip_text (GTK_WIDGET (button), _("Remove Background"));
+  gtk_widget_set_tooltip_text (GTK_WIDGET (button), _("Remove Background"));
 
-      g_signal_connect (button,
-                        "clicked",
-                        G_CALLBACK (on_delete_background_clicked_cb),
-                        source);
-    }
+  g_signal_connect (button,
+                    "clicked",
+                    G_CALLBACK (on_delete_background_clicked_cb),
+                    NULL);
 
   overlay = gtk_overlay_new ();
+  gtk_widget_set_halign (overlay, GTK_ALIGN_CENTER);
+  gtk_widget_set_valign (overlay, GTK_ALIGN_CENTER);
   gtk_widget_set_overflow (overlay, GTK_OVERFLOW_HIDDEN);
   gtk_widget_add_css_class (overlay, "background-thumbnail");
   gtk_overlay_set_child (GTK_OVERLAY (overlay), picture);
   gtk_overlay_add_overlay (GTK_OVERLAY (overlay), icon);
   gtk_overlay_add_overlay (GTK_OVERLAY (overlay), check);
-  if (button)
-    gtk_overlay_add_overlay (GTK_OVERLAY (overlay), button);
+  gtk_overlay_add_overlay (GTK_OVERLAY (overlay), button);
 
-  child = gtk_flow_box_child_new ();
-  gtk_widget_set_halign (child, GTK_ALIGN_CENTER);
-  gtk_widget_set_valign (child, GTK_ALIGN_CENTER);
-  gtk_flow_box_child_set_child (GTK_FLOW_BOX_CHILD (child), overlay);
-  gtk_accessible_update_property (GTK_ACCESSIBLE (child),
-                                  GTK_ACCESSIBLE_PROPERTY_LABEL,
-                                  cc_background_item_get_name (item),
-                                  -1);
+  g_object_set_data (G_OBJECT (overlay), "picture", picture);
+  g_object_set_data (G_OBJECT (overlay), "slideshow-icon", icon);
+  g_object_set_data (G_OBJECT (overlay), "remove-button", button);
+  g_object_set_data (G_OBJECT (overlay), "list-item", list_item);
 
-  g_object_set_data_full (G_OBJECT (child), "item", g_object_ref (item), g_object_unref);
+  gtk_list_item_set_child (list_item, overlay);
 
-  if (self->active_item && cc_background_item_compare (item, self->active_item))
+  g_signal_connect_object (list_item,
+                           "notify::position",
+                           G_CALLBACK (on_list_item_position_changed_cb),
+                           self,
+                           0);
+}
+
+static void
+on_factory_bind_cb (GtkSignalListItemFactory *factory,
+                    GtkListItem              *list_item,
+                    CcBackgroundChooser      *self)
+{
+  g_autoptr(CcBackgroundPaintable) paintable = NULL;
+  CcBackgroundItem *item;
+  GListModel *item_model;
+  GtkWidget *tile;
+
+  tile = gtk_list_item_get_child (list_item);
+
+  /* Placeholders only take up space */
+  if (!CC_IS_BACKGROUND_ITEM (gtk_list_item_get_item (list_item)))
     {
-      gtk_widget_add_css_class (GTK_WIDGET (child), "active-item");
-      gtk_accessible_update_state (GTK_ACCESSIBLE (child),
-                                   GTK_ACCESSIBLE_STATE_CHECKED, TRUE,
-                                   -1);
+      gtk_widget_set_visible (tile, FALSE);
+      gtk_list_item_set_activatable (list_item, FALSE);
+      gtk_list_item_set_focusable (list_item, FALSE);
+      return;
     }
-  else
-    gtk_accessible_update_state (GTK_ACCESSIBLE (child),
-                                    GTK_ACCESSIBLE_STATE_CHECKED, FALSE,
-                                    -1);
 
-  return child;
+  item = CC_BACKGROUND_ITEM (gtk_list_item_get_item (list_item));
+
+  gtk_widget_set_visible (tile, TRUE);
+  gtk_list_item_set_activatable (list_item, TRUE);
+  gtk_list_item_set_focusable (list_item, TRUE);
+
+  paintable = cc_background_paintable_new (self->thumbnail_factory,
+                                           item,
+                                           CC_BACKGROUND_PAINT_LIGHT_DARK,
+                                           THUMBNAIL_WIDTH,
+                                           THUMBNAIL_HEIGHT,
+                                           GTK_WIDGET (self));
+
+  gtk_picture_set_paintable (g_object_get_data (G_OBJECT (tile), "picture"),
+                             GDK_PAINTABLE (paintable));
+
+  gtk_widget_set_visible (g_object_get_data (G_OBJECT (tile), "slideshow-icon"),
+                          cc_background_item_changes_with_time (item));
+
+  item_model = gtk_flatten_list_model_get_model_for_item (GTK_FLATTEN_LIST_MODEL (self->model),
+                                                          gtk_list_item_get_position (list_item));
+  gtk_widget_set_visible (g_object_get_data (G_OBJECT (tile), "remove-button"),
+                          item_model == G_LIST_MODEL (bg_source_get_liststore (BG_SOURCE (self->recent_source))));
+
+  gtk_list_item_set_accessible_label (list_item, cc_background_item_get_name (item));
+
+  g_object_set_data_full (G_OBJECT (tile), "item", g_object_ref (item), g_object_unref);
+  update_tile_active_state (self, tile);
+
+  g_hash_table_add (self->bound_tiles, tile);
+  update_tile_section (self, tile);
 }
 
 static void
-update_recent_visibility (CcBackgroundChooser *self)
+on_factory_unbind_cb (GtkSignalListItemFactory *factory,
+                      GtkListItem              *list_item,
+                      CcBackgroundChooser      *self)
 {
-  GListStore *store;
-  gboolean has_items;
+  GtkWidget *tile;
+
+  tile = gtk_list_item_get_child (list_item);
 
-  store = bg_source_get_liststore (BG_SOURCE (self->recent_source));
-  has_items = g_list_model_get_n_items (G_LIST_MODEL (store)) != 0;
+  /* Dropping the paintable cancels its pending thumbnails */
+  gtk_picture_set_paintable (g_object_get_data (G_OBJECT (tile), "picture"), NULL);
+  g_object_set_data (G_OBJECT (tile), "item", NULL);
 
-  gtk_widget_set_visible (self->recent_box, has_items);
+  if (gtk_widget_get_parent (tile))
+    gtk_widget_remove_css_class (gtk_widget_get_parent (tile), "section-start");
+
+  g_hash_table_remove (self->bound_tiles, tile);
 }
 
 static void
-setup_flowbox (CcBackgroundChooser *self)
+setup_grid_view (CcBackgroundChooser *self)
 {
-  GListStore *store;
-
-  store = bg_source_get_liststore (BG_SOURCE (self->wallpapers_source));
+  g_autoptr(GtkNoSelection) selection_model = NULL;
+  g_autoptr(GListStore) sources = NULL;
+  GListStore *recent;
 
-  gtk_flow_box_bind_model (self->flowbox,
-                           G_LIST_MODEL (store),
-                           create_widget_func,
-                           self->wallpapers_source,
-                           NULL);
+  recent = bg_source_get_liststore (BG_SOURCE (self->recent_source));
+  self->placeholders = g_list_store_new (G_TYPE_OBJECT);
+  self->n_columns = gtk_grid_view_get_max_columns (self->grid_view);
 
-  store = bg_source_get_liststore (BG_SOURCE (self->recent_source));
+  /* Recent backgrounds come first, then the ones shipped with the system */
+  sources = g_list_store_new (G_TYPE_LIST_MODEL);
+  g_list_store_append (sources, recent);
+  g_list_store_append (sources, self->placeholders);
+  g_list_store_append (sources, bg_source_get_liststore (BG_SOURCE (self->wallpapers_source)));
 
-  gtk_flow_box_bind_model (self->recent_flowbox,
-                           G_LIST_MODEL (store),
-                           create_widget_func,
-                           self->recent_source,
-                           NULL);
-
-  update_recent_visibility (self);
-  g_signal_connect_object (store,
+  g_signal_connect_object (recent,
                            "items-changed",
-                           G_CALLBACK (update_recent_visibility),
+                           G_CALLBACK (update_sections),
                            self,
                            G_CONNECT_SWAPPED);
+
+  self->model = G_LIST_MODEL (gtk_flatten_list_model_new (G_LIST_MODEL (g_steal_pointer (&sources))));
+
+  /* The active background is shown by the tiles, not by selecting them */
+  selection_model = gtk_no_selection_new (g_object_ref (self->model));
+  gtk_grid_view_set_model (self->grid_view, GTK_SELECTION_MODEL (selection_model));
+
+  update_sections (self);
 }
 
 static void
 on_item_activated_cb (CcBackgroundChooser *self,
-                      GtkFlowBoxChild     *child,
-                      GtkFlowBox          *flowbox)
+                      guint                position,
+                      GtkGridView         *grid_view)
 {
-  self->recent_selected = flowbox == self->recent_flowbox;
-  if (self->recent_selected)
-    gtk_flow_box_unselect_all (self->flowbox);
-  else
-    gtk_flow_box_unselect_all (self->recent_flowbox);
-  emit_background_chosen (self);
+  g_autoptr(GObject) item = NULL;
+
+  item = g_list_model_get_item (self->model, position);
+
+  if (!CC_IS_BACKGROUND_ITEM (item))
+    return;
+
+  g_signal_emit (self, signals[BACKGROUND_CHOSEN], 0, item);
 }
 
 static void
@@ -268,6 +386,78 @@ file_dialog_open_cb (GObject      *source_object,
     }
 }
 
+/* The grid spreads its width evenly between its columns, so the number
+ * of columns it uses is the ratio between its width and a cell's.
+ */
+static guint
+get_n_columns (CcBackgroundChooser *self)
+{
+  GHashTableIter iter;
+  gpointer tile;
+  int grid_width;
+
+  grid_width = gtk_widget_get_width (GTK_WIDGET (self->grid_view));
+
+  g_hash_table_iter_init (&iter, self->bound_tiles);
+  while (g_hash_table_iter_next (&iter, &tile, NULL))
+    {
+      GtkWidget *cell = gtk_widget_get_parent (tile);
+      int cell_width;
+
+      if (cell == NULL)
+        continue;
+
+      cell_width = gtk_widget_get_width (cell);
+      if (cell_width <= 0)
+        continue;
+
+      return CLAMP ((grid_width + cell_width / 2) / cell_width,
+                    1, gtk_grid_view_get_max_columns (self->grid_view));
+    }
+
+  return 0;
+}
+
+static gboolean
+update_columns_cb (GtkWidget     *widget,
+                   GdkFrameClock *frame_clock,
+                   gpointer       user_data)
+{
+  CcBackgroundChooser *self = CC_BACKGROUND_CHOOSER (widget);
+  guint n_columns;
+
+  self->columns_tick_id = 0;
+
+  n_columns = get_n_columns (self);
+  if (n_columns > 0 && n_columns != self->n_columns)
+    {
+      self->n_columns = n_columns;
+      update_sections (self);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* GtkWidget overrides */
+
+static void
+cc_background_chooser_size_allocate (GtkWidget *widget,
+                                     int        width,
+                                     int        height,
+                                     int        baseline)
+{
+  CcBackgroundChooser *self = CC_BACKGROUND_CHOOSER (widget);
+
+  GTK_WIDGET_CLASS (cc_background_chooser_parent_class)->size_allocate (widget, width, height, baseline);
+
+  /* Changing the placeholders changes the model, which must not happen
+   * during allocation. Look at the columns the grid picked on the next
+   * frame instead.
+   */
+  if (self->columns_tick_id == 0)
+    self->columns_tick_id = gtk_widget_add_tick_callback (widget, update_columns_cb, NULL, NULL);
+}
+
 /* GObject overrides */
 
 static void
@@ -275,6 +465,9 @@ cc_background_chooser_finalize (GObject *object)
 {
   CcBackgroundChooser *self = (CcBackgroundChooser *)object;
 
+  g_clear_pointer (&self->bound_tiles, g_hash_table_unref);
+  g_clear_object (&self->model);
+  g_clear_object (&self->placeholders);
   g_clear_object (&self->recent_source);
   g_clear_object (&self->wallpapers_source);
   g_clear_object (&self->thumbnail_factory);
@@ -290,6 +483,8 @@ cc_background_chooser_class_init (CcBackgroundChooserClass *klass)
 
   object_class->finalize = cc_background_chooser_finalize;
 
+  widget_class->size_allocate = cc_background_chooser_size_allocate;
+
   signals[BACKGROUND_CHOSEN] = g_signal_new ("background-chosen",
                                              CC_TYPE_BACKGROUND_CHOOSER,
                                              G_SIGNAL_RUN_FIRST,
@@ -300,26 +495,27 @@ cc_background_chooser_class_init (CcBackgroundChooserClass *klass)
 
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gnome/control-center/background/cc-background-chooser.ui");
 
-  gtk_widget_class_bind_template_child (widget_class, CcBackgroundChooser, flowbox);
-  gtk_widget_class_bind_template_child (widget_class, CcBackgroundChooser, recent_box);
-  gtk_widget_class_bind_template_child (widget_class, CcBackgroundChooser, recent_flowbox);
+  gtk_widget_class_bind_template_child (widget_class, CcBackgroundChooser, grid_view);
 
+  gtk_widget_class_bind_template_callback (widget_class, on_factory_setup_cb);
+  gtk_widget_class_bind_template_callback (widget_class, on_factory_bind_cb);
+  gtk_widget_class_bind_template_callback (widget_class, on_factory_unbind_cb);
   gtk_widget_class_bind_template_callback (widget_class, on_item_activated_cb);
 }
 
 static void
 cc_background_chooser_init (CcBackgroundChooser *self)
 {
+  self->bound_tiles = g_hash_table_new (NULL, NULL);
+
   gtk_widget_init_template (GTK_WIDGET (self));
 
   self->recent_source = bg_recent_source_new ();
   self->wallpapers_source = bg_wallpapers_source_new ();
 
   self->thumbnail_factory = gnome_desktop_thumbnail_factory_new (GNOME_DESKTOP_THUMBNAIL_SIZE_LARGE);
-  g_object_set_data (G_OBJECT (self->recent_source), "background-chooser", self);
-  g_object_set_data (G_OBJECT (self->wallpapers_source), "background-chooser", self);
 
-  setup_flowbox (self);
+  setup_grid_view (self);
 }
 
 void
@@ -356,41 +552,19 @@ cc_background_chooser_select_file (CcBackgroundChooser *self)
                                  self);
 }
 
-static void flow_box_set_active_item (GtkFlowBox *flowbox, CcBackgroundItem *active_item)
-{
-  GtkFlowBoxChild *child = NULL;
-  CcBackgroundItem *item;
-  int idx = 0;
-
-  while ((child = gtk_flow_box_get_child_at_index (flowbox, idx++)))
-    {
-      item = g_object_get_data (G_OBJECT (child), "item");
-
-      if (cc_background_item_compare (item, active_item))
-        {
-          gtk_widget_add_css_class (GTK_WIDGET (child), "active-item");
-          gtk_accessible_update_state (GTK_ACCESSIBLE (child),
-                                       GTK_ACCESSIBLE_STATE_CHECKED, TRUE,
-                                       -1);
-        }
-      else
-        {
-          gtk_widget_remove_css_class (GTK_WIDGET (child), "active-item");
-          gtk_accessible_update_state (GTK_ACCESSIBLE (child),
-                                       GTK_ACCESSIBLE_STATE_CHECKED, FALSE,
-                                       -1);
-        }
-    }
-}
-
 void
 cc_background_chooser_set_active_item (CcBackgroundChooser *self, CcBackgroundItem *active_item)
 {
+  GHashTableIter iter;
+  gpointer tile;
+
   g_return_if_fail (CC_IS_BACKGROUND_CHOOSER (self));
   g_return_if_fail (CC_IS_BACKGROUND_ITEM (active_item));
 
   self->active_item = active_item;
 
-  flow_box_set_active_item (self->flowbox, active_item);
-  flow_box_set_active_item (self->recent_flowbox, active_item);
+  /* Tiles bound later pick up the active item when binding */
+  g_hash_table_iter_init (&iter, self->bound_tiles);
+  while (g_hash_table_iter_next (&iter, &tile, NULL))
+    update_tile_active_state (self, tile);
 }
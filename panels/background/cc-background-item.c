@@ -30,6 +30,8 @@
 #include <gdesktop-enums.h>
 
 #include "cc-background-item.h"
+#include "cc-background-thumbnail-cache.h"
+#include "cc-background-thumbnail-scheduler.h"
 #include "gdesktop-enums-types.h"
 #include "cc-background-enum-types.h"
 
@@ -187,6 +189,8 @@ typedef struct
 {
         GnomeDesktopThumbnailFactory *thumbs;
         GnomeBG                      *bg;
+        char                         *uri;
+        char                         *colors;
         GdkRectangle                  monitor_layout;
         int                           width;
         int                           height;
@@ -202,38 +206,106 @@ get_thumbnail_async_free (gpointer data)
 
         g_clear_object (&state->thumbs);
         g_clear_object (&state->bg);
+        g_free (state->uri);
+        g_free (state->colors);
         g_free (state);
 }
 
-static void
-cc_background_item_get_thumbnail_worker (GTask        *task,
-                                         gpointer      source_object,
-                                         gpointer      task_data,
-                                         GCancellable *cancellable)
+/* Builds the key of the thumbnail in the disk cache, which must change
+ * whenever the rendered thumbnail would.
+ */
+static char *
+get_thumbnail_cache_key (GetThumbnailAsync *state)
 {
-        GetThumbnailAsync *state = task_data;
-        CcBackgroundItem *item = source_object;
-        GdkPixbuf *pixbuf;
+        g_autoptr(GFileInfo) info = NULL;
+        g_autoptr(GFile) file = NULL;
+        guint64 mtime;
+
+        /* Slideshows render a different slide depending on the time */
+        if (gnome_bg_changes_with_time (state->bg))
+                return NULL;
+
+        file = g_file_new_for_commandline_arg (state->uri);
+        info = g_file_query_info (file,
+                                  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                  G_FILE_QUERY_INFO_NONE,
+                                  NULL,
+                                  NULL);
+        if (info == NULL)
+                return NULL;
+
+        mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+        return g_strdup_printf ("%s\n%" G_GUINT64_FORMAT "\n%dx%d@%d\n%s\n%dx%d\n%s",
+                                state->uri,
+                                mtime,
+                                state->width,
+                                state->height,
+                                state->scale_factor,
+                                state->dark ? "dark" : "light",
+                                state->monitor_layout.width,
+                                state->monitor_layout.height,
+                                state->colors);
+}
+
+/* Identifies the requests rendering the same thumbnail, which are
+ * coalesced by the scheduler. Unlike the disk cache key, it must be
+ * cheap to compute as it's built in the main thread.
+ */
+static char *
+get_thumbnail_request_key (GetThumbnailAsync *state)
+{
+        return g_strdup_printf ("%s\n%dx%d@%d\n%s\n%dx%d\n%s",
+                                state->uri,
+                                state->width,
+                                state->height,
+                                state->scale_factor,
+                                state->dark ? "dark" : "light",
+                                state->monitor_layout.width,
+                                state->monitor_layout.height,
+                                state->colors);
+}
+
+static GdkPixbuf *
+cc_background_item_get_thumbnail_worker (GTask   *task,
+                                         GError **error)
+{
+        GetThumbnailAsync *state = g_task_get_task_data (task);
+        CcBackgroundThumbnailCache *cache;
+        g_autofree char *cache_key = NULL;
+        GdkPixbuf *pixbuf = NULL;
 
         g_assert (G_IS_TASK (task));
-        g_assert (CC_IS_BACKGROUND_ITEM (item));
-        g_assert (!cancellable || G_IS_CANCELLABLE (cancellable));
         g_assert (state != NULL);
         g_assert (state->thumbs != NULL);
 
-        pixbuf = gnome_bg_create_thumbnail (state->bg,
-                                            state->thumbs,
-                                            &state->monitor_layout,
-                                            state->scale_factor * state->width,
-                                            state->scale_factor * state->height);
-
-        if (pixbuf != NULL)
-                g_task_return_pointer (task, pixbuf, g_object_unref);
-        else
-                g_task_return_new_error (task,
-                                         G_IO_ERROR,
-                                         G_IO_ERROR_FAILED,
-                                         "Failed to load pixbuf");
+        cache = cc_background_thumbnail_cache_get_default ();
+        cache_key = get_thumbnail_cache_key (state);
+
+        if (cache_key != NULL)
+                pixbuf = cc_background_thumbnail_cache_lookup (cache, cache_key);
+
+        if (pixbuf == NULL) {
+                g_autoptr(GError) local_error = NULL;
+
+                pixbuf = gnome_bg_create_thumbnail (state->bg,
+                                                    state->thumbs,
+                                                    &state->monitor_layout,
+                                                    state->scale_factor * state->width,
+                                                    state->scale_factor * state->height);
+
+                if (pixbuf != NULL && cache_key != NULL &&
+                    !cc_background_thumbnail_cache_store (cache, cache_key, pixbuf, &local_error))
+                        g_warning ("Failed to cache thumbnail of %s: %s", state->uri, local_error->message);
+        }
+
+        if (pixbuf == NULL)
+                g_set_error (error,
+                             G_IO_ERROR,
+                             G_IO_ERROR_FAILED,
+                             "Failed to load pixbuf");
+
+        return pixbuf;
 }
 
 void
@@ -249,6 +321,7 @@ cc_background_item_get_thumbnail_async (CcBackgroundItem             *item,
 {
         g_autoptr(GdkMonitor) monitor = NULL;
         g_autoptr(GTask) task = NULL;
+        g_autofree char *key = NULL;
         GetThumbnailAsync *state;
         CachedThumbnail *thumbnail;
         GListModel *monitors;
@@ -288,8 +361,18 @@ cc_background_item_get_thumbnail_async (CcBackgroundItem             *item,
         state->scale_factor = scale_factor;
         state->dark = !!dark;
         state->bg = item_to_gnome_bg (item, dark);
-
-        g_task_run_in_thread (task, cc_background_item_get_thumbnail_worker);
+        state->uri = g_strdup (dark ? item->uri_dark : item->uri);
+        state->colors = g_strdup_printf ("%d %d %s %s",
+                                         item->placement,
+                                         item->shading,
+                                         item->primary_color ? item->primary_color : "",
+                                         item->secondary_color ? item->secondary_color : "");
+
+        key = get_thumbnail_request_key (state);
+        cc_background_thumbnail_scheduler_push (cc_background_thumbnail_scheduler_get_default (),
+                                                task,
+                                                key,
+                                                cc_background_item_get_thumbnail_worker);
 }
 
 GdkPixbuf *
@@ -67,9 +67,12 @@ light_cb (GObject      *object,
           GAsyncResult *result,
           gpointer      user_data)
 {
-  g_autoptr(CcBackgroundPaintable) self = user_data;
+  CcBackgroundPaintable *self = user_data;
   g_autoptr(GdkPixbuf) pixbuf = NULL;
 
+  /* The request is cancelled when the paintable is disposed, so it's
+   * only safe to use self if it succeeded.
+   */
   if ((pixbuf = cc_background_item_get_thumbnail_finish (CC_BACKGROUND_ITEM (object), result, NULL)))
     {
       g_clear_object (&self->texture);
@@ -84,9 +87,12 @@ dark_cb (GObject      *object,
          GAsyncResult *result,
          gpointer      user_data)
 {
-  g_autoptr(CcBackgroundPaintable) self = user_data;
+  CcBackgroundPaintable *self = user_data;
   g_autoptr(GdkPixbuf) pixbuf = NULL;
 
+  /* The request is cancelled when the paintable is disposed, so it's
+   * only safe to use self if it succeeded.
+   */
   if ((pixbuf = cc_background_item_get_thumbnail_finish (CC_BACKGROUND_ITEM (object), result, NULL)))
     {
       g_clear_object (&self->dark_texture);
@@ -114,7 +120,7 @@ update_cache (CcBackgroundPaintable *self)
                                             FALSE,
                                             self->cancellable,
                                             light_cb,
-                                            g_object_ref (self));
+                                            self);
 
   if ((self->paint_flags & CC_BACKGROUND_PAINT_DARK) && has_dark)
     cc_background_item_get_thumbnail_async (self->item,
@@ -125,7 +131,7 @@ update_cache (CcBackgroundPaintable *self)
                                             TRUE,
                                             self->cancellable,
                                             dark_cb,
-                                            g_object_ref (self));
+                                            self);
 }
 
 static void
@@ -0,0 +1,386 @@
+/* cc-background-thumbnail-cache.c
+ *
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <config.h>
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+#include "cc-background-thumbnail-cache.h"
+
+/*
+ * CcBackgroundThumbnailCache stores rendered wallpaper thumbnails as PNG
+ * files, named after a hash of their key. The key must describe
+ * everything the thumbnail depends on, e.g. the URI and modification time
+ * of the wallpaper, the thumbnail size and whether it's the dark variant,
+ * so stale entries are never looked up again and only go away through
+ * eviction.
+ *
+ * Entries are evicted, least recently used first, when the cache grows
+ * over its maximum size. Looking up an entry updates its modification
+ * time, which is used to order them.
+ *
+ * All the functions are thread-safe, and are meant to be called from
+ * the thumbnailing threads.
+ */
+
+#define DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+
+/* Evict down to this percentage of the maximum size, so that adding a
+ * few thumbnails doesn't trigger an eviction each time.
+ */
+#define EVICTION_TARGET_PERCENT 75
+
+#define ENTRY_SUFFIX ".png"
+
+struct _CcBackgroundThumbnailCache
+{
+  GObject           parent_instance;
+
+  char             *path;
+  guint64           max_size;
+
+  GMutex            mutex;
+  guint64           size;
+  gboolean          size_known;
+};
+
+G_DEFINE_TYPE (CcBackgroundThumbnailCache, cc_background_thumbnail_cache, G_TYPE_OBJECT)
+
+typedef struct
+{
+  char   *filename;
+  guint64 size;
+  gint64  mtime;
+} CacheEntry;
+
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_free (entry->filename);
+  g_free (entry);
+}
+
+static int
+compare_entries_by_mtime (gconstpointer a,
+                          gconstpointer b)
+{
+  const CacheEntry *entry_a = *(const CacheEntry **) a;
+  const CacheEntry *entry_b = *(const CacheEntry **) b;
+
+  if (entry_a->mtime < entry_b->mtime)
+    return -1;
+  if (entry_a->mtime > entry_b->mtime)
+    return 1;
+  return 0;
+}
+
+static char *
+get_entry_filename (CcBackgroundThumbnailCache *self,
+                    const char                 *key)
+{
+  g_autofree char *checksum = NULL;
+  g_autofree char *basename = NULL;
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  basename = g_strconcat (checksum, ENTRY_SUFFIX, NULL);
+
+  return g_build_filename (self->path, basename, NULL);
+}
+
+/* Must be called with the mutex held */
+static GPtrArray *
+list_entries_locked (CcBackgroundThumbnailCache *self)
+{
+  g_autoptr(GPtrArray) entries = NULL;
+  g_autoptr(GDir) dir = NULL;
+  const char *name;
+
+  entries = g_ptr_array_new_with_free_func (cache_entry_free);
+  self->size = 0;
+  self->size_known = TRUE;
+
+  dir = g_dir_open (self->path, 0, NULL);
+  if (!dir)
+    return g_steal_pointer (&entries);
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *filename = NULL;
+      CacheEntry *entry;
+      GStatBuf buf;
+
+      if (!g_str_has_suffix (name, ENTRY_SUFFIX))
+        continue;
+
+      filename = g_build_filename (self->path, name, NULL);
+      if (g_stat (filename, &buf) != 0)
+        continue;
+
+      entry = g_new0 (CacheEntry, 1);
+      entry->filename = g_steal_pointer (&filename);
+      entry->size = buf.st_size;
+      entry->mtime = buf.st_mtime;
+      g_ptr_array_add (entries, entry);
+
+      self->size += entry->size;
+    }
+
+  return g_steal_pointer (&entries);
+}
+
+/* Must be called with the mutex held */
+static void
+evict_locked (CcBackgroundThumbnailCache *self)
+{
+  g_autoptr(GPtrArray) entries = NULL;
+  guint64 target_size;
+  guint n_evicted = 0;
+  guint i;
+
+  entries = list_entries_locked (self);
+  if (self->size <= self->max_size)
+    return;
+
+  target_size = self->max_size / 100 * EVICTION_TARGET_PERCENT;
+
+  g_ptr_array_sort (entries, compare_entries_by_mtime);
+
+  for (i = 0; i < entries->len && self->size > target_size; i++)
+    {
+      CacheEntry *entry = g_ptr_array_index (entries, i);
+
+      if (g_unlink (entry->filename) != 0)
+        continue;
+
+      self->size -= entry->size;
+      n_evicted++;
+    }
+
+  g_debug ("Evicted %u thumbnails from %s, %" G_GUINT64_FORMAT " bytes left",
+           n_evicted, self->path, self->size);
+}
+
+static void
+cc_background_thumbnail_cache_finalize (GObject *object)
+{
+  CcBackgroundThumbnailCache *self = CC_BACKGROUND_THUMBNAIL_CACHE (object);
+
+  g_clear_pointer (&self->path, g_free);
+  g_mutex_clear (&self->mutex);
+
+  G_OBJECT_CLASS (cc_background_thumbnail_cache_parent_class)->finalize (object);
+}
+
+static void
+cc_background_thumbnail_cache_class_init (CcBackgroundThumbnailCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_background_thumbnail_cache_finalize;
+}
+
+static void
+cc_background_thumbnail_cache_init (CcBackgroundThumbnailCache *self)
+{
+  g_mutex_init (&self->mutex);
+}
+
+/**
+ * cc_background_thumbnail_cache_new:
+ * @path: the directory to store the thumbnails in
+ * @max_size: the maximum size of the cache, in bytes
+ *
+ * Creates a thumbnail cache in @path. The directory is created when
+ * the first thumbnail is stored.
+ *
+ * Returns: (transfer full): a new #CcBackgroundThumbnailCache
+ */
+CcBackgroundThumbnailCache *
+cc_background_thumbnail_cache_new (const char *path,
+                                   guint64     max_size)
+{
+  CcBackgroundThumbnailCache *self;
+
+  g_return_val_if_fail (path != NULL, NULL);
+  g_return_val_if_fail (max_size > 0, NULL);
+
+  self = g_object_new (CC_TYPE_BACKGROUND_THUMBNAIL_CACHE, NULL);
+  self->path = g_strdup (path);
+  self->max_size = max_size;
+
+  return self;
+}
+
+/**
+ * cc_background_thumbnail_cache_get_default:
+ *
+ * Retrieves the thumbnail cache shared by the background panel, stored
+ * in the user cache directory.
+ *
+ * Returns: (transfer none): the default #CcBackgroundThumbnailCache
+ */
+CcBackgroundThumbnailCache *
+cc_background_thumbnail_cache_get_default (void)
+{
+  static CcBackgroundThumbnailCache *default_cache = NULL;
+
+  if (g_once_init_enter (&default_cache))
+    {
+      g_autofree char *path = NULL;
+
+      path = g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "backgrounds", NULL);
+
+      g_once_init_leave (&default_cache, cc_background_thumbnail_cache_new (path, DEFAULT_MAX_SIZE));
+    }
+
+  return default_cache;
+}
+
+/**
+ * cc_background_thumbnail_cache_lookup:
+ * @self: a #CcBackgroundThumbnailCache
+ * @key: the key of the thumbnail
+ *
+ * Loads the thumbnail stored for @key, if any.
+ *
+ * Returns: (transfer full) (nullable): the thumbnail, or %NULL
+ */
+GdkPixbuf *
+cc_background_thumbnail_cache_lookup (CcBackgroundThumbnailCache *self,
+                                      const char                 *key)
+{
+  g_autofree char *filename = NULL;
+  g_autoptr(GError) error = NULL;
+  GdkPixbuf *pixbuf;
+
+  g_return_val_if_fail (CC_IS_BACKGROUND_THUMBNAIL_CACHE (self), NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  filename = get_entry_filename (self, key);
+  pixbuf = gdk_pixbuf_new_from_file (filename, &error);
+
+  if (!pixbuf)
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_debug ("Failed to load cached thumbnail %s: %s", filename, error->message);
+      return NULL;
+    }
+
+  /* Mark it as recently used */
+  g_utime (filename, NULL);
+
+  return pixbuf;
+}
+
+/**
+ * cc_background_thumbnail_cache_store:
+ * @self: a #CcBackgroundThumbnailCache
+ * @key: the key of the thumbnail
+ * @pixbuf: the thumbnail
+ * @error: return location for a #GError
+ *
+ * Stores @pixbuf for @key, replacing any previous thumbnail, and evicts
+ * the least recently used thumbnails if the cache is over its maximum
+ * size.
+ *
+ * Returns: %TRUE if the thumbnail was stored
+ */
+gboolean
+cc_background_thumbnail_cache_store (CcBackgroundThumbnailCache  *self,
+                                     const char                  *key,
+                                     GdkPixbuf                   *pixbuf,
+                                     GError                     **error)
+{
+  g_autofree char *filename = NULL;
+  g_autofree char *buffer = NULL;
+  g_autoptr(GMutexLocker) locker = NULL;
+  gsize buffer_size;
+
+  g_return_val_if_fail (CC_IS_BACKGROUND_THUMBNAIL_CACHE (self), FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), FALSE);
+
+  if (!gdk_pixbuf_save_to_buffer (pixbuf, &buffer, &buffer_size, "png", error, NULL))
+    return FALSE;
+
+  if (g_mkdir_with_parents (self->path, 0700) != 0)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                   "Failed to create %s: %s", self->path, g_strerror (errsv));
+      return FALSE;
+    }
+
+  filename = get_entry_filename (self, key);
+
+  /* Hold the lock while replacing the file, so that the size of the
+   * entry it replaces is the one that gets subtracted.
+   */
+  locker = g_mutex_locker_new (&self->mutex);
+
+  if (self->size_known)
+    {
+      GStatBuf buf;
+
+      if (g_stat (filename, &buf) == 0)
+        self->size -= MIN ((guint64) buf.st_size, self->size);
+    }
+
+  if (!g_file_set_contents (filename, buffer, buffer_size, error))
+    {
+      /* The previous entry may or may not be gone, rescan next time */
+      self->size_known = FALSE;
+      return FALSE;
+    }
+
+  /* The directory is only scanned once, then its size is kept up to date */
+  if (!self->size_known)
+    g_ptr_array_unref (list_entries_locked (self));
+  else
+    self->size += buffer_size;
+
+  if (self->size > self->max_size)
+    evict_locked (self);
+
+  return TRUE;
+}
+
+/**
+ * cc_background_thumbnail_cache_get_size:
+ * @self: a #CcBackgroundThumbnailCache
+ *
+ * Returns: the size of the stored thumbnails, in bytes
+ */
+guint64
+cc_background_thumbnail_cache_get_size (CcBackgroundThumbnailCache *self)
+{
+  g_autoptr(GMutexLocker) locker = NULL;
+  g_autoptr(GPtrArray) entries = NULL;
+
+  g_return_val_if_fail (CC_IS_BACKGROUND_THUMBNAIL_CACHE (self), 0);
+
+  locker = g_mutex_locker_new (&self->mutex);
+  entries = list_entries_locked (self);
+
+  return self->size;
+}
@@ -0,0 +1,45 @@
+/* cc-background-thumbnail-cache.h
+ *
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_BACKGROUND_THUMBNAIL_CACHE (cc_background_thumbnail_cache_get_type ())
+G_DECLARE_FINAL_TYPE (CcBackgroundThumbnailCache, cc_background_thumbnail_cache, CC, BACKGROUND_THUMBNAIL_CACHE, GObject)
+
+CcBackgroundThumbnailCache *cc_background_thumbnail_cache_new         (const char                 *path,
+                                                                       guint64                     max_size);
+
+CcBackgroundThumbnailCache *cc_background_thumbnail_cache_get_default (void);
+
+GdkPixbuf                  *cc_background_thumbnail_cache_lookup      (CcBackgroundThumbnailCache *self,
+                                                                       const char                 *key);
+
+gboolean                    cc_background_thumbnail_cache_store       (CcBackgroundThumbnailCache *self,
+                                                                       const char                 *key,
+                                                                       GdkPixbuf                  *pixbuf,
+                                                                       GError                    **error);
+
+guint64                     cc_background_thumbnail_cache_get_size    (CcBackgroundThumbnailCache *self);
+
+G_END_DECLS
@@ -0,0 +1,392 @@
+/* cc-background-thumbnail-scheduler.c
+ *
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <config.h>
+
+#include "cc-background-thumbnail-scheduler.h"
+
+/*
+ * CcBackgroundThumbnailScheduler renders thumbnails on a fixed number of
+ * threads, instead of spawning one thread pool job per request, so that
+ * showing hundreds of wallpapers doesn't queue hundreds of full image
+ * decodes in front of the ones the user is looking at.
+ *
+ * Requests are grouped into jobs by key. Requests with the same key are
+ * coalesced into a single job, whose result is returned to all of them.
+ * Queued jobs run in the order they were queued. Only the tiles bound
+ * by the chooser's grid request thumbnails, and unbinding one cancels
+ * its requests: cancelling a request removes it from its job, and the
+ * job is dropped when none of its requests are left before it starts
+ * running.
+ */
+
+#define DEFAULT_MAX_THREADS 4
+
+struct _CcBackgroundThumbnailScheduler
+{
+  GObject           parent_instance;
+
+  GThreadPool      *pool;
+
+  GMutex            mutex;
+  GQueue            queue;
+  GHashTable       *jobs;
+};
+
+G_DEFINE_TYPE (CcBackgroundThumbnailScheduler, cc_background_thumbnail_scheduler, G_TYPE_OBJECT)
+
+typedef struct
+{
+  char                      *key;
+  gboolean                   running;
+  GTask                     *task;
+  CcBackgroundThumbnailFunc  func;
+  GList                     *requests;
+} Job;
+
+typedef struct
+{
+  CcBackgroundThumbnailScheduler *scheduler;
+  Job                            *job;
+  GTask                          *task;
+  GCancellable                   *cancellable;
+  gulong                          cancelled_id;
+  gboolean                        cancelled;
+} Request;
+
+static void
+job_free (gpointer data)
+{
+  Job *job = data;
+
+  g_assert (job->requests == NULL);
+
+  g_clear_object (&job->task);
+  g_free (job->key);
+  g_free (job);
+}
+
+static void
+request_free (Request *request)
+{
+  if (request->cancellable)
+    g_cancellable_disconnect (request->cancellable, request->cancelled_id);
+
+  g_clear_object (&request->cancellable);
+  g_clear_object (&request->task);
+  g_free (request);
+}
+
+static void
+request_return_cancelled (Request *request)
+{
+  if (!g_task_return_error_if_cancelled (request->task))
+    g_task_return_new_error (request->task,
+                             G_IO_ERROR,
+                             G_IO_ERROR_CANCELLED,
+                             "Thumbnail request was cancelled");
+
+  request_free (request);
+}
+
+static gboolean
+request_return_cancelled_idle_cb (gpointer user_data)
+{
+  request_return_cancelled (user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs in the thread where the cancellable was cancelled */
+static void
+on_request_cancelled_cb (GCancellable *cancellable,
+                         Request      *request)
+{
+  CcBackgroundThumbnailScheduler *self = request->scheduler;
+  Job *job;
+
+  g_mutex_lock (&self->mutex);
+
+  request->cancelled = TRUE;
+
+  /* Either it's not queued yet, or a thread is already returning the
+   * result to it. Both take care of the request themselves.
+   */
+  job = request->job;
+  if (job == NULL)
+    {
+      g_mutex_unlock (&self->mutex);
+      return;
+    }
+
+  job->requests = g_list_remove (job->requests, request);
+  request->job = NULL;
+
+  if (job->requests == NULL && !job->running)
+    {
+      g_queue_remove (&self->queue, job);
+      g_hash_table_remove (self->jobs, job->key);
+    }
+
+  g_mutex_unlock (&self->mutex);
+
+  /* The handler can't be disconnected from within itself */
+  g_idle_add (request_return_cancelled_idle_cb, request);
+}
+
+static void
+run_next_job (gpointer data,
+              gpointer user_data)
+{
+  CcBackgroundThumbnailScheduler *self = user_data;
+  g_autoptr(GdkPixbuf) pixbuf = NULL;
+  g_autoptr(GError) error = NULL;
+  GList *requests;
+  GList *l;
+  Job *job;
+
+  g_mutex_lock (&self->mutex);
+
+  /* There is one pool item per queued job, but the job it was pushed for
+   * might have been dropped since.
+   */
+  job = g_queue_pop_head (&self->queue);
+  if (job == NULL)
+    {
+      g_mutex_unlock (&self->mutex);
+      return;
+    }
+
+  job->running = TRUE;
+
+  g_mutex_unlock (&self->mutex);
+
+  pixbuf = job->func (job->task, &error);
+
+  g_mutex_lock (&self->mutex);
+
+  requests = g_steal_pointer (&job->requests);
+  for (l = requests; l; l = l->next)
+    ((Request *) l->data)->job = NULL;
+
+  g_hash_table_remove (self->jobs, job->key);
+
+  g_mutex_unlock (&self->mutex);
+
+  for (l = requests; l; l = l->next)
+    {
+      Request *request = l->data;
+
+      if (pixbuf != NULL)
+        g_task_return_pointer (request->task, g_object_ref (pixbuf), g_object_unref);
+      else if (error != NULL)
+        g_task_return_error (request->task, g_error_copy (error));
+      else
+        g_task_return_new_error (request->task,
+                                 G_IO_ERROR,
+                                 G_IO_ERROR_FAILED,
+                                 "Failed to create thumbnail");
+
+      request_free (request);
+    }
+
+  g_list_free (requests);
+}
+
+static void
+cc_background_thumbnail_scheduler_finalize (GObject *object)
+{
+  CcBackgroundThumbnailScheduler *self = CC_BACKGROUND_THUMBNAIL_SCHEDULER (object);
+  Job *job;
+
+  /* Wait for the running jobs, and drop the queued ones */
+  g_thread_pool_free (self->pool, TRUE, TRUE);
+
+  while ((job = g_queue_pop_head (&self->queue)) != NULL)
+    {
+      GList *requests;
+      GList *l;
+
+      g_mutex_lock (&self->mutex);
+      requests = g_steal_pointer (&job->requests);
+      for (l = requests; l; l = l->next)
+        ((Request *) l->data)->job = NULL;
+      g_mutex_unlock (&self->mutex);
+
+      for (l = requests; l; l = l->next)
+        request_return_cancelled (l->data);
+
+      g_list_free (requests);
+    }
+
+  g_clear_pointer (&self->jobs, g_hash_table_unref);
+  g_mutex_clear (&self->mutex);
+
+  G_OBJECT_CLASS (cc_background_thumbnail_scheduler_parent_class)->finalize (object);
+}
+
+static void
+cc_background_thumbnail_scheduler_class_init (CcBackgroundThumbnailSchedulerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_background_thumbnail_scheduler_finalize;
+}
+
+static void
+cc_background_thumbnail_scheduler_init (CcBackgroundThumbnailScheduler *self)
+{
+  g_mutex_init (&self->mutex);
+  g_queue_init (&self->queue);
+  self->jobs = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, job_free);
+}
+
+/**
+ * cc_background_thumbnail_scheduler_new:
+ * @max_threads: the number of threads rendering thumbnails
+ *
+ * Returns: (transfer full): a new #CcBackgroundThumbnailScheduler
+ */
+CcBackgroundThumbnailScheduler *
+cc_background_thumbnail_scheduler_new (guint max_threads)
+{
+  CcBackgroundThumbnailScheduler *self;
+
+  g_return_val_if_fail (max_threads > 0, NULL);
+
+  self = g_object_new (CC_TYPE_BACKGROUND_THUMBNAIL_SCHEDULER, NULL);
+  self->pool = g_thread_pool_new (run_next_job, self, max_threads, FALSE, NULL);
+
+  return self;
+}
+
+/**
+ * cc_background_thumbnail_scheduler_get_default:
+ *
+ * Retrieves the scheduler shared by the background panel, which uses
+ * up to half of the processors, and no more than 4 threads.
+ *
+ * Returns: (transfer none): the default #CcBackgroundThumbnailScheduler
+ */
+CcBackgroundThumbnailScheduler *
+cc_background_thumbnail_scheduler_get_default (void)
+{
+  static CcBackgroundThumbnailScheduler *default_scheduler = NULL;
+
+  if (g_once_init_enter (&default_scheduler))
+    {
+      guint max_threads;
+
+      max_threads = CLAMP (g_get_num_processors () / 2, 1, DEFAULT_MAX_THREADS);
+
+      g_once_init_leave (&default_scheduler, cc_background_thumbnail_scheduler_new (max_threads));
+    }
+
+  return default_scheduler;
+}
+
+/**
+ * cc_background_thumbnail_scheduler_push:
+ * @self: a #CcBackgroundThumbnailScheduler
+ * @task: the #GTask to return the thumbnail to
+ * @key: a key identifying the thumbnail
+ * @func: the function rendering the thumbnail
+ *
+ * Queues @task to be returned the thumbnail rendered by @func. If a job
+ * for @key is already queued or running, @task is added to it instead.
+ *
+ * The request is dropped, and @task returns %G_IO_ERROR_CANCELLED, when
+ * the cancellable of @task is cancelled.
+ */
+void
+cc_background_thumbnail_scheduler_push (CcBackgroundThumbnailScheduler *self,
+                                        GTask                          *task,
+                                        const char                     *key,
+                                        CcBackgroundThumbnailFunc       func)
+{
+  GCancellable *cancellable;
+  Request *request;
+  Job *job;
+
+  g_return_if_fail (CC_IS_BACKGROUND_THUMBNAIL_SCHEDULER (self));
+  g_return_if_fail (G_IS_TASK (task));
+  g_return_if_fail (key != NULL);
+  g_return_if_fail (func != NULL);
+
+  cancellable = g_task_get_cancellable (task);
+
+  request = g_new0 (Request, 1);
+  request->scheduler = self;
+  request->task = g_object_ref (task);
+
+  if (cancellable)
+    {
+      request->cancellable = g_object_ref (cancellable);
+      request->cancelled_id = g_cancellable_connect (cancellable,
+                                                     G_CALLBACK (on_request_cancelled_cb),
+                                                     request,
+                                                     NULL);
+    }
+
+  g_mutex_lock (&self->mutex);
+
+  if (request->cancelled)
+    {
+      g_mutex_unlock (&self->mutex);
+      request_return_cancelled (request);
+      return;
+    }
+
+  job = g_hash_table_lookup (self->jobs, key);
+
+  if (job == NULL)
+    {
+      job = g_new0 (Job, 1);
+      job->key = g_strdup (key);
+      job->task = g_object_ref (task);
+      job->func = func;
+
+      g_hash_table_insert (self->jobs, job->key, job);
+      g_queue_push_tail (&self->queue, job);
+      g_thread_pool_push (self->pool, GUINT_TO_POINTER (TRUE), NULL);
+    }
+
+  job->requests = g_list_append (job->requests, request);
+  request->job = job;
+
+  g_mutex_unlock (&self->mutex);
+}
+
+/**
+ * cc_background_thumbnail_scheduler_get_n_queued:
+ * @self: a #CcBackgroundThumbnailScheduler
+ *
+ * Returns: the number of jobs waiting for a thread
+ */
+guint
+cc_background_thumbnail_scheduler_get_n_queued (CcBackgroundThumbnailScheduler *self)
+{
+  g_autoptr(GMutexLocker) locker = NULL;
+
+  g_return_val_if_fail (CC_IS_BACKGROUND_THUMBNAIL_SCHEDULER (self), 0);
+
+  locker = g_mutex_locker_new (&self->mutex);
+
+  return g_queue_get_length (&self->queue);
+}
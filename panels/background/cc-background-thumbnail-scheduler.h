@@ -0,0 +1,55 @@
+/* cc-background-thumbnail-scheduler.h
+ *
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_BACKGROUND_THUMBNAIL_SCHEDULER (cc_background_thumbnail_scheduler_get_type ())
+G_DECLARE_FINAL_TYPE (CcBackgroundThumbnailScheduler, cc_background_thumbnail_scheduler, CC, BACKGROUND_THUMBNAIL_SCHEDULER, GObject)
+
+/**
+ * CcBackgroundThumbnailFunc:
+ * @task: the first #GTask queued for the job
+ * @error: return location for a #GError
+ *
+ * Renders a thumbnail in one of the scheduler threads. Only the source
+ * object and task data of @task may be used; the result is returned to
+ * every task coalesced into the job by the scheduler.
+ *
+ * Returns: (transfer full) (nullable): the thumbnail
+ */
+typedef GdkPixbuf * (*CcBackgroundThumbnailFunc) (GTask   *task,
+                                                  GError **error);
+
+CcBackgroundThumbnailScheduler *cc_background_thumbnail_scheduler_new         (guint                           max_threads);
+
+CcBackgroundThumbnailScheduler *cc_background_thumbnail_scheduler_get_default (void);
+
+void                            cc_background_thumbnail_scheduler_push        (CcBackgroundThumbnailScheduler *self,
+                                                                               GTask                          *task,
+                                                                               const char                     *key,
+                                                                               CcBackgroundThumbnailFunc       func);
+
+guint                           cc_background_thumbnail_scheduler_get_n_queued (CcBackgroundThumbnailScheduler *self);
+
+G_END_DECLS
@@ -19,8 +19,10 @@
  * along with this program; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
 #include <gio/gio.h>
 #include <string.h>
+#include <glib/gstdio.h>
 #include <libxml/parser.h>
 #include <gdesktop-enums.h>
 
@@ -28,22 +30,34 @@
 #include "cc-background-item.h"
 #include "cc-background-xml.h"
 
-/* The number of items we signal as "added" before
+/* The number of items we signal as "added" or "removed" before
  * returning to the main loop */
 #define NUM_ITEMS_PER_BATCH 1
 
+/* The wallpapers parsed from each XML file are cached, keyed by the path,
+ * modification time and size of the file, so that the files only get
+ * parsed again when they change. Bump the version when changing the
+ * format of the cache.
+ */
+#define CACHE_VERSION 1
+#define WALLPAPER_VARIANT_TYPE "(sumsmsmsmsmsmsiibb)"
+#define FILE_VARIANT_TYPE "(xta" WALLPAPER_VARIANT_TYPE ")"
+#define CACHE_VARIANT_TYPE "(usa{s" FILE_VARIANT_TYPE "})"
+
 struct _CcBackgroundXml
 {
   GObject      parent_instance;
 
   GHashTable  *wp_hash;
-  GAsyncQueue *item_added_queue;
-  guint        item_added_id;
+  GHashTable  *file_ids; /* XML filename → (item id → wallpaper variant) */
+  GAsyncQueue *item_changed_queue;
+  guint        item_changed_id;
   GSList      *monitors; /* GSList of GFileMonitor */
 };
 
 enum {
 	ADDED,
+	REMOVED,
 	LAST_SIGNAL
 };
 
@@ -107,62 +121,197 @@ enum_string_to_value (GType type,
 	return value->value;
 }
 
+typedef struct
+{
+  guint             signal_id;
+  CcBackgroundItem *item;
+} ItemChange;
+
+static void
+item_change_free (gpointer data)
+{
+	ItemChange *change = data;
+
+	g_object_unref (change->item);
+	g_free (change);
+}
+
 static gboolean
 idle_emit (CcBackgroundXml *xml)
 {
 	gint i;
 
-	g_async_queue_lock (xml->item_added_queue);
+	g_async_queue_lock (xml->item_changed_queue);
 
 	for (i = 0; i < NUM_ITEMS_PER_BATCH; i++) {
-		g_autoptr(GObject) item = NULL;
+		ItemChange *change;
 
-		item = g_async_queue_try_pop_unlocked (xml->item_added_queue);
-		if (item == NULL)
+		change = g_async_queue_try_pop_unlocked (xml->item_changed_queue);
+		if (change == NULL)
 			break;
-		g_signal_emit (G_OBJECT (xml), signals[ADDED], 0, item);
+		g_signal_emit (G_OBJECT (xml), change->signal_id, 0, change->item);
+		item_change_free (change);
 	}
 
-	g_async_queue_unlock (xml->item_added_queue);
+	g_async_queue_unlock (xml->item_changed_queue);
 
-        if (g_async_queue_length (xml->item_added_queue) > 0) {
+        if (g_async_queue_length (xml->item_changed_queue) > 0) {
                 return TRUE;
         } else {
-                xml->item_added_id = 0;
+                xml->item_changed_id = 0;
                 return FALSE;
         }
 }
 
 static void
-emit_added_in_idle (CcBackgroundXml *xml,
-		    GObject         *object)
+emit_in_idle (CcBackgroundXml  *xml,
+	      guint             signal_id,
+	      CcBackgroundItem *item)
 {
-	g_async_queue_lock (xml->item_added_queue);
-	g_async_queue_push_unlocked (xml->item_added_queue, object);
-	if (xml->item_added_id == 0)
-		xml->item_added_id = g_idle_add ((GSourceFunc) idle_emit, xml);
-	g_async_queue_unlock (xml->item_added_queue);
+	ItemChange *change;
+
+	change = g_new0 (ItemChange, 1);
+	change->signal_id = signal_id;
+	change->item = g_object_ref (item);
+
+	g_async_queue_lock (xml->item_changed_queue);
+	g_async_queue_push_unlocked (xml->item_changed_queue, change);
+	if (xml->item_changed_id == 0)
+		xml->item_changed_id = g_idle_add ((GSourceFunc) idle_emit, xml);
+	g_async_queue_unlock (xml->item_changed_queue);
+}
+
+static void
+emit_item_changed (CcBackgroundXml  *xml,
+		   guint             signal_id,
+		   CcBackgroundItem *item,
+		   gboolean          in_thread)
+{
+	if (in_thread)
+		emit_in_idle (xml, signal_id, item);
+	else
+		g_signal_emit (G_OBJECT (xml), signal_id, 0, item);
 }
 
 #define NONE "(none)"
 
-static gboolean
-cc_background_xml_load_xml_internal (CcBackgroundXml *xml,
-				     const gchar     *filename,
-				     gboolean         in_thread)
+static GVariant *
+wallpaper_to_variant (const gchar      *id,
+		      CcBackgroundItem *item)
+{
+  g_autofree gchar *name = NULL;
+  g_autofree gchar *uri = NULL;
+  g_autofree gchar *uri_dark = NULL;
+  g_autofree gchar *pcolor = NULL;
+  g_autofree gchar *scolor = NULL;
+  g_autofree gchar *source_url = NULL;
+  GDesktopBackgroundStyle placement;
+  GDesktopBackgroundShading shading;
+  CcBackgroundItemFlags flags;
+  gboolean is_deleted;
+  gboolean needs_download;
+
+  g_object_get (G_OBJECT (item),
+		"name", &name,
+		"uri", &uri,
+		"uri-dark", &uri_dark,
+		"primary-color", &pcolor,
+		"secondary-color", &scolor,
+		"source-url", &source_url,
+		"placement", &placement,
+		"shading", &shading,
+		"is-deleted", &is_deleted,
+		"needs-download", &needs_download,
+		"flags", &flags,
+		NULL);
+
+  return g_variant_new (WALLPAPER_VARIANT_TYPE,
+			id,
+			flags,
+			name,
+			uri,
+			uri_dark,
+			pcolor,
+			scolor,
+			source_url,
+			placement,
+			shading,
+			is_deleted,
+			needs_download);
+}
+
+/* Only sets the properties that were set when parsing, so the flags of
+ * the item match the ones of the parsed one */
+static CcBackgroundItem *
+wallpaper_from_variant (const gchar *filename,
+			GVariant    *variant)
 {
+  CcBackgroundItem *item;
+  const gchar *id, *name, *uri, *uri_dark, *pcolor, *scolor, *source_url;
+  gint32 placement, shading;
+  gboolean is_deleted, needs_download;
+  guint32 flags;
+
+  g_variant_get (variant, "(&su&ms&ms&ms&ms&ms&msiibb)",
+		 &id,
+		 &flags,
+		 &name,
+		 &uri,
+		 &uri_dark,
+		 &pcolor,
+		 &scolor,
+		 &source_url,
+		 &placement,
+		 &shading,
+		 &is_deleted,
+		 &needs_download);
+
+  item = cc_background_item_new (NULL);
+
+  g_object_set (G_OBJECT (item),
+		"is-deleted", is_deleted,
+		"source-xml", filename,
+		NULL);
+
+  if (flags & CC_BACKGROUND_ITEM_HAS_URI)
+    g_object_set (G_OBJECT (item), "uri", uri, NULL);
+  if (flags & CC_BACKGROUND_ITEM_HAS_URI_DARK)
+    g_object_set (G_OBJECT (item), "uri-dark", uri_dark, NULL);
+  if (name != NULL)
+    g_object_set (G_OBJECT (item), "name", name, NULL);
+  if (flags & CC_BACKGROUND_ITEM_HAS_PLACEMENT)
+    g_object_set (G_OBJECT (item), "placement", placement, NULL);
+  if (flags & CC_BACKGROUND_ITEM_HAS_SHADING)
+    g_object_set (G_OBJECT (item), "shading", shading, NULL);
+  if (flags & CC_BACKGROUND_ITEM_HAS_PCOLOR)
+    g_object_set (G_OBJECT (item), "primary-color", pcolor, NULL);
+  if (flags & CC_BACKGROUND_ITEM_HAS_SCOLOR)
+    g_object_set (G_OBJECT (item), "secondary-color", scolor, NULL);
+  if (source_url != NULL)
+    g_object_set (G_OBJECT (item),
+		  "source-url", source_url,
+		  "needs-download", needs_download,
+		  NULL);
+
+  return item;
+}
+
+/* Returns an array of WALLPAPER_VARIANT_TYPE, or NULL if the file
+ * couldn't be parsed */
+static GVariant *
+parse_xml_file (const gchar *filename)
+{
+  g_auto(GVariantBuilder) builder = G_VARIANT_BUILDER_INIT (G_VARIANT_TYPE ("a" WALLPAPER_VARIANT_TYPE));
   xmlDoc * wplist;
   xmlNode * root, * list, * wpa;
   xmlChar * nodelang;
   const gchar * const * syslangs;
   gint i;
-  gboolean retval;
 
   wplist = xmlParseFile (filename);
-  retval = FALSE;
 
   if (!wplist)
-    return retval;
+    return NULL;
 
   syslangs = g_get_language_names ();
 
@@ -286,25 +435,6 @@ cc_background_xml_load_xml_internal (CcBackgroundXml *xml,
 	}
       }
 
-      /* Check whether the target file exists */
-      {
-        const char *uri;
-
-	uri = cc_background_item_get_uri (item);
-	if (uri != NULL)
-	  {
-            g_autoptr(GFile) file = NULL;
-
-            file = g_file_new_for_uri (uri);
-	    if (g_file_query_exists (file, NULL) == FALSE)
-	      {
-	        g_clear_pointer (&cname, g_free);
-	        g_clear_object (&item);
-	        continue;
-	      }
-	  }
-      }
-
       /* FIXME, this is a broken way of doing,
        * need to use proper code here */
       uri = g_filename_to_uri (filename, NULL, NULL);
@@ -313,23 +443,327 @@ cc_background_xml_load_xml_internal (CcBackgroundXml *xml,
       else
         id = g_strdup_printf ("%s#%s", uri, cname);
 
-      /* Make sure we don't already have this one and that filename exists */
-      if (g_hash_table_lookup (xml->wp_hash, id) != NULL) {
-	continue;
-      }
-
-      g_hash_table_insert (xml->wp_hash,
-                           g_strdup (id),
-                           g_object_ref (item));
-      if (in_thread)
-        emit_added_in_idle (xml, g_object_ref (G_OBJECT (item)));
-      else
-        g_signal_emit (G_OBJECT (xml), signals[ADDED], 0, item);
-      retval = TRUE;
+      g_variant_builder_add_value (&builder, wallpaper_to_variant (id, item));
     }
   }
   xmlFreeDoc (wplist);
 
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+typedef struct
+{
+  gint64    mtime;
+  guint64   size;
+  GVariant *wallpapers;
+} CachedFile;
+
+static GMutex cache_mutex;
+static GHashTable *cached_files = NULL; /* XML filename → CachedFile */
+static gboolean cache_dirty = FALSE;
+
+static void
+cached_file_free (gpointer data)
+{
+  CachedFile *cached_file = data;
+
+  g_variant_unref (cached_file->wallpapers);
+  g_free (cached_file);
+}
+
+static gchar *
+get_cache_filename (void)
+{
+  return g_build_filename (g_get_user_cache_dir (),
+			   "gnome-control-center",
+			   "background-properties.cache",
+			   NULL);
+}
+
+/* Names are translated when parsing */
+static gchar *
+get_cache_languages (void)
+{
+  return g_strjoinv (":", (gchar **) g_get_language_names ());
+}
+
+/* Must be called with the cache mutex held */
+static void
+ensure_cache_locked (void)
+{
+  g_autoptr(GMappedFile) mapped_file = NULL;
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GVariant) files = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autofree gchar *cache_filename = NULL;
+  g_autofree gchar *languages = NULL;
+  const gchar *cache_languages;
+  const gchar *filename;
+  GVariantIter iter;
+  GVariant *wallpapers;
+  guint32 version;
+  gint64 mtime;
+  guint64 size;
+
+  if (cached_files != NULL)
+    return;
+
+  cached_files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, cached_file_free);
+
+  cache_filename = get_cache_filename ();
+  mapped_file = g_mapped_file_new (cache_filename, FALSE, NULL);
+  if (mapped_file == NULL)
+    return;
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  cache = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (CACHE_VARIANT_TYPE), bytes, FALSE));
+
+  /* Mapped data from disk isn't trusted until it's normalised */
+  if (!g_variant_is_normal_form (cache))
+    {
+      g_debug ("Ignoring corrupt background properties cache %s", cache_filename);
+      return;
+    }
+
+  languages = get_cache_languages ();
+  g_variant_get (cache, "(u&s@a{s" FILE_VARIANT_TYPE "})", &version, &cache_languages, &files);
+  if (version != CACHE_VERSION || g_strcmp0 (languages, cache_languages) != 0)
+    return;
+
+  g_variant_iter_init (&iter, files);
+  while (g_variant_iter_next (&iter, "{&s(xt@a" WALLPAPER_VARIANT_TYPE ")}", &filename, &mtime, &size, &wallpapers))
+    {
+      CachedFile *cached_file;
+
+      cached_file = g_new0 (CachedFile, 1);
+      cached_file->mtime = mtime;
+      cached_file->size = size;
+      cached_file->wallpapers = wallpapers;
+
+      g_hash_table_insert (cached_files, g_strdup (filename), cached_file);
+    }
+}
+
+static void
+save_cache (void)
+{
+  g_auto(GVariantBuilder) builder = G_VARIANT_BUILDER_INIT (G_VARIANT_TYPE ("a{s" FILE_VARIANT_TYPE "}"));
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *cache_filename = NULL;
+  g_autofree gchar *cache_dir = NULL;
+  g_autofree gchar *languages = NULL;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_mutex_lock (&cache_mutex);
+
+  if (!cache_dirty)
+    {
+      g_mutex_unlock (&cache_mutex);
+      return;
+    }
+
+  g_hash_table_iter_init (&iter, cached_files);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      CachedFile *cached_file = value;
+
+      /* Drop the files that went away */
+      if (!g_file_test (key, G_FILE_TEST_EXISTS))
+        {
+          g_hash_table_iter_remove (&iter);
+          continue;
+        }
+
+      g_variant_builder_add (&builder, "{s(xt@a" WALLPAPER_VARIANT_TYPE ")}",
+			     key,
+			     cached_file->mtime,
+			     cached_file->size,
+			     cached_file->wallpapers);
+    }
+
+  cache_dirty = FALSE;
+
+  g_mutex_unlock (&cache_mutex);
+
+  languages = get_cache_languages ();
+  cache = g_variant_ref_sink (g_variant_new ("(us@a{s" FILE_VARIANT_TYPE "})",
+					     CACHE_VERSION,
+					     languages,
+					     g_variant_builder_end (&builder)));
+
+  cache_filename = get_cache_filename ();
+  cache_dir = g_path_get_dirname (cache_filename);
+
+  if (g_mkdir_with_parents (cache_dir, 0700) != 0 ||
+      !g_file_set_contents (cache_filename,
+			    g_variant_get_data (cache),
+			    g_variant_get_size (cache),
+			    &error))
+    g_debug ("Failed to save background properties cache %s: %s",
+	     cache_filename, error ? error->message : g_strerror (errno));
+}
+
+/* Returns the wallpapers of the XML file, from the cache if the file
+ * didn't change since it was last parsed */
+static GVariant *
+get_wallpapers (const gchar *filename)
+{
+  g_autoptr(GFileInfo) info = NULL;
+  g_autoptr(GFile) file = NULL;
+  GVariant *wallpapers;
+  CachedFile *cached_file;
+  gint64 mtime;
+  guint64 size;
+
+  file = g_file_new_for_path (filename);
+  info = g_file_query_info (file,
+			    G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+			    G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+			    G_FILE_ATTRIBUTE_STANDARD_SIZE,
+			    G_FILE_QUERY_INFO_NONE,
+			    NULL,
+			    NULL);
+  if (info == NULL)
+    return NULL;
+
+  mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+	  g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+  size = g_file_info_get_size (info);
+
+  g_mutex_lock (&cache_mutex);
+
+  ensure_cache_locked ();
+
+  cached_file = g_hash_table_lookup (cached_files, filename);
+  if (cached_file != NULL && cached_file->mtime == mtime && cached_file->size == size)
+    {
+      wallpapers = g_variant_ref (cached_file->wallpapers);
+      g_mutex_unlock (&cache_mutex);
+      return wallpapers;
+    }
+
+  g_mutex_unlock (&cache_mutex);
+
+  wallpapers = parse_xml_file (filename);
+
+  /* Files that aren't valid are cached too, so they aren't parsed again */
+  if (wallpapers == NULL)
+    wallpapers = g_variant_ref_sink (g_variant_new_array (G_VARIANT_TYPE (WALLPAPER_VARIANT_TYPE), NULL, 0));
+
+  g_mutex_lock (&cache_mutex);
+
+  cached_file = g_new0 (CachedFile, 1);
+  cached_file->mtime = mtime;
+  cached_file->size = size;
+  cached_file->wallpapers = g_variant_ref (wallpapers);
+  g_hash_table_replace (cached_files, g_strdup (filename), cached_file);
+  cache_dirty = TRUE;
+
+  g_mutex_unlock (&cache_mutex);
+
+  return wallpapers;
+}
+
+/* Loads the wallpapers of the XML file, only signalling the items that
+ * were added, changed or removed since the file was last loaded. An item
+ * belongs to the first file that listed it, the other files never add or
+ * remove it. */
+static gboolean
+cc_background_xml_load_xml_internal (CcBackgroundXml *xml,
+				     const gchar     *filename,
+				     gboolean         in_thread)
+{
+  g_autoptr(GHashTable) ids = NULL;
+  g_autoptr(GVariant) wallpapers = NULL;
+  GHashTable *previous_ids;
+  GVariantIter iter;
+  GVariant *wallpaper;
+  gboolean retval;
+
+  wallpapers = get_wallpapers (filename);
+  previous_ids = g_hash_table_lookup (xml->file_ids, filename);
+  ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+  retval = FALSE;
+
+  if (wallpapers != NULL)
+    g_variant_iter_init (&iter, wallpapers);
+
+  while (wallpapers != NULL && (wallpaper = g_variant_iter_next_value (&iter)) != NULL) {
+    g_autoptr(GVariant) owned_wallpaper = wallpaper;
+    g_autoptr(CcBackgroundItem) item = NULL;
+    GVariant *previous_wallpaper = NULL;
+    const gchar *id;
+    const gchar *uri;
+
+    g_variant_get_child (wallpaper, 0, "&s", &id);
+
+    /* Make sure we don't already have this one */
+    if (g_hash_table_contains (ids, id))
+      continue;
+
+    if (previous_ids != NULL)
+      previous_wallpaper = g_hash_table_lookup (previous_ids, id);
+
+    if (previous_wallpaper == NULL) {
+      /* Listed by another file */
+      if (g_hash_table_contains (xml->wp_hash, id))
+        continue;
+    } else if (g_variant_equal (previous_wallpaper, wallpaper)) {
+      g_hash_table_insert (ids, g_strdup (id), g_variant_ref (wallpaper));
+      continue;
+    } else {
+      g_autoptr(CcBackgroundItem) previous_item = NULL;
+      g_autofree gchar *previous_id = NULL;
+
+      /* Same id, but some of its properties changed */
+      if (g_hash_table_steal_extended (xml->wp_hash, id, (gpointer *) &previous_id, (gpointer *) &previous_item))
+        emit_item_changed (xml, signals[REMOVED], previous_item, in_thread);
+    }
+
+    item = wallpaper_from_variant (filename, wallpaper);
+
+    /* Check whether the target file exists */
+    uri = cc_background_item_get_uri (item);
+    if (uri != NULL) {
+      g_autoptr(GFile) file = NULL;
+
+      file = g_file_new_for_uri (uri);
+      if (g_file_query_exists (file, NULL) == FALSE)
+        continue;
+    }
+
+    g_hash_table_insert (ids, g_strdup (id), g_variant_ref (wallpaper));
+    g_hash_table_insert (xml->wp_hash,
+                         g_strdup (id),
+                         g_object_ref (item));
+    emit_item_changed (xml, signals[ADDED], item, in_thread);
+    retval = TRUE;
+  }
+
+  /* Remove the items that are gone from the file */
+  if (previous_ids != NULL) {
+    GHashTableIter ids_iter;
+    gpointer id;
+
+    g_hash_table_iter_init (&ids_iter, previous_ids);
+    while (g_hash_table_iter_next (&ids_iter, &id, NULL)) {
+      g_autoptr(CcBackgroundItem) item = NULL;
+      g_autofree gchar *item_id = NULL;
+
+      if (g_hash_table_contains (ids, id))
+        continue;
+
+      if (!g_hash_table_steal_extended (xml->wp_hash, id, (gpointer *) &item_id, (gpointer *) &item))
+        continue;
+
+      emit_item_changed (xml, signals[REMOVED], item, in_thread);
+    }
+  }
+
+  g_hash_table_replace (xml->file_ids, g_strdup (filename), g_steal_pointer (&ids));
+
   return retval;
 }
 
@@ -342,10 +776,12 @@ gnome_wp_file_changed (CcBackgroundXml *xml,
   g_autofree gchar *filename = NULL;
 
   switch (event_type) {
-  case G_FILE_MONITOR_EVENT_CHANGED:
+  case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
   case G_FILE_MONITOR_EVENT_CREATED:
+  case G_FILE_MONITOR_EVENT_DELETED:
     filename = g_file_get_path (file);
     cc_background_xml_load_xml_internal (xml, filename, FALSE);
+    save_cache ();
     break;
   default:
     break;
@@ -463,6 +899,7 @@ load_list_thread (GTask *task,
 {
 	CcBackgroundXml *xml = CC_BACKGROUND_XML (source_object);
 	cc_background_xml_load_list (xml, TRUE);
+	save_cache ();
 	g_task_return_boolean (task, TRUE);
 }
 
@@ -484,12 +921,17 @@ gboolean
 cc_background_xml_load_xml (CcBackgroundXml *xml,
 			    const gchar     *filename)
 {
+	gboolean retval;
+
 	g_return_val_if_fail (CC_IS_BACKGROUND_XML (xml), FALSE);
 
 	if (g_file_test (filename, G_FILE_TEST_IS_REGULAR) == FALSE)
 		return FALSE;
 
-	return cc_background_xml_load_xml_internal (xml, filename, FALSE);
+	retval = cc_background_xml_load_xml_internal (xml, filename, FALSE);
+	save_cache ();
+
+	return retval;
 }
 
 static void
@@ -618,8 +1060,9 @@ cc_background_xml_finalize (GObject *object)
         g_slist_free_full (xml->monitors, g_object_unref);
 
 	g_clear_pointer (&xml->wp_hash, g_hash_table_destroy);
-	g_clear_handle_id (&xml->item_added_id, g_source_remove);
-	g_clear_pointer (&xml->item_added_queue, g_async_queue_unref);
+	g_clear_pointer (&xml->file_ids, g_hash_table_destroy);
+	g_clear_handle_id (&xml->item_changed_id, g_source_remove);
+	g_clear_pointer (&xml->item_changed_queue, g_async_queue_unref);
 
         G_OBJECT_CLASS (cc_background_xml_parent_class)->finalize (object);
 }
@@ -638,6 +1081,13 @@ cc_background_xml_class_init (CcBackgroundXmlClass *klass)
 				       NULL, NULL,
 				       g_cclosure_marshal_VOID__OBJECT,
 				       G_TYPE_NONE, 1, CC_TYPE_BACKGROUND_ITEM);
+	signals[REMOVED] = g_signal_new ("removed",
+					 G_OBJECT_CLASS_TYPE (object_class),
+					 G_SIGNAL_RUN_LAST,
+					 0,
+					 NULL, NULL,
+					 g_cclosure_marshal_VOID__OBJECT,
+					 G_TYPE_NONE, 1, CC_TYPE_BACKGROUND_ITEM);
 }
 
 static void
@@ -647,7 +1097,11 @@ cc_background_xml_init (CcBackgroundXml *xml)
                                               g_str_equal,
                                               (GDestroyNotify) g_free,
                                               (GDestroyNotify) g_object_unref);
-	xml->item_added_queue = g_async_queue_new_full ((GDestroyNotify) g_object_unref);
+        xml->file_ids = g_hash_table_new_full (g_str_hash,
+                                               g_str_equal,
+                                               (GDestroyNotify) g_free,
+                                               (GDestroyNotify) g_hash_table_unref);
+	xml->item_changed_queue = g_async_queue_new_full (item_change_free);
 }
 
 CcBackgroundXml *
@@ -214,6 +214,28 @@ panel_changed_cb (CcBluetoothPanel *self,
 		g_warning ("Failed to activate '%s' panel: %s", panel, error->message);
 }
 
+/* The settings widget follows BlueZ on its own, only the killswitch
+ * and adapter state are reflected in the panel itself */
+static void
+cc_bluetooth_panel_suspend (CcPanel *panel)
+{
+	CcBluetoothPanel *self = CC_BLUETOOTH_PANEL (panel);
+
+	g_signal_handlers_block_by_func (self->rfkill, airplane_mode_changed, self);
+	g_signal_handlers_block_by_func (self->settings_widget, adapter_status_changed_cb, self);
+}
+
+static void
+cc_bluetooth_panel_resume (CcPanel *panel)
+{
+	CcBluetoothPanel *self = CC_BLUETOOTH_PANEL (panel);
+
+	g_signal_handlers_unblock_by_func (self->rfkill, airplane_mode_changed, self);
+	g_signal_handlers_unblock_by_func (self->settings_widget, adapter_status_changed_cb, self);
+
+	airplane_mode_changed (self);
+}
+
 static void
 cc_bluetooth_panel_class_init (CcBluetoothPanelClass *klass)
 {
@@ -224,6 +246,8 @@ cc_bluetooth_panel_class_init (CcBluetoothPanelClass *klass)
 	object_class->finalize = cc_bluetooth_panel_finalize;
 
 	panel_class->get_help_uri = cc_bluetooth_panel_get_help_uri;
+	panel_class->suspend = cc_bluetooth_panel_suspend;
+	panel_class->resume = cc_bluetooth_panel_resume;
 
 	gtk_widget_class_set_template_from_resource (widget_class, "/org/gnome/control-center/bluetooth/cc-bluetooth-panel.ui");
 
@@ -139,6 +139,8 @@ set_current_output (CcDisplayPanel   *self,
                     gboolean          force);
 static void
 on_screen_changed (CcDisplayPanel *self);
+static void
+cc_display_panel_up_client_changed (CcDisplayPanel *self);
 
 
 static CcDisplayConfigType
@@ -578,6 +580,43 @@ cc_display_panel_get_help_uri (CcPanel *panel)
   return "help:gnome-help/prefs-display";
 }
 
+/* Monitor and lid changes are not followed while hidden, and the
+ * monitor labels are taken down as they only make sense in this panel.
+ */
+static void
+cc_display_panel_suspend (CcPanel *panel)
+{
+  CcDisplayPanel *self = CC_DISPLAY_PANEL (panel);
+
+  if (self->manager)
+    g_signal_handlers_block_by_func (self->manager, on_screen_changed, self);
+  if (self->up_client)
+    g_signal_handlers_block_by_func (self->up_client, cc_display_panel_up_client_changed, self);
+  if (self->focus_id)
+    g_signal_handler_block (cc_shell_get_toplevel (cc_panel_get_shell (panel)), self->focus_id);
+
+  monitor_labeler_hide (self);
+}
+
+static void
+cc_display_panel_resume (CcPanel *panel)
+{
+  CcDisplayPanel *self = CC_DISPLAY_PANEL (panel);
+
+  if (self->manager)
+    g_signal_handlers_unblock_by_func (self->manager, on_screen_changed, self);
+  if (self->up_client)
+    {
+      g_signal_handlers_unblock_by_func (self->up_client, cc_display_panel_up_client_changed, self);
+      self->lid_is_closed = up_client_get_lid_is_closed (self->up_client);
+    }
+  if (self->focus_id)
+    g_signal_handler_unblock (cc_shell_get_toplevel (cc_panel_get_shell (panel)), self->focus_id);
+
+  /* Also shows the monitor labels again */
+  on_screen_changed (self);
+}
+
 static void
 cc_display_panel_class_init (CcDisplayPanelClass *klass)
 {
@@ -590,6 +629,8 @@ cc_display_panel_class_init (CcDisplayPanelClass *klass)
   g_type_ensure (CC_TYPE_DISPLAY_CUSTOMIZATION);
 
   panel_class->get_help_uri = cc_display_panel_get_help_uri;
+  panel_class->suspend = cc_display_panel_suspend;
+  panel_class->resume = cc_display_panel_resume;
 
   object_class->constructed = cc_display_panel_constructed;
   object_class->dispose = cc_display_panel_dispose;
@@ -1077,6 +1118,8 @@ session_bus_ready (GObject        *source,
                            G_CALLBACK (on_screen_changed),
                            self,
                            G_CONNECT_SWAPPED);
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    g_signal_handlers_block_by_func (self->manager, on_screen_changed, self);
 }
 
 static void
@@ -28,6 +28,7 @@ struct _CcWifiConnectionList
 
   guint          freeze_count;
   gboolean       updating;
+  gboolean       suspended;
 
   gboolean       checkable;
   gboolean       forgettable;
@@ -39,8 +40,17 @@ struct _CcWifiConnectionList
 
   NMConnection  *last_active;
 
+  /* The connections shown in the list, and the row of each of them. The
+   * row is NULL if the connection is hidden because it is unavailable.
+   * Rows are kept across updates; they are only created and removed as
+   * connections and APs come and go. */
   GPtrArray     *connections;
-  GPtrArray     *connections_row;
+  GHashTable    *connection_to_row;
+
+  /* All APs of the device the list is tracking, and the connection rows
+   * each of them was added to. */
+  GHashTable    *aps;
+  GHashTable    *ap_to_rows;
 
   /* AP SSID cache stores the APs SSID used for assigning it to a row.
    * This is necessary to efficiently remove it when its SSID changes.
@@ -55,12 +65,6 @@ struct _CcWifiConnectionList
   GHashTable    *ssid_to_row;
 };
 
-static void on_device_ap_added_cb   (CcWifiConnectionList *self,
-                                     NMAccessPoint        *ap,
-                                     NMDeviceWifi         *device);
-static void on_device_ap_removed_cb (CcWifiConnectionList *self,
-                                     NMAccessPoint        *ap,
-                                     NMDeviceWifi         *device);
 static void on_row_configured_cb    (CcWifiConnectionList *self,
                                      CcWifiConnectionRow  *row);
 static void on_row_forget_cb        (CcWifiConnectionList *self,
@@ -119,6 +123,26 @@ connection_ignored (NMConnection *connection)
   return FALSE;
 }
 
+static NMConnection *
+get_active_connection (CcWifiConnectionList *self)
+{
+  NMActiveConnection *ac;
+
+  ac = nm_device_get_active_connection (NM_DEVICE (self->device));
+  if (!ac)
+    return NULL;
+
+  return NM_CONNECTION (nm_active_connection_get_connection (ac));
+}
+
+/* Whether the connection has a row even if none of the APs is compatible */
+static gboolean
+connection_always_shown (CcWifiConnectionList *self,
+                         NMConnection         *connection)
+{
+  return !self->hide_unavailable || connection == get_active_connection (self);
+}
+
 static CcWifiConnectionRow*
 cc_wifi_connection_list_row_add (CcWifiConnectionList *self,
                                  NMConnection         *connection,
@@ -151,58 +175,408 @@ cc_wifi_connection_list_row_add (CcWifiConnectionList *self,
   return res;
 }
 
+static void
+cc_wifi_connection_list_row_remove (CcWifiConnectionList *self,
+                                    CcWifiConnectionRow  *row)
+{
+  g_signal_emit_by_name (self, "remove-row", row);
+  gtk_list_box_remove (self->listbox, GTK_WIDGET (row));
+}
+
+static CcWifiConnectionRow *
+get_connection_row (CcWifiConnectionList *self,
+                    NMConnection         *connection)
+{
+  CcWifiConnectionRow *row;
+
+  row = g_hash_table_lookup (self->connection_to_row, connection);
+  if (!row)
+    {
+      row = cc_wifi_connection_list_row_add (self, connection, NULL, TRUE);
+      g_hash_table_insert (self->connection_to_row, connection, row);
+    }
+
+  return row;
+}
+
+/* Removes the row of a connection once it has no APs left, unless it is
+ * shown regardless. */
+static void
+maybe_remove_connection_row (CcWifiConnectionList *self,
+                             CcWifiConnectionRow  *row)
+{
+  NMConnection *connection;
+
+  if (cc_wifi_connection_row_get_access_points (row)->len > 0)
+    return;
+
+  connection = cc_wifi_connection_row_get_connection (row);
+  if (connection_always_shown (self, connection))
+    return;
+
+  g_hash_table_insert (self->connection_to_row, connection, NULL);
+  cc_wifi_connection_list_row_remove (self, row);
+}
+
+static GPtrArray *
+get_access_point_connections (CcWifiConnectionList *self,
+                              NMAccessPoint        *ap)
+{
+  GPtrArray *connections;
+  NMConnection *ac_con;
+
+  connections = nm_access_point_filter_connections (ap, self->connections);
+
+  /* If this is the active AP, then add the active connection to the list. This
+   * is a workaround because nm_access_pointer_filter_connections() will not
+   * include it otherwise.
+   * So it seems like the dummy AP entry that NM creates internally is not actually
+   * compatible with the connection that is being activated.
+   */
+  if (ap != nm_device_wifi_get_active_access_point (self->device))
+    return connections;
+
+  ac_con = get_active_connection (self);
+  if (ac_con &&
+      !g_ptr_array_find (connections, ac_con, NULL) &&
+      g_hash_table_contains (self->connection_to_row, ac_con))
+    {
+      g_debug ("Adding active connection to list of valid connections for AP");
+      g_ptr_array_add (connections, g_object_ref (ac_con));
+    }
+
+  return connections;
+}
+
+/* Returns the SSID to group the AP by if it cannot be assigned to a
+ * connection, or NULL if there should be no entry for it. */
+static GBytes *
+get_access_point_ssid (CcWifiConnectionList *self,
+                       NMAccessPoint        *ap)
+{
+  NM80211ApSecurityFlags rsn_flags;
+  GBytes *ap_ssid;
+
+  if (!self->show_aps)
+    return NULL;
+
+  /* Not for hidden APs that don't have an SSID or a hidden OWE transition
+   * network. */
+  ap_ssid = nm_access_point_get_ssid (ap);
+  if (ap_ssid == NULL)
+    return NULL;
+
+  /* Skip OWE-TM network with OWE RSN */
+  rsn_flags = nm_access_point_get_rsn_flags (ap);
+  if (rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_OWE && rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_OWE_TM)
+    return NULL;
+
+  return new_hashable_ssid (ap_ssid);
+}
+
+static void
+remove_access_point_from_ssid_row (CcWifiConnectionList *self,
+                                   NMAccessPoint        *ap)
+{
+  CcWifiConnectionRow *row;
+  g_autoptr(GBytes) ssid = NULL;
+
+  g_hash_table_steal_extended (self->ap_ssid_cache, ap, NULL, (gpointer*) &ssid);
+  if (!ssid)
+    return;
+
+  row = g_hash_table_lookup (self->ssid_to_row, ssid);
+  g_assert (row != NULL);
+
+  if (cc_wifi_connection_row_remove_access_point (row, ap))
+    {
+      g_hash_table_remove (self->ssid_to_row, ssid);
+      cc_wifi_connection_list_row_remove (self, row);
+    }
+  else
+    {
+      gtk_list_box_row_changed (GTK_LIST_BOX_ROW (row));
+    }
+}
+
+static void
+add_access_point_to_ssid_row (CcWifiConnectionList *self,
+                              NMAccessPoint        *ap,
+                              GBytes               *ssid)
+{
+  CcWifiConnectionRow *row;
+
+  g_hash_table_insert (self->ap_ssid_cache, ap, g_bytes_ref (ssid));
+
+  row = g_hash_table_lookup (self->ssid_to_row, ssid);
+  if (!row)
+    {
+      row = cc_wifi_connection_list_row_add (self, NULL, ap, FALSE);
+
+      g_hash_table_insert (self->ssid_to_row, g_bytes_ref (ssid), row);
+    }
+  else
+    {
+      cc_wifi_connection_row_add_access_point (row, ap);
+      gtk_list_box_row_changed (GTK_LIST_BOX_ROW (row));
+    }
+}
+
+/* Moves the AP to the rows it belongs to now, touching only the rows
+ * that gain or lose it. */
+static void
+update_access_point (CcWifiConnectionList *self,
+                     NMAccessPoint        *ap)
+{
+  g_autoptr(GPtrArray) connections = NULL;
+  g_autoptr(GPtrArray) old_rows = NULL;
+  g_autoptr(GPtrArray) new_rows = NULL;
+  g_autoptr(GBytes) ssid = NULL;
+  CcWifiConnectionRow *row;
+  GBytes *old_ssid;
+  guint i;
+
+  connections = get_access_point_connections (self, ap);
+
+  new_rows = g_ptr_array_new ();
+  for (i = 0; i < connections->len; i++)
+    g_ptr_array_add (new_rows, get_connection_row (self, g_ptr_array_index (connections, i)));
+
+  g_hash_table_steal_extended (self->ap_to_rows, ap, NULL, (gpointer*) &old_rows);
+
+  /* Add the AP to the rows that didn't have it before removing it from
+   * the others, so that no row is emptied on the way. */
+  for (i = 0; i < new_rows->len; i++)
+    {
+      row = g_ptr_array_index (new_rows, i);
+      if (old_rows && g_ptr_array_find (old_rows, row, NULL))
+        continue;
+
+      cc_wifi_connection_row_add_access_point (row, ap);
+      gtk_list_box_row_changed (GTK_LIST_BOX_ROW (row));
+    }
+
+  for (i = 0; old_rows && i < old_rows->len; i++)
+    {
+      row = g_ptr_array_index (old_rows, i);
+      if (g_ptr_array_find (new_rows, row, NULL))
+        continue;
+
+      cc_wifi_connection_row_remove_access_point (row, ap);
+      gtk_list_box_row_changed (GTK_LIST_BOX_ROW (row));
+      maybe_remove_connection_row (self, row);
+    }
+
+  /* The AP is not compatible to any known connection, generate an entry for the
+   * SSID or add to existing one. */
+  if (new_rows->len == 0)
+    ssid = get_access_point_ssid (self, ap);
+  else
+    g_hash_table_insert (self->ap_to_rows, ap, g_steal_pointer (&new_rows));
+
+  old_ssid = g_hash_table_lookup (self->ap_ssid_cache, ap);
+  if (ssid && old_ssid && g_bytes_equal (ssid, old_ssid))
+    return;
+
+  remove_access_point_from_ssid_row (self, ap);
+  if (ssid)
+    add_access_point_to_ssid_row (self, ap, ssid);
+}
+
+/* Removes the AP from all rows, keeping the rows of connections that
+ * are shown anyway. */
+static void
+remove_access_point (CcWifiConnectionList *self,
+                     NMAccessPoint        *ap)
+{
+  g_autoptr(GPtrArray) rows = NULL;
+  guint i;
+
+  g_hash_table_steal_extended (self->ap_to_rows, ap, NULL, (gpointer*) &rows);
+  for (i = 0; rows && i < rows->len; i++)
+    {
+      CcWifiConnectionRow *row = g_ptr_array_index (rows, i);
+
+      cc_wifi_connection_row_remove_access_point (row, ap);
+      gtk_list_box_row_changed (GTK_LIST_BOX_ROW (row));
+      maybe_remove_connection_row (self, row);
+    }
+
+  remove_access_point_from_ssid_row (self, ap);
+}
+
+/* The SSID or other settings of a connection may have changed, so the
+ * APs it had and the ones it is compatible with now are reassigned. */
+static void
+on_connection_changed_cb (CcWifiConnectionList *self,
+                          NMConnection         *connection)
+{
+  g_autoptr(GPtrArray) aps = NULL;
+  CcWifiConnectionRow *row;
+  GHashTableIter iter;
+  NMAccessPoint *ap;
+  guint i;
+
+  if (!g_hash_table_contains (self->connection_to_row, connection))
+    return;
+
+  /* Compatible APs go first, so that the row isn't emptied on the way */
+  aps = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, self->aps);
+  while (g_hash_table_iter_next (&iter, (gpointer*) &ap, NULL))
+    {
+      if (nm_access_point_connection_valid (ap, connection))
+        g_ptr_array_add (aps, ap);
+    }
+
+  row = g_hash_table_lookup (self->connection_to_row, connection);
+  if (row)
+    {
+      const GPtrArray *row_aps = cc_wifi_connection_row_get_access_points (row);
+
+      for (i = 0; i < row_aps->len; i++)
+        {
+          ap = g_ptr_array_index (row_aps, i);
+          if (!g_ptr_array_find (aps, ap, NULL))
+            g_ptr_array_add (aps, ap);
+        }
+    }
+
+  for (i = 0; i < aps->len; i++)
+    update_access_point (self, g_ptr_array_index (aps, i));
+
+  row = g_hash_table_lookup (self->connection_to_row, connection);
+  if (row)
+    {
+      cc_wifi_connection_row_update (row);
+      maybe_remove_connection_row (self, row);
+    }
+  else if (connection_always_shown (self, connection))
+    {
+      get_connection_row (self, connection);
+    }
+}
+
+static void
+add_connection (CcWifiConnectionList *self,
+                NMConnection         *connection)
+{
+  g_autoptr(GPtrArray) aps = NULL;
+  GHashTableIter iter;
+  NMAccessPoint *ap;
+  guint i;
+
+  g_ptr_array_add (self->connections, g_object_ref (connection));
+  g_hash_table_insert (self->connection_to_row, connection, NULL);
+  g_signal_connect_object (connection, "changed",
+                           G_CALLBACK (on_connection_changed_cb),
+                           self, G_CONNECT_SWAPPED);
+  if (connection_always_shown (self, connection))
+    get_connection_row (self, connection);
+
+  /* Move the APs of the connection over to its row */
+  aps = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, self->aps);
+  while (g_hash_table_iter_next (&iter, (gpointer*) &ap, NULL))
+    {
+      if (nm_access_point_connection_valid (ap, connection))
+        g_ptr_array_add (aps, ap);
+    }
+
+  for (i = 0; i < aps->len; i++)
+    update_access_point (self, g_ptr_array_index (aps, i));
+}
+
+static void
+remove_connection (CcWifiConnectionList *self,
+                   NMConnection         *connection)
+{
+  g_autoptr(GPtrArray) aps = NULL;
+  CcWifiConnectionRow *row;
+  guint i;
+
+  g_signal_handlers_disconnect_by_func (connection, on_connection_changed_cb, self);
+
+  row = g_hash_table_lookup (self->connection_to_row, connection);
+  g_hash_table_remove (self->connection_to_row, connection);
+
+  if (row)
+    {
+      const GPtrArray *row_aps = cc_wifi_connection_row_get_access_points (row);
+
+      aps = g_ptr_array_new ();
+      for (i = 0; i < row_aps->len; i++)
+        {
+          NMAccessPoint *ap = g_ptr_array_index (row_aps, i);
+          GPtrArray *rows = g_hash_table_lookup (self->ap_to_rows, ap);
+
+          g_ptr_array_remove_fast (rows, row);
+          if (rows->len == 0)
+            g_hash_table_remove (self->ap_to_rows, ap);
+          g_ptr_array_add (aps, ap);
+        }
+
+      cc_wifi_connection_list_row_remove (self, row);
+    }
+
+  g_ptr_array_remove (self->connections, connection);
+
+  /* The APs of the connection may now belong to other rows */
+  for (i = 0; aps && i < aps->len; i++)
+    update_access_point (self, g_ptr_array_index (aps, i));
+}
+
 static void
 clear_widget (CcWifiConnectionList *self)
 {
-  const GPtrArray *aps;
   GHashTableIter iter;
   CcWifiConnectionRow *row;
-  gint i;
+  NMAccessPoint *ap;
+  guint i;
 
-  /* Clear everything; disconnect all AP signals first */
-  aps = nm_device_wifi_get_access_points (self->device);
-  for (i = 0; i < aps->len; i++)
-    g_signal_handlers_disconnect_by_data (g_ptr_array_index (aps, i), self);
+  /* Clear everything; disconnect all AP and connection signals first */
+  g_hash_table_iter_init (&iter, self->aps);
+  while (g_hash_table_iter_next (&iter, (gpointer*) &ap, NULL))
+    g_signal_handlers_disconnect_by_data (ap, self);
+
+  for (i = 0; i < self->connections->len; i++)
+    g_signal_handlers_disconnect_by_func (g_ptr_array_index (self->connections, i), on_connection_changed_cb, self);
 
   /* Remove all AP only rows */
   g_hash_table_iter_init (&iter, self->ssid_to_row);
   while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &row))
     {
       g_hash_table_iter_remove (&iter);
-      g_signal_emit_by_name (self, "remove-row", row);
-      gtk_list_box_remove (self->listbox, GTK_WIDGET (row));
+      cc_wifi_connection_list_row_remove (self, row);
     }
 
   /* Remove all connection rows */
-  for (i = 0; i < self->connections_row->len; i++)
+  g_hash_table_iter_init (&iter, self->connection_to_row);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &row))
     {
-      if (!g_ptr_array_index (self->connections_row, i))
-        continue;
-
-      row = g_ptr_array_index (self->connections_row, i);
-      g_ptr_array_index (self->connections_row, i) = NULL;
-      g_signal_emit_by_name (self, "remove-row", row);
-      gtk_list_box_remove (self->listbox, GTK_WIDGET (row));
+      g_hash_table_iter_remove (&iter);
+      if (row)
+        cc_wifi_connection_list_row_remove (self, row);
     }
 
   /* Reset the internal state */
-  g_ptr_array_set_size (self->connections, 0);
-  g_ptr_array_set_size (self->connections_row, 0);
-  g_hash_table_remove_all (self->ssid_to_row);
+  g_hash_table_remove_all (self->ap_to_rows);
   g_hash_table_remove_all (self->ap_ssid_cache);
+  g_hash_table_remove_all (self->aps);
+  g_ptr_array_set_size (self->connections, 0);
 }
 
 static void
 update_connections (CcWifiConnectionList *self)
 {
-  const GPtrArray *aps;
   const GPtrArray *acs_client;
   g_autoptr(GPtrArray) acs = NULL;
-  NMActiveConnection *ac;
-  NMConnection *ac_con = NULL;
+  g_autoptr(GHashTable) acs_set = NULL;
+  NMAccessPoint *active_ap;
+  NMConnection *ac_con;
   gint i;
 
-  /* We don't want full UI rebuilds during some UI interactions, so allow freezing the list. */
+  /* We don't want any UI updates during some UI interactions, so allow freezing the list. */
   if (self->freeze_count > 0)
     return;
 
@@ -211,47 +585,64 @@ update_connections (CcWifiConnectionList *self)
     return;
   self->updating = TRUE;
 
-  clear_widget (self);
-
-  /* Copy the new connections; also create a row if we show unavailable
-   * connections */
+  /* Collect the connections to show */
   acs_client = nm_client_get_connections (self->client);
 
   acs = g_ptr_array_new_full (acs_client->len + 1, NULL);
   for (i = 0; i < acs_client->len; i++)
     g_ptr_array_add (acs, g_ptr_array_index (acs_client, i));
 
-  ac = nm_device_get_active_connection (NM_DEVICE (self->device));
-  if (ac)
-    ac_con = NM_CONNECTION (nm_active_connection_get_connection (ac));
-
+  ac_con = get_active_connection (self);
   if (ac_con && !g_ptr_array_find (acs, ac_con, NULL))
     {
       g_debug ("Adding remote connection for active connection");
-      g_ptr_array_add (acs, g_object_ref (ac_con));
+      g_ptr_array_add (acs, ac_con);
     }
 
+  acs_set = g_hash_table_new (g_direct_hash, g_direct_equal);
   for (i = 0; i < acs->len; i++)
     {
-      NMConnection *con;
+      if (!connection_ignored (g_ptr_array_index (acs, i)))
+        g_hash_table_add (acs_set, g_ptr_array_index (acs, i));
+    }
 
-      con = g_ptr_array_index (acs, i);
-      if (connection_ignored (con))
-        continue;
+  /* Drop the rows of connections that are gone */
+  for (i = self->connections->len; i > 0; i--)
+    {
+      NMConnection *con = g_ptr_array_index (self->connections, i - 1);
 
-      g_ptr_array_add (self->connections, g_object_ref (con));
-      if (self->hide_unavailable && con != ac_con)
-        g_ptr_array_add (self->connections_row, NULL);
-      else
-        g_ptr_array_add (self->connections_row,
-                         cc_wifi_connection_list_row_add (self, con,
-                         NULL, TRUE));
+      if (!g_hash_table_contains (acs_set, con))
+        remove_connection (self, con);
     }
 
-  /* Coldplug all known APs again */
-  aps = nm_device_wifi_get_access_points (self->device);
-  for (i = 0; i < aps->len; i++)
-    on_device_ap_added_cb (self, g_ptr_array_index (aps, i), self->device);
+  /* Add the new ones, in the order of the client */
+  for (i = 0; i < acs->len; i++)
+    {
+      NMConnection *con = g_ptr_array_index (acs, i);
+
+      if (g_hash_table_contains (acs_set, con) &&
+          !g_hash_table_contains (self->connection_to_row, con))
+        add_connection (self, con);
+    }
+
+  /* The active connection may have changed, which decides whether
+   * connections without APs have a row */
+  for (i = 0; i < self->connections->len; i++)
+    {
+      NMConnection *con = g_ptr_array_index (self->connections, i);
+      CcWifiConnectionRow *row;
+
+      row = g_hash_table_lookup (self->connection_to_row, con);
+      if (row)
+        maybe_remove_connection_row (self, row);
+      else if (connection_always_shown (self, con))
+        get_connection_row (self, con);
+    }
+
+  /* And the active AP is always grouped with the active connection */
+  active_ap = nm_device_wifi_get_active_access_point (self->device);
+  if (active_ap && g_hash_table_contains (self->aps, active_ap))
+    update_access_point (self, active_ap);
 
   self->updating = FALSE;
 }
@@ -280,36 +671,27 @@ on_access_point_property_changed (CcWifiConnectionList *self,
                                   NMAccessPoint        *ap)
 {
   CcWifiConnectionRow *row;
+  GPtrArray *rows;
   GBytes *ssid;
-  gboolean has_connection = FALSE;
-  gint i;
+  guint i;
 
-  /* If the SSID changed then the AP needs to be added/removed from rows.
-   * Do this by simulating an AP addition/removal.  */
+  /* If the SSID changed then the AP needs to be moved to other rows. */
   if (g_str_equal (pspec->name, NM_ACCESS_POINT_SSID))
     {
-      g_debug ("Simulating add/remove for SSID change");
-      on_device_ap_removed_cb (self, ap, self->device);
-      on_device_ap_added_cb (self, ap, self->device);
+      g_debug ("Updating rows for SSID change");
+      update_access_point (self, ap);
       return;
     }
 
-  /* Otherwise, find all rows that contain the AP and update it. Do this by
-   * first searching all rows with connections, and then looking it up in the
-   * SSID rows if not found. */
-  for (i = 0; i < self->connections_row->len; i++)
+  /* Otherwise, update the rows that contain the AP. */
+  rows = g_hash_table_lookup (self->ap_to_rows, ap);
+  if (rows)
     {
-      row = g_ptr_array_index (self->connections_row, i);
-      if (row && cc_wifi_connection_row_has_access_point (row, ap))
-        {
-          cc_wifi_connection_row_update (row);
-          has_connection = TRUE;
-        }
+      for (i = 0; i < rows->len; i++)
+        cc_wifi_connection_row_update (g_ptr_array_index (rows, i));
+      return;
     }
 
-  if (!self->show_aps || has_connection)
-    return;
-
   ssid = g_hash_table_lookup (self->ap_ssid_cache, ap);
   if (!ssid)
     return;
@@ -326,95 +708,15 @@ on_device_ap_added_cb (CcWifiConnectionList *self,
                        NMAccessPoint        *ap,
                        NMDeviceWifi         *device)
 {
-  g_autoptr(GPtrArray) connections = NULL;
-  NM80211ApSecurityFlags rsn_flags;
-  CcWifiConnectionRow *row;
-  GBytes *ap_ssid;
-  g_autoptr(GBytes) ssid = NULL;
-  guint i, j;
+  if (g_hash_table_contains (self->aps, ap))
+    return;
 
+  g_hash_table_add (self->aps, g_object_ref (ap));
   g_signal_connect_object (ap, "notify",
                            G_CALLBACK (on_access_point_property_changed),
                            self, G_CONNECT_SWAPPED);
 
-  connections = nm_access_point_filter_connections (ap, self->connections);
-
-  /* If this is the active AP, then add the active connection to the list. This
-   * is a workaround because nm_access_pointer_filter_connections() will not
-   * include it otherwise.
-   * So it seems like the dummy AP entry that NM creates internally is not actually
-   * compatible with the connection that is being activated.
-   */
-  if (ap == nm_device_wifi_get_active_access_point (device))
-    {
-      NMActiveConnection *ac;
-      NMConnection *ac_con;
-
-      ac = nm_device_get_active_connection (NM_DEVICE (self->device));
-
-      if (ac)
-        {
-          guint idx;
-
-          ac_con = NM_CONNECTION (nm_active_connection_get_connection (ac));
-
-          if (!g_ptr_array_find (connections, ac_con, NULL) &&
-              g_ptr_array_find (self->connections, ac_con, &idx))
-            {
-              g_debug ("Adding active connection to list of valid connections for AP");
-              g_ptr_array_add (connections, g_object_ref (ac_con));
-            }
-        }
-    }
-
-  /* Add the AP to all connection related rows, creating the row if neccessary. */
-  for (i = 0; i < connections->len; i++)
-    {
-      gboolean found = g_ptr_array_find (self->connections, g_ptr_array_index (connections, i), &j);
-
-      g_assert (found);
-
-      row = g_ptr_array_index (self->connections_row, j);
-      if (!row)
-        row = cc_wifi_connection_list_row_add (self, g_ptr_array_index (connections, i), NULL, TRUE);
-      cc_wifi_connection_row_add_access_point (row, ap);
-      g_ptr_array_index (self->connections_row, j) = row;
-    }
-
-  if (connections->len > 0)
-    return;
-
-  if (!self->show_aps)
-    return;
-
-  /* The AP is not compatible to any known connection, generate an entry for the
-   * SSID or add to existing one. However, not for hidden APs that don't have an SSID
-   * or a hidden OWE transition network.
-   */
-  ap_ssid = nm_access_point_get_ssid (ap);
-  if (ap_ssid == NULL)
-    return;
-
-  /* Skip OWE-TM network with OWE RSN */
-  rsn_flags = nm_access_point_get_rsn_flags (ap);
-  if (rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_OWE && rsn_flags & NM_802_11_AP_SEC_KEY_MGMT_OWE_TM)
-    return;
-
-  ssid = new_hashable_ssid (ap_ssid);
-
-  g_hash_table_insert (self->ap_ssid_cache, ap, g_bytes_ref (ssid));
-
-  row = g_hash_table_lookup (self->ssid_to_row, ssid);
-  if (!row)
-    {
-      row = cc_wifi_connection_list_row_add (self, NULL, ap, FALSE);
-
-      g_hash_table_insert (self->ssid_to_row, g_bytes_ref (ssid), row);
-    }
-  else
-    {
-      cc_wifi_connection_row_add_access_point (row, ap);
-    }
+  update_access_point (self, ap);
 }
 
 static void
@@ -422,50 +724,13 @@ on_device_ap_removed_cb (CcWifiConnectionList *self,
                          NMAccessPoint        *ap,
                          NMDeviceWifi         *device)
 {
-  CcWifiConnectionRow *row;
-  g_autoptr(GBytes) ssid = NULL;
-  gboolean found = FALSE;
-  gint i;
-
-  g_signal_handlers_disconnect_by_data (ap, self);
-
-  /* Find any connection related row with the AP and remove the AP from it. Remove the
-   * row if it was the last AP and we are hiding unavailable connections. */
-  for (i = 0; i < self->connections_row->len; i++)
-    {
-      row = g_ptr_array_index (self->connections_row, i);
-      if (row && cc_wifi_connection_row_remove_access_point (row, ap))
-        {
-          found = TRUE;
-
-          if (self->hide_unavailable)
-            {
-              g_ptr_array_index (self->connections_row, i) = NULL;
-              g_signal_emit_by_name (self, "remove-row", row);
-              gtk_list_box_remove (self->listbox, GTK_WIDGET (row));
-            }
-        }
-    }
-
-  if (found || !self->show_aps)
-    return;
-
-  /* If the AP was inserted into a row without a connection, then we will get an
-   * SSID for it here. */
-  g_hash_table_steal_extended (self->ap_ssid_cache, ap, NULL, (gpointer*) &ssid);
-  if (!ssid)
+  if (!g_hash_table_contains (self->aps, ap))
     return;
 
-  /* And we can update the row (possibly removing it) */
-  row = g_hash_table_lookup (self->ssid_to_row, ssid);
-  g_assert (row != NULL);
+  g_signal_handlers_disconnect_by_data (ap, self);
+  remove_access_point (self, ap);
 
-  if (cc_wifi_connection_row_remove_access_point (row, ap))
-    {
-      g_hash_table_remove (self->ssid_to_row, ssid);
-      g_signal_emit_by_name (self, "remove-row", row);
-      gtk_list_box_remove (self->listbox, GTK_WIDGET (row));
-    }
+  g_hash_table_remove (self->aps, ap);
 }
 
 static void
@@ -479,9 +744,6 @@ on_client_connection_added_cb (CcWifiConnectionList *self,
   if (connection_ignored (connection))
     return;
 
-  /* The approach we take to handle connection changes is to do a full rebuild.
-   * It happens seldom enough to make this feasible.
-   */
   update_connections (self);
 }
 
@@ -490,12 +752,9 @@ on_client_connection_removed_cb (CcWifiConnectionList *self,
                                  NMConnection         *connection,
                                  NMClient             *client)
 {
-  if (!g_ptr_array_find (self->connections, connection, NULL))
+  if (!g_hash_table_contains (self->connection_to_row, connection))
     return;
 
-  /* The approach we take to handle connection changes is to do a full rebuild.
-   * It happens seldom enough to make this feasible.
-   */
   update_connections (self);
 }
 
@@ -504,24 +763,19 @@ on_device_state_changed_cb (CcWifiConnectionList *self,
                             GParamSpec           *pspec,
                             NMDeviceWifi         *device)
 {
-  NMActiveConnection *ac;
-  NMConnection *connection = NULL;
-  guint idx;
+  NMConnection *connection;
+  CcWifiConnectionRow *row;
 
-  ac = nm_device_get_active_connection (NM_DEVICE (self->device));
-  if (ac)
-    connection = NM_CONNECTION (nm_active_connection_get_connection (ac));
+  connection = get_active_connection (self);
 
   /* Just update the corresponding row if the AC is still the same. */
-  if (self->last_active == connection &&
-      g_ptr_array_find (self->connections, connection, &idx) &&
-      g_ptr_array_index (self->connections_row, idx))
+  row = connection ? g_hash_table_lookup (self->connection_to_row, connection) : NULL;
+  if (self->last_active == connection && row)
     {
-      cc_wifi_connection_row_update (g_ptr_array_index (self->connections_row, idx));
+      cc_wifi_connection_row_update (row);
       return;
     }
 
-  /* Give up and do a full update. */
   update_connections (self);
   self->last_active = connection;
 }
@@ -533,16 +787,14 @@ on_device_active_ap_changed_cb (CcWifiConnectionList *self,
 {
   NMAccessPoint *ap;
   /* We need to make sure the active AP is grouped with the active connection.
-   * Do so by simply removing and adding it.
    *
    * This is necessary because the AP is added before this property
    * is updated. */
   ap = nm_device_wifi_get_active_access_point (self->device);
-  if (ap)
+  if (ap && g_hash_table_contains (self->aps, ap))
     {
-      g_debug ("Simulating add/remove for active AP change");
-      on_device_ap_removed_cb (self, ap, self->device);
-      on_device_ap_added_cb (self, ap, self->device);
+      g_debug ("Updating rows for active AP change");
+      update_access_point (self, ap);
     }
 }
 
@@ -570,7 +822,9 @@ cc_wifi_connection_list_finalize (GObject *object)
   g_clear_object (&self->device);
 
   g_clear_pointer (&self->connections, g_ptr_array_unref);
-  g_clear_pointer (&self->connections_row, g_ptr_array_unref);
+  g_clear_pointer (&self->connection_to_row, g_hash_table_unref);
+  g_clear_pointer (&self->aps, g_hash_table_unref);
+  g_clear_pointer (&self->ap_to_rows, g_hash_table_unref);
   g_clear_pointer (&self->ssid_to_row, g_hash_table_unref);
   g_clear_pointer (&self->ap_ssid_cache, g_hash_table_unref);
 
@@ -581,6 +835,8 @@ static void
 cc_wifi_connection_list_constructed (GObject *object)
 {
   CcWifiConnectionList *self = (CcWifiConnectionList *)object;
+  const GPtrArray *aps;
+  guint i;
 
   G_OBJECT_CLASS (cc_wifi_connection_list_parent_class)->constructed (object);
 
@@ -610,12 +866,13 @@ cc_wifi_connection_list_constructed (GObject *object)
   g_signal_connect_object (self->device, "notify::active-access-point",
                            G_CALLBACK (on_device_active_ap_changed_cb),
                            self, G_CONNECT_SWAPPED);
+
+  /* Populate the connections first, then coldplug all known APs */
   on_device_state_changed_cb (self, NULL, self->device);
 
-  /* Simulate a change notification on the available connections.
-   * This uses the implementation detail that the list is rebuild
-   * completely in this case. */
-  update_connections (self);
+  aps = nm_device_wifi_get_access_points (self->device);
+  for (i = 0; i < aps->len; i++)
+    on_device_ap_added_cb (self, g_ptr_array_index (aps, i), self->device);
 }
 
 static void
@@ -786,7 +1043,11 @@ cc_wifi_connection_list_init (CcWifiConnectionList *self)
   self->show_aps = TRUE;
 
   self->connections = g_ptr_array_new_with_free_func (g_object_unref);
-  self->connections_row = g_ptr_array_new ();
+  self->connection_to_row = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->aps = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                     g_object_unref, NULL);
+  self->ap_to_rows = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, (GDestroyNotify) g_ptr_array_unref);
   self->ssid_to_row = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
                                              (GDestroyNotify) g_bytes_unref, NULL);
   self->ap_ssid_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal,
@@ -854,6 +1115,135 @@ cc_wifi_connection_list_is_empty (CcWifiConnectionList *self)
   return self->connections->len == 0;
 }
 
+/* Blocks or unblocks all handlers the list has on the client, the device,
+ * the APs and the connections. */
+static void
+block_handlers (CcWifiConnectionList *self,
+                gboolean              block)
+{
+  GHashTableIter iter;
+  NMAccessPoint *ap;
+  guint i;
+
+  if (block)
+    {
+      g_signal_handlers_block_matched (self->client, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+      g_signal_handlers_block_matched (self->device, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+    }
+  else
+    {
+      g_signal_handlers_unblock_matched (self->client, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+      g_signal_handlers_unblock_matched (self->device, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+    }
+
+  g_hash_table_iter_init (&iter, self->aps);
+  while (g_hash_table_iter_next (&iter, (gpointer*) &ap, NULL))
+    {
+      if (block)
+        g_signal_handlers_block_matched (ap, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+      else
+        g_signal_handlers_unblock_matched (ap, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+    }
+
+  for (i = 0; i < self->connections->len; i++)
+    {
+      NMConnection *con = g_ptr_array_index (self->connections, i);
+
+      if (block)
+        g_signal_handlers_block_by_func (con, on_connection_changed_cb, self);
+      else
+        g_signal_handlers_unblock_by_func (con, on_connection_changed_cb, self);
+    }
+}
+
+/**
+ * cc_wifi_connection_list_suspend:
+ * @self: a #CcWifiConnectionList
+ *
+ * Stops following NetworkManager until cc_wifi_connection_list_resume()
+ * is called. Used while the panel showing the list is hidden.
+ */
+void
+cc_wifi_connection_list_suspend (CcWifiConnectionList *self)
+{
+  g_return_if_fail (CC_IS_WIFI_CONNECTION_LIST (self));
+
+  if (self->suspended)
+    return;
+
+  self->suspended = TRUE;
+  block_handlers (self, TRUE);
+}
+
+/**
+ * cc_wifi_connection_list_resume:
+ * @self: a #CcWifiConnectionList
+ *
+ * Follows NetworkManager again, and brings the connections and APs of
+ * the list up to date with what changed while it was suspended.
+ */
+void
+cc_wifi_connection_list_resume (CcWifiConnectionList *self)
+{
+  g_autoptr(GPtrArray) connections = NULL;
+  g_autoptr(GPtrArray) gone = NULL;
+  g_autoptr(GPtrArray) known = NULL;
+  const GPtrArray *aps;
+  GHashTableIter iter;
+  CcWifiConnectionRow *row;
+  NMAccessPoint *ap;
+  guint i;
+
+  g_return_if_fail (CC_IS_WIFI_CONNECTION_LIST (self));
+
+  if (!self->suspended)
+    return;
+
+  self->suspended = FALSE;
+  block_handlers (self, FALSE);
+
+  /* Connections that came, went or changed */
+  self->last_active = NULL;
+  on_device_state_changed_cb (self, NULL, self->device);
+
+  connections = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < self->connections->len; i++)
+    g_ptr_array_add (connections, g_object_ref (g_ptr_array_index (self->connections, i)));
+
+  for (i = 0; i < connections->len; i++)
+    on_connection_changed_cb (self, g_ptr_array_index (connections, i));
+
+  /* APs that went, then the ones that may have moved, then new ones */
+  aps = nm_device_wifi_get_access_points (self->device);
+
+  gone = g_ptr_array_new_with_free_func (g_object_unref);
+  known = g_ptr_array_new_with_free_func (g_object_unref);
+  g_hash_table_iter_init (&iter, self->aps);
+  while (g_hash_table_iter_next (&iter, (gpointer*) &ap, NULL))
+    g_ptr_array_add (g_ptr_array_find ((GPtrArray *) aps, ap, NULL) ? known : gone, g_object_ref (ap));
+
+  for (i = 0; i < gone->len; i++)
+    on_device_ap_removed_cb (self, g_ptr_array_index (gone, i), self->device);
+
+  for (i = 0; i < known->len; i++)
+    update_access_point (self, g_ptr_array_index (known, i));
+
+  for (i = 0; i < aps->len; i++)
+    on_device_ap_added_cb (self, g_ptr_array_index (aps, i), self->device);
+
+  /* Strength, security and state of the rows that are left */
+  g_hash_table_iter_init (&iter, self->connection_to_row);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &row))
+    {
+      if (row)
+        cc_wifi_connection_row_update (row);
+    }
+
+  g_hash_table_iter_init (&iter, self->ssid_to_row);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &row))
+    cc_wifi_connection_row_update (row);
+}
+
 void
 cc_wifi_connection_list_set_placeholder_text (CcWifiConnectionList *self,
                                               const gchar          *placeholder_text)
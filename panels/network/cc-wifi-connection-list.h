@@ -37,6 +37,9 @@ CcWifiConnectionList *cc_wifi_connection_list_new (NMClient     *client,
 void                  cc_wifi_connection_list_freeze (CcWifiConnectionList  *list);
 void                  cc_wifi_connection_list_thaw   (CcWifiConnectionList  *list);
 
+void                  cc_wifi_connection_list_suspend (CcWifiConnectionList *self);
+void                  cc_wifi_connection_list_resume  (CcWifiConnectionList *self);
+
 GtkListBox           *cc_wifi_connection_list_get_list_box (CcWifiConnectionList *self);
 
 gboolean              cc_wifi_connection_list_is_empty (CcWifiConnectionList *self);
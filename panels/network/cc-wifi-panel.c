@@ -123,6 +123,52 @@ update_panel_visibility (NMClient *client)
   g_debug ("Wi-Fi panel visible: %s", visible ? "yes" : "no");
 }
 
+static void
+monitor_wifi_devices (NMClient *client)
+{
+  g_signal_connect (client, "device-added", G_CALLBACK (update_panel_visibility), NULL);
+  g_signal_connect (client, "device-removed", G_CALLBACK (update_panel_visibility), NULL);
+
+  update_panel_visibility (client);
+}
+
+static void
+nm_client_ready_cb (GObject      *source_object,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  g_autoptr(NMClient) client = NULL;
+  g_autoptr(GError) error = NULL;
+
+  client = nm_client_new_finish (result, &error);
+
+  if (!client)
+    {
+      CcApplication *application;
+
+      g_warning ("Error connecting to NetworkManager: %s", error->message);
+
+      application = CC_APPLICATION (g_application_get_default ());
+      cc_shell_model_set_panel_visibility (cc_application_get_model (application),
+                                           "wifi",
+                                           CC_PANEL_VISIBLE_IN_SEARCH);
+      return;
+    }
+
+  /* A panel may have stored its own client in the meantime */
+  if (cc_object_storage_has_object (CC_OBJECT_NMCLIENT))
+    {
+      g_clear_object (&client);
+      client = cc_object_storage_get_object (CC_OBJECT_NMCLIENT);
+    }
+  else
+    {
+      cc_object_storage_add_object (CC_OBJECT_NMCLIENT, client);
+    }
+
+  monitor_wifi_devices (client);
+}
+
 void
 cc_wifi_panel_static_init_func (void)
 {
@@ -130,21 +176,19 @@ cc_wifi_panel_static_init_func (void)
 
   g_debug ("Monitoring NetworkManager for Wi-Fi devices");
 
-  /* Create and store a NMClient instance if it doesn't exist yet */
+  /* Create and store a NMClient instance if it doesn't exist yet, without
+   * blocking on NetworkManager.
+   */
   if (!cc_object_storage_has_object (CC_OBJECT_NMCLIENT))
     {
-      g_autoptr(NMClient) new_client = nm_client_new (NULL, NULL);
-      cc_object_storage_add_object (CC_OBJECT_NMCLIENT, new_client);
+      nm_client_new_async (NULL, nm_client_ready_cb, NULL);
+      return;
     }
 
   client = cc_object_storage_get_object (CC_OBJECT_NMCLIENT);
 
   /* Update the panel visibility and monitor for changes */
-
-  g_signal_connect (client, "device-added", G_CALLBACK (update_panel_visibility), NULL);
-  g_signal_connect (client, "device-removed", G_CALLBACK (update_panel_visibility), NULL);
-
-  update_panel_visibility (client);
+  monitor_wifi_devices (client);
 }
 
 /* Auxiliary methods */
@@ -236,6 +280,17 @@ wifi_panel_update_qr_image_cb (CcWifiPanel *self)
   gtk_widget_set_visible (GTK_WIDGET (self->spinner), hotspot == NULL);
 }
 
+/* The "ap0" and "p2p0" interfaces don't get a page of their own */
+static gboolean
+wifi_device_is_ignored (NMDevice *device)
+{
+  const char *iface;
+
+  iface = nm_device_get_iface (device);
+
+  return g_strcmp0 (iface, "ap0") == 0 || g_strcmp0 (iface, "p2p0") == 0;
+}
+
 static void
 add_wifi_device (CcWifiPanel *self,
                  NMDevice    *device)
@@ -246,8 +301,7 @@ add_wifi_device (CcWifiPanel *self,
 
   iface = nm_device_get_iface(device);
 
-  /* Check if the interface is "ap0" or "p2p0" and ignore it */
-  if (g_strcmp0 (iface, "ap0") == 0 || g_strcmp0 (iface, "p2p0") == 0) {
+  if (wifi_device_is_ignored (device)) {
     g_debug ("Ignoring device with interface: %s", iface);
     g_signal_connect_object (device, "state-changed",
                              G_CALLBACK (wifi_panel_update_qr_image_cb),
@@ -777,6 +831,9 @@ rfkill_proxy_acquired_cb (GObject      *source_object,
                            self,
                            G_CONNECT_SWAPPED);
 
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    g_signal_handlers_block_by_func (proxy, on_rfkill_proxy_properties_changed_cb, self);
+
   sync_airplane_mode_switch (self);
 }
 
@@ -844,6 +901,124 @@ cc_wifi_panel_get_help_uri (CcPanel *panel)
   return "help:gnome-help/net-wireless";
 }
 
+/* Catches up with the devices that came, went or changed their managed
+ * state while the panel was suspended. */
+static void
+sync_wifi_devices (CcWifiPanel *self)
+{
+  g_autoptr(GPtrArray) gone = NULL;
+  const GPtrArray *devices;
+  guint i;
+
+  devices = nm_client_get_devices (self->client);
+
+  gone = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < self->devices->len; i++)
+    {
+      NMDevice *device = net_device_wifi_get_device (g_ptr_array_index (self->devices, i));
+
+      if (!g_ptr_array_find ((GPtrArray *) devices, device, NULL) ||
+          !nm_device_get_managed (device))
+        g_ptr_array_add (gone, g_object_ref (device));
+    }
+
+  for (i = 0; i < gone->len; i++)
+    {
+      NMDevice *device = g_ptr_array_index (gone, i);
+
+      g_signal_handlers_disconnect_by_func (device,
+                                            G_CALLBACK (device_state_changed_cb),
+                                            self);
+      remove_wifi_device (self, device);
+    }
+
+  for (i = 0; i < devices->len; i++)
+    {
+      NMDevice *device = g_ptr_array_index (devices, i);
+
+      if (!NM_IS_DEVICE_WIFI (device))
+        continue;
+
+      if (wifi_device_is_ignored (device))
+        {
+          if (!g_signal_handler_find (device, G_SIGNAL_MATCH_FUNC | G_SIGNAL_MATCH_DATA,
+                                      0, 0, NULL, (gpointer) wifi_panel_update_qr_image_cb, self))
+            g_signal_connect_object (device, "state-changed",
+                                     G_CALLBACK (wifi_panel_update_qr_image_cb),
+                                     self,
+                                     G_CONNECT_SWAPPED);
+          continue;
+        }
+
+      if (!g_signal_handler_find (device, G_SIGNAL_MATCH_FUNC | G_SIGNAL_MATCH_DATA,
+                                  0, 0, NULL, (gpointer) device_state_changed_cb, self))
+        g_signal_connect_object (device,
+                                 "notify::state",
+                                 G_CALLBACK (device_state_changed_cb),
+                                 self,
+                                 G_CONNECT_SWAPPED);
+
+      device_state_changed_cb (self, NULL, device);
+    }
+}
+
+static void
+cc_wifi_panel_suspend (CcPanel *panel)
+{
+  CcWifiPanel *self = CC_WIFI_PANEL (panel);
+  const GPtrArray *devices;
+  guint i;
+
+  g_signal_handlers_block_by_func (self->client, device_added_cb, self);
+  g_signal_handlers_block_by_func (self->client, device_removed_cb, self);
+  g_signal_handlers_block_by_func (self->client, wireless_enabled_cb, self);
+
+  if (self->rfkill_proxy)
+    g_signal_handlers_block_by_func (self->rfkill_proxy, on_rfkill_proxy_properties_changed_cb, self);
+
+  /* The state and QR code handlers on the devices */
+  devices = nm_client_get_devices (self->client);
+  for (i = 0; i < devices->len; i++)
+    g_signal_handlers_block_matched (g_ptr_array_index (devices, i),
+                                     G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+
+  for (i = 0; i < self->devices->len; i++)
+    net_device_wifi_suspend (g_ptr_array_index (self->devices, i));
+}
+
+static void
+cc_wifi_panel_resume (CcPanel *panel)
+{
+  CcWifiPanel *self = CC_WIFI_PANEL (panel);
+  const GPtrArray *devices;
+  guint i;
+
+  g_signal_handlers_unblock_by_func (self->client, device_added_cb, self);
+  g_signal_handlers_unblock_by_func (self->client, device_removed_cb, self);
+  g_signal_handlers_unblock_by_func (self->client, wireless_enabled_cb, self);
+
+  if (self->rfkill_proxy)
+    g_signal_handlers_unblock_by_func (self->rfkill_proxy, on_rfkill_proxy_properties_changed_cb, self);
+
+  /* Devices added since were not seen, so they have nothing blocked */
+  devices = nm_client_get_devices (self->client);
+  for (i = 0; i < devices->len; i++)
+    g_signal_handlers_unblock_matched (g_ptr_array_index (devices, i),
+                                       G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+
+  sync_wifi_devices (self);
+  check_main_stack_page (self);
+
+  for (i = 0; i < self->devices->len; i++)
+    net_device_wifi_resume (g_ptr_array_index (self->devices, i));
+
+  if (self->rfkill_proxy)
+    sync_airplane_mode_switch (self);
+
+  if (self->devices->len > 0)
+    wifi_panel_update_qr_image_cb (self);
+}
+
 static void
 cc_wifi_panel_finalize (GObject *object)
 {
@@ -934,6 +1109,8 @@ cc_wifi_panel_class_init (CcWifiPanelClass *klass)
   CcPanelClass *panel_class = CC_PANEL_CLASS (klass);
 
   panel_class->get_help_uri = cc_wifi_panel_get_help_uri;
+  panel_class->suspend = cc_wifi_panel_suspend;
+  panel_class->resume = cc_wifi_panel_resume;
 
   object_class->finalize = cc_wifi_panel_finalize;
   object_class->get_property = cc_wifi_panel_get_property;
@@ -65,6 +65,7 @@ struct _NetDeviceWifi
         AdwActionRow            *hotspot_security_row;
         AdwActionRow            *hotspot_password_row;
         GtkBox                  *listbox_box;
+        CcWifiConnectionList    *visible_networks_list;
         GtkStack                *stack;
         AdwPreferencesGroup     *saved_networks_box;
         CcWifiConnectionList    *saved_networks_list;
@@ -93,6 +94,7 @@ struct _NetDeviceWifi
 
         guint                    monitor_scanning_id;
         guint                    scan_id;
+        gboolean                 suspended;
         GCancellable            *cancellable;
 };
 
@@ -388,7 +390,8 @@ nm_device_wifi_refresh_ui (NetDeviceWifi *self)
         }
 
         if (self->scan_id == 0 &&
-            nm_client_wireless_get_enabled (self->client)) {
+            nm_client_wireless_get_enabled (self->client) &&
+            !cc_panel_is_suspended (self->panel)) {
                 self->scan_id = g_timeout_add_seconds (PERIODIC_WIFI_SCAN_TIMEOUT,
                                                        request_scan, self);
                 request_scan (self);
@@ -1189,6 +1192,7 @@ net_device_wifi_new (CcPanel *panel, NMClient *client, NMDevice *device)
         list = cc_wifi_connection_list_new (client, NM_DEVICE_WIFI (device), TRUE, TRUE, FALSE, FALSE);
         cc_wifi_connection_list_set_placeholder_text (list, _("Searching for networks…"));
         gtk_box_append (self->listbox_box, GTK_WIDGET (list));
+        self->visible_networks_list = list;
 
         listbox = cc_wifi_connection_list_get_list_box (list);
         gtk_list_box_set_sort_func (listbox, (GtkListBoxSortFunc)ap_sort, self, NULL);
@@ -1272,3 +1276,46 @@ net_device_wifi_turn_off_hotspot (NetDeviceWifi *self)
 
         stop_shared_connection (self);
 }
+
+/* Stops the periodic scans and following NetworkManager while the panel
+ * is hidden, net_device_wifi_resume() catches up with what changed.
+ */
+void
+net_device_wifi_suspend (NetDeviceWifi *self)
+{
+        g_return_if_fail (NET_IS_DEVICE_WIFI (self));
+
+        if (self->suspended)
+                return;
+        self->suspended = TRUE;
+
+        disable_scan_timeout (self);
+
+        g_signal_handlers_block_by_func (self->client, wireless_enabled_toggled, self);
+        g_signal_handlers_block_by_func (self->client, nm_client_on_permission_change, self);
+        g_signal_handlers_block_by_func (self->device, nm_device_wifi_refresh_ui, self);
+
+        cc_wifi_connection_list_suspend (self->visible_networks_list);
+        cc_wifi_connection_list_suspend (self->saved_networks_list);
+}
+
+void
+net_device_wifi_resume (NetDeviceWifi *self)
+{
+        g_return_if_fail (NET_IS_DEVICE_WIFI (self));
+
+        /* Devices added while the panel was suspended weren't suspended */
+        if (!self->suspended)
+                return;
+        self->suspended = FALSE;
+
+        g_signal_handlers_unblock_by_func (self->client, wireless_enabled_toggled, self);
+        g_signal_handlers_unblock_by_func (self->client, nm_client_on_permission_change, self);
+        g_signal_handlers_unblock_by_func (self->device, nm_device_wifi_refresh_ui, self);
+
+        cc_wifi_connection_list_resume (self->visible_networks_list);
+        cc_wifi_connection_list_resume (self->saved_networks_list);
+
+        nm_client_on_permission_change (self);
+        nm_device_wifi_refresh_ui (self);
+}
@@ -65,9 +65,10 @@ typedef struct {
   CcNotificationsPanel *self;
 } Application;
 
-static void build_app_store (CcNotificationsPanel *self);
-static void select_app      (CcNotificationsPanel *self, GtkListBoxRow *row);
-static int  sort_apps       (gconstpointer one, gconstpointer two, gpointer user_data);
+static void build_app_store  (CcNotificationsPanel *self);
+static void children_changed (CcNotificationsPanel *self, const char *key);
+static void select_app       (CcNotificationsPanel *self, GtkListBoxRow *row);
+static int  sort_apps        (gconstpointer one, gconstpointer two, gpointer user_data);
 
 CC_PANEL_REGISTER (CcNotificationsPanel, cc_notifications_panel);
 
@@ -169,6 +170,24 @@ cc_notifications_panel_get_help_uri (CcPanel *panel)
   return "help:gnome-help/shell-notifications";
 }
 
+static void
+cc_notifications_panel_suspend (CcPanel *panel)
+{
+  CcNotificationsPanel *self = CC_NOTIFICATIONS_PANEL (panel);
+
+  g_signal_handlers_block_by_func (self->master_settings, children_changed, self);
+}
+
+/* Apps that sent their first notification while hidden get a row now */
+static void
+cc_notifications_panel_resume (CcPanel *panel)
+{
+  CcNotificationsPanel *self = CC_NOTIFICATIONS_PANEL (panel);
+
+  g_signal_handlers_unblock_by_func (self->master_settings, children_changed, self);
+  children_changed (self, NULL);
+}
+
 static void
 cc_notifications_panel_class_init (CcNotificationsPanelClass *klass)
 {
@@ -177,6 +196,8 @@ cc_notifications_panel_class_init (CcNotificationsPanelClass *klass)
   CcPanelClass   *panel_class  = CC_PANEL_CLASS (klass);
 
   panel_class->get_help_uri = cc_notifications_panel_get_help_uri;
+  panel_class->suspend = cc_notifications_panel_suspend;
+  panel_class->resume = cc_notifications_panel_resume;
 
   /* Separate dispose() and finalize() functions are necessary
    * to make sure we cancel the running thread before the panel
@@ -0,0 +1,499 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2024 Bardia Moshiri <fakeshell@bardia.tech>
+// Copyright (C) 2024 Erik Inkinen <erik.inkinen@erikinkinen.fi>
+
+#include "cc-batman-config.h"
+
+/*
+ * The batman configuration, kept in memory and exposed as
+ * properties.  Changes are coalesced into a single write of the
+ * whole file, replaced atomically, and edits made by someone
+ * else are picked up through a file monitor.
+ */
+
+#define SETTINGS_GROUP "Settings"
+
+/* Several options are usually flipped in a row */
+#define SAVE_TIMEOUT_MS 500
+#define RELOAD_TIMEOUT_MS 250
+
+struct _CcBatmanConfig
+{
+  GObject       parent_instance;
+
+  GFile        *file;
+  GKeyFile     *keyfile;
+  gchar        *etag; /* Of the contents we last read or wrote */
+  gboolean      loaded;
+
+  GFileMonitor *monitor;
+  GCancellable *cancellable;
+  guint         reload_id;
+
+  guint         save_id;
+  gboolean      saving;
+  gboolean      save_again;
+};
+
+G_DEFINE_TYPE (CcBatmanConfig, cc_batman_config, G_TYPE_OBJECT)
+
+enum {
+  PROP_0,
+  PROP_OFFLINE,
+  PROP_POWERSAVE,
+  PROP_MAX_CPU_USAGE,
+  PROP_CHARGESAVE,
+  PROP_BUSSAVE,
+  PROP_GPUSAVE,
+  PROP_BTSAVE,
+  PROP_HYBRISSAVE,
+  PROP_WIFISAVE,
+  PROP_WAYDROIDSAVE,
+  N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+static const gchar *property_keys[N_PROPS] = {
+  [PROP_OFFLINE] = "OFFLINE",
+  [PROP_POWERSAVE] = "POWERSAVE",
+  [PROP_MAX_CPU_USAGE] = "MAX_CPU_USAGE",
+  [PROP_CHARGESAVE] = "CHARGESAVE",
+  [PROP_BUSSAVE] = "BUSSAVE",
+  [PROP_GPUSAVE] = "GPUSAVE",
+  [PROP_BTSAVE] = "BTSAVE",
+  [PROP_HYBRISSAVE] = "HYBRIS",
+  [PROP_WIFISAVE] = "WIFI",
+  [PROP_WAYDROIDSAVE] = "WAYDROID",
+};
+
+static void cc_batman_config_save (CcBatmanConfig *self);
+
+static GKeyFile *
+parse_config (const gchar  *contents,
+              gsize         length,
+              GError      **error)
+{
+  g_autoptr(GKeyFile) keyfile = g_key_file_new ();
+
+  if (!g_key_file_load_from_data (keyfile, contents, length,
+                                  G_KEY_FILE_KEEP_COMMENTS, error))
+    return NULL;
+
+  return g_steal_pointer (&keyfile);
+}
+
+/* Takes the contents read from disk, notifying the options
+ * whose value differs from what we had */
+static void
+set_keyfile (CcBatmanConfig *self,
+             GKeyFile       *keyfile)
+{
+  g_object_freeze_notify (G_OBJECT (self));
+
+  for (guint prop_id = PROP_0 + 1; prop_id < N_PROPS; prop_id++)
+    {
+      g_autofree gchar *old_value = NULL;
+      g_autofree gchar *new_value = NULL;
+
+      old_value = g_key_file_get_value (self->keyfile, SETTINGS_GROUP, property_keys[prop_id], NULL);
+      new_value = g_key_file_get_value (keyfile, SETTINGS_GROUP, property_keys[prop_id], NULL);
+
+      if (g_strcmp0 (old_value, new_value) != 0)
+        g_object_notify_by_pspec (G_OBJECT (self), properties[prop_id]);
+    }
+
+  g_key_file_unref (self->keyfile);
+  self->keyfile = g_key_file_ref (keyfile);
+
+  g_object_thaw_notify (G_OBJECT (self));
+}
+
+static void
+reload_cb (GObject      *object,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  CcBatmanConfig *self;
+  g_autoptr(GKeyFile) keyfile = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *contents = NULL;
+  g_autofree gchar *etag = NULL;
+  gsize length;
+
+  if (!g_file_load_contents_finish (G_FILE (object), result, &contents, &length, &etag, &error))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) &&
+          !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        g_warning ("Failed to reload %s: %s", BATMAN_CONFIG_FILE, error->message);
+      return;
+    }
+
+  self = CC_BATMAN_CONFIG (user_data);
+
+  /* Our own write, or local changes that will overwrite it */
+  if (g_strcmp0 (etag, self->etag) == 0 || self->save_id != 0 || self->saving)
+    return;
+
+  keyfile = parse_config (contents, length, &error);
+  if (!keyfile)
+    {
+      g_warning ("Failed to parse %s: %s", BATMAN_CONFIG_FILE, error->message);
+      return;
+    }
+
+  g_debug ("%s changed on disk", BATMAN_CONFIG_FILE);
+
+  g_set_str (&self->etag, etag);
+  self->loaded = TRUE;
+  set_keyfile (self, keyfile);
+}
+
+static gboolean
+reload_timeout_cb (gpointer user_data)
+{
+  CcBatmanConfig *self = CC_BATMAN_CONFIG (user_data);
+
+  self->reload_id = 0;
+  g_file_load_contents_async (self->file, self->cancellable, reload_cb, self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+on_file_changed (CcBatmanConfig    *self,
+                 GFile             *file,
+                 GFile             *other_file,
+                 GFileMonitorEvent  event_type,
+                 GFileMonitor      *monitor)
+{
+  if (event_type == G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED ||
+      event_type == G_FILE_MONITOR_EVENT_DELETED)
+    return;
+
+  g_clear_handle_id (&self->reload_id, g_source_remove);
+  self->reload_id = g_timeout_add (RELOAD_TIMEOUT_MS, reload_timeout_cb, self);
+}
+
+static void
+save_cb (GObject      *object,
+         GAsyncResult *result,
+         gpointer      user_data)
+{
+  g_autoptr(CcBatmanConfig) self = CC_BATMAN_CONFIG (user_data);
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *etag = NULL;
+
+  self->saving = FALSE;
+
+  if (g_file_replace_contents_finish (G_FILE (object), result, &etag, &error))
+    g_set_str (&self->etag, etag);
+  else
+    g_warning ("Failed to write %s: %s", BATMAN_CONFIG_FILE, error->message);
+
+  if (self->save_again)
+    {
+      self->save_again = FALSE;
+      cc_batman_config_save (self);
+    }
+}
+
+static void
+cc_batman_config_save (CcBatmanConfig *self)
+{
+  g_autoptr(GBytes) bytes = NULL;
+  gchar *contents;
+  gsize length;
+
+  g_clear_handle_id (&self->save_id, g_source_remove);
+
+  if (!self->loaded)
+    {
+      g_warning ("Not writing %s, it couldn’t be read", BATMAN_CONFIG_FILE);
+      return;
+    }
+
+  /* Only one write at a time, the next one has the latest values */
+  if (self->saving)
+    {
+      self->save_again = TRUE;
+      return;
+    }
+
+  contents = g_key_file_to_data (self->keyfile, &length, NULL);
+  bytes = g_bytes_new_take (contents, length);
+
+  /* Written to a temporary file, synced, then renamed over the
+   * configuration, so batman never sees a partial file. The write
+   * isn’t cancelled when we go away, the changes have to land. */
+  self->saving = TRUE;
+  g_file_replace_contents_bytes_async (self->file, bytes, NULL, FALSE,
+                                       G_FILE_CREATE_NONE, NULL,
+                                       save_cb, g_object_ref (self));
+}
+
+static gboolean
+save_timeout_cb (gpointer user_data)
+{
+  CcBatmanConfig *self = CC_BATMAN_CONFIG (user_data);
+
+  self->save_id = 0;
+  cc_batman_config_save (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+cc_batman_config_get_property (GObject    *object,
+                               guint       prop_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+  CcBatmanConfig *self = CC_BATMAN_CONFIG (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_CPU_USAGE:
+      g_value_set_int (value, g_key_file_get_integer (self->keyfile, SETTINGS_GROUP,
+                                                      property_keys[prop_id], NULL));
+      break;
+
+    case PROP_OFFLINE:
+    case PROP_POWERSAVE:
+    case PROP_CHARGESAVE:
+    case PROP_BUSSAVE:
+    case PROP_GPUSAVE:
+    case PROP_BTSAVE:
+    case PROP_HYBRISSAVE:
+    case PROP_WIFISAVE:
+    case PROP_WAYDROIDSAVE:
+      g_value_set_boolean (value, g_key_file_get_boolean (self->keyfile, SETTINGS_GROUP,
+                                                          property_keys[prop_id], NULL));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+cc_batman_config_set_property (GObject      *object,
+                               guint         prop_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  CcBatmanConfig *self = CC_BATMAN_CONFIG (object);
+  g_autofree gchar *old_value = NULL;
+  g_autofree gchar *new_value = NULL;
+
+  switch (prop_id)
+    {
+    case PROP_MAX_CPU_USAGE:
+      new_value = g_strdup_printf ("%d", g_value_get_int (value));
+      break;
+
+    case PROP_OFFLINE:
+    case PROP_POWERSAVE:
+    case PROP_CHARGESAVE:
+    case PROP_BUSSAVE:
+    case PROP_GPUSAVE:
+    case PROP_BTSAVE:
+    case PROP_HYBRISSAVE:
+    case PROP_WIFISAVE:
+    case PROP_WAYDROIDSAVE:
+      new_value = g_strdup (g_value_get_boolean (value) ? "true" : "false");
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      return;
+    }
+
+  old_value = g_key_file_get_value (self->keyfile, SETTINGS_GROUP, property_keys[prop_id], NULL);
+  if (g_strcmp0 (old_value, new_value) == 0)
+    return;
+
+  g_key_file_set_value (self->keyfile, SETTINGS_GROUP, property_keys[prop_id], new_value);
+  g_object_notify_by_pspec (object, pspec);
+
+  g_clear_handle_id (&self->save_id, g_source_remove);
+  self->save_id = g_timeout_add (SAVE_TIMEOUT_MS, save_timeout_cb, self);
+}
+
+static void
+cc_batman_config_dispose (GObject *object)
+{
+  CcBatmanConfig *self = CC_BATMAN_CONFIG (object);
+
+  cc_batman_config_flush (self);
+
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+  g_clear_handle_id (&self->reload_id, g_source_remove);
+  if (self->monitor != NULL)
+    g_file_monitor_cancel (self->monitor);
+  g_clear_object (&self->monitor);
+
+  G_OBJECT_CLASS (cc_batman_config_parent_class)->dispose (object);
+}
+
+static void
+cc_batman_config_finalize (GObject *object)
+{
+  CcBatmanConfig *self = CC_BATMAN_CONFIG (object);
+
+  g_clear_object (&self->file);
+  g_clear_pointer (&self->keyfile, g_key_file_unref);
+  g_clear_pointer (&self->etag, g_free);
+
+  G_OBJECT_CLASS (cc_batman_config_parent_class)->finalize (object);
+}
+
+static void
+cc_batman_config_class_init (CcBatmanConfigClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = cc_batman_config_get_property;
+  object_class->set_property = cc_batman_config_set_property;
+  object_class->dispose = cc_batman_config_dispose;
+  object_class->finalize = cc_batman_config_finalize;
+
+  properties[PROP_OFFLINE] =
+    g_param_spec_boolean ("offline", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_POWERSAVE] =
+    g_param_spec_boolean ("powersave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_MAX_CPU_USAGE] =
+    g_param_spec_int ("max-cpu-usage", NULL, NULL, 0, 100, 0,
+                      G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_CHARGESAVE] =
+    g_param_spec_boolean ("chargesave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_BUSSAVE] =
+    g_param_spec_boolean ("bussave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_GPUSAVE] =
+    g_param_spec_boolean ("gpusave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_BTSAVE] =
+    g_param_spec_boolean ("btsave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_HYBRISSAVE] =
+    g_param_spec_boolean ("hybrissave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_WIFISAVE] =
+    g_param_spec_boolean ("wifisave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  properties[PROP_WAYDROIDSAVE] =
+    g_param_spec_boolean ("waydroidsave", NULL, NULL, FALSE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, N_PROPS, properties);
+}
+
+static void
+cc_batman_config_init (CcBatmanConfig *self)
+{
+  self->keyfile = g_key_file_new ();
+  self->cancellable = g_cancellable_new ();
+}
+
+/**
+ * cc_batman_config_new:
+ * @path: The batman configuration file, usually %BATMAN_CONFIG_FILE
+ *
+ * Reads the configuration at @path, and keeps watching it for
+ * changes made by someone else.
+ *
+ * Returns: (transfer full): A #CcBatmanConfig
+ */
+CcBatmanConfig *
+cc_batman_config_new (const gchar *path)
+{
+  CcBatmanConfig *self;
+  g_autoptr(GKeyFile) keyfile = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *contents = NULL;
+  gsize length;
+
+  g_return_val_if_fail (path != NULL, NULL);
+
+  self = g_object_new (CC_TYPE_BATMAN_CONFIG, NULL);
+  self->file = g_file_new_for_path (path);
+
+  if (g_file_load_contents (self->file, NULL, &contents, &length, &self->etag, &error) &&
+      (keyfile = parse_config (contents, length, &error)) != NULL)
+    {
+      g_key_file_unref (self->keyfile);
+      self->keyfile = g_steal_pointer (&keyfile);
+      self->loaded = TRUE;
+    }
+  else if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+    {
+      g_debug ("%s doesn’t exist, batman isn’t installed", path);
+    }
+  else
+    {
+      g_warning ("Failed to load %s: %s", path, error->message);
+    }
+  g_clear_error (&error);
+
+  self->monitor = g_file_monitor_file (self->file, G_FILE_MONITOR_NONE, NULL, &error);
+  if (self->monitor != NULL)
+    g_signal_connect_object (self->monitor, "changed",
+                             G_CALLBACK (on_file_changed),
+                             self, G_CONNECT_SWAPPED);
+  else
+    g_warning ("Failed to monitor %s: %s", path, error->message);
+
+  return self;
+}
+
+/**
+ * cc_batman_config_flush:
+ * @self: a #CcBatmanConfig
+ *
+ * Writes the pending changes right away, instead of waiting
+ * for more of them.  This blocks, unless a write is already in
+ * progress, in which case the changes are written after it.
+ */
+void
+cc_batman_config_flush (CcBatmanConfig *self)
+{
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *contents = NULL;
+  g_autofree gchar *etag = NULL;
+  gsize length;
+
+  g_return_if_fail (CC_IS_BATMAN_CONFIG (self));
+
+  if (self->save_id == 0)
+    return;
+
+  /* Queued after the write in progress */
+  if (self->saving || !self->loaded)
+    {
+      cc_batman_config_save (self);
+      return;
+    }
+
+  g_clear_handle_id (&self->save_id, g_source_remove);
+
+  contents = g_key_file_to_data (self->keyfile, &length, NULL);
+  if (g_file_replace_contents (self->file, contents, length, NULL, FALSE,
+                               G_FILE_CREATE_NONE, &etag, NULL, &error))
+    g_set_str (&self->etag, etag);
+  else
+    g_warning ("Failed to write %s: %s", BATMAN_CONFIG_FILE, error->message);
+}
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-2.0-only
+// Copyright (C) 2024 Bardia Moshiri <fakeshell@bardia.tech>
+// Copyright (C) 2024 Erik Inkinen <erik.inkinen@erikinkinen.fi>
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define BATMAN_CONFIG_FILE "/var/lib/batman/config"
+
+#define CC_TYPE_BATMAN_CONFIG (cc_batman_config_get_type ())
+G_DECLARE_FINAL_TYPE (CcBatmanConfig, cc_batman_config, CC, BATMAN_CONFIG, GObject)
+
+CcBatmanConfig *cc_batman_config_new   (const gchar    *path);
+
+void            cc_batman_config_flush (CcBatmanConfig *self);
+
+G_END_DECLS
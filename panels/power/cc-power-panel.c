@@ -27,7 +27,7 @@
 #include <gio/gdesktopappinfo.h>
 
 #include "shell/cc-object-storage.h"
-#include "cc-batman-config-control.h"
+#include "cc-batman-config.h"
 #include "cc-list-row.h"
 #include "cc-battery-row.h"
 #include "cc-hostname.h"
@@ -92,6 +92,8 @@ struct _CcPowerPanel
   CcPowerProfileRow *power_profiles_row[NUM_CC_POWER_PROFILES];
   gboolean       power_profiles_in_update;
   gboolean       has_performance_degraded;
+
+  CcBatmanConfig *batman_config;
 };
 
 CC_PANEL_REGISTER (CcPowerPanel, cc_power_panel)
@@ -276,6 +278,24 @@ up_client_device_added (CcPowerPanel *self,
   up_client_changed (self);
 }
 
+/* Drops the devices we know of, and follows the ones UPower has now */
+static void
+load_devices (CcPowerPanel *self)
+{
+  guint i;
+
+  for (i = 0; self->devices != NULL && i < self->devices->len; i++)
+    g_signal_handlers_disconnect_by_func (g_ptr_array_index (self->devices, i), up_client_changed, self);
+  g_clear_pointer (&self->devices, g_ptr_array_unref);
+
+  self->devices = up_client_get_devices2 (self->up_client);
+  for (i = 0; self->devices != NULL && i < self->devices->len; i++) {
+    UpDevice *device = g_ptr_array_index (self->devices, i);
+    g_signal_connect_object (G_OBJECT (device), "notify",
+                             G_CALLBACK (up_client_changed), self, G_CONNECT_SWAPPED);
+  }
+}
+
 static void
 als_row_changed_cb (CcPowerPanel *self)
 {
@@ -386,6 +406,10 @@ iio_proxy_appeared_cb (GDBusConnection *connection,
       return;
     }
 
+  /* Connected in cc_power_panel_resume() otherwise */
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    return;
+
   g_signal_connect_object (G_OBJECT (self->iio_proxy), "g-properties-changed",
                            G_CALLBACK (als_enabled_state_changed), self,
                            G_CONNECT_SWAPPED);
@@ -398,8 +422,14 @@ iio_proxy_vanished_cb (GDBusConnection *connection,
                        gpointer user_data)
 {
   CcPowerPanel *self = CC_POWER_PANEL (user_data);
+
+  /* The proxy is shared, and may be handed out again */
+  if (self->iio_proxy != NULL)
+    g_signal_handlers_disconnect_by_func (self->iio_proxy, als_enabled_state_changed, self);
   g_clear_object (&self->iio_proxy);
-  als_enabled_state_changed (self);
+
+  if (!cc_panel_is_suspended (CC_PANEL (self)))
+    als_enabled_state_changed (self);
 }
 
 static gboolean
@@ -1214,6 +1244,91 @@ batman_service_enabled_switch_state_set (GtkSwitch* sender, gboolean state, gpoi
     return TRUE;
 }
 
+static void
+batman_max_cpu_usage_changed_cb (CcPowerPanel *self)
+{
+  g_autofree gchar *text = NULL;
+  gint max_cpu_usage;
+
+  g_object_get (self->batman_config, "max-cpu-usage", &max_cpu_usage, NULL);
+  text = g_strdup_printf ("%d", max_cpu_usage);
+  gtk_editable_set_text (GTK_EDITABLE (self->batman_max_cpu_row), text);
+}
+
+static void
+batman_max_cpu_row_apply_cb (CcPowerPanel *self)
+{
+  const gchar *text;
+  guint64 max_cpu_usage;
+
+  text = gtk_editable_get_text (GTK_EDITABLE (self->batman_max_cpu_row));
+  if (!g_ascii_string_to_unsigned (text, 10, 0, 100, &max_cpu_usage, NULL))
+    {
+      g_warning ("CPU usage must be between 0 and 100");
+      max_cpu_usage = 0;
+      gtk_editable_set_text (GTK_EDITABLE (self->batman_max_cpu_row), "0");
+    }
+
+  g_object_set (self->batman_config, "max-cpu-usage", (gint) max_cpu_usage, NULL);
+}
+
+/* Batteries, sensors and power profiles report changes often, so don't
+ * follow them while hidden. The devices are read again on resume, as
+ * some may have come or gone in the meantime. */
+static void
+cc_power_panel_suspend (CcPanel *panel)
+{
+  CcPowerPanel *self = CC_POWER_PANEL (panel);
+  guint i;
+
+  g_signal_handlers_block_by_func (self->up_client, up_client_device_added, self);
+  g_signal_handlers_block_by_func (self->up_client, up_client_device_removed, self);
+
+  for (i = 0; self->devices != NULL && i < self->devices->len; i++)
+    g_signal_handlers_disconnect_by_func (g_ptr_array_index (self->devices, i), up_client_changed, self);
+
+  if (self->iio_proxy != NULL)
+    g_signal_handlers_disconnect_by_func (self->iio_proxy, als_enabled_state_changed, self);
+
+  if (self->power_profiles_prop_id != 0)
+    g_signal_handler_block (self->power_profiles_proxy, self->power_profiles_prop_id);
+}
+
+static void
+cc_power_panel_resume (CcPanel *panel)
+{
+  CcPowerPanel *self = CC_POWER_PANEL (panel);
+
+  g_signal_handlers_unblock_by_func (self->up_client, up_client_device_added, self);
+  g_signal_handlers_unblock_by_func (self->up_client, up_client_device_removed, self);
+
+  load_devices (self);
+  up_client_changed (self);
+
+  if (self->iio_proxy != NULL)
+    g_signal_connect_object (G_OBJECT (self->iio_proxy), "g-properties-changed",
+                             G_CALLBACK (als_enabled_state_changed), self,
+                             G_CONNECT_SWAPPED);
+  als_enabled_state_changed (self);
+
+  if (self->power_profiles_prop_id != 0)
+    {
+      g_autoptr(GVariant) active_profile = NULL;
+
+      g_signal_handler_unblock (self->power_profiles_proxy, self->power_profiles_prop_id);
+
+      active_profile = g_dbus_proxy_get_cached_property (self->power_profiles_proxy, "ActiveProfile");
+      if (active_profile)
+        {
+          self->power_profiles_in_update = TRUE;
+          performance_profile_set_active (self, g_variant_get_string (active_profile, NULL));
+          self->power_profiles_in_update = FALSE;
+        }
+
+      power_profile_update_info_boxes (self);
+    }
+}
+
 static void
 cc_power_panel_dispose (GObject *object)
 {
@@ -1227,6 +1342,7 @@ cc_power_panel_dispose (GObject *object)
   g_clear_object (&self->up_client);
   g_clear_object (&self->iio_proxy);
   g_clear_object (&self->power_profiles_proxy);
+  g_clear_object (&self->batman_config);
   if (self->iio_proxy_watch_id != 0)
     g_bus_unwatch_name (self->iio_proxy_watch_id);
   self->iio_proxy_watch_id = 0;
@@ -1244,6 +1360,8 @@ cc_power_panel_class_init (CcPowerPanelClass *klass)
   object_class->dispose = cc_power_panel_dispose;
 
   panel_class->get_help_uri = cc_power_panel_get_help_uri;
+  panel_class->suspend = cc_power_panel_suspend;
+  panel_class->resume = cc_power_panel_resume;
 
   gtk_widget_class_set_template_from_resource (widget_class, "/org/gnome/control-center/power/cc-power-panel.ui");
 
@@ -1290,7 +1408,6 @@ cc_power_panel_class_init (CcPowerPanelClass *klass)
 static void
 cc_power_panel_init (CcPowerPanel *self)
 {
-  guint i;
   g_autoptr(GtkCssProvider) provider = NULL;
 
   g_resources_register (cc_power_get_resource ());
@@ -1333,12 +1450,7 @@ cc_power_panel_init (CcPowerPanel *self)
   g_signal_connect_object (self->up_client, "device-added", G_CALLBACK (up_client_device_added), self, G_CONNECT_SWAPPED);
   g_signal_connect_object (self->up_client, "device-removed", G_CALLBACK (up_client_device_removed), self, G_CONNECT_SWAPPED);
 
-  self->devices = up_client_get_devices2 (self->up_client);
-  for (i = 0; self->devices != NULL && i < self->devices->len; i++) {
-    UpDevice *device = g_ptr_array_index (self->devices, i);
-    g_signal_connect_object (G_OBJECT (device), "notify",
-                             G_CALLBACK (up_client_changed), self, G_CONNECT_SWAPPED);
-  }
+  load_devices (self);
   up_client_changed (self);
 
   gtk_switch_set_state (GTK_SWITCH (self->batman_service_switch), check_batman_active () == TRUE);
@@ -1349,48 +1461,30 @@ cc_power_panel_init (CcPowerPanel *self)
   gtk_switch_set_active (GTK_SWITCH (self->batman_service_enabled_switch), check_batman_enabled () == TRUE);
   g_signal_connect (self->batman_service_enabled_switch, "state-set", G_CALLBACK (batman_service_enabled_switch_state_set), NULL);
 
-  read_batman_config ();
-
-  GString *max_cpu_str = g_string_new (NULL);
-  g_string_printf (max_cpu_str, "%d", batman_config.max_cpu_usage);
-  gtk_editable_set_text (GTK_EDITABLE (self->batman_max_cpu_row), max_cpu_str->str);
-  g_string_free (max_cpu_str, TRUE);
-
-  g_signal_connect (self->batman_max_cpu_row, "apply", G_CALLBACK (max_cpu_entry_apply), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_waydroidsave_switch), batman_config.waydroidsave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_waydroidsave_switch), batman_config.waydroidsave);
-  g_signal_connect (self->batman_waydroidsave_switch, "state-set", G_CALLBACK (waydroidsave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_wifisave_switch), batman_config.wifisave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_wifisave_switch), batman_config.wifisave);
-  g_signal_connect (self->batman_wifisave_switch, "state-set", G_CALLBACK (wifisave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_hybrissave_switch), batman_config.hybrissave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_hybrissave_switch), batman_config.hybrissave);
-  g_signal_connect (self->batman_hybrissave_switch, "state-set", G_CALLBACK (hybrissave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_btsave_switch), batman_config.btsave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_btsave_switch), batman_config.btsave);
-  g_signal_connect (self->batman_btsave_switch, "state-set", G_CALLBACK (btsave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_bussave_switch), batman_config.bussave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_bussave_switch), batman_config.bussave);
-  g_signal_connect (self->batman_bussave_switch, "state-set", G_CALLBACK (bussave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_chargesave_switch), batman_config.chargesave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_chargesave_switch), batman_config.chargesave);
-  g_signal_connect (self->batman_chargesave_switch, "state-set", G_CALLBACK (chargesave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_gpusave_switch), batman_config.gpusave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_gpusave_switch), batman_config.gpusave);
-  g_signal_connect (self->batman_gpusave_switch, "state-set", G_CALLBACK (gpusave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_powersave_switch), batman_config.powersave);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_powersave_switch), batman_config.powersave);
-  g_signal_connect (self->batman_powersave_switch, "state-set", G_CALLBACK (powersave_switch_state_set), NULL);
-
-  gtk_switch_set_state (GTK_SWITCH (self->batman_offline_switch), batman_config.offline);
-  gtk_switch_set_active (GTK_SWITCH (self->batman_offline_switch), batman_config.offline);
-  g_signal_connect (self->batman_offline_switch, "state-set", G_CALLBACK (offline_switch_state_set), NULL);
+  self->batman_config = cc_batman_config_new (BATMAN_CONFIG_FILE);
+
+  g_signal_connect_object (self->batman_config, "notify::max-cpu-usage",
+                           G_CALLBACK (batman_max_cpu_usage_changed_cb), self, G_CONNECT_SWAPPED);
+  batman_max_cpu_usage_changed_cb (self);
+  g_signal_connect_object (self->batman_max_cpu_row, "apply",
+                           G_CALLBACK (batman_max_cpu_row_apply_cb), self, G_CONNECT_SWAPPED);
+
+  g_object_bind_property (self->batman_config, "waydroidsave", self->batman_waydroidsave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "wifisave", self->batman_wifisave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "hybrissave", self->batman_hybrissave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "btsave", self->batman_btsave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "bussave", self->batman_bussave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "chargesave", self->batman_chargesave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "gpusave", self->batman_gpusave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "powersave", self->batman_powersave_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+  g_object_bind_property (self->batman_config, "offline", self->batman_offline_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
 }
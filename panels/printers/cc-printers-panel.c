@@ -113,6 +113,9 @@ struct _CcPrintersPanel
 
   GHashTable *printer_entries;
   gboolean    entries_filled;
+  GHashTable *printer_state_updates; /* printer name → PrinterStateUpdate */
+  gboolean    printers_list_outdated;
+  guint       notifications_tick_id;
   GVariant   *action;
 
   GtkSizeGroup *size_group;
@@ -127,6 +130,15 @@ typedef struct
   GCancellable *cancellable;
 } SetPPDItem;
 
+/* The state of a printer, as last told by CUPS */
+typedef struct
+{
+  gint      printer_state;
+  gchar    *printer_state_reasons;
+  gboolean  is_accepting_jobs;
+  gboolean  markers_changed;
+} PrinterStateUpdate;
+
 enum {
   PROP_0,
   PROP_PARAMETERS,
@@ -302,6 +314,12 @@ cc_printers_panel_dispose (GObject *object)
 
   detach_from_cups_notifier (CC_PRINTERS_PANEL (object));
 
+  if (self->notifications_tick_id != 0)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (self), self->notifications_tick_id);
+      self->notifications_tick_id = 0;
+    }
+
   if (self->deleted_printer_name != NULL)
     {
       g_autoptr(PpPrinter) printer = pp_printer_new (self->deleted_printer_name);
@@ -319,6 +337,7 @@ cc_printers_panel_dispose (GObject *object)
   g_clear_pointer (&self->deleted_printer_name, g_free);
   g_clear_pointer (&self->action, g_variant_unref);
   g_clear_pointer (&self->printer_entries, g_hash_table_destroy);
+  g_clear_pointer (&self->printer_state_updates, g_hash_table_destroy);
   g_clear_pointer (&self->all_ppds_list, ppd_list_free);
   free_dests (self);
   g_list_free_full (self->deleted_printers, g_free);
@@ -380,6 +399,247 @@ on_get_job_attributes_cb (GObject      *source_object,
     }
 }
 
+static void
+printer_state_update_free (gpointer data)
+{
+  PrinterStateUpdate *update = data;
+
+  g_free (update->printer_state_reasons);
+  g_free (update);
+}
+
+static void
+update_dest_state (cups_dest_t        *dest,
+                   PrinterStateUpdate *update)
+{
+  g_autofree gchar *printer_state = g_strdup_printf ("%d", update->printer_state);
+
+  dest->num_options = cupsAddOption ("printer-state",
+                                     printer_state,
+                                     dest->num_options,
+                                     &dest->options);
+  dest->num_options = cupsAddOption ("printer-state-reasons",
+                                     update->printer_state_reasons != NULL ? update->printer_state_reasons : "none",
+                                     dest->num_options,
+                                     &dest->options);
+  dest->num_options = cupsAddOption ("printer-is-accepting-jobs",
+                                     update->is_accepting_jobs ? "true" : "false",
+                                     dest->num_options,
+                                     &dest->options);
+}
+
+static gchar *
+join_attribute_values (GHashTable  *attributes,
+                       const gchar *attribute_name)
+{
+  IPPAttribute *attribute;
+  GString      *values;
+  gint          i;
+
+  attribute = g_hash_table_lookup (attributes, attribute_name);
+  if (attribute == NULL)
+    return NULL;
+
+  values = g_string_new (NULL);
+  for (i = 0; i < attribute->num_of_values; i++)
+    {
+      if (i > 0)
+        g_string_append_c (values, ',');
+
+      if (attribute->attribute_type == IPP_ATTRIBUTE_TYPE_INTEGER)
+        g_string_append_printf (values, "%d", attribute->attribute_values[i].integer_value);
+      else if (attribute->attribute_values[i].string_value != NULL)
+        g_string_append (values, attribute->attribute_values[i].string_value);
+    }
+
+  return g_string_free (values, FALSE);
+}
+
+static void
+on_get_marker_attributes_cb (GHashTable *table,
+                             gpointer    user_data)
+{
+  CcPrintersPanel       *self = user_data;
+  g_autoptr(GHashTable)  attributes = table;
+  g_autofree gchar      *marker_names = NULL;
+  g_autofree gchar      *marker_levels = NULL;
+  g_autofree gchar      *marker_colors = NULL;
+  g_autofree gchar      *marker_types = NULL;
+  IPPAttribute          *name_attribute;
+  const gchar           *printer_name;
+  PpPrinterEntry        *printer_entry;
+  gint                   i;
+
+  if (attributes == NULL)
+    return;
+
+  name_attribute = g_hash_table_lookup (attributes, "printer-name");
+  if (name_attribute == NULL || name_attribute->num_of_values < 1)
+    return;
+
+  printer_name = name_attribute->attribute_values[0].string_value;
+  marker_names = join_attribute_values (attributes, "marker-names");
+  marker_levels = join_attribute_values (attributes, "marker-levels");
+  marker_colors = join_attribute_values (attributes, "marker-colors");
+  marker_types = join_attribute_values (attributes, "marker-types");
+
+  for (i = 0; i < self->num_dests; i++)
+    {
+      cups_dest_t *dest = &self->dests[i];
+
+      if (g_strcmp0 (dest->name, printer_name) != 0)
+        continue;
+
+      if (marker_names != NULL)
+        dest->num_options = cupsAddOption ("marker-names", marker_names, dest->num_options, &dest->options);
+      if (marker_levels != NULL)
+        dest->num_options = cupsAddOption ("marker-levels", marker_levels, dest->num_options, &dest->options);
+      if (marker_colors != NULL)
+        dest->num_options = cupsAddOption ("marker-colors", marker_colors, dest->num_options, &dest->options);
+      if (marker_types != NULL)
+        dest->num_options = cupsAddOption ("marker-types", marker_types, dest->num_options, &dest->options);
+    }
+
+  printer_entry = g_hash_table_lookup (self->printer_entries, printer_name);
+  if (printer_entry != NULL)
+    pp_printer_entry_update_markers (printer_entry,
+                                     marker_names,
+                                     marker_levels,
+                                     marker_colors,
+                                     marker_types);
+}
+
+/* The supply levels aren't part of the notifications, so they are asked
+ * for again. The requests of several printers are batched together. */
+static void
+update_markers (CcPrintersPanel *self,
+                const gchar     *printer_name)
+{
+  static gchar *marker_attributes[] = {
+    "printer-name",
+    "marker-names",
+    "marker-levels",
+    "marker-colors",
+    "marker-types",
+    NULL };
+
+  get_ipp_attributes_async (printer_name,
+                            marker_attributes,
+                            cc_panel_get_cancellable (CC_PANEL (self)),
+                            on_get_marker_attributes_cb,
+                            self);
+}
+
+/* A busy printer changes its state many times per second, so the
+ * notifications are coalesced and handled once per frame. */
+static gboolean
+handle_notifications (GtkWidget     *widget,
+                      GdkFrameClock *frame_clock,
+                      gpointer       user_data)
+{
+  CcPrintersPanel *self = CC_PRINTERS_PANEL (widget);
+  GHashTableIter   iter;
+  gpointer         key, value;
+  gint             i;
+
+  self->notifications_tick_id = 0;
+
+  if (self->printers_list_outdated)
+    {
+      actualize_printers_list (self);
+      return G_SOURCE_REMOVE;
+    }
+
+  g_hash_table_iter_init (&iter, self->printer_state_updates);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      PrinterStateUpdate *update = value;
+      PpPrinterEntry     *printer_entry;
+
+      for (i = 0; i < self->num_dests; i++)
+        {
+          if (g_strcmp0 (self->dests[i].name, key) == 0)
+            update_dest_state (&self->dests[i], update);
+        }
+
+      printer_entry = g_hash_table_lookup (self->printer_entries, key);
+      if (printer_entry == NULL)
+        continue;
+
+      pp_printer_entry_update_state (printer_entry,
+                                     update->printer_state,
+                                     update->printer_state_reasons,
+                                     update->is_accepting_jobs);
+
+      if (update->markers_changed)
+        update_markers (self, key);
+    }
+
+  g_hash_table_remove_all (self->printer_state_updates);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * CUPS tells about changes of the supply levels with state changes too,
+ * either with marker reasons, or without any change of the state itself
+ * since the pending update, or the last known state.
+ */
+static gboolean
+markers_may_have_changed (CcPrintersPanel    *self,
+                          const gchar        *printer_name,
+                          gint                printer_state,
+                          const gchar        *printer_state_reasons,
+                          PrinterStateUpdate *previous_update)
+{
+  g_auto(GStrv) reasons = NULL;
+  gint          i;
+
+  if (printer_state_reasons != NULL)
+    {
+      reasons = g_strsplit (printer_state_reasons, ",", -1);
+      for (i = 0; reasons[i] != NULL; i++)
+        {
+          if (g_str_has_prefix (reasons[i], "marker-") ||
+              g_str_has_prefix (reasons[i], "toner-"))
+            return TRUE;
+        }
+    }
+
+  if (previous_update != NULL)
+    return previous_update->markers_changed ||
+           (previous_update->printer_state == printer_state &&
+            g_strcmp0 (previous_update->printer_state_reasons, printer_state_reasons) == 0);
+
+  for (i = 0; i < self->num_dests; i++)
+    {
+      const gchar *known_state;
+      const gchar *known_reasons;
+
+      if (g_strcmp0 (self->dests[i].name, printer_name) != 0)
+        continue;
+
+      known_state = cupsGetOption ("printer-state", self->dests[i].num_options, self->dests[i].options);
+      known_reasons = cupsGetOption ("printer-state-reasons", self->dests[i].num_options, self->dests[i].options);
+
+      return known_state != NULL &&
+             atoi (known_state) == printer_state &&
+             g_strcmp0 (known_reasons, printer_state_reasons != NULL ? printer_state_reasons : "none") == 0;
+    }
+
+  return FALSE;
+}
+
+static void
+queue_notifications (CcPrintersPanel *self)
+{
+  if (self->notifications_tick_id == 0)
+    self->notifications_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                                handle_notifications,
+                                                                NULL,
+                                                                NULL);
+}
+
 static void
 on_cups_notification (GDBusConnection *connection,
                       const char      *sender_name,
@@ -443,10 +703,41 @@ on_cups_notification (GDBusConnection *connection,
     }
 
   if (g_strcmp0 (signal_name, "PrinterAdded") == 0 ||
-      g_strcmp0 (signal_name, "PrinterDeleted") == 0 ||
-      g_strcmp0 (signal_name, "PrinterStateChanged") == 0 ||
-      g_strcmp0 (signal_name, "PrinterStopped") == 0)
-    actualize_printers_list (self);
+      g_strcmp0 (signal_name, "PrinterDeleted") == 0)
+    {
+      self->printers_list_outdated = TRUE;
+      queue_notifications (self);
+    }
+  else if (g_strcmp0 (signal_name, "PrinterStateChanged") == 0 ||
+           g_strcmp0 (signal_name, "PrinterStopped") == 0)
+    {
+      /* Only the state of known printers is updated in place */
+      if (printer_name != NULL &&
+          g_hash_table_contains (self->printer_entries, printer_name))
+        {
+          PrinterStateUpdate *previous_update;
+          PrinterStateUpdate *update;
+
+          previous_update = g_hash_table_lookup (self->printer_state_updates, printer_name);
+
+          update = g_new0 (PrinterStateUpdate, 1);
+          update->printer_state = printer_state;
+          update->printer_state_reasons = g_strdup (printer_state_reasons);
+          update->is_accepting_jobs = printer_is_accepting_jobs;
+          update->markers_changed = markers_may_have_changed (self,
+                                                              printer_name,
+                                                              printer_state,
+                                                              printer_state_reasons,
+                                                              previous_update);
+          g_hash_table_replace (self->printer_state_updates, g_strdup (printer_name), update);
+        }
+      else
+        {
+          self->printers_list_outdated = TRUE;
+        }
+
+      queue_notifications (self);
+    }
   else if (g_strcmp0 (signal_name, "JobCreated") == 0 ||
            g_strcmp0 (signal_name, "JobCompleted") == 0)
     {
@@ -898,6 +1189,10 @@ actualize_printers_list_cb (GObject      *source_object,
 static void
 actualize_printers_list (CcPrintersPanel *self)
 {
+  /* The state of every printer is about to be listed anyway */
+  self->printers_list_outdated = FALSE;
+  g_hash_table_remove_all (self->printer_state_updates);
+
   pp_cups_get_dests_async (self->cups,
                            cc_panel_get_cancellable (CC_PANEL (self)),
                            actualize_printers_list_cb,
@@ -1254,6 +1549,11 @@ cc_printers_panel_init (CcPrintersPanel *self)
                                                  g_free,
                                                  NULL);
 
+  self->printer_state_updates = g_hash_table_new_full (g_str_hash,
+                                                       g_str_equal,
+                                                       g_free,
+                                                       printer_state_update_free);
+
   g_type_ensure (CC_TYPE_PERMISSION_INFOBAR);
 
   g_object_set_data_full (self->reference, "self", self, NULL);
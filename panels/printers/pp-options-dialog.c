@@ -747,15 +747,18 @@ populate_options (PpOptionsDialog *self)
   printer_get_ppd_async (self->printer_name,
                          NULL,
                          0,
+                         NULL,
                          printer_get_ppd_cb,
                          self);
 
   get_named_dest_async (self->printer_name,
+                        NULL,
                         get_named_dest_cb,
                         self);
 
   get_ipp_attributes_async (self->printer_name,
                             (gchar **) attributes,
+                            NULL,
                             get_ipp_attributes_cb,
                             self);
 }
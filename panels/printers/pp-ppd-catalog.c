@@ -0,0 +1,348 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 8 -*-
+ *
+ * Copyright 2026  The GNOME Settings contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include <cups/cups.h>
+
+#include "pp-ppd-catalog.h"
+
+/* The list of all PPDs is kept in a cache file, so that CUPS doesn't have
+ * to be asked for it, and the response parsed again, each time a printer
+ * is added. The file is mapped and read in place: every string is stored
+ * once in a table, and manufacturers, in the order of their normalized
+ * names, and PPDs refer to it by index. Bump the version when changing
+ * the format of the catalog.
+ */
+#define CATALOG_VERSION 1
+#define CATALOG_VARIANT_TYPE "(usxasa(uuuu)a(uu))"
+
+/* Laid out as the fixed size tuples of the catalog */
+typedef struct
+{
+  guint32 name;
+  guint32 display_name;
+  guint32 first_ppd;
+  guint32 n_ppds;
+} CatalogManufacturer;
+
+typedef struct
+{
+  guint32 name;
+  guint32 display_name;
+} CatalogPPD;
+
+/* Where cups-driverd looks for drivers */
+static const gchar * const ppd_dirs[] = {
+  "/usr/share/ppd",
+  "/usr/local/share/ppd",
+  "/opt/share/ppd",
+  "/usr/share/cups/model",
+  "/usr/share/cups/drv",
+  "/usr/lib/cups/driver",
+  "/usr/libexec/cups/driver",
+};
+
+#define MAX_PPD_DIR_DEPTH 8
+
+static gchar *
+get_catalog_filename (void)
+{
+  return g_build_filename (g_get_user_cache_dir (),
+                           "gnome-control-center",
+                           "printers-ppd-catalog.cache",
+                           NULL);
+}
+
+static gint64
+get_mtime (const struct stat *buf)
+{
+  return (gint64) buf->st_mtim.tv_sec * G_USEC_PER_SEC + buf->st_mtim.tv_nsec / 1000;
+}
+
+/* Drivers being added or removed changes the modification time of the
+ * directory they are in. Only directories are looked at, the PPDs
+ * themselves would be too many. */
+static void
+update_dir_timestamp (const gchar *path,
+                      gint         depth,
+                      gint64      *timestamp)
+{
+  struct dirent *entry;
+  struct stat    buf;
+  DIR           *dir;
+
+  if (lstat (path, &buf) != 0 || !S_ISDIR (buf.st_mode))
+    return;
+
+  *timestamp = MAX (*timestamp, get_mtime (&buf));
+
+  if (depth >= MAX_PPD_DIR_DEPTH)
+    return;
+
+  dir = opendir (path);
+  if (dir == NULL)
+    return;
+
+  while ((entry = readdir (dir)) != NULL)
+    {
+      g_autofree gchar *child = NULL;
+
+      if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN)
+        continue;
+
+      if (g_str_equal (entry->d_name, ".") || g_str_equal (entry->d_name, ".."))
+        continue;
+
+      child = g_build_filename (path, entry->d_name, NULL);
+      update_dir_timestamp (child, depth + 1, timestamp);
+    }
+
+  closedir (dir);
+}
+
+/*
+ * Returns the time of the last change to the installed drivers, or -1 if
+ * the list of PPDs shouldn't be cached because the CUPS server isn't the
+ * local one.
+ */
+gint64
+ppd_catalog_get_timestamp (void)
+{
+  g_autofree gchar *ppds_dat = NULL;
+  const gchar      *server;
+  const gchar      *cache_dir;
+  struct stat       buf;
+  gint64            timestamp = 0;
+  gint              i;
+
+  server = cupsServer ();
+  if (server == NULL ||
+      (server[0] != '/' &&
+       g_strcmp0 (server, "localhost") != 0 &&
+       !g_str_has_prefix (server, "localhost:")))
+    return -1;
+
+  /* cups-driverd keeps the list of drivers it found there */
+  cache_dir = g_getenv ("CUPS_CACHEDIR");
+  ppds_dat = g_build_filename (cache_dir != NULL ? cache_dir : "/var/cache/cups", "ppds.dat", NULL);
+  if (stat (ppds_dat, &buf) == 0)
+    timestamp = get_mtime (&buf);
+
+  for (i = 0; i < G_N_ELEMENTS (ppd_dirs); i++)
+    update_dir_timestamp (ppd_dirs[i], 0, &timestamp);
+
+  return timestamp;
+}
+
+/*
+ * Returns the list of PPDs saved with the given timestamp, or NULL
+ * if there is none.
+ */
+PPDList *
+ppd_catalog_load (gint64 timestamp)
+{
+  g_autoptr(GMappedFile) mapped_file = NULL;
+  g_autoptr(GBytes)      bytes = NULL;
+  g_autoptr(GVariant)    catalog = NULL;
+  g_autoptr(GVariant)    strings_variant = NULL;
+  g_autoptr(GVariant)    manufacturers_variant = NULL;
+  g_autoptr(GVariant)    ppds_variant = NULL;
+  g_autofree gchar      *filename = NULL;
+  g_autofree const gchar **strings = NULL;
+  const CatalogManufacturer *manufacturers;
+  const CatalogPPD      *ppds;
+  const gchar           *catalog_server;
+  PPDList               *list;
+  guint32                version;
+  gint64                 catalog_timestamp;
+  gsize                  n_strings;
+  gsize                  n_manufacturers;
+  gsize                  n_ppds;
+  gsize                  i, j;
+
+  filename = get_catalog_filename ();
+  mapped_file = g_mapped_file_new (filename, FALSE, NULL);
+  if (mapped_file == NULL)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  catalog = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (CATALOG_VARIANT_TYPE), bytes, FALSE));
+
+  /* Mapped data from disk isn't trusted until it's normalised */
+  if (!g_variant_is_normal_form (catalog))
+    {
+      g_debug ("Ignoring corrupt PPD catalog %s", filename);
+      return NULL;
+    }
+
+  g_variant_get (catalog, "(u&sx@as@a(uuuu)@a(uu))",
+                 &version,
+                 &catalog_server,
+                 &catalog_timestamp,
+                 &strings_variant,
+                 &manufacturers_variant,
+                 &ppds_variant);
+  if (version != CATALOG_VERSION ||
+      catalog_timestamp != timestamp ||
+      g_strcmp0 (catalog_server, cupsServer ()) != 0)
+    return NULL;
+
+  strings = g_variant_get_strv (strings_variant, &n_strings);
+  manufacturers = g_variant_get_fixed_array (manufacturers_variant, &n_manufacturers, sizeof (CatalogManufacturer));
+  ppds = g_variant_get_fixed_array (ppds_variant, &n_ppds, sizeof (CatalogPPD));
+
+  for (i = 0; i < n_manufacturers; i++)
+    {
+      if (manufacturers[i].name >= n_strings ||
+          manufacturers[i].display_name >= n_strings ||
+          (guint64) manufacturers[i].first_ppd + manufacturers[i].n_ppds > n_ppds)
+        {
+          g_debug ("Ignoring corrupt PPD catalog %s", filename);
+          return NULL;
+        }
+    }
+
+  for (i = 0; i < n_ppds; i++)
+    {
+      if (ppds[i].name >= n_strings || ppds[i].display_name >= n_strings)
+        {
+          g_debug ("Ignoring corrupt PPD catalog %s", filename);
+          return NULL;
+        }
+    }
+
+  list = g_new0 (PPDList, 1);
+  list->num_of_manufacturers = n_manufacturers;
+  list->manufacturers = g_new0 (PPDManufacturerItem *, n_manufacturers);
+
+  for (i = 0; i < n_manufacturers; i++)
+    {
+      const CatalogManufacturer *manufacturer = &manufacturers[i];
+      PPDManufacturerItem       *item;
+
+      item = g_new0 (PPDManufacturerItem, 1);
+      item->manufacturer_name = g_strdup (strings[manufacturer->name]);
+      item->manufacturer_display_name = g_strdup (strings[manufacturer->display_name]);
+      item->num_of_ppds = manufacturer->n_ppds;
+      item->ppds = g_new0 (PPDName *, manufacturer->n_ppds);
+
+      for (j = 0; j < manufacturer->n_ppds; j++)
+        {
+          const CatalogPPD *ppd = &ppds[manufacturer->first_ppd + j];
+
+          item->ppds[j] = g_new0 (PPDName, 1);
+          item->ppds[j]->ppd_name = g_strdup (strings[ppd->name]);
+          item->ppds[j]->ppd_display_name = g_strdup (strings[ppd->display_name]);
+          item->ppds[j]->ppd_match_level = -1;
+        }
+
+      list->manufacturers[i] = item;
+    }
+
+  return list;
+}
+
+static guint32
+intern_string (GHashTable  *string_ids,
+               GPtrArray   *strings,
+               const gchar *string)
+{
+  gpointer id;
+
+  if (g_hash_table_lookup_extended (string_ids, string, NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  g_hash_table_insert (string_ids, (gpointer) string, GUINT_TO_POINTER (strings->len));
+  g_ptr_array_add (strings, (gpointer) string);
+
+  return strings->len - 1;
+}
+
+void
+ppd_catalog_save (PPDList *list,
+                  gint64   timestamp)
+{
+  g_autoptr(GHashTable) string_ids = NULL;
+  g_autoptr(GPtrArray)  strings = NULL;
+  g_autoptr(GArray)     manufacturers = NULL;
+  g_autoptr(GArray)     ppds = NULL;
+  g_autoptr(GVariant)   catalog = NULL;
+  g_autoptr(GError)     error = NULL;
+  g_autofree gchar     *filename = NULL;
+  g_autofree gchar     *dirname = NULL;
+  gsize                 i, j;
+
+  string_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  strings = g_ptr_array_new ();
+  manufacturers = g_array_sized_new (FALSE, FALSE, sizeof (CatalogManufacturer), list->num_of_manufacturers);
+  ppds = g_array_new (FALSE, FALSE, sizeof (CatalogPPD));
+
+  for (i = 0; i < list->num_of_manufacturers; i++)
+    {
+      PPDManufacturerItem *item = list->manufacturers[i];
+      CatalogManufacturer  manufacturer;
+
+      manufacturer.name = intern_string (string_ids, strings, item->manufacturer_name);
+      manufacturer.display_name = intern_string (string_ids, strings, item->manufacturer_display_name);
+      manufacturer.first_ppd = ppds->len;
+      manufacturer.n_ppds = item->num_of_ppds;
+      g_array_append_val (manufacturers, manufacturer);
+
+      for (j = 0; j < item->num_of_ppds; j++)
+        {
+          CatalogPPD ppd;
+
+          ppd.name = intern_string (string_ids, strings, item->ppds[j]->ppd_name);
+          ppd.display_name = intern_string (string_ids, strings, item->ppds[j]->ppd_display_name);
+          g_array_append_val (ppds, ppd);
+        }
+    }
+
+  g_ptr_array_add (strings, NULL);
+
+  catalog = g_variant_ref_sink (g_variant_new ("(usx^as@a(uuuu)@a(uu))",
+                                               CATALOG_VERSION,
+                                               cupsServer (),
+                                               timestamp,
+                                               (const gchar * const *) strings->pdata,
+                                               g_variant_new_fixed_array (G_VARIANT_TYPE ("(uuuu)"),
+                                                                          manufacturers->data,
+                                                                          manufacturers->len,
+                                                                          sizeof (CatalogManufacturer)),
+                                               g_variant_new_fixed_array (G_VARIANT_TYPE ("(uu)"),
+                                                                          ppds->data,
+                                                                          ppds->len,
+                                                                          sizeof (CatalogPPD))));
+
+  filename = get_catalog_filename ();
+  dirname = g_path_get_dirname (filename);
+
+  if (g_mkdir_with_parents (dirname, 0700) != 0 ||
+      !g_file_set_contents (filename,
+                            g_variant_get_data (catalog),
+                            g_variant_get_size (catalog),
+                            &error))
+    g_debug ("Failed to save PPD catalog %s: %s",
+             filename, error ? error->message : g_strerror (errno));
+}
@@ -681,20 +681,10 @@ pp_printer_entry_get_location (PpPrinterEntry *self)
   return self->printer_location;
 }
 
-void
-pp_printer_entry_update (PpPrinterEntry *self,
-                         cups_dest_t     printer,
-                         gboolean        is_authorized)
+static void
+update_state (PpPrinterEntry *self,
+              const gchar    *reason)
 {
-  cups_ptype_t      printer_type = 0;
-  gboolean          is_accepting_jobs = TRUE;
-  gboolean          ink_supply_is_empty;
-  g_autofree gchar *instance = NULL;
-  const gchar      *printer_uri = NULL;
-  const gchar      *device_uri = NULL;
-  const gchar      *location = NULL;
-  const gchar      *printer_make_and_model = NULL;
-  const gchar      *reason = NULL;
   gchar           **printer_reasons = NULL;
   g_autofree gchar *status = NULL;
   g_autofree gchar *printer_status = NULL;
@@ -756,62 +746,6 @@ pp_printer_entry_update (PpPrinterEntry *self,
       N_("The optical photo conductor is no longer functioning")
     };
 
-  if (printer.instance)
-    {
-      instance = g_strdup_printf ("%s / %s", printer.name, printer.instance);
-    }
-  else
-    {
-      instance = g_strdup (printer.name);
-    }
-
-  self->printer_state = PRINTER_READY;
-
-  for (i = 0; i < printer.num_options; i++)
-    {
-      if (g_strcmp0 (printer.options[i].name, "device-uri") == 0)
-        device_uri = printer.options[i].value;
-      else if (g_strcmp0 (printer.options[i].name, "printer-uri-supported") == 0)
-        printer_uri = printer.options[i].value;
-      else if (g_strcmp0 (printer.options[i].name, "printer-type") == 0)
-        printer_type = atoi (printer.options[i].value);
-      else if (g_strcmp0 (printer.options[i].name, "printer-location") == 0)
-        location = printer.options[i].value;
-      else if (g_strcmp0 (printer.options[i].name, "printer-state-reasons") == 0)
-        reason = printer.options[i].value;
-      else if (g_strcmp0 (printer.options[i].name, "marker-names") == 0)
-        {
-          g_free (self->inklevel->marker_names);
-          self->inklevel->marker_names = g_strcompress (g_strdup (printer.options[i].value));
-        }
-      else if (g_strcmp0 (printer.options[i].name, "marker-levels") == 0)
-        {
-          g_free (self->inklevel->marker_levels);
-          self->inklevel->marker_levels = g_strdup (printer.options[i].value);
-        }
-      else if (g_strcmp0 (printer.options[i].name, "marker-colors") == 0)
-        {
-          g_free (self->inklevel->marker_colors);
-          self->inklevel->marker_colors = g_strdup (printer.options[i].value);
-        }
-      else if (g_strcmp0 (printer.options[i].name, "marker-types") == 0)
-        {
-          g_free (self->inklevel->marker_types);
-          self->inklevel->marker_types = g_strdup (printer.options[i].value);
-        }
-      else if (g_strcmp0 (printer.options[i].name, "printer-make-and-model") == 0)
-        printer_make_and_model = printer.options[i].value;
-      else if (g_strcmp0 (printer.options[i].name, "printer-state") == 0)
-        self->printer_state = atoi (printer.options[i].value);
-      else if (g_strcmp0 (printer.options[i].name, "printer-is-accepting-jobs") == 0)
-        {
-          if (g_strcmp0 (printer.options[i].value, "true") == 0)
-            is_accepting_jobs = TRUE;
-          else
-            is_accepting_jobs = FALSE;
-        }
-    }
-
   /* Find the first of the most severe reasons
    * and show it in the status field
    */
@@ -856,7 +790,7 @@ pp_printer_entry_update (PpPrinterEntry *self,
         status = g_strdup (_(statuses[report_index]));
     }
 
-  if ((self->printer_state == PRINTER_STOPPED || !is_accepting_jobs) &&
+  if ((self->printer_state == PRINTER_STOPPED || !self->is_accepting_jobs) &&
       status != NULL && status[0] != '\0')
     {
       gtk_label_set_label (self->error_status, status);
@@ -871,7 +805,7 @@ pp_printer_entry_update (PpPrinterEntry *self,
   switch (self->printer_state)
     {
       case PRINTER_READY:
-        if (is_accepting_jobs)
+        if (self->is_accepting_jobs)
           {
             /* Translators: Printer's state (can start new job without waiting) */
             printer_status = g_strdup ( C_("printer state", "Ready"));
@@ -892,16 +826,92 @@ pp_printer_entry_update (PpPrinterEntry *self,
         break;
     }
 
+  gtk_label_set_text (self->printer_status, printer_status);
+}
+
+void
+pp_printer_entry_update (PpPrinterEntry *self,
+                         cups_dest_t     printer,
+                         gboolean        is_authorized)
+{
+  cups_ptype_t      printer_type = 0;
+  gboolean          is_accepting_jobs = TRUE;
+  gboolean          ink_supply_is_empty;
+  g_autofree gchar *instance = NULL;
+  const gchar      *printer_uri = NULL;
+  const gchar      *device_uri = NULL;
+  const gchar      *location = NULL;
+  const gchar      *printer_make_and_model = NULL;
+  const gchar      *reason = NULL;
+  int               i;
+
+  if (printer.instance)
+    {
+      instance = g_strdup_printf ("%s / %s", printer.name, printer.instance);
+    }
+  else
+    {
+      instance = g_strdup (printer.name);
+    }
+
+  self->printer_state = PRINTER_READY;
+
+  for (i = 0; i < printer.num_options; i++)
+    {
+      if (g_strcmp0 (printer.options[i].name, "device-uri") == 0)
+        device_uri = printer.options[i].value;
+      else if (g_strcmp0 (printer.options[i].name, "printer-uri-supported") == 0)
+        printer_uri = printer.options[i].value;
+      else if (g_strcmp0 (printer.options[i].name, "printer-type") == 0)
+        printer_type = atoi (printer.options[i].value);
+      else if (g_strcmp0 (printer.options[i].name, "printer-location") == 0)
+        location = printer.options[i].value;
+      else if (g_strcmp0 (printer.options[i].name, "printer-state-reasons") == 0)
+        reason = printer.options[i].value;
+      else if (g_strcmp0 (printer.options[i].name, "marker-names") == 0)
+        {
+          g_free (self->inklevel->marker_names);
+          self->inklevel->marker_names = g_strcompress (g_strdup (printer.options[i].value));
+        }
+      else if (g_strcmp0 (printer.options[i].name, "marker-levels") == 0)
+        {
+          g_free (self->inklevel->marker_levels);
+          self->inklevel->marker_levels = g_strdup (printer.options[i].value);
+        }
+      else if (g_strcmp0 (printer.options[i].name, "marker-colors") == 0)
+        {
+          g_free (self->inklevel->marker_colors);
+          self->inklevel->marker_colors = g_strdup (printer.options[i].value);
+        }
+      else if (g_strcmp0 (printer.options[i].name, "marker-types") == 0)
+        {
+          g_free (self->inklevel->marker_types);
+          self->inklevel->marker_types = g_strdup (printer.options[i].value);
+        }
+      else if (g_strcmp0 (printer.options[i].name, "printer-make-and-model") == 0)
+        printer_make_and_model = printer.options[i].value;
+      else if (g_strcmp0 (printer.options[i].name, "printer-state") == 0)
+        self->printer_state = atoi (printer.options[i].value);
+      else if (g_strcmp0 (printer.options[i].name, "printer-is-accepting-jobs") == 0)
+        {
+          if (g_strcmp0 (printer.options[i].value, "true") == 0)
+            is_accepting_jobs = TRUE;
+          else
+            is_accepting_jobs = FALSE;
+        }
+    }
+
+  self->is_accepting_jobs = is_accepting_jobs;
+  update_state (self, reason);
+
   g_free (self->printer_location);
   self->printer_location = g_strdup (location);
 
-  self->is_accepting_jobs = is_accepting_jobs;
   self->is_authorized = is_authorized;
 
   g_free (self->printer_hostname);
   self->printer_hostname = printer_get_hostname (printer_type, device_uri, printer_uri);
 
-  gtk_label_set_text (self->printer_status, printer_status);
   gtk_label_set_text (self->printer_name_label, instance);
   self->is_default = printer.is_default;
   g_object_notify (G_OBJECT (self), "default");
@@ -938,6 +948,53 @@ pp_printer_entry_update (PpPrinterEntry *self,
   gtk_widget_action_set_enabled (GTK_WIDGET (self), "printer.remove", self->is_authorized);
 }
 
+/*
+ * Updates only the state of the printer, as told by a notification
+ * from CUPS, without looking at its other attributes again.
+ */
+void
+pp_printer_entry_update_state (PpPrinterEntry *self,
+                               gint            printer_state,
+                               const gchar    *printer_state_reasons,
+                               gboolean        is_accepting_jobs)
+{
+  g_return_if_fail (PP_IS_PRINTER_ENTRY (self));
+
+  self->printer_state = printer_state;
+  self->is_accepting_jobs = is_accepting_jobs;
+  update_state (self, printer_state_reasons);
+}
+
+/*
+ * Updates only the supply levels of the printer, as asked for again
+ * after a notification from CUPS.
+ */
+void
+pp_printer_entry_update_markers (PpPrinterEntry *self,
+                                 const gchar    *marker_names,
+                                 const gchar    *marker_levels,
+                                 const gchar    *marker_colors,
+                                 const gchar    *marker_types)
+{
+  gboolean ink_supply_is_empty;
+
+  g_return_if_fail (PP_IS_PRINTER_ENTRY (self));
+
+  g_free (self->inklevel->marker_names);
+  self->inklevel->marker_names = g_strdup (marker_names);
+  g_free (self->inklevel->marker_levels);
+  self->inklevel->marker_levels = g_strdup (marker_levels);
+  g_free (self->inklevel->marker_colors);
+  self->inklevel->marker_colors = g_strdup (marker_colors);
+  g_free (self->inklevel->marker_types);
+  self->inklevel->marker_types = g_strdup (marker_types);
+
+  ink_supply_is_empty = supply_level_is_empty (self);
+  gtk_widget_set_visible (GTK_WIDGET (self->printer_inklevel_label), !ink_supply_is_empty);
+  gtk_widget_set_visible (GTK_WIDGET (self->supply_frame), !ink_supply_is_empty);
+  gtk_widget_queue_draw (GTK_WIDGET (self->supply_drawing_area));
+}
+
 static void
 set_compact (PpPrinterEntry *self,
              gboolean        compact)
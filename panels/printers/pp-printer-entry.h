@@ -43,3 +43,14 @@ void            pp_printer_entry_authenticate_jobs (PpPrinterEntry *self);
 void            pp_printer_entry_update (PpPrinterEntry *self,
                                          cups_dest_t     printer,
                                          gboolean        is_authorized);
+
+void            pp_printer_entry_update_state (PpPrinterEntry *self,
+                                               gint            printer_state,
+                                               const gchar    *printer_state_reasons,
+                                               gboolean        is_accepting_jobs);
+
+void            pp_printer_entry_update_markers (PpPrinterEntry *self,
+                                                 const gchar    *marker_names,
+                                                 const gchar    *marker_levels,
+                                                 const gchar    *marker_colors,
+                                                 const gchar    *marker_types);
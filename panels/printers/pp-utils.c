@@ -26,6 +26,7 @@
 #include <cups/cups.h>
 #include <cups/ppd.h>
 
+#include "pp-ppd-catalog.h"
 #include "pp-utils.h"
 
 #define DBUS_TIMEOUT      120000
@@ -1169,26 +1170,176 @@ get_page_size_from_locale (void)
     return "A4";
 }
 
+/*
+ * The IPP requests of some of the functions below are made one after
+ * another by a single worker thread, rather than each by a thread of its
+ * own. The worker keeps its connection to the CUPS server open between
+ * requests, libcups keeps it per thread for CUPS_HTTP_DEFAULT. Attributes
+ * wanted for several printers at the same time are asked for at once.
+ *
+ * Requests which can take long, those to remote servers and those
+ * downloading several PPDs, get a thread of their own so that they don't
+ * hold up the others. The connections to remote servers are kept for
+ * REMOTE_CONNECTION_IDLE_TIMEOUT seconds after their last use.
+ */
+typedef struct
+{
+  GThreadFunc func;
+  gpointer    data;
+} IPPWorkerJob;
+
+#define REMOTE_CONNECTION_IDLE_TIMEOUT 60
+
+typedef struct
+{
+  http_t *http;
+  gint64  last_used;
+} RemoteConnection;
+
+static void
+remote_connection_free (RemoteConnection *connection)
+{
+  httpClose (connection->http);
+  g_free (connection);
+}
+
+/* Only holds the connections not in use by any thread */
+G_LOCK_DEFINE_STATIC (remote_connections);
+static GHashTable *remote_connections = NULL; /* "host:port" → RemoteConnection */
+static guint       remote_connections_timeout_id = 0;
+
+static gboolean
+remote_connections_timeout_cb (gpointer user_data)
+{
+  GHashTableIter    iter;
+  RemoteConnection *connection;
+  gint64            now = g_get_monotonic_time ();
+  gboolean          result = G_SOURCE_CONTINUE;
+
+  G_LOCK (remote_connections);
+
+  g_hash_table_iter_init (&iter, remote_connections);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &connection))
+    {
+      if (now - connection->last_used >= REMOTE_CONNECTION_IDLE_TIMEOUT * G_TIME_SPAN_SECOND)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  if (g_hash_table_size (remote_connections) == 0)
+    {
+      remote_connections_timeout_id = 0;
+      result = G_SOURCE_REMOVE;
+    }
+
+  G_UNLOCK (remote_connections);
+
+  return result;
+}
+
+/*
+ * Returns a connection to host_name:port for the calling thread alone,
+ * to be given back by remote_connection_release().
+ */
+static http_t *
+remote_connection_take (const gchar *host_name,
+                        gint         port)
+{
+  g_autofree gchar *key = g_strdup_printf ("%s:%d", host_name, port);
+  RemoteConnection *connection = NULL;
+  http_t           *http = NULL;
+
+  G_LOCK (remote_connections);
+  if (remote_connections != NULL &&
+      g_hash_table_steal_extended (remote_connections, key, NULL, (gpointer *) &connection))
+    {
+      http = connection->http;
+      g_free (connection);
+    }
+  G_UNLOCK (remote_connections);
+
+  if (http == NULL)
+    {
+#ifdef HAVE_CUPS_HTTPCONNECT2
+      http = httpConnect2 (host_name, port, NULL, AF_UNSPEC,
+                           HTTP_ENCRYPTION_IF_REQUESTED, 1, 30000, NULL);
+#else
+      http = httpConnect (host_name, port);
+#endif
+    }
+
+  return http;
+}
+
+/*
+ * Keeps the connection for later requests, or closes it if reuse is FALSE,
+ * e.g. when the server may have closed it.
+ */
+static void
+remote_connection_release (const gchar *host_name,
+                           gint         port,
+                           http_t      *http,
+                           gboolean     reuse)
+{
+  g_autofree gchar *key = g_strdup_printf ("%s:%d", host_name, port);
+  RemoteConnection *connection;
+
+  if (!reuse)
+    {
+      httpClose (http);
+      return;
+    }
+
+  G_LOCK (remote_connections);
+
+  if (remote_connections == NULL)
+    remote_connections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) remote_connection_free);
+
+  /* Another thread may have connected to the same server meanwhile */
+  if (g_hash_table_contains (remote_connections, key))
+    {
+      httpClose (http);
+    }
+  else
+    {
+      connection = g_new0 (RemoteConnection, 1);
+      connection->http = http;
+      connection->last_used = g_get_monotonic_time ();
+      g_hash_table_insert (remote_connections, g_steal_pointer (&key), connection);
+    }
+
+  if (remote_connections_timeout_id == 0)
+    remote_connections_timeout_id = g_timeout_add_seconds (REMOTE_CONNECTION_IDLE_TIMEOUT,
+                                                           remote_connections_timeout_cb,
+                                                           NULL);
+
+  G_UNLOCK (remote_connections);
+}
+
 typedef struct
 {
   gchar        *printer_name;
   gchar       **attributes_names;
   GHashTable   *result;
+  GCancellable *cancellable;
   GIACallback   callback;
   gpointer      user_data;
+  GDestroyNotify user_data_free; /* Called instead of callback once cancelled */
   GMainContext *context;
 } GIAData;
 
 static GIAData *
-gia_data_new (const gchar *printer_name, gchar **attributes_names, GIACallback callback, gpointer user_data)
+gia_data_new (const gchar *printer_name, gchar **attributes_names, GCancellable *cancellable, GIACallback callback, gpointer user_data, GDestroyNotify user_data_free)
 {
   GIAData *data;
 
   data = g_new0 (GIAData, 1);
   data->printer_name = g_strdup (printer_name);
   data->attributes_names = g_strdupv (attributes_names);
+  if (cancellable)
+    data->cancellable = g_object_ref (cancellable);
   data->callback = callback;
   data->user_data = user_data;
+  data->user_data_free = user_data_free;
   data->context = g_main_context_ref_thread_default ();
 
   return data;
@@ -1202,6 +1353,7 @@ gia_data_free (GIAData *data)
     g_strfreev (data->attributes_names);
   if (data->result)
     g_hash_table_unref (data->result);
+  g_clear_object (&data->cancellable);
   if (data->context)
     g_main_context_unref (data->context);
   g_free (data);
@@ -1212,8 +1364,15 @@ get_ipp_attributes_idle_cb (gpointer user_data)
 {
   GIAData *data = (GIAData *) user_data;
 
-  data->callback (data->result, data->user_data);
-  data->result = NULL;
+  if (!g_cancellable_is_cancelled (data->cancellable))
+    {
+      data->callback (data->result, data->user_data);
+      data->result = NULL;
+    }
+  else if (data->user_data_free)
+    {
+      data->user_data_free (data->user_data);
+    }
 
   return FALSE;
 }
@@ -1239,136 +1398,320 @@ ipp_attribute_free2 (gpointer attr)
   ipp_attribute_free (attribute);
 }
 
-static gpointer
-get_ipp_attributes_func (gpointer user_data)
+static void
+gia_data_add_attribute (GIAData         *data,
+                        const gchar     *attribute_name,
+                        ipp_attribute_t *attr)
 {
-  ipp_attribute_t  *attr = NULL;
-  GIAData          *data = user_data;
-  ipp_t            *request;
-  ipp_t            *response = NULL;
-  g_autofree gchar *printer_uri = NULL;
-  char            **requested_attrs = NULL;
-  gint              i, j, length = 0;
+  IPPAttribute *attribute;
+  gint          i;
 
-  printer_uri = g_strdup_printf ("ipp://localhost/printers/%s", data->printer_name);
+  if (ippGetCount (attr) <= 0 || ippGetValueTag (attr) == IPP_TAG_NOVALUE)
+    return;
 
-  if (data->attributes_names)
+  attribute = g_new0 (IPPAttribute, 1);
+  attribute->attribute_name = g_strdup (attribute_name);
+  attribute->attribute_values = g_new0 (IPPAttributeValue, ippGetCount (attr));
+  attribute->num_of_values = ippGetCount (attr);
+
+  if (ippGetValueTag (attr) == IPP_TAG_INTEGER ||
+      ippGetValueTag (attr) == IPP_TAG_ENUM)
     {
-      length = g_strv_length (data->attributes_names);
+      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_INTEGER;
 
-      requested_attrs = g_new0 (char *, length);
-      for (i = 0; data->attributes_names[i]; i++)
-        requested_attrs[i] = g_strdup (data->attributes_names[i]);
+      for (i = 0; i < ippGetCount (attr); i++)
+        attribute->attribute_values[i].integer_value = ippGetInteger (attr, i);
+    }
+  else if (ippGetValueTag (attr) == IPP_TAG_NAME ||
+           ippGetValueTag (attr) == IPP_TAG_STRING ||
+           ippGetValueTag (attr) == IPP_TAG_TEXT ||
+           ippGetValueTag (attr) == IPP_TAG_URI ||
+           ippGetValueTag (attr) == IPP_TAG_KEYWORD ||
+           ippGetValueTag (attr) == IPP_TAG_URISCHEME)
+    {
+      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_STRING;
 
-      request = ippNewRequest (IPP_GET_PRINTER_ATTRIBUTES);
-      ippAddString (request, IPP_TAG_OPERATION, IPP_TAG_URI,
-                    "printer-uri", NULL, printer_uri);
-      ippAddStrings (request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
-                     "requested-attributes", length, NULL, (const char **) requested_attrs);
-      response = cupsDoRequest (CUPS_HTTP_DEFAULT, request, "/");
+      for (i = 0; i < ippGetCount (attr); i++)
+        attribute->attribute_values[i].string_value = g_strdup (ippGetString (attr, i, NULL));
+    }
+  else if (ippGetValueTag (attr) == IPP_TAG_RANGE)
+    {
+      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_RANGE;
+
+      for (i = 0; i < ippGetCount (attr); i++)
+        {
+          attribute->attribute_values[i].lower_range =
+            ippGetRange (attr, i, &(attribute->attribute_values[i].upper_range));
+        }
+    }
+  else if (ippGetValueTag (attr) == IPP_TAG_BOOLEAN)
+    {
+      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_BOOLEAN;
+
+      for (i = 0; i < ippGetCount (attr); i++)
+        attribute->attribute_values[i].boolean_value = ippGetBoolean (attr, i);
     }
 
+  if (!data->result)
+    data->result = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ipp_attribute_free2);
+
+  g_hash_table_insert (data->result, g_strdup (attribute_name), attribute);
+}
+
+static void
+get_ipp_attributes_request (GIAData *data)
+{
+  ipp_attribute_t  *attr = NULL;
+  ipp_t            *request;
+  ipp_t            *response;
+  g_autofree gchar *printer_uri = NULL;
+  gint              j, length;
+
+  if (!data->attributes_names || g_cancellable_is_cancelled (data->cancellable))
+    return;
+
+  printer_uri = g_strdup_printf ("ipp://localhost/printers/%s", data->printer_name);
+  length = g_strv_length (data->attributes_names);
+
+  request = ippNewRequest (IPP_GET_PRINTER_ATTRIBUTES);
+  ippAddString (request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                "printer-uri", NULL, printer_uri);
+  ippAddStrings (request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
+                 "requested-attributes", length, NULL, (const char **) data->attributes_names);
+  response = cupsDoRequest (CUPS_HTTP_DEFAULT, request, "/");
+
   if (response)
     {
       if (ippGetStatusCode (response) <= IPP_OK_CONFLICT)
         {
           for (j = 0; j < length; j++)
             {
-              attr = ippFindAttribute (response, requested_attrs[j], IPP_TAG_ZERO);
-              if (attr && ippGetCount (attr) > 0 && ippGetValueTag (attr) != IPP_TAG_NOVALUE)
-                {
-                  IPPAttribute *attribute;
+              attr = ippFindAttribute (response, data->attributes_names[j], IPP_TAG_ZERO);
+              if (attr)
+                gia_data_add_attribute (data, data->attributes_names[j], attr);
+            }
+        }
 
-                  attribute = g_new0 (IPPAttribute, 1);
-                  attribute->attribute_name = g_strdup (requested_attrs[j]);
-                  attribute->attribute_values = g_new0 (IPPAttributeValue, ippGetCount (attr));
-                  attribute->num_of_values = ippGetCount (attr);
+      ippDelete (response);
+    }
+}
 
-                  if (ippGetValueTag (attr) == IPP_TAG_INTEGER ||
-                      ippGetValueTag (attr) == IPP_TAG_ENUM)
-                    {
-                      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_INTEGER;
+static gpointer
+get_ipp_attributes_func (gpointer user_data)
+{
+  GIAData *data = user_data;
 
-                      for (i = 0; i < ippGetCount (attr); i++)
-                        attribute->attribute_values[i].integer_value = ippGetInteger (attr, i);
-                    }
-                  else if (ippGetValueTag (attr) == IPP_TAG_NAME ||
-                           ippGetValueTag (attr) == IPP_TAG_STRING ||
-                           ippGetValueTag (attr) == IPP_TAG_TEXT ||
-                           ippGetValueTag (attr) == IPP_TAG_URI ||
-                           ippGetValueTag (attr) == IPP_TAG_KEYWORD ||
-                           ippGetValueTag (attr) == IPP_TAG_URISCHEME)
-                    {
-                      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_STRING;
+  get_ipp_attributes_request (data);
+  get_ipp_attributes_cb (data);
 
-                      for (i = 0; i < ippGetCount (attr); i++)
-                        attribute->attribute_values[i].string_value = g_strdup (ippGetString (attr, i, NULL));
-                    }
-                  else if (ippGetValueTag (attr) == IPP_TAG_RANGE)
-                    {
-                      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_RANGE;
+  return NULL;
+}
 
-                      for (i = 0; i < ippGetCount (attr); i++)
-                        {
-                          attribute->attribute_values[i].lower_range =
-                            ippGetRange (attr, i, &(attribute->attribute_values[i].upper_range));
-                        }
-                    }
-                  else if (ippGetValueTag (attr) == IPP_TAG_BOOLEAN)
-                    {
-                      attribute->attribute_type = IPP_ATTRIBUTE_TYPE_BOOLEAN;
+static void
+gia_data_add_printer_attributes (GPtrArray   *batch,
+                                 gboolean    *answered,
+                                 const gchar *printer_name,
+                                 GPtrArray   *attrs)
+{
+  guint i, j;
 
-                      for (i = 0; i < ippGetCount (attr); i++)
-                        attribute->attribute_values[i].boolean_value = ippGetBoolean (attr, i);
-                    }
+  for (i = 0; i < batch->len; i++)
+    {
+      GIAData *data = g_ptr_array_index (batch, i);
 
-                  if (!data->result)
-                    data->result = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, ipp_attribute_free2);
+      if (answered[i] || g_strcmp0 (data->printer_name, printer_name) != 0)
+        continue;
 
-                  g_hash_table_insert (data->result, g_strdup (requested_attrs[j]), attribute);
-                }
+      for (j = 0; j < attrs->len; j++)
+        {
+          ipp_attribute_t *attr = g_ptr_array_index (attrs, j);
+
+          if (g_strv_contains ((const gchar * const *) data->attributes_names, ippGetName (attr)))
+            gia_data_add_attribute (data, ippGetName (attr), attr);
+        }
+
+      answered[i] = TRUE;
+    }
+}
+
+/*
+ * Gets the attributes of several printers with a single CUPS-Get-Printers
+ * request. The printers it doesn't list, like classes, are asked about
+ * one by one.
+ */
+static void
+get_ipp_attributes_batch (GPtrArray *batch)
+{
+  g_autoptr(GHashTable) names = NULL;
+  g_autoptr(GPtrArray)  requested_attrs = NULL;
+  g_autofree gboolean  *answered = NULL;
+  ipp_attribute_t      *attr;
+  ipp_t                *request;
+  ipp_t                *response;
+  guint                 i, j;
+
+  names = g_hash_table_new (g_str_hash, g_str_equal);
+  requested_attrs = g_ptr_array_new ();
+  answered = g_new0 (gboolean, batch->len);
+
+  g_hash_table_add (names, (gpointer) "printer-name");
+  g_ptr_array_add (requested_attrs, (gpointer) "printer-name");
+
+  for (i = 0; i < batch->len; i++)
+    {
+      GIAData *data = g_ptr_array_index (batch, i);
+
+      if (!data->attributes_names || g_cancellable_is_cancelled (data->cancellable))
+        {
+          answered[i] = TRUE;
+          continue;
+        }
+
+      for (j = 0; data->attributes_names[j] != NULL; j++)
+        {
+          if (g_hash_table_add (names, data->attributes_names[j]))
+            g_ptr_array_add (requested_attrs, data->attributes_names[j]);
+        }
+    }
+
+  request = ippNewRequest (CUPS_GET_PRINTERS);
+  ippAddStrings (request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
+                 "requested-attributes", requested_attrs->len, NULL, (const char **) requested_attrs->pdata);
+  response = cupsDoRequest (CUPS_HTTP_DEFAULT, request, "/");
+
+  if (response && ippGetStatusCode (response) <= IPP_OK_CONFLICT)
+    {
+      attr = ippFirstAttribute (response);
+      while (attr != NULL)
+        {
+          g_autoptr(GPtrArray) attrs = g_ptr_array_new ();
+          const gchar         *printer_name = NULL;
+
+          while (attr != NULL && ippGetGroupTag (attr) != IPP_TAG_PRINTER)
+            attr = ippNextAttribute (response);
+
+          while (attr != NULL && ippGetGroupTag (attr) == IPP_TAG_PRINTER)
+            {
+              if (g_strcmp0 (ippGetName (attr), "printer-name") == 0 &&
+                  ippGetValueTag (attr) == IPP_TAG_NAME)
+                printer_name = ippGetString (attr, 0, NULL);
+
+              g_ptr_array_add (attrs, attr);
+              attr = ippNextAttribute (response);
             }
+
+          if (printer_name != NULL)
+            gia_data_add_printer_attributes (batch, answered, printer_name, attrs);
         }
+    }
 
-      ippDelete (response);
+  if (response)
+    ippDelete (response);
+
+  for (i = 0; i < batch->len; i++)
+    {
+      if (!answered[i])
+        get_ipp_attributes_request (g_ptr_array_index (batch, i));
+
+      get_ipp_attributes_cb (g_ptr_array_index (batch, i));
     }
+}
 
+static gpointer
+ipp_worker_func (gpointer user_data)
+{
+  GAsyncQueue *queue = user_data;
 
-  for (i = 0; i < length; i++)
-    g_free (requested_attrs[i]);
-  g_free (requested_attrs);
+  while (TRUE)
+    {
+      g_autoptr(GPtrArray) batch = g_ptr_array_new ();
+      g_autoptr(GPtrArray) jobs = g_ptr_array_new_with_free_func (g_free);
+      IPPWorkerJob        *job;
+      guint                i;
 
-  get_ipp_attributes_cb (data);
+      /* Take all the jobs queued while the previous ones were running */
+      job = g_async_queue_pop (queue);
+      do
+        {
+          if (job->func == get_ipp_attributes_func)
+            {
+              g_ptr_array_add (batch, job->data);
+              g_free (job);
+            }
+          else
+            {
+              g_ptr_array_add (jobs, job);
+            }
+        }
+      while ((job = g_async_queue_try_pop (queue)) != NULL);
+
+      if (batch->len > 1)
+        get_ipp_attributes_batch (batch);
+      else if (batch->len == 1)
+        get_ipp_attributes_func (g_ptr_array_index (batch, 0));
+
+      for (i = 0; i < jobs->len; i++)
+        {
+          job = g_ptr_array_index (jobs, i);
+          job->func (job->data);
+        }
+    }
 
   return NULL;
 }
 
-void
-get_ipp_attributes_async (const gchar  *printer_name,
-                          gchar       **attributes_names,
-                          GIACallback   callback,
-                          gpointer      user_data)
+static void
+ipp_worker_push (GThreadFunc func,
+                 gpointer    data)
 {
-  GIAData          *data;
-  g_autoptr(GThread) thread = NULL;
-  g_autoptr(GError) error = NULL;
+  static gsize  queue = 0;
+  IPPWorkerJob *job;
 
-  data = gia_data_new (printer_name, attributes_names, callback, user_data);
+  if (g_once_init_enter (&queue))
+    {
+      GAsyncQueue *new_queue = g_async_queue_new ();
 
-  thread = g_thread_try_new ("get-ipp-attributes",
-                             get_ipp_attributes_func,
-                             data,
-                             &error);
+      g_thread_unref (g_thread_new ("ipp-worker", ipp_worker_func, new_queue));
+      g_once_init_leave (&queue, (gsize) new_queue);
+    }
+
+  job = g_new0 (IPPWorkerJob, 1);
+  job->func = func;
+  job->data = data;
+  g_async_queue_push ((GAsyncQueue *) queue, job);
+}
 
+/*
+ * Runs a request which can take long in a thread of its own,
+ * falling back to the worker if the thread can't be created.
+ */
+static void
+ipp_thread_run (const gchar *name,
+                GThreadFunc  func,
+                gpointer     data)
+{
+  g_autoptr(GThread) thread = NULL;
+  g_autoptr(GError)  error = NULL;
+
+  thread = g_thread_try_new (name, func, data, &error);
   if (!thread)
     {
       g_warning ("%s", error->message);
-      callback (NULL, user_data);
-
-      gia_data_free (data);
+      ipp_worker_push (func, data);
     }
 }
 
+void
+get_ipp_attributes_async (const gchar  *printer_name,
+                          gchar       **attributes_names,
+                          GCancellable *cancellable,
+                          GIACallback   callback,
+                          gpointer      user_data)
+{
+  ipp_worker_push (get_ipp_attributes_func,
+                   gia_data_new (printer_name, attributes_names, cancellable, callback, user_data, NULL));
+}
+
 IPPAttribute *
 ipp_attribute_copy (IPPAttribute *attr)
 {
@@ -1729,30 +2072,20 @@ get_ppds_attribute_async (gchar       **ppds_names,
                           GPACallback   callback,
                           gpointer      user_data)
 {
-  GPAData          *data;
-  g_autoptr(GThread) thread = NULL;
-  g_autoptr(GError) error = NULL;
-
   if (!ppds_names || !attribute_name)
     {
       callback (NULL, user_data);
       return;
     }
 
-  data = gpa_data_new (ppds_names, attribute_name, callback, user_data);
-
-  thread = g_thread_try_new ("get-ppds-attribute",
-                             get_ppds_attribute_func,
-                             data,
-                             &error);
-
-  if (!thread)
-    {
-      g_warning ("%s", error->message);
-      callback (NULL, user_data);
-
-      gpa_data_free (data);
-    }
+  /* Each PPD is downloaded and parsed */
+  if (g_strv_length (ppds_names) > 1)
+    ipp_thread_run ("get-ppds-attribute",
+                    get_ppds_attribute_func,
+                    gpa_data_new (ppds_names, attribute_name, callback, user_data));
+  else
+    ipp_worker_push (get_ppds_attribute_func,
+                     gpa_data_new (ppds_names, attribute_name, callback, user_data));
 }
 
 
@@ -2306,6 +2639,14 @@ get_device_attributes_async_scb (GHashTable *result,
    g_steal_pointer (&data);
 }
 
+static void
+get_device_attributes_cancelled_cb (gpointer user_data)
+{
+  g_autoptr(GDAData) data = user_data;
+
+  data->callback (NULL, NULL, NULL, data->user_data);
+}
+
 /*
  * Get device-id, device-make-and-model and device-uri for given printer.
  */
@@ -2326,10 +2667,14 @@ get_device_attributes_async (const gchar  *printer_name,
   attributes = g_new0 (gchar *, 2);
   attributes[0] = g_strdup ("device-uri");
 
-  get_ipp_attributes_async (printer_name,
-                            attributes,
-                            get_device_attributes_async_scb,
-                            gda_data_new (printer_name, cancellable, callback, user_data));
+  /* The callback is called even if the request gets cancelled */
+  ipp_worker_push (get_ipp_attributes_func,
+                   gia_data_new (printer_name,
+                                 attributes,
+                                 cancellable,
+                                 get_device_attributes_async_scb,
+                                 gda_data_new (printer_name, cancellable, callback, user_data),
+                                 get_device_attributes_cancelled_cb));
 }
 
 /*
@@ -2493,218 +2838,237 @@ static const struct {
   { "zebra", "Zebra" },
 };
 
-static gpointer
-get_all_ppds_func (gpointer user_data)
+/* Most PPDs share a handful of manufacturers, so each name is normalized once */
+static const gchar *
+normalize_cached (GHashTable  *normalized_names,
+                  const gchar *name)
 {
-  ipp_attribute_t *attr;
-  GHashTable      *ppds_hash = NULL;
-  GHashTable      *manufacturers_hash = NULL;
-  GAPData         *data = user_data;
-  PPDName         *item;
-  ipp_t           *request;
-  ipp_t           *response;
-  GList           *list;
-  gchar           *manufacturer_display_name;
-  gint             i, j;
-
-  request = ippNewRequest (CUPS_GET_PPDS);
-  response = cupsDoRequest (CUPS_HTTP_DEFAULT, request, "/");
+  gchar *normalized_name;
 
-  if (response &&
-      ippGetStatusCode (response) <= IPP_OK_CONFLICT)
+  normalized_name = g_hash_table_lookup (normalized_names, name);
+  if (normalized_name == NULL)
     {
-      /*
-       * This hash contains names of manufacturers as keys and
-       * values are GLists of PPD names.
-       */
-      ppds_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      normalized_name = normalize (name);
+      g_hash_table_insert (normalized_names, g_strdup (name), normalized_name);
+    }
 
-      /*
-       * This hash contains all possible names of manufacturers as keys
-       * and values are just first occurrences of their equivalents.
-       * This is for mapping of e.g. "Hewlett Packard" and "HP" to the same name
-       * (the one which comes first).
-       */
-      manufacturers_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  return normalized_name;
+}
 
-      for (i = 0; i < G_N_ELEMENTS (manufacturers_names); i++)
-        {
-          g_hash_table_insert (manufacturers_hash,
-                               g_strdup (manufacturers_names[i].normalized_name),
-                               g_strdup (manufacturers_names[i].display_name));
-        }
+static gint
+compare_manufacturer_names (gconstpointer a,
+                            gconstpointer b)
+{
+  return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
 
-      for (attr = ippFirstAttribute (response); attr != NULL; attr = ippNextAttribute (response))
-        {
-          const gchar      *ppd_device_id = NULL;
-          const gchar      *ppd_make_and_model = NULL;
-          const gchar      *ppd_name = NULL;
-          const gchar      *ppd_product = NULL;
-          const gchar      *ppd_make = NULL;
-          g_autofree gchar *mdl = NULL;
-          g_autofree gchar *mfg = NULL;
-          g_autofree gchar *mfg_normalized = NULL;
+static PPDList *
+get_ppd_list_from_response (ipp_t *response)
+{
+  ipp_attribute_t     *attr;
+  g_autoptr(GHashTable) ppds_hash = NULL;
+  g_autoptr(GHashTable) manufacturers_hash = NULL;
+  g_autoptr(GHashTable) normalized_names = NULL;
+  g_autoptr(GPtrArray)  sorted_names = NULL;
+  PPDList              *result;
+  gint                  i;
 
-          while (attr != NULL && ippGetGroupTag (attr) != IPP_TAG_PRINTER)
-            attr = ippNextAttribute (response);
+  /*
+   * This hash contains names of manufacturers as keys and
+   * values are arrays of PPD names.
+   */
+  ppds_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
 
-          if (attr == NULL)
-            break;
+  /*
+   * This hash contains all possible names of manufacturers as keys
+   * and values are just first occurrences of their equivalents.
+   * This is for mapping of e.g. "Hewlett Packard" and "HP" to the same name
+   * (the one which comes first).
+   */
+  manufacturers_hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-          while (attr != NULL && ippGetGroupTag (attr) == IPP_TAG_PRINTER)
-            {
-              if (g_strcmp0 (ippGetName (attr), "ppd-device-id") == 0 &&
-                  ippGetValueTag (attr) == IPP_TAG_TEXT)
-                ppd_device_id = ippGetString (attr, 0, NULL);
-              else if (g_strcmp0 (ippGetName (attr), "ppd-make-and-model") == 0 &&
-                       ippGetValueTag (attr) == IPP_TAG_TEXT)
-                ppd_make_and_model = ippGetString (attr, 0, NULL);
-              else if (g_strcmp0 (ippGetName (attr), "ppd-name") == 0 &&
-                       ippGetValueTag (attr) == IPP_TAG_NAME)
-                ppd_name = ippGetString (attr, 0, NULL);
-              else if (g_strcmp0 (ippGetName (attr), "ppd-product") == 0 &&
-                       ippGetValueTag (attr) == IPP_TAG_TEXT)
-                ppd_product = ippGetString (attr, 0, NULL);
-              else if (g_strcmp0 (ippGetName (attr), "ppd-make") == 0 &&
-                       ippGetValueTag (attr) == IPP_TAG_TEXT)
-                ppd_make = ippGetString (attr, 0, NULL);
+  normalized_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-              attr = ippNextAttribute (response);
-            }
+  for (i = 0; i < G_N_ELEMENTS (manufacturers_names); i++)
+    {
+      g_hash_table_insert (manufacturers_hash,
+                           g_strdup (manufacturers_names[i].normalized_name),
+                           g_strdup (manufacturers_names[i].display_name));
+    }
 
-          /* Get manufacturer's name */
-          if (ppd_device_id && ppd_device_id[0] != '\0')
-            {
-              mfg = get_tag_value (ppd_device_id, "mfg");
-              if (!mfg)
-                mfg = get_tag_value (ppd_device_id, "manufacturer");
-              mfg_normalized = normalize (mfg);
-            }
+  for (attr = ippFirstAttribute (response); attr != NULL; attr = ippNextAttribute (response))
+    {
+      const gchar      *ppd_device_id = NULL;
+      const gchar      *ppd_make_and_model = NULL;
+      const gchar      *ppd_name = NULL;
+      const gchar      *ppd_product = NULL;
+      const gchar      *ppd_make = NULL;
+      const gchar      *mfg_normalized = NULL;
+      const gchar      *manufacturer_display_name;
+      g_autofree gchar *mdl = NULL;
+      g_autofree gchar *mfg = NULL;
 
-          if (!mfg &&
-              ppd_make &&
-              ppd_make[0] != '\0')
-            {
-              mfg = g_strdup (ppd_make);
-              mfg_normalized = normalize (ppd_make);
-            }
+      while (attr != NULL && ippGetGroupTag (attr) != IPP_TAG_PRINTER)
+        attr = ippNextAttribute (response);
 
-          /* Get model */
-          if (ppd_make_and_model &&
-              ppd_make_and_model[0] != '\0')
-            {
-              mdl = g_strdup (ppd_make_and_model);
-            }
+      if (attr == NULL)
+        break;
 
-          if (!mdl &&
-              ppd_product &&
-              ppd_product[0] != '\0')
-            {
-              mdl = g_strdup (ppd_product);
-            }
+      while (attr != NULL && ippGetGroupTag (attr) == IPP_TAG_PRINTER)
+        {
+          if (g_strcmp0 (ippGetName (attr), "ppd-device-id") == 0 &&
+              ippGetValueTag (attr) == IPP_TAG_TEXT)
+            ppd_device_id = ippGetString (attr, 0, NULL);
+          else if (g_strcmp0 (ippGetName (attr), "ppd-make-and-model") == 0 &&
+                   ippGetValueTag (attr) == IPP_TAG_TEXT)
+            ppd_make_and_model = ippGetString (attr, 0, NULL);
+          else if (g_strcmp0 (ippGetName (attr), "ppd-name") == 0 &&
+                   ippGetValueTag (attr) == IPP_TAG_NAME)
+            ppd_name = ippGetString (attr, 0, NULL);
+          else if (g_strcmp0 (ippGetName (attr), "ppd-product") == 0 &&
+                   ippGetValueTag (attr) == IPP_TAG_TEXT)
+            ppd_product = ippGetString (attr, 0, NULL);
+          else if (g_strcmp0 (ippGetName (attr), "ppd-make") == 0 &&
+                   ippGetValueTag (attr) == IPP_TAG_TEXT)
+            ppd_make = ippGetString (attr, 0, NULL);
+
+          attr = ippNextAttribute (response);
+        }
 
-          if (!mdl &&
-              ppd_device_id &&
-              ppd_device_id[0] != '\0')
-            {
-              mdl = get_tag_value (ppd_device_id, "mdl");
-              if (!mdl)
-                mdl = get_tag_value (ppd_device_id, "model");
-            }
+      /* Get manufacturer's name */
+      if (ppd_device_id && ppd_device_id[0] != '\0')
+        {
+          mfg = get_tag_value (ppd_device_id, "mfg");
+          if (!mfg)
+            mfg = get_tag_value (ppd_device_id, "manufacturer");
+          if (mfg)
+            mfg_normalized = normalize_cached (normalized_names, mfg);
+        }
 
-          if (ppd_name && ppd_name[0] != '\0' &&
-              mdl && mdl[0] != '\0' &&
-              mfg && mfg[0] != '\0')
-            {
-              manufacturer_display_name = g_hash_table_lookup (manufacturers_hash, mfg_normalized);
-              if (!manufacturer_display_name)
-                {
-                  g_hash_table_insert (manufacturers_hash, g_strdup (mfg_normalized), g_strdup (mfg));
-                }
-              else
-                {
-                  g_free (mfg_normalized);
-                  mfg_normalized = normalize (manufacturer_display_name);
-                }
+      if (!mfg &&
+          ppd_make &&
+          ppd_make[0] != '\0')
+        {
+          mfg = g_strdup (ppd_make);
+          mfg_normalized = normalize_cached (normalized_names, ppd_make);
+        }
 
-              item = g_new0 (PPDName, 1);
-              item->ppd_name = g_strdup (ppd_name);
-              item->ppd_display_name = g_strdup (mdl);
-              item->ppd_match_level = -1;
+      /* Get model */
+      if (ppd_make_and_model &&
+          ppd_make_and_model[0] != '\0')
+        {
+          mdl = g_strdup (ppd_make_and_model);
+        }
 
-              list = g_hash_table_lookup (ppds_hash, mfg_normalized);
-              if (list)
-                {
-                  list = g_list_append (list, item);
-                }
-              else
-                {
-                  list = g_list_append (list, item);
-                  g_hash_table_insert (ppds_hash, g_strdup (mfg_normalized), list);
-                }
-            }
+      if (!mdl &&
+          ppd_product &&
+          ppd_product[0] != '\0')
+        {
+          mdl = g_strdup (ppd_product);
+        }
 
-          if (attr == NULL)
-            break;
+      if (!mdl &&
+          ppd_device_id &&
+          ppd_device_id[0] != '\0')
+        {
+          mdl = get_tag_value (ppd_device_id, "mdl");
+          if (!mdl)
+            mdl = get_tag_value (ppd_device_id, "model");
+        }
+
+      if (ppd_name && ppd_name[0] != '\0' &&
+          mdl && mdl[0] != '\0' &&
+          mfg && mfg[0] != '\0')
+        {
+          GPtrArray *ppds;
+          PPDName   *item;
+
+          manufacturer_display_name = g_hash_table_lookup (manufacturers_hash, mfg_normalized);
+          if (!manufacturer_display_name)
+            g_hash_table_insert (manufacturers_hash, g_strdup (mfg_normalized), g_strdup (mfg));
+          else
+            mfg_normalized = normalize_cached (normalized_names, manufacturer_display_name);
+
+          item = g_new0 (PPDName, 1);
+          item->ppd_name = g_strdup (ppd_name);
+          item->ppd_display_name = g_steal_pointer (&mdl);
+          item->ppd_match_level = -1;
+
+          ppds = g_hash_table_lookup (ppds_hash, mfg_normalized);
+          if (ppds == NULL)
+            {
+              ppds = g_ptr_array_new ();
+              g_hash_table_insert (ppds_hash, g_strdup (mfg_normalized), ppds);
+            }
+          g_ptr_array_add (ppds, item);
         }
+
+      if (attr == NULL)
+        break;
     }
 
-  if (response)
-    ippDelete(response);
+  /* Sort list of manufacturers */
+  sorted_names = g_hash_table_get_keys_as_ptr_array (ppds_hash);
+  g_ptr_array_sort (sorted_names, compare_manufacturer_names);
 
-  if (ppds_hash &&
-      manufacturers_hash)
+  /*
+   * Fill resulting list of lists (list of manufacturers where
+   * each item contains list of PPD names)
+   */
+  result = g_new0 (PPDList, 1);
+  result->num_of_manufacturers = sorted_names->len;
+  result->manufacturers = g_new0 (PPDManufacturerItem *, sorted_names->len);
+
+  for (i = 0; i < sorted_names->len; i++)
     {
-      GHashTableIter  iter;
-      gpointer        key;
-      gpointer        value;
-      GList          *ppd_item;
-      GList          *sort_list = NULL;
-      GList          *list_iter;
-      gchar          *name;
+      const gchar *name = g_ptr_array_index (sorted_names, i);
+      GPtrArray   *ppds = g_hash_table_lookup (ppds_hash, name);
+      PPDManufacturerItem *manufacturer;
+      gsize        n_ppds;
 
-      data->result = g_new0 (PPDList, 1);
-      data->result->num_of_manufacturers = g_hash_table_size (ppds_hash);
-      data->result->manufacturers = g_new0 (PPDManufacturerItem *, data->result->num_of_manufacturers);
+      manufacturer = g_new0 (PPDManufacturerItem, 1);
+      manufacturer->manufacturer_name = g_strdup (name);
+      manufacturer->manufacturer_display_name = g_strdup (g_hash_table_lookup (manufacturers_hash, name));
+      manufacturer->ppds = (PPDName **) g_ptr_array_steal (ppds, &n_ppds);
+      manufacturer->num_of_ppds = n_ppds;
 
-      g_hash_table_iter_init (&iter, ppds_hash);
-      while (g_hash_table_iter_next (&iter, &key, &value))
-        {
-          sort_list = g_list_append (sort_list, g_strdup (key));
-        }
+      result->manufacturers[i] = manufacturer;
+    }
 
-      /* Sort list of manufacturers */
-      sort_list = g_list_sort (sort_list, (GCompareFunc) g_strcmp0);
+  return result;
+}
 
-      /*
-       * Fill resulting list of lists (list of manufacturers where
-       * each item contains list of PPD names)
-       */
-      i = 0;
-      for (list_iter = sort_list; list_iter; list_iter = list_iter->next)
-        {
-          name = (gchar *) list_iter->data;
-          value = g_hash_table_lookup (ppds_hash, name);
+static gpointer
+get_all_ppds_func (gpointer user_data)
+{
+  GAPData *data = user_data;
+  ipp_t   *request;
+  ipp_t   *response;
+  gint64   timestamp;
 
-          data->result->manufacturers[i] = g_new0 (PPDManufacturerItem, 1);
-          data->result->manufacturers[i]->manufacturer_name = g_strdup (name);
-          data->result->manufacturers[i]->manufacturer_display_name = g_strdup (g_hash_table_lookup (manufacturers_hash, name));
-          data->result->manufacturers[i]->num_of_ppds = g_list_length ((GList *) value);
-          data->result->manufacturers[i]->ppds = g_new0 (PPDName *, data->result->manufacturers[i]->num_of_ppds);
+  /* Taken before the request, so that drivers installed meanwhile are
+   * listed the next time.
+   */
+  timestamp = ppd_catalog_get_timestamp ();
+  if (timestamp >= 0)
+    data->result = ppd_catalog_load (timestamp);
 
-          for (ppd_item = (GList *) value, j = 0; ppd_item; ppd_item = ppd_item->next, j++)
-            {
-              data->result->manufacturers[i]->ppds[j] = ppd_item->data;
-            }
+  if (data->result == NULL)
+    {
+      request = ippNewRequest (CUPS_GET_PPDS);
+      response = cupsDoRequest (CUPS_HTTP_DEFAULT, request, "/");
 
-          g_list_free ((GList *) value);
+      if (response &&
+          ippGetStatusCode (response) <= IPP_OK_CONFLICT)
+        {
+          data->result = get_ppd_list_from_response (response);
 
-          i++;
+          if (timestamp >= 0)
+            ppd_catalog_save (data->result, timestamp);
         }
 
-      g_list_free_full (sort_list, g_free);
-      g_hash_table_destroy (ppds_hash);
-      g_hash_table_destroy (manufacturers_hash);
+      if (response)
+        ippDelete(response);
     }
 
   get_all_ppds_cb (data);
@@ -2838,13 +3202,14 @@ typedef struct
   gchar        *host_name;
   gint          port;
   gchar        *result;
+  GCancellable *cancellable;
   PGPCallback   callback;
   gpointer      user_data;
   GMainContext *context;
 } PGPData;
 
 static PGPData *
-pgp_data_new (const gchar *printer_name, const gchar *host_name, gint port, PGPCallback callback, gpointer user_data)
+pgp_data_new (const gchar *printer_name, const gchar *host_name, gint port, GCancellable *cancellable, PGPCallback callback, gpointer user_data)
 {
   PGPData *data;
 
@@ -2852,6 +3217,8 @@ pgp_data_new (const gchar *printer_name, const gchar *host_name, gint port, PGPC
   data->printer_name = g_strdup (printer_name);
   data->host_name = g_strdup (host_name);
   data->port = port;
+  if (cancellable)
+    data->cancellable = g_object_ref (cancellable);
   data->callback = callback;
   data->user_data = user_data;
   data->context = g_main_context_ref_thread_default ();
@@ -2865,6 +3232,7 @@ pgp_data_free (PGPData *data)
   g_free (data->printer_name);
   g_free (data->host_name);
   g_free (data->result);
+  g_clear_object (&data->cancellable);
   if (data->context)
     g_main_context_unref (data->context);
   g_free (data);
@@ -2875,7 +3243,10 @@ printer_get_ppd_idle_cb (gpointer user_data)
 {
   PGPData *data = user_data;
 
-  data->callback (data->result, data->user_data);
+  if (!g_cancellable_is_cancelled (data->cancellable))
+    data->callback (data->result, data->user_data);
+  else if (data->result != NULL)
+    g_unlink (data->result);
 
   return FALSE;
 }
@@ -2899,20 +3270,21 @@ printer_get_ppd_func (gpointer user_data)
 {
   PGPData *data = user_data;
 
-  if (data->host_name)
+  if (g_cancellable_is_cancelled (data->cancellable))
+    {
+      /* Nothing to do */
+    }
+  else if (data->host_name)
     {
       http_t *http;
 
-#ifdef HAVE_CUPS_HTTPCONNECT2
-      http = httpConnect2 (data->host_name, data->port, NULL, AF_UNSPEC,
-                           HTTP_ENCRYPTION_IF_REQUESTED, 1, 30000, NULL);
-#else
-      http = httpConnect (data->host_name, data->port);
-#endif
+      http = remote_connection_take (data->host_name, data->port);
       if (http)
         {
           data->result = g_strdup (cupsGetPPD2 (http, data->printer_name));
-          httpClose (http);
+
+          /* Connect again next time, the server may have closed the connection */
+          remote_connection_release (data->host_name, data->port, http, data->result != NULL);
         }
     }
   else
@@ -2926,48 +3298,41 @@ printer_get_ppd_func (gpointer user_data)
 }
 
 void
-printer_get_ppd_async (const gchar *printer_name,
-                       const gchar *host_name,
-                       gint         port,
-                       PGPCallback  callback,
-                       gpointer     user_data)
+printer_get_ppd_async (const gchar  *printer_name,
+                       const gchar  *host_name,
+                       gint          port,
+                       GCancellable *cancellable,
+                       PGPCallback   callback,
+                       gpointer      user_data)
 {
-  PGPData          *data;
-  g_autoptr(GThread) thread = NULL;
-  g_autoptr(GError) error = NULL;
-
-  data = pgp_data_new (printer_name, host_name, port, callback, user_data);
-
-  thread = g_thread_try_new ("printer-get-ppd",
-                             printer_get_ppd_func,
-                             data,
-                             &error);
-
-  if (!thread)
-    {
-      g_warning ("%s", error->message);
-      callback (NULL, user_data);
-
-      pgp_data_free (data);
-    }
+  if (host_name)
+    ipp_thread_run ("printer-get-ppd",
+                    printer_get_ppd_func,
+                    pgp_data_new (printer_name, host_name, port, cancellable, callback, user_data));
+  else
+    ipp_worker_push (printer_get_ppd_func,
+                     pgp_data_new (printer_name, host_name, port, cancellable, callback, user_data));
 }
 
 typedef struct
 {
   gchar        *printer_name;
   cups_dest_t  *result;
+  GCancellable *cancellable;
   GNDCallback   callback;
   gpointer      user_data;
   GMainContext *context;
 } GNDData;
 
 static GNDData *
-gnd_data_new (const gchar *printer_name, GNDCallback callback, gpointer user_data)
+gnd_data_new (const gchar *printer_name, GCancellable *cancellable, GNDCallback callback, gpointer user_data)
 {
   GNDData *data;
 
   data = g_new0 (GNDData, 1);
   data->printer_name = g_strdup (printer_name);
+  if (cancellable)
+    data->cancellable = g_object_ref (cancellable);
   data->callback = callback;
   data->user_data = user_data;
   data->context = g_main_context_ref_thread_default ();
@@ -2979,6 +3344,7 @@ static void
 gnd_data_free (GNDData *data)
 {
   g_free (data->printer_name);
+  g_clear_object (&data->cancellable);
   if (data->context)
     g_main_context_unref (data->context);
   g_free (data);
@@ -2989,7 +3355,10 @@ get_named_dest_idle_cb (gpointer user_data)
 {
   GNDData *data = user_data;
 
-  data->callback (data->result, data->user_data);
+  if (!g_cancellable_is_cancelled (data->cancellable))
+    data->callback (data->result, data->user_data);
+  else if (data->result != NULL)
+    cupsFreeDests (1, data->result);
 
   return FALSE;
 }
@@ -3013,7 +3382,8 @@ get_named_dest_func (gpointer user_data)
 {
   GNDData *data = user_data;
 
-  data->result = cupsGetNamedDest (CUPS_HTTP_DEFAULT, data->printer_name, NULL);
+  if (!g_cancellable_is_cancelled (data->cancellable))
+    data->result = cupsGetNamedDest (CUPS_HTTP_DEFAULT, data->printer_name, NULL);
 
   get_named_dest_cb (data);
 
@@ -3021,28 +3391,13 @@ get_named_dest_func (gpointer user_data)
 }
 
 void
-get_named_dest_async (const gchar *printer_name,
-                      GNDCallback  callback,
-                      gpointer     user_data)
+get_named_dest_async (const gchar  *printer_name,
+                      GCancellable *cancellable,
+                      GNDCallback   callback,
+                      gpointer      user_data)
 {
-  GNDData          *data;
-  g_autoptr(GThread) thread = NULL;
-  g_autoptr(GError) error = NULL;
-
-  data = gnd_data_new (printer_name, callback, user_data);
-
-  thread = g_thread_try_new ("get-named-dest",
-                             get_named_dest_func,
-                             data,
-                             &error);
-
-  if (!thread)
-    {
-      g_warning ("%s", error->message);
-      callback (NULL, user_data);
-
-      gnd_data_free (data);
-    }
+  ipp_worker_push (get_named_dest_func,
+                   gnd_data_new (printer_name, cancellable, callback, user_data));
 }
 
 typedef struct
@@ -200,6 +200,7 @@ typedef void (*GIACallback) (GHashTable *table,
 
 void        get_ipp_attributes_async (const gchar  *printer_name,
                                       gchar       **attributes_names,
+                                      GCancellable *cancellable,
                                       GIACallback   callback,
                                       gpointer      user_data);
 
@@ -212,19 +213,21 @@ gchar      *get_standard_manufacturers_name (const gchar *name);
 typedef void (*PGPCallback) (const gchar *ppd_filename,
                              gpointer     user_data);
 
-void        printer_get_ppd_async (const gchar *printer_name,
-                                   const gchar *host_name,
-                                   gint         port,
-                                   PGPCallback  callback,
-                                   gpointer     user_data);
+void        printer_get_ppd_async (const gchar  *printer_name,
+                                   const gchar  *host_name,
+                                   gint          port,
+                                   GCancellable *cancellable,
+                                   PGPCallback   callback,
+                                   gpointer      user_data);
 
 /* NOTE: 'destination' is passed with ownership as cupsCopyDest doesn't seem to work as expected */
 typedef void (*GNDCallback) (cups_dest_t *destination,
                              gpointer     user_data);
 
-void        get_named_dest_async (const gchar *printer_name,
-                                  GNDCallback  callback,
-                                  gpointer     user_data);
+void        get_named_dest_async (const gchar  *printer_name,
+                                  GCancellable *cancellable,
+                                  GNDCallback   callback,
+                                  gpointer      user_data);
 
 typedef void (*PAOCallback) (gboolean success,
                              gpointer user_data);
@@ -104,7 +104,8 @@ set_output_stream (CcSoundPanel   *self,
   gboolean can_fade = FALSE, has_lfe = FALSE;
 
   cc_volume_slider_set_stream (self->output_volume_slider, stream, CC_STREAM_TYPE_OUTPUT);
-  cc_level_bar_set_stream (self->output_level_bar, stream);
+  if (!cc_panel_is_suspended (CC_PANEL (self)))
+    cc_level_bar_set_stream (self->output_level_bar, stream);
 
   if (stream != NULL)
     {
@@ -136,7 +137,8 @@ set_input_stream (CcSoundPanel   *self,
                   GvcMixerStream *stream)
 {
   cc_volume_slider_set_stream (self->input_volume_slider, stream, CC_STREAM_TYPE_INPUT);
-  cc_level_bar_set_stream (self->input_level_bar, stream);
+  if (!cc_panel_is_suspended (CC_PANEL (self)))
+    cc_level_bar_set_stream (self->input_level_bar, stream);
 }
 
 static void
@@ -251,6 +253,40 @@ cc_sound_panel_get_help_uri (CcPanel *panel)
   return "help:gnome-help/media#sound";
 }
 
+static GvcMixerStream *
+get_device_stream (CcSoundPanel     *self,
+                   CcDeviceComboBox *combo_box)
+{
+  GvcMixerUIDevice *device;
+
+  device = cc_device_combo_box_get_device (combo_box);
+  if (device == NULL)
+    return NULL;
+
+  return gvc_mixer_control_get_stream_from_device (self->mixer_control, device);
+}
+
+static void
+cc_sound_panel_suspend (CcPanel *panel)
+{
+  CcSoundPanel *self = CC_SOUND_PANEL (panel);
+
+  /* Stop monitoring the levels, this keeps the microphone in use */
+  cc_level_bar_set_stream (self->output_level_bar, NULL);
+  cc_level_bar_set_stream (self->input_level_bar, NULL);
+}
+
+static void
+cc_sound_panel_resume (CcPanel *panel)
+{
+  CcSoundPanel *self = CC_SOUND_PANEL (panel);
+
+  cc_level_bar_set_stream (self->output_level_bar,
+                           get_device_stream (self, self->output_device_combo_box));
+  cc_level_bar_set_stream (self->input_level_bar,
+                           get_device_stream (self, self->input_device_combo_box));
+}
+
 static void
 cc_sound_panel_finalize (GObject *object)
 {
@@ -270,6 +306,8 @@ cc_sound_panel_class_init (CcSoundPanelClass *klass)
   CcPanelClass *panel_class = CC_PANEL_CLASS (klass);
 
   panel_class->get_help_uri = cc_sound_panel_get_help_uri;
+  panel_class->suspend = cc_sound_panel_suspend;
+  panel_class->resume = cc_sound_panel_resume;
 
   object_class->finalize = cc_sound_panel_finalize;
 
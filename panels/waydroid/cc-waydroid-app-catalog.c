@@ -0,0 +1,714 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <string.h>
+
+#include "cc-waydroid-app-catalog.h"
+
+/* Waydroid writes a desktop file for every app it can launch, named after
+ * the package, with the name of the app and the path of its icon. Reading
+ * them all at once gives what would otherwise take a NameToPackageName
+ * call per app. */
+#define DESKTOP_FILE_PREFIX "waydroid."
+#define DESKTOP_FILE_SUFFIX ".desktop"
+
+#define CHANGED_TIMEOUT_MS 500
+
+struct _CcWaydroidApp
+{
+  GObject     parent_instance;
+
+  gchar      *name;
+  gchar      *package_name;
+  gchar      *icon_path;
+  GdkTexture *texture;
+};
+
+G_DEFINE_FINAL_TYPE (CcWaydroidApp, cc_waydroid_app, G_TYPE_OBJECT)
+
+static void
+cc_waydroid_app_finalize (GObject *object)
+{
+  CcWaydroidApp *self = CC_WAYDROID_APP (object);
+
+  g_clear_pointer (&self->name, g_free);
+  g_clear_pointer (&self->package_name, g_free);
+  g_clear_pointer (&self->icon_path, g_free);
+  g_clear_object (&self->texture);
+
+  G_OBJECT_CLASS (cc_waydroid_app_parent_class)->finalize (object);
+}
+
+static void
+cc_waydroid_app_class_init (CcWaydroidAppClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_waydroid_app_finalize;
+}
+
+static void
+cc_waydroid_app_init (CcWaydroidApp *self)
+{
+}
+
+const gchar *
+cc_waydroid_app_get_name (CcWaydroidApp *self)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP (self), NULL);
+
+  return self->name;
+}
+
+/* Returns the package name from the desktop file Waydroid wrote for the
+ * app, or the one set with cc_waydroid_app_set_package_name(); NULL if
+ * the app has no desktop file and its package name wasn't looked up yet */
+const gchar *
+cc_waydroid_app_get_package_name (CcWaydroidApp *self)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP (self), NULL);
+
+  return self->package_name;
+}
+
+/* For the package name looked up over D-Bus, so it's only asked once */
+void
+cc_waydroid_app_set_package_name (CcWaydroidApp *self,
+                                  const gchar   *package_name)
+{
+  g_return_if_fail (CC_IS_WAYDROID_APP (self));
+
+  g_free (self->package_name);
+  self->package_name = g_strdup (package_name);
+}
+
+/* Returns NULL if the app has no icon */
+const gchar *
+cc_waydroid_app_get_icon_path (CcWaydroidApp *self)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP (self), NULL);
+
+  return self->icon_path;
+}
+
+/* Returns the icon as loaded by the catalog, so that binding a row
+ * doesn't decode it again; NULL if the app has no icon or it couldn't
+ * be loaded */
+GdkPaintable *
+cc_waydroid_app_get_icon (CcWaydroidApp *self)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP (self), NULL);
+
+  return GDK_PAINTABLE (self->texture);
+}
+
+typedef struct
+{
+  gchar      *package_name;
+  gchar      *icon_path;
+  GdkTexture *texture;
+} AppEntry;
+
+static void
+app_entry_free (AppEntry *entry)
+{
+  g_free (entry->package_name);
+  g_free (entry->icon_path);
+  g_clear_object (&entry->texture);
+  g_free (entry);
+}
+
+static CcWaydroidApp *
+app_new (const gchar    *name,
+         const AppEntry *entry)
+{
+  CcWaydroidApp *app;
+
+  app = g_object_new (CC_TYPE_WAYDROID_APP, NULL);
+  app->name = g_strdup (name);
+
+  if (entry != NULL)
+    {
+      app->package_name = g_strdup (entry->package_name);
+      app->icon_path = g_strdup (entry->icon_path);
+      g_set_object (&app->texture, entry->texture);
+    }
+
+  return app;
+}
+
+static gboolean
+app_matches_entry (CcWaydroidApp  *app,
+                   const AppEntry *entry)
+{
+  /* What is known of an app without a desktop file, such as a package
+   * name looked up over D-Bus, is kept */
+  if (entry == NULL)
+    return TRUE;
+
+  return g_strcmp0 (app->package_name, entry->package_name) == 0 &&
+         g_strcmp0 (app->icon_path, entry->icon_path) == 0;
+}
+
+struct _CcWaydroidAppCatalog
+{
+  GObject       parent_instance;
+
+  gchar        *applications_dir;
+  gchar        *icons_dir;
+
+  /* Sorted by name, which is also the key of the index */
+  GListStore   *apps;
+  GHashTable   *apps_by_name;
+
+  GFileMonitor *monitor;
+  guint         changed_id;
+
+  gboolean      refreshing;
+};
+
+G_DEFINE_FINAL_TYPE (CcWaydroidAppCatalog, cc_waydroid_app_catalog, G_TYPE_OBJECT)
+
+enum {
+  CHANGED,
+  LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+static gboolean
+emit_changed_cb (gpointer user_data)
+{
+  CcWaydroidAppCatalog *self = CC_WAYDROID_APP_CATALOG (user_data);
+
+  self->changed_id = 0;
+  g_signal_emit (self, signals[CHANGED], 0);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Installing or removing an app touches a few files at once, so changes
+ * are reported once things settle. */
+static void
+on_applications_dir_changed (CcWaydroidAppCatalog *self,
+                             GFile                *file,
+                             GFile                *other_file,
+                             GFileMonitorEvent     event_type,
+                             GFileMonitor         *monitor)
+{
+  g_autofree gchar *basename = g_file_get_basename (file);
+
+  if (!g_str_has_prefix (basename, DESKTOP_FILE_PREFIX) ||
+      !g_str_has_suffix (basename, DESKTOP_FILE_SUFFIX))
+    return;
+
+  g_clear_handle_id (&self->changed_id, g_source_remove);
+  self->changed_id = g_timeout_add (CHANGED_TIMEOUT_MS, emit_changed_cb, self);
+}
+
+static void
+cc_waydroid_app_catalog_dispose (GObject *object)
+{
+  CcWaydroidAppCatalog *self = CC_WAYDROID_APP_CATALOG (object);
+
+  g_clear_handle_id (&self->changed_id, g_source_remove);
+  if (self->monitor != NULL)
+    g_file_monitor_cancel (self->monitor);
+  g_clear_object (&self->monitor);
+
+  G_OBJECT_CLASS (cc_waydroid_app_catalog_parent_class)->dispose (object);
+}
+
+static void
+cc_waydroid_app_catalog_finalize (GObject *object)
+{
+  CcWaydroidAppCatalog *self = CC_WAYDROID_APP_CATALOG (object);
+
+  g_clear_pointer (&self->applications_dir, g_free);
+  g_clear_pointer (&self->icons_dir, g_free);
+  g_clear_pointer (&self->apps_by_name, g_hash_table_unref);
+  g_clear_object (&self->apps);
+
+  G_OBJECT_CLASS (cc_waydroid_app_catalog_parent_class)->finalize (object);
+}
+
+static void
+cc_waydroid_app_catalog_class_init (CcWaydroidAppCatalogClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = cc_waydroid_app_catalog_dispose;
+  object_class->finalize = cc_waydroid_app_catalog_finalize;
+
+  /* Emitted when the apps installed in Waydroid may have changed */
+  signals[CHANGED] = g_signal_new ("changed",
+                                   G_TYPE_FROM_CLASS (klass),
+                                   G_SIGNAL_RUN_LAST,
+                                   0, NULL, NULL, NULL,
+                                   G_TYPE_NONE, 0);
+}
+
+static void
+cc_waydroid_app_catalog_init (CcWaydroidAppCatalog *self)
+{
+  self->apps = g_list_store_new (CC_TYPE_WAYDROID_APP);
+  self->apps_by_name = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+}
+
+/*
+ * Creates a catalog of the apps whose desktop files Waydroid wrote in
+ * @data_dir, or in the user data directory if NULL.
+ */
+CcWaydroidAppCatalog *
+cc_waydroid_app_catalog_new (const gchar *data_dir)
+{
+  CcWaydroidAppCatalog *self;
+  g_autoptr(GFile) dir = NULL;
+  g_autoptr(GError) error = NULL;
+
+  if (data_dir == NULL)
+    data_dir = g_get_user_data_dir ();
+
+  self = g_object_new (CC_TYPE_WAYDROID_APP_CATALOG, NULL);
+  self->applications_dir = g_build_filename (data_dir, "applications", NULL);
+  self->icons_dir = g_build_filename (data_dir, "waydroid", "data", "icons", NULL);
+
+  dir = g_file_new_for_path (self->applications_dir);
+  self->monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+  if (self->monitor != NULL)
+    g_signal_connect_object (self->monitor, "changed",
+                             G_CALLBACK (on_applications_dir_changed),
+                             self, G_CONNECT_SWAPPED);
+  else
+    g_debug ("Failed to monitor %s: %s", self->applications_dir, error->message);
+
+  return self;
+}
+
+/* Returns the apps sorted by name; items are CcWaydroidApp */
+GListModel *
+cc_waydroid_app_catalog_get_model (CcWaydroidAppCatalog *self)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP_CATALOG (self), NULL);
+
+  return G_LIST_MODEL (self->apps);
+}
+
+CcWaydroidApp *
+cc_waydroid_app_catalog_lookup (CcWaydroidAppCatalog *self,
+                                const gchar          *name)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP_CATALOG (self), NULL);
+
+  return g_hash_table_lookup (self->apps_by_name, name);
+}
+
+typedef struct
+{
+  gchar      *applications_dir;
+  gchar      *icons_dir;
+  GPtrArray  *names;
+  GHashTable *entries;
+
+  /* The icons already loaded, by path, with NULL for those that failed */
+  GHashTable *textures;
+} UpdateData;
+
+static void
+update_data_free (UpdateData *data)
+{
+  g_free (data->applications_dir);
+  g_free (data->icons_dir);
+  g_clear_pointer (&data->names, g_ptr_array_unref);
+  g_clear_pointer (&data->entries, g_hash_table_unref);
+  g_clear_pointer (&data->textures, g_hash_table_unref);
+  g_free (data);
+}
+
+static void
+texture_unref (gpointer texture)
+{
+  if (texture != NULL)
+    g_object_unref (texture);
+}
+
+static gint
+compare_names (gconstpointer a,
+               gconstpointer b)
+{
+  return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
+
+static gchar *
+get_icon_path (const gchar *icons_dir,
+               const gchar *package_name,
+               const gchar *icon)
+{
+  g_autofree gchar *icon_path = NULL;
+
+  if (icon != NULL && g_path_is_absolute (icon) && g_file_test (icon, G_FILE_TEST_EXISTS))
+    return g_strdup (icon);
+
+  icon_path = g_strdup_printf ("%s/%s.png", icons_dir, package_name);
+  if (g_file_test (icon_path, G_FILE_TEST_EXISTS))
+    return g_steal_pointer (&icon_path);
+
+  return NULL;
+}
+
+/* Textures can be made on any thread, so icons are decoded here rather
+ * than each time a row shows them. One that was loaded before is
+ * shared. */
+static GdkTexture *
+load_icon (UpdateData  *data,
+           const gchar *icon_path)
+{
+  g_autoptr(GError) error = NULL;
+  GdkTexture *texture;
+
+  if (g_hash_table_lookup_extended (data->textures, icon_path, NULL, (gpointer *) &texture))
+    return texture != NULL ? g_object_ref (texture) : NULL;
+
+  texture = gdk_texture_new_from_filename (icon_path, &error);
+  if (texture == NULL)
+    g_debug ("Failed to load %s: %s", icon_path, error->message);
+
+  g_hash_table_insert (data->textures, g_strdup (icon_path), texture != NULL ? g_object_ref (texture) : NULL);
+
+  return texture;
+}
+
+static void
+scan_desktop_files_thread (GTask        *task,
+                           gpointer      source_object,
+                           gpointer      task_data,
+                           GCancellable *cancellable)
+{
+  UpdateData *data = task_data;
+  g_autoptr(GDir) dir = NULL;
+  const gchar *filename;
+  gsize prefix_len = strlen (DESKTOP_FILE_PREFIX);
+  gsize suffix_len = strlen (DESKTOP_FILE_SUFFIX);
+  guint i, j;
+
+  /* The list is kept sorted, without duplicates */
+  g_ptr_array_sort (data->names, compare_names);
+  for (i = 0, j = 0; i < data->names->len; i++)
+    {
+      const gchar *name = g_ptr_array_index (data->names, i);
+
+      if (name[0] == '\0' || (j > 0 && g_str_equal (name, g_ptr_array_index (data->names, j - 1))))
+        continue;
+
+      data->names->pdata[i] = data->names->pdata[j];
+      data->names->pdata[j++] = (gpointer) name;
+    }
+  g_ptr_array_set_size (data->names, j);
+
+  data->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) app_entry_free);
+
+  dir = g_dir_open (data->applications_dir, 0, NULL);
+  while (dir != NULL && (filename = g_dir_read_name (dir)) != NULL)
+    {
+      g_autoptr(GKeyFile) key_file = NULL;
+      g_autofree gchar *path = NULL;
+      g_autofree gchar *name = NULL;
+      g_autofree gchar *icon = NULL;
+      AppEntry *entry;
+      gsize len;
+
+      if (g_task_return_error_if_cancelled (task))
+        return;
+
+      len = strlen (filename);
+      if (len <= prefix_len + suffix_len ||
+          !g_str_has_prefix (filename, DESKTOP_FILE_PREFIX) ||
+          !g_str_has_suffix (filename, DESKTOP_FILE_SUFFIX))
+        continue;
+
+      path = g_build_filename (data->applications_dir, filename, NULL);
+      key_file = g_key_file_new ();
+      if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, NULL))
+        continue;
+
+      name = g_key_file_get_string (key_file, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_NAME, NULL);
+      if (name == NULL || g_hash_table_contains (data->entries, name))
+        continue;
+
+      icon = g_key_file_get_string (key_file, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_ICON, NULL);
+
+      entry = g_new0 (AppEntry, 1);
+      entry->package_name = g_strndup (filename + prefix_len, len - prefix_len - suffix_len);
+      entry->icon_path = get_icon_path (data->icons_dir, entry->package_name, icon);
+      if (entry->icon_path != NULL)
+        entry->texture = load_icon (data, entry->icon_path);
+      g_hash_table_insert (data->entries, g_steal_pointer (&name), entry);
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+index_app (CcWaydroidAppCatalog *self,
+           CcWaydroidApp        *app)
+{
+  g_hash_table_replace (self->apps_by_name, g_strdup (app->name), g_object_ref (app));
+}
+
+/* Updates the model in place, so that only the rows of the apps that
+ * changed are replaced. */
+static void
+merge_apps (CcWaydroidAppCatalog *self,
+            UpdateData           *data)
+{
+  g_autoptr(GPtrArray) apps = NULL;
+  guint n_items;
+  guint i, j;
+
+  apps = g_ptr_array_new_full (data->names->len, g_object_unref);
+  for (i = 0; i < data->names->len; i++)
+    {
+      const gchar *name = g_ptr_array_index (data->names, i);
+      const AppEntry *entry = g_hash_table_lookup (data->entries, name);
+      CcWaydroidApp *app = g_hash_table_lookup (self->apps_by_name, name);
+
+      if (app != NULL && app_matches_entry (app, entry))
+        g_ptr_array_add (apps, g_object_ref (app));
+      else
+        g_ptr_array_add (apps, app_new (name, entry));
+    }
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->apps));
+  if (n_items == 0)
+    {
+      for (j = 0; j < apps->len; j++)
+        index_app (self, g_ptr_array_index (apps, j));
+      g_list_store_splice (self->apps, 0, 0, apps->pdata, apps->len);
+      return;
+    }
+
+  i = 0;
+  j = 0;
+  while (i < n_items || j < apps->len)
+    {
+      g_autoptr(CcWaydroidApp) old_app = NULL;
+      CcWaydroidApp *app = NULL;
+      gint cmp;
+
+      if (i < n_items)
+        old_app = g_list_model_get_item (G_LIST_MODEL (self->apps), i);
+      if (j < apps->len)
+        app = g_ptr_array_index (apps, j);
+
+      if (old_app == NULL)
+        cmp = 1;
+      else if (app == NULL)
+        cmp = -1;
+      else
+        cmp = g_strcmp0 (old_app->name, app->name);
+
+      if (cmp < 0)
+        {
+          g_hash_table_remove (self->apps_by_name, old_app->name);
+          g_list_store_remove (self->apps, i);
+          n_items--;
+        }
+      else if (cmp > 0)
+        {
+          index_app (self, app);
+          g_list_store_insert (self->apps, i, app);
+          n_items++;
+          i++;
+          j++;
+        }
+      else
+        {
+          if (old_app != app)
+            {
+              index_app (self, app);
+              g_list_store_splice (self->apps, i, 1, (gpointer *) &app, 1);
+            }
+          i++;
+          j++;
+        }
+    }
+}
+
+static void
+scan_desktop_files_cb (GObject      *source_object,
+                       GAsyncResult *res,
+                       gpointer      user_data)
+{
+  CcWaydroidAppCatalog *self = CC_WAYDROID_APP_CATALOG (source_object);
+  g_autoptr(GTask) task = G_TASK (user_data);
+  g_autoptr(GError) error = NULL;
+
+  if (!g_task_propagate_boolean (G_TASK (res), &error))
+    {
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  merge_apps (self, g_task_get_task_data (G_TASK (res)));
+
+  g_task_return_boolean (task, TRUE);
+}
+
+/*
+ * Makes the catalog list the apps with the given names, reading the
+ * package names and icons of all of them from the desktop files at once.
+ */
+void
+cc_waydroid_app_catalog_update_async (CcWaydroidAppCatalog *self,
+                                      const gchar * const  *names,
+                                      GCancellable         *cancellable,
+                                      GAsyncReadyCallback   callback,
+                                      gpointer              user_data)
+{
+  g_autoptr(GTask) task = NULL;
+  g_autoptr(GTask) scan_task = NULL;
+  UpdateData *data;
+  guint i;
+
+  g_return_if_fail (CC_IS_WAYDROID_APP_CATALOG (self));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cc_waydroid_app_catalog_update_async);
+
+  data = g_new0 (UpdateData, 1);
+  data->applications_dir = g_strdup (self->applications_dir);
+  data->icons_dir = g_strdup (self->icons_dir);
+  data->names = g_ptr_array_new_with_free_func (g_free);
+  for (; names != NULL && *names != NULL; names++)
+    g_ptr_array_add (data->names, g_strdup (*names));
+
+  data->textures = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, texture_unref);
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (self->apps)); i++)
+    {
+      g_autoptr(CcWaydroidApp) app = g_list_model_get_item (G_LIST_MODEL (self->apps), i);
+
+      if (app->icon_path != NULL)
+        g_hash_table_replace (data->textures,
+                              g_strdup (app->icon_path),
+                              app->texture != NULL ? g_object_ref (app->texture) : NULL);
+    }
+
+  scan_task = g_task_new (self, cancellable, scan_desktop_files_cb, g_steal_pointer (&task));
+  g_task_set_task_data (scan_task, data, (GDestroyNotify) update_data_free);
+  g_task_run_in_thread (scan_task, scan_desktop_files_thread);
+}
+
+gboolean
+cc_waydroid_app_catalog_update_finish (CcWaydroidAppCatalog  *self,
+                                       GAsyncResult          *result,
+                                       GError               **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+refresh_updated_cb (GObject      *source_object,
+                    GAsyncResult *res,
+                    gpointer      user_data)
+{
+  CcWaydroidAppCatalog *self = CC_WAYDROID_APP_CATALOG (source_object);
+  g_autoptr(GTask) task = G_TASK (user_data);
+  g_autoptr(GError) error = NULL;
+
+  self->refreshing = FALSE;
+
+  if (!cc_waydroid_app_catalog_update_finish (self, res, &error))
+    g_task_return_error (task, g_steal_pointer (&error));
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+all_names_cb (GObject      *source_object,
+              GAsyncResult *res,
+              gpointer      user_data)
+{
+  g_autoptr(GTask) task = G_TASK (user_data);
+  CcWaydroidAppCatalog *self = g_task_get_source_object (task);
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree const gchar **names = NULL;
+
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (result == NULL)
+    {
+      self->refreshing = FALSE;
+      g_task_return_error (task, g_steal_pointer (&error));
+      return;
+    }
+
+  /* The rest of what the rows show is read for all apps at once */
+  g_variant_get (result, "(^a&s)", &names);
+  cc_waydroid_app_catalog_update_async (self, names,
+                                        g_task_get_cancellable (task),
+                                        refresh_updated_cb,
+                                        g_steal_pointer (&task));
+}
+
+/*
+ * Asks Waydroid over @session_proxy for the names of its apps and updates
+ * the catalog with them. Without a proxy, that is when the session isn't
+ * up, this fails right away with %G_IO_ERROR_NOT_CONNECTED rather than
+ * leaving the catalog refreshing.
+ */
+void
+cc_waydroid_app_catalog_refresh_async (CcWaydroidAppCatalog *self,
+                                       GDBusProxy           *session_proxy,
+                                       GCancellable         *cancellable,
+                                       GAsyncReadyCallback   callback,
+                                       gpointer              user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (CC_IS_WAYDROID_APP_CATALOG (self));
+  g_return_if_fail (session_proxy == NULL || G_IS_DBUS_PROXY (session_proxy));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cc_waydroid_app_catalog_refresh_async);
+
+  if (session_proxy == NULL)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_CONNECTED,
+                               "No session of Waydroid to ask for its apps");
+      return;
+    }
+
+  self->refreshing = TRUE;
+  g_dbus_proxy_call (session_proxy,
+                     "GetAllNames",
+                     NULL,
+                     G_DBUS_CALL_FLAGS_NONE,
+                     G_MAXINT,
+                     cancellable,
+                     all_names_cb,
+                     g_steal_pointer (&task));
+}
+
+gboolean
+cc_waydroid_app_catalog_refresh_finish (CcWaydroidAppCatalog  *self,
+                                        GAsyncResult          *result,
+                                        GError               **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/* Whether a refresh is waiting on Waydroid or on the desktop files */
+gboolean
+cc_waydroid_app_catalog_get_refreshing (CcWaydroidAppCatalog *self)
+{
+  g_return_val_if_fail (CC_IS_WAYDROID_APP_CATALOG (self), FALSE);
+
+  return self->refreshing;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define CC_TYPE_WAYDROID_APP (cc_waydroid_app_get_type ())
+G_DECLARE_FINAL_TYPE (CcWaydroidApp, cc_waydroid_app, CC, WAYDROID_APP, GObject)
+
+const gchar          *cc_waydroid_app_get_name             (CcWaydroidApp        *self);
+
+const gchar          *cc_waydroid_app_get_package_name     (CcWaydroidApp        *self);
+
+void                  cc_waydroid_app_set_package_name     (CcWaydroidApp        *self,
+                                                            const gchar          *package_name);
+
+const gchar          *cc_waydroid_app_get_icon_path        (CcWaydroidApp        *self);
+
+GdkPaintable         *cc_waydroid_app_get_icon             (CcWaydroidApp        *self);
+
+#define CC_TYPE_WAYDROID_APP_CATALOG (cc_waydroid_app_catalog_get_type ())
+G_DECLARE_FINAL_TYPE (CcWaydroidAppCatalog, cc_waydroid_app_catalog, CC, WAYDROID_APP_CATALOG, GObject)
+
+CcWaydroidAppCatalog *cc_waydroid_app_catalog_new          (const gchar          *data_dir);
+
+GListModel           *cc_waydroid_app_catalog_get_model    (CcWaydroidAppCatalog *self);
+
+CcWaydroidApp        *cc_waydroid_app_catalog_lookup       (CcWaydroidAppCatalog *self,
+                                                            const gchar          *name);
+
+void                  cc_waydroid_app_catalog_update_async (CcWaydroidAppCatalog *self,
+                                                            const gchar * const  *names,
+                                                            GCancellable         *cancellable,
+                                                            GAsyncReadyCallback   callback,
+                                                            gpointer              user_data);
+
+gboolean              cc_waydroid_app_catalog_update_finish (CcWaydroidAppCatalog *self,
+                                                             GAsyncResult         *result,
+                                                             GError              **error);
+
+void                  cc_waydroid_app_catalog_refresh_async (CcWaydroidAppCatalog *self,
+                                                             GDBusProxy           *session_proxy,
+                                                             GCancellable         *cancellable,
+                                                             GAsyncReadyCallback   callback,
+                                                             gpointer              user_data);
+
+gboolean              cc_waydroid_app_catalog_refresh_finish (CcWaydroidAppCatalog *self,
+                                                              GAsyncResult         *result,
+                                                              GError              **error);
+
+gboolean              cc_waydroid_app_catalog_get_refreshing (CcWaydroidAppCatalog *self);
+
+G_END_DECLS
@@ -5,6 +5,7 @@
  */
 
 #include "cc-waydroid-panel.h"
+#include "cc-waydroid-app-catalog.h"
 #include "cc-waydroid-resources.h"
 #include "cc-util.h"
 
@@ -33,8 +34,7 @@ struct _CcWaydroidPanel {
   GtkWidget        *waydroid_vendor_label;
   GtkWidget        *waydroid_version_label;
   AdwExpanderRow   *app_selector;
-  GtkListBox       *app_list;
-  GListStore       *app_list_store;
+  GtkListView      *app_list;
   GtkWidget        *launch_app_button;
   GtkWidget        *remove_app_button;
   GtkWidget        *install_app_button;
@@ -45,8 +45,9 @@ struct _CcWaydroidPanel {
   GtkWidget        *kill_app_button;
   AdwBottomSheet   *bottom_sheet;
 
-  gchar            **apps;
-  GList            *app_widgets;
+  CcWaydroidAppCatalog *catalog;
+  gboolean         app_list_bound;
+  GCancellable     *selection_cancellable;
   gchar            *selected_app_name;
   gchar            *selected_app_pkgname;
 
@@ -54,7 +55,12 @@ struct _CcWaydroidPanel {
   gchar            *waydroid_vendor_output;
   gchar            *waydroid_version_output;
 
-  gboolean         refreshing;
+  GCancellable     *cancellable;
+  GDBusProxy       *container_proxy;
+  GDBusProxy       *session_proxy;
+  guint            n_pending_proxies;
+  guint            update_info_id;
+
   gboolean         waydroid_notification_active;
   gboolean         waydroid_nfc_active;
   gboolean         waydroid_shared_folder_enabled;
@@ -62,12 +68,28 @@ struct _CcWaydroidPanel {
 
 G_DEFINE_TYPE (CcWaydroidPanel, cc_waydroid_panel, CC_TYPE_PANEL)
 
+static void
+cc_waydroid_panel_dispose (GObject *object)
+{
+  CcWaydroidPanel *self = CC_WAYDROID_PANEL (object);
+
+  g_cancellable_cancel (self->cancellable);
+  g_cancellable_cancel (self->selection_cancellable);
+  g_clear_handle_id (&self->update_info_id, g_source_remove);
+  g_clear_object (&self->container_proxy);
+  g_clear_object (&self->session_proxy);
+  g_clear_object (&self->catalog);
+
+  G_OBJECT_CLASS (cc_waydroid_panel_parent_class)->dispose (object);
+}
+
 static void
 cc_waydroid_panel_finalize (GObject *object)
 {
   CcWaydroidPanel *self = CC_WAYDROID_PANEL (object);
 
-  g_list_free_full (self->app_widgets, g_object_unref);
+  g_clear_object (&self->cancellable);
+  g_clear_object (&self->selection_cancellable);
 
   if (self->selected_app_name != NULL)
     g_free (self->selected_app_name);
@@ -79,10 +101,6 @@ cc_waydroid_panel_finalize (GObject *object)
     g_free (self->waydroid_vendor_output);
   if (self->waydroid_version_output != NULL)
     g_free (self->waydroid_version_output);
-  if (self->apps != NULL)
-    g_strfreev (self->apps);
-
-  self->app_widgets = NULL;
 
   G_OBJECT_CLASS (cc_waydroid_panel_parent_class)->finalize (object);
 }
@@ -106,644 +124,102 @@ show_toast (CcWaydroidPanel *self, const char *format, ...)
   g_free (message);
 }
 
-static gchar *
-waydroid_get_state (void)
+static void
+waydroid_call_done_cb (GObject      *source_object,
+                       GAsyncResult *res,
+                       gpointer      user_data)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gchar *state = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return NULL;
-  }
-
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "GetSession",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    G_MAXINT,
-    NULL,
-    &error
-  );
+  const gchar *method = user_data;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
 
-  if (error) {
-    g_debug ("Error calling GetSession: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    GVariant *inner_dict;
-    GVariantIter iter;
-    gchar *key, *value;
-
-    inner_dict = g_variant_get_child_value (result, 0);
-
-    g_variant_iter_init (&iter, inner_dict);
-
-    while (g_variant_iter_next (&iter, "{ss}", &key, &value)) {
-      if (g_strcmp0 (key, "state") == 0) {
-        state = g_strdup (value);
-        g_free (key);
-        g_free (value);
-        break;
-      }
-      g_free (key);
-      g_free (value);
-    }
-
-    g_variant_unref (inner_dict);
-    g_variant_unref (result);
-  }
-
-  g_object_unref (waydroid_proxy);
-
-  return state;
-}
-
-static gboolean
-waydroid_get_nfc_status (void)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gboolean nfc_status = FALSE;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return FALSE;
-  }
-
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "GetNfcStatus",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    G_MAXINT,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling GetNfcStatus: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    g_variant_get(result, "(b)", &nfc_status);
-    g_variant_unref (result);
-  }
-
-  g_object_unref (waydroid_proxy);
-
-  return nfc_status;
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (error && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    g_debug ("Error calling %s: %s", method, error->message);
 }
 
+/*
+ * Calls a method on one of the long-lived proxies. Without a callback,
+ * errors are only logged. Nothing is called if the proxy couldn't be
+ * created.
+ */
 static void
-waydroid_toggle_nfc (void)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
+waydroid_call (CcWaydroidPanel     *self,
+               GDBusProxy          *proxy,
+               const gchar         *method,
+               GVariant            *parameters,
+               GAsyncReadyCallback  callback,
+               gpointer             user_data)
+{
+  if (proxy == NULL) {
+    g_debug ("Not calling %s, no proxy for Waydroid", method);
+    if (parameters != NULL)
+      g_variant_unref (g_variant_ref_sink (parameters));
     return;
   }
 
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "NfcToggle",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling NfcToggle: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
-}
-
-static gchar *
-waydroid_get_vendor (void)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gchar *vendor = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return NULL;
-  }
-
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "VendorType",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    G_MAXINT,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling VendorType: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    g_variant_get (result, "(s)", &vendor);
-    g_variant_unref (result);
+  if (callback == NULL) {
+    callback = waydroid_call_done_cb;
+    user_data = (gpointer) method;
   }
 
-  g_object_unref (waydroid_proxy);
-
-  return vendor;
+  g_dbus_proxy_call (proxy,
+                     method,
+                     parameters,
+                     G_DBUS_CALL_FLAGS_NONE,
+                     G_MAXINT,
+                     self->cancellable,
+                     callback,
+                     user_data);
 }
 
 static gchar *
-waydroid_get_ip (void)
+parse_session_state (GVariant *result)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gchar *ip = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
+  g_autoptr(GVariant) inner_dict = NULL;
+  GVariantIter iter;
+  const gchar *key, *value;
 
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return NULL;
-  }
+  inner_dict = g_variant_get_child_value (result, 0);
 
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "IpAddress",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    G_MAXINT,
-    NULL,
-    &error
-  );
+  g_variant_iter_init (&iter, inner_dict);
 
-  if (error) {
-    g_debug ("Error calling IpAddress: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    g_variant_get (result, "(s)", &ip);
-    g_variant_unref (result);
+  while (g_variant_iter_next (&iter, "{&s&s}", &key, &value)) {
+    if (g_strcmp0 (key, "state") == 0)
+      return g_strdup (value);
   }
 
-  g_object_unref (waydroid_proxy);
-
-  return ip;
-}
-
-static gchar *
-waydroid_get_version (void)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gchar *version = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return NULL;
-  }
-
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "LineageVersion",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    G_MAXINT,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling LineageVersion: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    g_variant_get (result, "(s)", &version);
-    g_variant_unref (result);
-  }
-
-  g_object_unref (waydroid_proxy);
-
-  return version;
-}
-
-static void
-waydroid_mount_shared (void)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return;
-  }
-
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "MountSharedFolder",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling MountSharedFolder: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
+  return NULL;
 }
 
 static void
-waydroid_umount_shared (void)
+waydroid_toggle_nfc (CcWaydroidPanel *self)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return;
-  }
-
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "UnmountSharedFolder",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling UnmountSharedFolder: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
+  waydroid_call (self, self->container_proxy, "NfcToggle", NULL, NULL, NULL);
 }
 
 static void
-waydroid_remove_app (const gchar *package_name)
+waydroid_mount_shared (CcWaydroidPanel *self)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return;
-  }
-
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "RemoveApp",
-    g_variant_new("(s)", package_name),
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling RemoveApp: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
+  waydroid_call (self, self->container_proxy, "MountSharedFolder", NULL, NULL, NULL);
 }
 
 static void
-waydroid_install_app (const gchar *package_path)
+waydroid_umount_shared (CcWaydroidPanel *self)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return;
-  }
-
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "InstallApp",
-    g_variant_new("(s)", package_path),
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling InstallApp: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
+  waydroid_call (self, self->container_proxy, "UnmountSharedFolder", NULL, NULL, NULL);
 }
 
 static void
-waydroid_clear_app_data (const gchar *package_name)
+waydroid_clear_app_data (CcWaydroidPanel *self, const gchar *package_name)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return;
-  }
-
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "ClearAppData",
-    g_variant_new("(s)", package_name),
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling ClearAppData: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
+  waydroid_call (self, self->container_proxy, "ClearAppData", g_variant_new ("(s)", package_name), NULL, NULL);
 }
 
 static void
-waydroid_kill_app (const gchar *package_name)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SYSTEM,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_CONTAINER_DBUS_NAME,
-    WAYDROID_CONTAINER_DBUS_PATH,
-    WAYDROID_CONTAINER_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return;
-  }
-
-  g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "KillApp",
-    g_variant_new("(s)", package_name),
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling KillApp: %s", error->message);
-    g_clear_error (&error);
-  }
-
-  g_object_unref (waydroid_proxy);
-}
-
-static gchar *
-waydroid_name_to_package_name (const gchar *name)
-{
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gchar *app_name = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return NULL;
-  }
-
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "NameToPackageName",
-    g_variant_new ("(s)", name),
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling NameToPackageName: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    g_variant_get (result, "(s)", &app_name);
-    g_variant_unref (result);
-  }
-
-  g_object_unref (waydroid_proxy);
-  return app_name;
-}
-
-static gchar **
-waydroid_get_all_names (void)
+waydroid_kill_app (CcWaydroidPanel *self, const gchar *package_name)
 {
-  GDBusProxy *waydroid_proxy;
-  GError *error = NULL;
-  GVariant *result;
-  gchar **names = NULL;
-
-  waydroid_proxy = g_dbus_proxy_new_for_bus_sync(
-    G_BUS_TYPE_SESSION,
-    G_DBUS_PROXY_FLAGS_NONE,
-    NULL,
-    WAYDROID_SESSION_DBUS_NAME,
-    WAYDROID_SESSION_DBUS_PATH,
-    WAYDROID_SESSION_DBUS_INTERFACE,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error creating proxy: %s", error->message);
-    g_clear_error (&error);
-    return NULL;
-  }
-
-  result = g_dbus_proxy_call_sync(
-    waydroid_proxy,
-    "GetAllNames",
-    NULL,
-    G_DBUS_CALL_FLAGS_NONE,
-    -1,
-    NULL,
-    &error
-  );
-
-  if (error) {
-    g_debug ("Error calling GetAllNames: %s", error->message);
-    g_clear_error (&error);
-  } else {
-    g_variant_get (result, "(^as)", &names);
-    g_variant_unref (result);
-  }
-
-  g_object_unref (waydroid_proxy);
-  return names;
+  waydroid_call (self, self->container_proxy, "KillApp", g_variant_new ("(s)", package_name), NULL, NULL);
 }
 
 static int
@@ -811,7 +287,7 @@ cc_waydroid_panel_enable_notification (CcWaydroidPanel *self, gboolean state)
 static void
 cc_waydroid_panel_nfc (GtkSwitch *widget, gboolean state, CcWaydroidPanel *self)
 {
-  waydroid_toggle_nfc ();
+  waydroid_toggle_nfc (self);
   gtk_switch_set_state (GTK_SWITCH (self->waydroid_nfc_switch), state);
   gtk_switch_set_active (GTK_SWITCH (self->waydroid_nfc_switch), state);
 }
@@ -864,191 +340,207 @@ static void
 cc_waydroid_panel_shared_folder (GtkSwitch *widget, gboolean state, CcWaydroidPanel *self)
 {
   if (state) {
-    waydroid_mount_shared ();
+    waydroid_mount_shared (self);
     gtk_switch_set_state (GTK_SWITCH (self->waydroid_shared_folder_switch), TRUE);
     gtk_switch_set_active (GTK_SWITCH (self->waydroid_shared_folder_switch), TRUE);
   } else {
-    waydroid_umount_shared ();
+    waydroid_umount_shared (self);
     gtk_switch_set_state (GTK_SWITCH (self->waydroid_shared_folder_switch), FALSE);
     gtk_switch_set_active (GTK_SWITCH (self->waydroid_shared_folder_switch), FALSE);
   }
 }
 
-static gboolean
-update_ip_idle (gpointer user_data)
+static void
+ip_address_cb (GObject      *source_object,
+               GAsyncResult *res,
+               gpointer      user_data)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-
-  gtk_label_set_text (GTK_LABEL (self->waydroid_ip_label), self->waydroid_ip_output);
+  CcWaydroidPanel *self;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
 
-  return G_SOURCE_REMOVE;
-}
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-static gpointer
-update_waydroid_ip (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  self = CC_WAYDROID_PANEL (user_data);
 
-  self->waydroid_ip_output = waydroid_get_ip ();
+  if (error) {
+    g_debug ("Error calling IpAddress: %s", error->message);
+    return;
+  }
 
-  g_idle_add (update_ip_idle, self);
+  g_clear_pointer (&self->waydroid_ip_output, g_free);
+  g_variant_get (result, "(s)", &self->waydroid_ip_output);
 
-  return NULL;
+  gtk_label_set_text (GTK_LABEL (self->waydroid_ip_label), self->waydroid_ip_output);
 }
 
 static void
-update_waydroid_ip_threaded (CcWaydroidPanel *self)
+update_waydroid_ip (CcWaydroidPanel *self)
 {
-  g_thread_new ("update_waydroid_ip", update_waydroid_ip, self);
+  waydroid_call (self, self->session_proxy, "IpAddress", NULL, ip_address_cb, self);
 }
 
-static GtkWidget *
-create_app_row (const gchar *app_name)
+static void
+app_row_setup_cb (GtkSignalListItemFactory *factory,
+                  GtkListItem              *list_item,
+                  gpointer                  user_data)
 {
   GtkWidget *box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 12);
+  GtkWidget *icon;
+  GtkWidget *label;
+
   gtk_widget_set_margin_top (box, 12);
   gtk_widget_set_margin_bottom (box, 8);
   gtk_widget_set_margin_start (box, 16);
   gtk_widget_set_margin_end (box, 16);
 
-  gchar *app_pkgname = waydroid_name_to_package_name (app_name);
-
-  GtkWidget *icon;
-  if (app_pkgname != NULL) {
-    const gchar *home_dir = g_get_home_dir ();
-    gchar *icon_path = g_strdup_printf ("%s/.local/share/waydroid/data/icons/%s.png", home_dir, app_pkgname);
-
-    if (g_file_test (icon_path, G_FILE_TEST_EXISTS))
-      icon = gtk_image_new_from_file (icon_path);
-    else
-      icon = gtk_image_new_from_icon_name ("application-x-executable");
-
-    g_free (icon_path);
-    g_free (app_pkgname);
-  } else
-    icon = gtk_image_new_from_icon_name ("application-x-executable");
-
+  icon = gtk_image_new ();
   gtk_image_set_pixel_size (GTK_IMAGE (icon), 32);
   gtk_box_append (GTK_BOX (box), icon);
 
-  GtkWidget *label = gtk_label_new (app_name);
+  label = gtk_label_new (NULL);
   gtk_widget_set_hexpand (label, TRUE);
   gtk_label_set_xalign (GTK_LABEL (label), 0);
   gtk_box_append (GTK_BOX (box), label);
 
-  return box;
+  gtk_list_item_set_child (list_item, box);
 }
 
 static void
-on_app_activated (GtkListBox *box, GtkListBoxRow *row, gpointer user_data)
+app_row_bind_cb (GtkSignalListItemFactory *factory,
+                 GtkListItem              *list_item,
+                 gpointer                  user_data)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  CcWaydroidApp *app = gtk_list_item_get_item (list_item);
+  GtkWidget *box = gtk_list_item_get_child (list_item);
+  GtkWidget *icon = gtk_widget_get_first_child (box);
+  GtkWidget *label = gtk_widget_get_next_sibling (icon);
 
-  GtkWidget *child = gtk_list_box_row_get_child (row);
-  GtkWidget *label = gtk_widget_get_first_child (child);
+  if (cc_waydroid_app_get_icon (app) != NULL)
+    gtk_image_set_from_paintable (GTK_IMAGE (icon), cc_waydroid_app_get_icon (app));
+  else
+    gtk_image_set_from_icon_name (GTK_IMAGE (icon), "application-x-executable");
 
-  while (label && !GTK_IS_LABEL (label)) {
-    label = gtk_widget_get_next_sibling (label);
-  }
+  gtk_label_set_label (GTK_LABEL (label), cc_waydroid_app_get_name (app));
+}
+
+static void
+selected_package_name_cb (GObject      *source_object,
+                          GAsyncResult *res,
+                          gpointer      user_data)
+{
+  CcWaydroidPanel *self;
+  CcWaydroidApp *app;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
 
-  if (GTK_IS_LABEL (label)) {
-    const gchar *app_name = gtk_label_get_text (GTK_LABEL (label));
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-    self->selected_app_name = g_strdup (app_name);
-    self->selected_app_pkgname = waydroid_name_to_package_name (app_name);
+  self = CC_WAYDROID_PANEL (user_data);
 
-    g_debug ("Selected app: %s", self->selected_app_name);
-    g_debug ("Package name: %s", self->selected_app_pkgname);
+  g_clear_pointer (&self->selected_app_pkgname, g_free);
 
-    adw_bottom_sheet_set_open (self->bottom_sheet, TRUE);
-  }
-}
+  if (error) {
+    g_debug ("Error calling NameToPackageName: %s", error->message);
+  } else {
+    g_variant_get (result, "(s)", &self->selected_app_pkgname);
 
-static int
-qsort_g_strcmp0 (const void *a, const void *b)
-{
-  return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
-}
+    /* Any earlier lookup was cancelled, so this is the selected app */
+    app = cc_waydroid_app_catalog_lookup (self->catalog, self->selected_app_name);
+    if (app != NULL)
+      cc_waydroid_app_set_package_name (app, self->selected_app_pkgname);
+  }
 
-static gboolean
-set_refresh_sensitive (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-  gtk_widget_set_sensitive (GTK_WIDGET (self->refresh_app_list_button), !self->refreshing);
-  gtk_widget_set_sensitive (GTK_WIDGET (self->app_selector), !self->refreshing);
-  return G_SOURCE_REMOVE;
+  g_debug ("Package name: %s", self->selected_app_pkgname);
+
+  adw_bottom_sheet_set_open (self->bottom_sheet, TRUE);
 }
 
-static gboolean
-update_app_list_idle (gpointer user_data)
+static void
+on_app_activated (GtkListView *list, guint position, gpointer user_data)
 {
   CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-  AdwExpanderRow *expander_row = ADW_EXPANDER_ROW (self->app_selector);
-  GtkListBox *list_box = self->app_list;
+  GListModel *model = cc_waydroid_app_catalog_get_model (self->catalog);
+  g_autoptr(CcWaydroidApp) app = NULL;
+  const gchar *package_name;
+
+  app = g_list_model_get_item (model, position);
+  if (app == NULL)
+    return;
 
-  adw_expander_row_set_expanded (self->app_selector, FALSE);
+  g_free (self->selected_app_name);
+  self->selected_app_name = g_strdup (cc_waydroid_app_get_name (app));
 
-  if (self->apps == NULL) {
-    g_debug ("self->apps became NULL, returning");
-    return G_SOURCE_REMOVE;
-  }
+  g_debug ("Selected app: %s", self->selected_app_name);
 
-  if (!list_box) {
-    list_box = GTK_LIST_BOX (gtk_list_box_new ());
-    gtk_widget_set_margin_top (GTK_WIDGET (list_box), 8);
-    gtk_widget_set_margin_bottom (GTK_WIDGET (list_box), 8);
-    gtk_list_box_set_selection_mode (list_box, GTK_SELECTION_NONE);
-    g_signal_connect (list_box, "row-activated", G_CALLBACK (on_app_activated), self);
+  g_cancellable_cancel (self->selection_cancellable);
+  g_clear_object (&self->selection_cancellable);
 
-    adw_expander_row_add_row (expander_row, GTK_WIDGET (list_box));
-    self->app_list = list_box;
-  } else {
-    gtk_list_box_remove_all (list_box);
+  /* Waydroid is only asked for apps it wrote no desktop file for */
+  package_name = cc_waydroid_app_get_package_name (app);
+  if (package_name != NULL) {
+    g_free (self->selected_app_pkgname);
+    self->selected_app_pkgname = g_strdup (package_name);
+    adw_bottom_sheet_set_open (self->bottom_sheet, TRUE);
+    return;
   }
 
-  g_list_free_full (self->app_widgets, g_object_unref);
-  self->app_widgets = NULL;
-  qsort (self->apps, g_strv_length (self->apps), sizeof (gchar *), qsort_g_strcmp0);
+  if (self->session_proxy == NULL)
+    return;
 
-  for (gchar **app = self->apps; *app; app++) {
-    if ((*app)[0] != '\0') {
-      GtkWidget *row = create_app_row (*app);
-      gtk_list_box_append (list_box, row);
-      self->app_widgets = g_list_append (self->app_widgets, g_object_ref (row));
-      g_debug ("Added row for app: %s", *app);
-    }
-  }
+  self->selection_cancellable = g_cancellable_new ();
+  g_dbus_proxy_call (self->session_proxy,
+                     "NameToPackageName",
+                     g_variant_new ("(s)", self->selected_app_name),
+                     G_DBUS_CALL_FLAGS_NONE,
+                     G_MAXINT,
+                     self->selection_cancellable,
+                     selected_package_name_cb,
+                     self);
+}
 
-  self->refreshing = FALSE;
-  g_idle_add (set_refresh_sensitive, self);
+static void
+set_refresh_sensitive (CcWaydroidPanel *self)
+{
+  gboolean refreshing = cc_waydroid_app_catalog_get_refreshing (self->catalog);
 
-  return G_SOURCE_REMOVE;
+  gtk_widget_set_sensitive (GTK_WIDGET (self->refresh_app_list_button), !refreshing);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->app_selector), !refreshing);
 }
 
-static gpointer
-update_app_list (gpointer user_data)
+static void
+catalog_refreshed_cb (GObject      *source_object,
+                      GAsyncResult *res,
+                      gpointer      user_data)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  CcWaydroidPanel *self;
+  g_autoptr(GError) error = NULL;
 
-  self->refreshing = TRUE;
-  g_idle_add (set_refresh_sensitive, self);
-  self->apps = waydroid_get_all_names ();
-  if (self->apps == NULL) {
-    g_debug ("Failed to get app names");
-    self->refreshing = FALSE;
-    g_idle_add (set_refresh_sensitive, self);
-    return NULL;
-  }
+  if (!cc_waydroid_app_catalog_refresh_finish (CC_WAYDROID_APP_CATALOG (source_object), res, &error) &&
+      g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-  g_idle_add (update_app_list_idle, self);
+  self = CC_WAYDROID_PANEL (user_data);
 
-  return NULL;
+  set_refresh_sensitive (self);
+
+  if (error)
+    g_debug ("Failed to refresh app list: %s", error->message);
 }
 
 static void
-update_app_list_threaded (CcWaydroidPanel *self)
+update_app_list (CcWaydroidPanel *self)
 {
-  g_thread_new ("update_app_list", update_app_list, self);
+  if (cc_waydroid_app_catalog_get_refreshing (self->catalog))
+    return;
+
+  cc_waydroid_app_catalog_refresh_async (self->catalog, self->session_proxy, self->cancellable,
+                                         catalog_refreshed_cb, self);
+  set_refresh_sensitive (self);
 }
 
 static void
@@ -1071,6 +563,24 @@ set_enable_widgets_state (CcWaydroidPanel *self)
   return G_SOURCE_REMOVE;
 }
 
+static void
+app_list_changed_cb (GObject      *source_object,
+                     GAsyncResult *res,
+                     gpointer      user_data)
+{
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
+
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  if (error)
+    g_debug ("Error installing or removing app: %s", error->message);
+
+  update_app_list (CC_WAYDROID_PANEL (user_data));
+}
+
 static void
 cc_waydroid_panel_uninstall_app (GtkWidget *widget, CcWaydroidPanel *self)
 {
@@ -1079,233 +589,244 @@ cc_waydroid_panel_uninstall_app (GtkWidget *widget, CcWaydroidPanel *self)
     set_widgets_state (self, FALSE);
 
     gchar *stripped_pkgname = g_strstrip (pkgname);
-    waydroid_remove_app (stripped_pkgname);
+    waydroid_call (self, self->session_proxy, "RemoveApp", g_variant_new ("(s)", stripped_pkgname),
+                   app_list_changed_cb, self);
 
     g_timeout_add_seconds (5, (GSourceFunc) set_enable_widgets_state, self);
-
-    update_app_list_threaded (self);
   } else
     show_toast (self, "No app selected");
 }
 
-static gpointer
-cc_waydroid_panel_launch_app (gpointer user_data)
+static void
+cc_waydroid_panel_launch_app (GtkWidget *widget, CcWaydroidPanel *self)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  g_autofree gchar *pkgname = NULL;
+  g_autofree gchar *desktop_file_path = NULL;
+  g_autofree gchar *launch_command = NULL;
+  g_autoptr(GError) error = NULL;
 
-  if (self->selected_app_pkgname != NULL && g_strstrip (self->selected_app_pkgname)[0] != '\0') {
-    g_debug ("Launching Android application: %s", self->selected_app_pkgname);
+  if (self->selected_app_pkgname == NULL) {
+    show_toast (self, "No app selected");
+    return;
+  }
 
-    const gchar *home_dir = g_get_home_dir ();
-    gchar *desktop_file_path = g_strdup_printf ("%s/.local/share/applications/waydroid.%s.desktop", home_dir, g_strstrip (self->selected_app_pkgname));
-    gchar *launch_command = g_strdup_printf ("dex \"%s\"", desktop_file_path);
+  /* The selection may change while the app starts */
+  pkgname = g_strstrip (g_strdup (self->selected_app_pkgname));
+  if (pkgname[0] == '\0')
+    return;
 
-    g_spawn_command_line_async (launch_command, NULL);
+  g_debug ("Launching Android application: %s", pkgname);
 
-    g_free (launch_command);
-    g_free (desktop_file_path);
-  }
+  desktop_file_path = g_strdup_printf ("%s/.local/share/applications/waydroid.%s.desktop", g_get_home_dir (), pkgname);
+  launch_command = g_strdup_printf ("dex \"%s\"", desktop_file_path);
 
-  return NULL;
+  if (!g_spawn_command_line_async (launch_command, &error))
+    g_warning ("Failed to launch %s: %s", pkgname, error->message);
 }
 
 static void
-cc_waydroid_panel_launch_app_threaded (GtkWidget *widget, CcWaydroidPanel *self)
-{
-  if (self->selected_app_pkgname != NULL)
-    g_thread_new ("cc_waydroid_panel_launch_app", cc_waydroid_panel_launch_app, self);
-  else
-    show_toast (self, "No app selected");
-}
-
-static gboolean
-update_vendor_idle (gpointer user_data)
+vendor_type_cb (GObject      *source_object,
+                GAsyncResult *res,
+                gpointer      user_data)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-
-  gtk_label_set_text (GTK_LABEL (self->waydroid_vendor_label), self->waydroid_vendor_output);
+  CcWaydroidPanel *self;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
 
-  return G_SOURCE_REMOVE;
-}
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-static gpointer
-update_waydroid_vendor (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  self = CC_WAYDROID_PANEL (user_data);
 
-  self->waydroid_vendor_output = waydroid_get_vendor ();
+  if (error) {
+    g_debug ("Error calling VendorType: %s", error->message);
+    return;
+  }
 
-  g_idle_add (update_vendor_idle, self);
+  g_clear_pointer (&self->waydroid_vendor_output, g_free);
+  g_variant_get (result, "(s)", &self->waydroid_vendor_output);
 
-  return NULL;
+  gtk_label_set_text (GTK_LABEL (self->waydroid_vendor_label), self->waydroid_vendor_output);
 }
 
 static void
-update_waydroid_vendor_threaded (CcWaydroidPanel *self)
+update_waydroid_vendor (CcWaydroidPanel *self)
 {
-  g_thread_new ("update_waydroid_vendor", update_waydroid_vendor, self);
+  waydroid_call (self, self->session_proxy, "VendorType", NULL, vendor_type_cb, self);
 }
 
-static gboolean
-update_version_idle (gpointer user_data)
+static void
+lineage_version_cb (GObject      *source_object,
+                    GAsyncResult *res,
+                    gpointer      user_data)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-
-  gtk_label_set_text (GTK_LABEL (self->waydroid_version_label), self->waydroid_version_output);
+  CcWaydroidPanel *self;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
 
-  return G_SOURCE_REMOVE;
-}
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-static gpointer
-update_waydroid_version (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  self = CC_WAYDROID_PANEL (user_data);
 
-  self->waydroid_version_output = waydroid_get_version ();
+  if (error) {
+    g_debug ("Error calling LineageVersion: %s", error->message);
+    return;
+  }
 
-  g_idle_add (update_version_idle, self);
+  g_clear_pointer (&self->waydroid_version_output, g_free);
+  g_variant_get (result, "(s)", &self->waydroid_version_output);
 
-  return NULL;
+  gtk_label_set_text (GTK_LABEL (self->waydroid_version_label), self->waydroid_version_output);
 }
 
 static void
-update_waydroid_version_threaded (CcWaydroidPanel *self)
+update_waydroid_version (CcWaydroidPanel *self)
 {
-  g_thread_new ("update_waydroid_version", update_waydroid_version, self);
+  waydroid_call (self, self->session_proxy, "LineageVersion", NULL, lineage_version_cb, self);
 }
 
-static gboolean
-check_nfc_idle (gpointer user_data)
+static void
+nfc_status_cb (GObject      *source_object,
+               GAsyncResult *res,
+               gpointer      user_data)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  CcWaydroidPanel *self;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
+
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WAYDROID_PANEL (user_data);
+
+  if (error) {
+    g_debug ("Error calling GetNfcStatus: %s", error->message);
+    self->waydroid_nfc_active = FALSE;
+  } else {
+    g_variant_get (result, "(b)", &self->waydroid_nfc_active);
+  }
 
   g_signal_handlers_block_by_func (self->waydroid_nfc_switch, cc_waydroid_panel_nfc, self);
   gtk_switch_set_state (GTK_SWITCH (self->waydroid_nfc_switch), self->waydroid_nfc_active);
   gtk_switch_set_active (GTK_SWITCH (self->waydroid_nfc_switch), self->waydroid_nfc_active);
   g_signal_handlers_unblock_by_func (self->waydroid_nfc_switch, cc_waydroid_panel_nfc, self);
+}
 
-  return G_SOURCE_REMOVE;
+static void
+check_waydroid_nfc (CcWaydroidPanel *self)
+{
+  waydroid_call (self, self->container_proxy, "GetNfcStatus", NULL, nfc_status_cb, self);
 }
 
-static gpointer
-check_waydroid_nfc (gpointer user_data)
+/* What isn't asked from Waydroid itself is checked in a single thread */
+typedef struct {
+  gboolean notification_active;
+  gboolean shared_folder_enabled;
+} LocalState;
+
+static void
+check_local_state_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
 {
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  LocalState *state = g_new0 (LocalState, 1);
+  g_autofree gchar *android_dir_path = NULL;
 
-  self->waydroid_nfc_active = waydroid_get_nfc_status ();
+  state->notification_active = cc_is_service_active (WAYDROID_NOTIFICATION_CLIENT_SERVICE, G_BUS_TYPE_SESSION);
 
-  g_idle_add (check_nfc_idle, self);
+  android_dir_path = g_strdup_printf ("%s/Android", g_get_home_dir ());
+  state->shared_folder_enabled = is_mounted (android_dir_path) == 1;
 
-  return NULL;
+  g_task_return_pointer (task, state, g_free);
 }
 
 static void
-check_waydroid_nfc_threaded (CcWaydroidPanel *self)
+check_local_state_cb (GObject      *source_object,
+                      GAsyncResult *res,
+                      gpointer      user_data)
 {
-  g_thread_new ("check_waydroid_nfc", check_waydroid_nfc, self);
-}
+  CcWaydroidPanel *self = CC_WAYDROID_PANEL (source_object);
+  g_autofree LocalState *state = NULL;
 
-static gboolean
-check_notification_idle (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+  state = g_task_propagate_pointer (G_TASK (res), NULL);
+  if (state == NULL)
+    return;
+
+  self->waydroid_notification_active = state->notification_active;
+  self->waydroid_shared_folder_enabled = state->shared_folder_enabled;
 
   g_signal_handlers_block_by_func (self->waydroid_notification_switch, cc_waydroid_panel_notification, self);
   gtk_switch_set_state (GTK_SWITCH (self->waydroid_notification_switch), self->waydroid_notification_active);
   gtk_switch_set_active (GTK_SWITCH (self->waydroid_notification_switch), self->waydroid_notification_active);
   g_signal_handlers_unblock_by_func (self->waydroid_notification_switch, cc_waydroid_panel_notification, self);
 
-  return G_SOURCE_REMOVE;
-}
-
-static gpointer
-check_waydroid_notification (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-
-  self->waydroid_notification_active = cc_is_service_active (WAYDROID_NOTIFICATION_CLIENT_SERVICE, G_BUS_TYPE_SESSION);
-
-  g_idle_add (check_notification_idle, self);
-
-  return NULL;
-}
-
-static void
-check_waydroid_notification_threaded (CcWaydroidPanel *self)
-{
-  g_thread_new ("check_waydroid_notification", check_waydroid_notification, self);
-}
-
-static gboolean
-check_shared_folder_idle (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-
   g_signal_handlers_block_by_func (self->waydroid_shared_folder_switch, cc_waydroid_panel_shared_folder, self);
   gtk_switch_set_state (GTK_SWITCH (self->waydroid_shared_folder_switch), self->waydroid_shared_folder_enabled);
   gtk_switch_set_active (GTK_SWITCH (self->waydroid_shared_folder_switch), self->waydroid_shared_folder_enabled);
   g_signal_handlers_unblock_by_func (self->waydroid_shared_folder_switch, cc_waydroid_panel_shared_folder, self);
-
-  return G_SOURCE_REMOVE;
-}
-
-static gpointer
-check_waydroid_shared_folder (gpointer user_data)
-{
-  CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-
-  const gchar *home_dir = g_get_home_dir ();
-  gchar *android_dir_path = g_strdup_printf ("%s/Android", home_dir);
-  self->waydroid_shared_folder_enabled = is_mounted (android_dir_path);
-  g_free (android_dir_path);
-
-  g_idle_add (check_shared_folder_idle, self);
-
-  return NULL;
 }
 
 static void
-check_waydroid_shared_folder_threaded (CcWaydroidPanel *self)
+check_local_state (CcWaydroidPanel *self)
 {
-  g_thread_new ("check_waydroid_shared_folder", check_waydroid_shared_folder, self);
+  g_autoptr(GTask) task = NULL;
+
+  task = g_task_new (self, self->cancellable, check_local_state_cb, NULL);
+  g_task_set_return_on_cancel (task, TRUE);
+  g_task_run_in_thread (task, check_local_state_thread);
 }
 
 static void
 update_waydroid_info (CcWaydroidPanel *self)
 {
-  update_waydroid_ip_threaded (self);
-  update_waydroid_vendor_threaded (self);
-  update_waydroid_version_threaded (self);
-  update_app_list_threaded (self);
-  check_waydroid_notification_threaded (self);
-  check_waydroid_nfc_threaded (self);
-  check_waydroid_shared_folder_threaded (self);
+  update_waydroid_ip (self);
+  update_waydroid_vendor (self);
+  update_waydroid_version (self);
+  update_app_list (self);
+  check_waydroid_nfc (self);
+  check_local_state (self);
 }
 
 static gboolean
 update_waydroid_info_idle (gpointer user_data)
 {
   CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
+
+  self->update_info_id = 0;
   update_waydroid_info (self);
+
   return G_SOURCE_REMOVE;
 }
 
+/* Coalesces the refreshes asked for in one main loop iteration */
+static void
+queue_update_waydroid_info (CcWaydroidPanel *self)
+{
+  if (self->update_info_id == 0)
+    self->update_info_id = g_idle_add (update_waydroid_info_idle, self);
+}
+
 static void
 cc_waydroid_refresh_button (GtkButton *button, gpointer user_data)
 {
   CcWaydroidPanel *self = (CcWaydroidPanel *) user_data;
-  g_idle_add (update_waydroid_info_idle, self);
+  queue_update_waydroid_info (self);
 }
 
 static void
 install_app (CcWaydroidPanel *self, GFile *file)
 {
   gchar *file_path = g_file_get_path (file);
-  waydroid_install_app (file_path);
 
-  g_free (file_path);
+  waydroid_call (self, self->session_proxy, "InstallApp", g_variant_new ("(s)", file_path),
+                 app_list_changed_cb, self);
 
-  update_app_list_threaded (self);
+  g_free (file_path);
 }
 
 static void
@@ -1362,7 +883,7 @@ cc_waydroid_panel_clear_app_data (GtkWidget *widget, CcWaydroidPanel *self)
     set_widgets_state (self, FALSE);
 
     gchar *stripped_pkgname = g_strstrip (pkgname);
-    waydroid_clear_app_data (stripped_pkgname);
+    waydroid_clear_app_data (self, stripped_pkgname);
 
     g_timeout_add_seconds (2, (GSourceFunc) set_enable_widgets_state, self);
   } else
@@ -1377,7 +898,7 @@ cc_waydroid_panel_kill_app (GtkWidget *widget, CcWaydroidPanel *self)
     set_widgets_state (self, FALSE);
 
     gchar *stripped_pkgname = g_strstrip (pkgname);
-    waydroid_kill_app (stripped_pkgname);
+    waydroid_kill_app (self, stripped_pkgname);
 
     g_timeout_add_seconds (2, (GSourceFunc) set_enable_widgets_state, self);
   } else
@@ -1439,15 +960,7 @@ enable_idle (gpointer data)
                          GTK_WIDGET (self->factory_reset_button),
                          NULL);
 
-  g_signal_connect (G_OBJECT (self->launch_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_launch_app_threaded), self);
-  g_signal_connect (G_OBJECT (self->remove_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_uninstall_app), self);
-  g_signal_connect (G_OBJECT (self->install_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_install_app), self);
-  g_signal_connect (G_OBJECT (self->store_button), "clicked", G_CALLBACK (cc_waydroid_panel_open_store), self);
-  g_signal_connect (self->refresh_app_list_button, "clicked", G_CALLBACK (cc_waydroid_refresh_button), self);
-  g_signal_connect (G_OBJECT (self->clear_app_data_button), "clicked", G_CALLBACK (cc_waydroid_panel_clear_app_data), self);
-  g_signal_connect (G_OBJECT (self->kill_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_kill_app), self);
-
-  g_idle_add (update_waydroid_info_idle, self);
+  queue_update_waydroid_info (self);
 
   return G_SOURCE_REMOVE;
 }
@@ -1512,12 +1025,192 @@ cc_waydroid_panel_enable_waydroid (GtkSwitch *widget, gboolean state, CcWaydroid
   return FALSE;
 }
 
+static void
+show_waydroid_running (CcWaydroidPanel *self)
+{
+  g_signal_handlers_block_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
+  gtk_switch_set_state (GTK_SWITCH (self->waydroid_enabled_switch), TRUE);
+  gtk_switch_set_active (GTK_SWITCH (self->waydroid_enabled_switch), TRUE);
+  g_signal_handlers_unblock_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
+
+  set_widgets_sensitive (TRUE,
+                         GTK_WIDGET (self->waydroid_nfc_switch),
+                         GTK_WIDGET (self->waydroid_notification_switch),
+                         GTK_WIDGET (self->launch_app_button),
+                         GTK_WIDGET (self->remove_app_button),
+                         GTK_WIDGET (self->install_app_button),
+                         GTK_WIDGET (self->app_selector),
+                         GTK_WIDGET (self->store_button),
+                         GTK_WIDGET (self->refresh_app_list_button),
+                         GTK_WIDGET (self->clear_app_data_button),
+                         GTK_WIDGET (self->kill_app_button),
+                         NULL);
+
+  set_widgets_sensitive (FALSE,
+                         GTK_WIDGET (self->factory_reset_button),
+                         NULL);
+
+  queue_update_waydroid_info (self);
+}
+
+static void
+show_waydroid_stopped (CcWaydroidPanel *self)
+{
+  g_signal_handlers_block_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
+  gtk_switch_set_state (GTK_SWITCH (self->waydroid_enabled_switch), FALSE);
+  gtk_switch_set_active (GTK_SWITCH (self->waydroid_enabled_switch), FALSE);
+  g_signal_handlers_unblock_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
+  gtk_label_set_text (GTK_LABEL (self->waydroid_vendor_label), "");
+  gtk_label_set_text (GTK_LABEL (self->waydroid_version_label), "");
+
+  set_widgets_sensitive (FALSE,
+                         GTK_WIDGET (self->waydroid_nfc_switch),
+                         GTK_WIDGET (self->waydroid_notification_switch),
+                         GTK_WIDGET (self->launch_app_button),
+                         GTK_WIDGET (self->remove_app_button),
+                         GTK_WIDGET (self->install_app_button),
+                         GTK_WIDGET (self->app_selector),
+                         GTK_WIDGET (self->store_button),
+                         GTK_WIDGET (self->refresh_app_list_button),
+                         GTK_WIDGET (self->clear_app_data_button),
+                         GTK_WIDGET (self->kill_app_button),
+                         NULL);
+}
+
+static void
+session_state_cb (GObject      *source_object,
+                  GAsyncResult *res,
+                  gpointer      user_data)
+{
+  CcWaydroidPanel *self;
+  g_autoptr(GVariant) result = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *state = NULL;
+
+  result = g_dbus_proxy_call_finish (G_DBUS_PROXY (source_object), res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WAYDROID_PANEL (user_data);
+
+  if (error) {
+    g_debug ("Error calling GetSession: %s", error->message);
+    return;
+  }
+
+  state = parse_session_state (result);
+  if (g_strcmp0 (state, "RUNNING") == 0)
+    show_waydroid_running (self);
+  else
+    show_waydroid_stopped (self);
+}
+
+/* Waydroid exports no properties, so the session coming and going on
+ * the bus is the only change there is to watch */
+static void
+on_session_owner_changed (CcWaydroidPanel *self)
+{
+  g_autofree gchar *name_owner = g_dbus_proxy_get_name_owner (self->session_proxy);
+
+  if (name_owner == NULL) {
+    show_waydroid_stopped (self);
+    return;
+  }
+
+  waydroid_call (self, self->container_proxy, "GetSession", NULL, session_state_cb, self);
+}
+
+static void
+proxy_ready (CcWaydroidPanel *self)
+{
+  self->n_pending_proxies--;
+  if (self->n_pending_proxies > 0)
+    return;
+
+  waydroid_call (self, self->container_proxy, "GetSession", NULL, session_state_cb, self);
+}
+
+static void
+container_proxy_ready_cb (GObject      *source_object,
+                          GAsyncResult *res,
+                          gpointer      user_data)
+{
+  CcWaydroidPanel *self;
+  g_autoptr(GDBusProxy) proxy = NULL;
+  g_autoptr(GError) error = NULL;
+
+  proxy = g_dbus_proxy_new_for_bus_finish (res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WAYDROID_PANEL (user_data);
+
+  if (error) {
+    g_debug ("Error creating proxy: %s", error->message);
+  } else {
+    self->container_proxy = g_steal_pointer (&proxy);
+  }
+
+  proxy_ready (self);
+}
+
+static void
+session_proxy_ready_cb (GObject      *source_object,
+                        GAsyncResult *res,
+                        gpointer      user_data)
+{
+  CcWaydroidPanel *self;
+  g_autoptr(GDBusProxy) proxy = NULL;
+  g_autoptr(GError) error = NULL;
+
+  proxy = g_dbus_proxy_new_for_bus_finish (res, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WAYDROID_PANEL (user_data);
+
+  if (error) {
+    g_debug ("Error creating proxy: %s", error->message);
+  } else {
+    self->session_proxy = g_steal_pointer (&proxy);
+    g_signal_connect_object (self->session_proxy, "notify::g-name-owner",
+                             G_CALLBACK (on_session_owner_changed), self, G_CONNECT_SWAPPED);
+  }
+
+  proxy_ready (self);
+}
+
+/* Apps installed or removed from inside Android show up in the desktop
+ * files Waydroid writes */
+static void
+on_catalog_changed (CcWaydroidPanel *self)
+{
+  if (gtk_switch_get_active (GTK_SWITCH (self->waydroid_enabled_switch)))
+    update_app_list (self);
+}
+
+/* The list only gets its model once shown, and then only makes rows
+ * for the apps scrolled into view */
+static void
+on_app_selector_expanded (CcWaydroidPanel *self)
+{
+  g_autoptr(GtkSelectionModel) selection = NULL;
+
+  if (self->app_list_bound || !adw_expander_row_get_expanded (self->app_selector))
+    return;
+
+  selection = GTK_SELECTION_MODEL (gtk_no_selection_new (g_object_ref (cc_waydroid_app_catalog_get_model (self->catalog))));
+  gtk_list_view_set_model (self->app_list, selection);
+  self->app_list_bound = TRUE;
+}
+
 static void
 cc_waydroid_panel_class_init (CcWaydroidPanelClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
+  object_class->dispose = cc_waydroid_panel_dispose;
   object_class->finalize = cc_waydroid_panel_finalize;
 
   gtk_widget_class_set_template_from_resource (widget_class,
@@ -1603,21 +1296,22 @@ cc_waydroid_panel_class_init (CcWaydroidPanelClass *klass)
 static void
 cc_waydroid_panel_init (CcWaydroidPanel *self)
 {
+  GtkListItemFactory *factory;
+  GtkWidget *scrolled_window;
+
   g_resources_register (cc_waydroid_get_resource ());
   gtk_widget_init_template (GTK_WIDGET (self));
 
-  self->app_list_store = g_list_store_new (G_TYPE_APP_INFO);
+  self->cancellable = g_cancellable_new ();
 
   self->selected_app_name = NULL;
   self->selected_app_pkgname = NULL;
   self->waydroid_ip_output = NULL;
   self->waydroid_vendor_output = NULL;
   self->waydroid_version_output = NULL;
-  self->apps = NULL;
   self->waydroid_notification_active = FALSE;
   self->waydroid_nfc_active = FALSE;
   self->waydroid_shared_folder_enabled = FALSE;
-  self->refreshing = FALSE;
 
   if (g_file_test ("/usr/bin/waydroid", G_FILE_TEST_EXISTS)) {
     g_signal_connect (G_OBJECT (self->waydroid_enabled_switch), "state-set", G_CALLBACK (cc_waydroid_panel_enable_waydroid), self);
@@ -1626,6 +1320,13 @@ cc_waydroid_panel_init (CcWaydroidPanel *self)
     g_signal_connect (G_OBJECT (self->waydroid_nfc_switch), "state-set", G_CALLBACK (cc_waydroid_panel_nfc), self);
     g_signal_connect (G_OBJECT (self->waydroid_notification_switch), "state-set", G_CALLBACK (cc_waydroid_panel_notification), self);
     g_signal_connect (G_OBJECT (self->factory_reset_button), "clicked", G_CALLBACK (cc_waydroid_factory_reset_threaded), self);
+    g_signal_connect (G_OBJECT (self->launch_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_launch_app), self);
+    g_signal_connect (G_OBJECT (self->remove_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_uninstall_app), self);
+    g_signal_connect (G_OBJECT (self->install_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_install_app), self);
+    g_signal_connect (G_OBJECT (self->store_button), "clicked", G_CALLBACK (cc_waydroid_panel_open_store), self);
+    g_signal_connect (self->refresh_app_list_button, "clicked", G_CALLBACK (cc_waydroid_refresh_button), self);
+    g_signal_connect (G_OBJECT (self->clear_app_data_button), "clicked", G_CALLBACK (cc_waydroid_panel_clear_app_data), self);
+    g_signal_connect (G_OBJECT (self->kill_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_kill_app), self);
 
     gchar *file_path = g_build_filename (g_get_home_dir (), ".android_enable", NULL);
     if (g_file_test (file_path, G_FILE_TEST_EXISTS)) {
@@ -1642,50 +1343,50 @@ cc_waydroid_panel_init (CcWaydroidPanel *self)
 
     g_free (file_path);
 
-    gchar *current_state = waydroid_get_state ();
-
-    if (current_state != NULL && g_strcmp0 (current_state, "RUNNING") == 0) {
-      g_signal_handlers_block_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
-      gtk_switch_set_state (GTK_SWITCH (self->waydroid_enabled_switch), TRUE);
-      gtk_switch_set_active (GTK_SWITCH (self->waydroid_enabled_switch), TRUE);
-      g_signal_handlers_unblock_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
-
-      set_widgets_sensitive (FALSE,
-                             GTK_WIDGET (self->factory_reset_button),
-                             NULL);
-
-      g_signal_connect (G_OBJECT (self->launch_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_launch_app_threaded), self);
-      g_signal_connect (G_OBJECT (self->remove_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_uninstall_app), self);
-      g_signal_connect (G_OBJECT (self->install_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_install_app), self);
-      g_signal_connect (G_OBJECT (self->store_button), "clicked", G_CALLBACK (cc_waydroid_panel_open_store), self);
-      g_signal_connect (self->refresh_app_list_button, "clicked", G_CALLBACK (cc_waydroid_refresh_button), self);
-      g_signal_connect (G_OBJECT (self->clear_app_data_button), "clicked", G_CALLBACK (cc_waydroid_panel_clear_app_data), self);
-      g_signal_connect (G_OBJECT (self->kill_app_button), "clicked", G_CALLBACK (cc_waydroid_panel_kill_app), self);
-
-      g_idle_add (update_waydroid_info_idle, self);
-    } else {
-      g_signal_handlers_block_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
-      gtk_switch_set_state (GTK_SWITCH (self->waydroid_enabled_switch), FALSE);
-      gtk_switch_set_active (GTK_SWITCH (self->waydroid_enabled_switch), FALSE);
-      g_signal_handlers_unblock_by_func (self->waydroid_enabled_switch, cc_waydroid_panel_enable_waydroid, self);
-      gtk_label_set_text (GTK_LABEL (self->waydroid_vendor_label), "");
-      gtk_label_set_text (GTK_LABEL (self->waydroid_version_label), "");
-
-      set_widgets_sensitive (FALSE,
-                             GTK_WIDGET (self->waydroid_nfc_switch),
-                             GTK_WIDGET (self->waydroid_notification_switch),
-                             GTK_WIDGET (self->launch_app_button),
-                             GTK_WIDGET (self->remove_app_button),
-                             GTK_WIDGET (self->install_app_button),
-                             GTK_WIDGET (self->app_selector),
-                             GTK_WIDGET (self->store_button),
-                             GTK_WIDGET (self->refresh_app_list_button),
-                             GTK_WIDGET (self->clear_app_data_button),
-                             GTK_WIDGET (self->kill_app_button),
-                             NULL);
-    }
-
-    g_free (current_state);
+    self->catalog = cc_waydroid_app_catalog_new (NULL);
+    g_signal_connect_object (self->catalog, "changed", G_CALLBACK (on_catalog_changed), self, G_CONNECT_SWAPPED);
+
+    factory = gtk_signal_list_item_factory_new ();
+    g_signal_connect (factory, "setup", G_CALLBACK (app_row_setup_cb), self);
+    g_signal_connect (factory, "bind", G_CALLBACK (app_row_bind_cb), self);
+
+    self->app_list = GTK_LIST_VIEW (gtk_list_view_new (NULL, factory));
+    gtk_list_view_set_single_click_activate (self->app_list, TRUE);
+    g_signal_connect (self->app_list, "activate", G_CALLBACK (on_app_activated), self);
+
+    /* A list view only recycles rows when it scrolls by itself */
+    scrolled_window = gtk_scrolled_window_new ();
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_propagate_natural_height (GTK_SCROLLED_WINDOW (scrolled_window), TRUE);
+    gtk_scrolled_window_set_max_content_height (GTK_SCROLLED_WINDOW (scrolled_window), 400);
+    gtk_widget_set_margin_top (scrolled_window, 8);
+    gtk_widget_set_margin_bottom (scrolled_window, 8);
+    gtk_scrolled_window_set_child (GTK_SCROLLED_WINDOW (scrolled_window), GTK_WIDGET (self->app_list));
+    adw_expander_row_add_row (self->app_selector, scrolled_window);
+    g_signal_connect_swapped (self->app_selector, "notify::expanded", G_CALLBACK (on_app_selector_expanded), self);
+
+    /* Shown as stopped until Waydroid tells otherwise */
+    show_waydroid_stopped (self);
+
+    self->n_pending_proxies = 2;
+    g_dbus_proxy_new_for_bus (G_BUS_TYPE_SYSTEM,
+                              G_DBUS_PROXY_FLAGS_NONE,
+                              NULL,
+                              WAYDROID_CONTAINER_DBUS_NAME,
+                              WAYDROID_CONTAINER_DBUS_PATH,
+                              WAYDROID_CONTAINER_DBUS_INTERFACE,
+                              self->cancellable,
+                              container_proxy_ready_cb,
+                              self);
+    g_dbus_proxy_new_for_bus (G_BUS_TYPE_SESSION,
+                              G_DBUS_PROXY_FLAGS_NONE,
+                              NULL,
+                              WAYDROID_SESSION_DBUS_NAME,
+                              WAYDROID_SESSION_DBUS_PATH,
+                              WAYDROID_SESSION_DBUS_INTERFACE,
+                              self->cancellable,
+                              session_proxy_ready_cb,
+                              self);
   } else {
     gtk_switch_set_state (GTK_SWITCH (self->waydroid_enabled_switch), FALSE);
     gtk_switch_set_active (GTK_SWITCH (self->waydroid_enabled_switch), FALSE);
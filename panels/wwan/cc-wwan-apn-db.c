@@ -0,0 +1,940 @@
+/* -*- Mode: C; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* cc-wwan-apn-db.c
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "cc-wwan-apn-db"
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "cc-wwan-apn-db.h"
+
+/**
+ * @short_description: Shared mobile-provider-info APN database
+ * @include: "cc-wwan-apn-db.h"
+ *
+ * #CcWwanApnDb keeps the APNs of the mobile-provider-info database
+ * in a table indexed by MCCMNC, so that all the modems look up their
+ * APNs in the same table, which is only loaded once, in a thread.
+ *
+ * Only the parts of serviceproviders.xml needed for the APN list are
+ * kept: the GSM networks of each provider and their APNs, named in the
+ * language of the user. The table is saved in a cache file, and loaded
+ * from it as long as the database has the same modification time, to the
+ * nanosecond, and size, and the user the same languages.
+ */
+
+/* Bump the version when changing the format of the cache */
+#define CACHE_VERSION 3
+#define CACHE_VARIANT_TYPE "(ussxxasa(uuuu)a(uu)a(uu))"
+
+/* Unset strings in the cache */
+#define NO_STRING G_MAXUINT32
+
+#ifndef MOBILE_BROADBAND_PROVIDER_INFO_DATABASE
+# define MOBILE_BROADBAND_PROVIDER_INFO_DATABASE "/usr/share/mobile-broadband-provider-info/serviceproviders.xml"
+#endif
+
+typedef struct
+{
+  guint32 first_apn;
+  guint32 n_apns;
+} ProviderRange;
+
+typedef struct
+{
+  GStringChunk *strings;
+  GArray       *apns;      /* CcWwanProviderApn, pointing into strings */
+  GArray       *providers; /* ProviderRange */
+  GHashTable   *networks;  /* MCCMNC → index of the provider */
+} ApnTable;
+
+struct _CcWwanApnDb
+{
+  GObject    parent_instance;
+
+  gchar     *database;
+  gchar     *cache_file;
+  GStrv      languages;
+
+  ApnTable  *table;
+  GError    *error;
+  gboolean   loading;
+  GPtrArray *pending_lookups;
+};
+
+G_DEFINE_TYPE (CcWwanApnDb, cc_wwan_apn_db, G_TYPE_OBJECT)
+
+static ApnTable *
+apn_table_new (void)
+{
+  ApnTable *table;
+
+  table = g_new0 (ApnTable, 1);
+  table->strings = g_string_chunk_new (4096);
+  table->apns = g_array_new (FALSE, FALSE, sizeof (CcWwanProviderApn));
+  table->providers = g_array_new (FALSE, FALSE, sizeof (ProviderRange));
+  table->networks = g_hash_table_new (g_str_hash, g_str_equal);
+
+  return table;
+}
+
+static void
+apn_table_free (ApnTable *table)
+{
+  g_hash_table_unref (table->networks);
+  g_array_unref (table->providers);
+  g_array_unref (table->apns);
+  g_string_chunk_free (table->strings);
+  g_free (table);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ApnTable, apn_table_free)
+
+static const gchar *
+apn_table_intern (ApnTable    *table,
+                  const gchar *string)
+{
+  if (!string || !*string)
+    return NULL;
+
+  return g_string_chunk_insert_const (table->strings, string);
+}
+
+/* The first provider listing a network wins */
+static void
+apn_table_add_network (ApnTable    *table,
+                       const gchar *mcc_mnc,
+                       guint        provider)
+{
+  if (g_hash_table_contains (table->networks, mcc_mnc))
+    return;
+
+  g_hash_table_insert (table->networks,
+                       (gpointer) apn_table_intern (table, mcc_mnc),
+                       GUINT_TO_POINTER (provider));
+}
+
+typedef struct
+{
+  gchar *name;
+  gchar *apn;
+  gchar *username;
+  gchar *password;
+} ParsedApn;
+
+static void
+parsed_apn_clear (gpointer data)
+{
+  ParsedApn *apn = data;
+
+  g_free (apn->name);
+  g_free (apn->apn);
+  g_free (apn->username);
+  g_free (apn->password);
+}
+
+typedef struct
+{
+  ApnTable            *table;
+  const gchar * const *languages;
+
+  gboolean             in_provider;
+  gboolean             in_gsm;
+  gboolean             in_apn;
+
+  gchar               *provider_name;
+  guint                provider_name_rank;
+  GPtrArray           *networks;
+  GArray              *apns;
+  ParsedApn            apn;
+  guint                apn_name_rank;
+
+  GString             *text;
+  gboolean             collect_text;
+  gchar               *text_lang;
+} ParseData;
+
+static gboolean
+language_equal (const gchar *a,
+                const gchar *b)
+{
+  for (; *a && *b; a++, b++)
+    {
+      gchar ca = *a == '-' ? '_' : g_ascii_tolower (*a);
+      gchar cb = *b == '-' ? '_' : g_ascii_tolower (*b);
+
+      if (ca != cb)
+        return FALSE;
+    }
+
+  return *a == *b;
+}
+
+/* Lower is better, like in g_get_language_names() */
+static guint
+get_language_rank (const gchar * const *languages,
+                   const gchar         *lang)
+{
+  guint i;
+
+  for (i = 0; lang && languages[i]; i++)
+    if (language_equal (languages[i], lang))
+      return i;
+
+  /* Like libnma, names without a language are the English
+   * ones, used when none is in a language of the user */
+  if (!lang || language_equal (lang, "en"))
+    return g_strv_length ((GStrv) languages);
+
+  return G_MAXUINT - 1;
+}
+
+static const gchar *
+get_attribute (const gchar **attribute_names,
+               const gchar **attribute_values,
+               const gchar  *name)
+{
+  guint i;
+
+  for (i = 0; attribute_names[i]; i++)
+    if (g_str_equal (attribute_names[i], name))
+      return attribute_values[i];
+
+  return NULL;
+}
+
+static void
+parse_start_element (GMarkupParseContext  *context,
+                     const gchar          *element_name,
+                     const gchar         **attribute_names,
+                     const gchar         **attribute_values,
+                     gpointer              user_data,
+                     GError              **error)
+{
+  ParseData *data = user_data;
+
+  if (g_str_equal (element_name, "provider"))
+    {
+      data->in_provider = TRUE;
+      g_clear_pointer (&data->provider_name, g_free);
+      data->provider_name_rank = G_MAXUINT;
+      g_ptr_array_set_size (data->networks, 0);
+      g_array_set_size (data->apns, 0);
+    }
+  else if (!data->in_provider)
+    {
+      return;
+    }
+  else if (g_str_equal (element_name, "gsm"))
+    {
+      data->in_gsm = TRUE;
+    }
+  else if (data->in_gsm && g_str_equal (element_name, "network-id"))
+    {
+      const gchar *mcc, *mnc;
+
+      mcc = get_attribute (attribute_names, attribute_values, "mcc");
+      mnc = get_attribute (attribute_names, attribute_values, "mnc");
+      if (mcc && mnc)
+        g_ptr_array_add (data->networks, g_strconcat (mcc, mnc, NULL));
+    }
+  else if (data->in_gsm && g_str_equal (element_name, "apn"))
+    {
+      data->in_apn = TRUE;
+      memset (&data->apn, 0, sizeof (data->apn));
+      data->apn_name_rank = G_MAXUINT;
+      data->apn.apn = g_strdup (get_attribute (attribute_names, attribute_values, "value"));
+    }
+  else if (g_str_equal (element_name, "name") ||
+           g_str_equal (element_name, "username") ||
+           g_str_equal (element_name, "password"))
+    {
+      data->collect_text = TRUE;
+      g_string_truncate (data->text, 0);
+      g_free (data->text_lang);
+      data->text_lang = g_strdup (get_attribute (attribute_names, attribute_values, "xml:lang"));
+    }
+}
+
+static void
+parse_add_provider (ParseData *data)
+{
+  ProviderRange range;
+  guint provider, i;
+
+  if (data->networks->len == 0 || data->apns->len == 0)
+    return;
+
+  range.first_apn = data->table->apns->len;
+  range.n_apns = data->apns->len;
+  provider = data->table->providers->len;
+  g_array_append_val (data->table->providers, range);
+
+  for (i = 0; i < data->apns->len; i++)
+    {
+      ParsedApn *parsed = &g_array_index (data->apns, ParsedApn, i);
+      CcWwanProviderApn apn;
+      const gchar *name;
+
+      /* Same fallback as libnma for APNs without a name */
+      name = parsed->name ? parsed->name : data->provider_name;
+      if (!name)
+        name = parsed->apn;
+
+      apn.name = apn_table_intern (data->table, name);
+      apn.apn = apn_table_intern (data->table, parsed->apn);
+      apn.username = apn_table_intern (data->table, parsed->username);
+      apn.password = apn_table_intern (data->table, parsed->password);
+      g_array_append_val (data->table->apns, apn);
+    }
+
+  for (i = 0; i < data->networks->len; i++)
+    apn_table_add_network (data->table, g_ptr_array_index (data->networks, i), provider);
+}
+
+static void
+parse_end_element (GMarkupParseContext  *context,
+                   const gchar          *element_name,
+                   gpointer              user_data,
+                   GError              **error)
+{
+  ParseData *data = user_data;
+  g_autofree gchar *text = NULL;
+
+  if (data->collect_text)
+    {
+      text = g_strstrip (g_strdup (data->text->str));
+      data->collect_text = FALSE;
+    }
+
+  if (!data->in_provider)
+    return;
+
+  if (g_str_equal (element_name, "provider"))
+    {
+      parse_add_provider (data);
+      data->in_provider = FALSE;
+    }
+  else if (g_str_equal (element_name, "gsm"))
+    {
+      data->in_gsm = FALSE;
+    }
+  else if (data->in_apn && g_str_equal (element_name, "apn"))
+    {
+      g_array_append_val (data->apns, data->apn);
+      memset (&data->apn, 0, sizeof (data->apn));
+      data->in_apn = FALSE;
+    }
+  else if (g_str_equal (element_name, "name"))
+    {
+      guint rank = get_language_rank (data->languages, data->text_lang);
+
+      /* The first name in the best language wins */
+      if (data->in_apn && rank < data->apn_name_rank)
+        {
+          g_free (data->apn.name);
+          data->apn.name = g_steal_pointer (&text);
+          data->apn_name_rank = rank;
+        }
+      else if (!data->in_gsm && rank < data->provider_name_rank)
+        {
+          g_free (data->provider_name);
+          data->provider_name = g_steal_pointer (&text);
+          data->provider_name_rank = rank;
+        }
+    }
+  else if (data->in_apn && g_str_equal (element_name, "username"))
+    {
+      g_free (data->apn.username);
+      data->apn.username = g_steal_pointer (&text);
+    }
+  else if (data->in_apn && g_str_equal (element_name, "password"))
+    {
+      g_free (data->apn.password);
+      data->apn.password = g_steal_pointer (&text);
+    }
+}
+
+static void
+parse_text (GMarkupParseContext  *context,
+            const gchar          *text,
+            gsize                 text_len,
+            gpointer              user_data,
+            GError              **error)
+{
+  ParseData *data = user_data;
+
+  if (data->collect_text)
+    g_string_append_len (data->text, text, text_len);
+}
+
+static const GMarkupParser database_parser = {
+  parse_start_element,
+  parse_end_element,
+  parse_text,
+  NULL,
+  NULL,
+};
+
+static ApnTable *
+parse_database (const gchar          *database,
+                const gchar * const  *languages,
+                GError              **error)
+{
+  g_autoptr(GMarkupParseContext) context = NULL;
+  g_autoptr(ApnTable) table = NULL;
+  g_autofree gchar *contents = NULL;
+  ParseData data = { 0 };
+  gboolean ret;
+  gsize length;
+
+  if (!g_file_get_contents (database, &contents, &length, error))
+    return NULL;
+
+  table = apn_table_new ();
+
+  data.table = table;
+  data.languages = languages;
+  data.networks = g_ptr_array_new_with_free_func (g_free);
+  data.apns = g_array_new (FALSE, FALSE, sizeof (ParsedApn));
+  g_array_set_clear_func (data.apns, parsed_apn_clear);
+  data.text = g_string_new (NULL);
+
+  context = g_markup_parse_context_new (&database_parser, G_MARKUP_TREAT_CDATA_AS_TEXT, &data, NULL);
+  ret = g_markup_parse_context_parse (context, contents, length, error) &&
+        g_markup_parse_context_end_parse (context, error);
+
+  parsed_apn_clear (&data.apn);
+  g_free (data.provider_name);
+  g_ptr_array_unref (data.networks);
+  g_array_unref (data.apns);
+  g_string_free (data.text, TRUE);
+  g_free (data.text_lang);
+
+  if (!ret)
+    return NULL;
+
+  g_debug ("Parsed %u APNs of %u networks from %s",
+           table->apns->len, g_hash_table_size (table->networks), database);
+
+  return g_steal_pointer (&table);
+}
+
+static const gchar *
+cache_get_string (const gchar **strings,
+                  gsize         n_strings,
+                  guint32       index,
+                  gboolean     *valid)
+{
+  if (index == NO_STRING)
+    return NULL;
+
+  if (index >= n_strings)
+    {
+      *valid = FALSE;
+      return NULL;
+    }
+
+  return strings[index];
+}
+
+static ApnTable *
+load_cache (const gchar *cache_file,
+            const gchar *database,
+            const gchar *languages,
+            gint64       mtime,
+            gint64       size)
+{
+  g_autoptr(GMappedFile) mapped_file = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GVariant) strings_variant = NULL;
+  g_autoptr(GVariant) apns_variant = NULL;
+  g_autoptr(GVariant) providers_variant = NULL;
+  g_autoptr(GVariant) networks_variant = NULL;
+  g_autoptr(ApnTable) table = NULL;
+  g_autofree const gchar **strings = NULL;
+  const guint32 (*apns)[4];
+  const ProviderRange *providers;
+  const guint32 (*networks)[2];
+  const gchar *cache_database;
+  const gchar *cache_languages;
+  gint64 cache_mtime, cache_size;
+  gsize n_strings, n_apns, n_providers, n_networks, i;
+  gboolean valid = TRUE;
+  guint32 version;
+
+  mapped_file = g_mapped_file_new (cache_file, FALSE, NULL);
+  if (!mapped_file)
+    return NULL;
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  cache = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (CACHE_VARIANT_TYPE), bytes, FALSE));
+
+  /* Mapped data from disk isn't trusted until it's normalised */
+  if (!g_variant_is_normal_form (cache))
+    {
+      g_debug ("Ignoring corrupt APN cache %s", cache_file);
+      return NULL;
+    }
+
+  g_variant_get (cache, "(u&s&sxx@as@a(uuuu)@a(uu)@a(uu))",
+                 &version,
+                 &cache_database,
+                 &cache_languages,
+                 &cache_mtime,
+                 &cache_size,
+                 &strings_variant,
+                 &apns_variant,
+                 &providers_variant,
+                 &networks_variant);
+  if (version != CACHE_VERSION ||
+      cache_mtime != mtime ||
+      cache_size != size ||
+      g_strcmp0 (cache_database, database) != 0 ||
+      g_strcmp0 (cache_languages, languages) != 0)
+    return NULL;
+
+  strings = g_variant_get_strv (strings_variant, &n_strings);
+  apns = g_variant_get_fixed_array (apns_variant, &n_apns, 4 * sizeof (guint32));
+  providers = g_variant_get_fixed_array (providers_variant, &n_providers, sizeof (ProviderRange));
+  networks = g_variant_get_fixed_array (networks_variant, &n_networks, 2 * sizeof (guint32));
+
+  table = apn_table_new ();
+
+  for (i = 0; i < n_apns; i++)
+    {
+      CcWwanProviderApn apn;
+
+      apn.name = apn_table_intern (table, cache_get_string (strings, n_strings, apns[i][0], &valid));
+      apn.apn = apn_table_intern (table, cache_get_string (strings, n_strings, apns[i][1], &valid));
+      apn.username = apn_table_intern (table, cache_get_string (strings, n_strings, apns[i][2], &valid));
+      apn.password = apn_table_intern (table, cache_get_string (strings, n_strings, apns[i][3], &valid));
+      g_array_append_val (table->apns, apn);
+    }
+
+  for (i = 0; i < n_providers; i++)
+    {
+      if ((guint64) providers[i].first_apn + providers[i].n_apns > n_apns)
+        valid = FALSE;
+    }
+  g_array_append_vals (table->providers, providers, n_providers);
+
+  for (i = 0; i < n_networks && valid; i++)
+    {
+      const gchar *mcc_mnc = cache_get_string (strings, n_strings, networks[i][0], &valid);
+
+      if (!mcc_mnc || networks[i][1] >= n_providers)
+        valid = FALSE;
+      else
+        apn_table_add_network (table, mcc_mnc, networks[i][1]);
+    }
+
+  if (!valid)
+    {
+      g_debug ("Ignoring corrupt APN cache %s", cache_file);
+      return NULL;
+    }
+
+  return g_steal_pointer (&table);
+}
+
+static guint32
+intern_string (GHashTable  *string_ids,
+               GPtrArray   *strings,
+               const gchar *string)
+{
+  gpointer id;
+
+  if (!string)
+    return NO_STRING;
+
+  if (g_hash_table_lookup_extended (string_ids, string, NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  g_hash_table_insert (string_ids, (gpointer) string, GUINT_TO_POINTER (strings->len));
+  g_ptr_array_add (strings, (gpointer) string);
+
+  return strings->len - 1;
+}
+
+static void
+save_cache (ApnTable    *table,
+            const gchar *cache_file,
+            const gchar *database,
+            const gchar *languages,
+            gint64       mtime,
+            gint64       size)
+{
+  g_autoptr(GHashTable) string_ids = NULL;
+  g_autoptr(GPtrArray) strings = NULL;
+  g_autoptr(GArray) apns = NULL;
+  g_autoptr(GArray) networks = NULL;
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *dirname = NULL;
+  GHashTableIter iter;
+  gpointer key, value;
+  guint i;
+
+  string_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  strings = g_ptr_array_new ();
+  apns = g_array_sized_new (FALSE, FALSE, 4 * sizeof (guint32), table->apns->len);
+  networks = g_array_sized_new (FALSE, FALSE, 2 * sizeof (guint32), g_hash_table_size (table->networks));
+
+  for (i = 0; i < table->apns->len; i++)
+    {
+      CcWwanProviderApn *apn = &g_array_index (table->apns, CcWwanProviderApn, i);
+      guint32 ids[4];
+
+      ids[0] = intern_string (string_ids, strings, apn->name);
+      ids[1] = intern_string (string_ids, strings, apn->apn);
+      ids[2] = intern_string (string_ids, strings, apn->username);
+      ids[3] = intern_string (string_ids, strings, apn->password);
+      g_array_append_val (apns, ids);
+    }
+
+  g_hash_table_iter_init (&iter, table->networks);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      guint32 ids[2];
+
+      ids[0] = intern_string (string_ids, strings, key);
+      ids[1] = GPOINTER_TO_UINT (value);
+      g_array_append_val (networks, ids);
+    }
+
+  g_ptr_array_add (strings, NULL);
+
+  cache = g_variant_ref_sink (g_variant_new ("(ussxx^as@a(uuuu)@a(uu)@a(uu))",
+                                             CACHE_VERSION,
+                                             database,
+                                             languages,
+                                             mtime,
+                                             size,
+                                             (const gchar * const *) strings->pdata,
+                                             g_variant_new_fixed_array (G_VARIANT_TYPE ("(uuuu)"),
+                                                                        apns->data,
+                                                                        apns->len,
+                                                                        4 * sizeof (guint32)),
+                                             g_variant_new_fixed_array (G_VARIANT_TYPE ("(uu)"),
+                                                                        table->providers->data,
+                                                                        table->providers->len,
+                                                                        sizeof (ProviderRange)),
+                                             g_variant_new_fixed_array (G_VARIANT_TYPE ("(uu)"),
+                                                                        networks->data,
+                                                                        networks->len,
+                                                                        2 * sizeof (guint32))));
+
+  dirname = g_path_get_dirname (cache_file);
+
+  if (g_mkdir_with_parents (dirname, 0700) != 0 ||
+      !g_file_set_contents (cache_file,
+                            g_variant_get_data (cache),
+                            g_variant_get_size (cache),
+                            &error))
+    g_debug ("Failed to save APN cache %s: %s",
+             cache_file, error ? error->message : g_strerror (errno));
+}
+
+static void
+load_table_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  CcWwanApnDb *self = source_object;
+  g_autoptr(ApnTable) table = NULL;
+  g_autofree gchar *languages = NULL;
+  GError *error = NULL;
+  GStatBuf buf;
+  gint64 mtime;
+
+  if (g_stat (self->database, &buf) != 0)
+    {
+      int saved_errno = errno;
+
+      g_task_return_new_error (task, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                               "Failed to read %s: %s", self->database, g_strerror (saved_errno));
+      return;
+    }
+
+  /* Whole seconds miss a database replaced within the same second */
+  mtime = (gint64) buf.st_mtim.tv_sec * G_GINT64_CONSTANT (1000000000) + buf.st_mtim.tv_nsec;
+  languages = g_strjoinv (":", self->languages);
+
+  if (self->cache_file)
+    table = load_cache (self->cache_file, self->database, languages, mtime, buf.st_size);
+
+  if (!table)
+    {
+      table = parse_database (self->database, (const gchar * const *) self->languages, &error);
+      if (!table)
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+
+      if (self->cache_file)
+        save_cache (table, self->cache_file, self->database, languages, mtime, buf.st_size);
+    }
+
+  g_task_return_pointer (task, g_steal_pointer (&table), (GDestroyNotify) apn_table_free);
+}
+
+static gboolean
+apn_table_lookup_network (ApnTable    *table,
+                          const gchar *mcc_mnc,
+                          guint       *provider)
+{
+  g_autofree gchar *other_mcc_mnc = NULL;
+  gpointer value;
+  gsize length;
+
+  if (g_hash_table_lookup_extended (table->networks, mcc_mnc, NULL, &value))
+    {
+      *provider = GPOINTER_TO_UINT (value);
+      return TRUE;
+    }
+
+  /* Like libnma, a 2-digit MNC also matches the same MNC with
+   * 3 digits starting with a zero, and the other way around */
+  length = strlen (mcc_mnc);
+  if (length == 5)
+    other_mcc_mnc = g_strdup_printf ("%.3s0%s", mcc_mnc, mcc_mnc + 3);
+  else if (length == 6 && mcc_mnc[3] == '0')
+    other_mcc_mnc = g_strdup_printf ("%.3s%s", mcc_mnc, mcc_mnc + 4);
+
+  if (other_mcc_mnc &&
+      g_hash_table_lookup_extended (table->networks, other_mcc_mnc, NULL, &value))
+    {
+      *provider = GPOINTER_TO_UINT (value);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+wwan_apn_db_complete_lookup (CcWwanApnDb *self,
+                             GTask       *task)
+{
+  const gchar *mcc_mnc = g_task_get_task_data (task);
+  g_autoptr(GPtrArray) apns = NULL;
+  const ProviderRange *range;
+  guint provider;
+  guint i;
+
+  if (self->error)
+    {
+      g_task_return_error (task, g_error_copy (self->error));
+      return;
+    }
+
+  apns = g_ptr_array_new ();
+
+  if (apn_table_lookup_network (self->table, mcc_mnc, &provider))
+    {
+      range = &g_array_index (self->table->providers, ProviderRange, provider);
+
+      for (i = 0; i < range->n_apns; i++)
+        g_ptr_array_add (apns, &g_array_index (self->table->apns, CcWwanProviderApn, range->first_apn + i));
+    }
+
+  g_task_return_pointer (task, g_steal_pointer (&apns), (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+load_table_cb (GObject      *object,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  CcWwanApnDb *self = CC_WWAN_APN_DB (object);
+  g_autoptr(GPtrArray) pending_lookups = NULL;
+  guint i;
+
+  self->loading = FALSE;
+  self->table = g_task_propagate_pointer (G_TASK (result), &self->error);
+
+  if (self->error)
+    g_warning ("Failed to load mobile providers database: %s", self->error->message);
+
+  pending_lookups = g_steal_pointer (&self->pending_lookups);
+  self->pending_lookups = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (i = 0; i < pending_lookups->len; i++)
+    wwan_apn_db_complete_lookup (self, g_ptr_array_index (pending_lookups, i));
+}
+
+static void
+cc_wwan_apn_db_finalize (GObject *object)
+{
+  CcWwanApnDb *self = (CcWwanApnDb *)object;
+
+  g_clear_pointer (&self->database, g_free);
+  g_clear_pointer (&self->cache_file, g_free);
+  g_clear_pointer (&self->languages, g_strfreev);
+  g_clear_pointer (&self->table, apn_table_free);
+  g_clear_error (&self->error);
+  g_clear_pointer (&self->pending_lookups, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (cc_wwan_apn_db_parent_class)->finalize (object);
+}
+
+static void
+cc_wwan_apn_db_class_init (CcWwanApnDbClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = cc_wwan_apn_db_finalize;
+}
+
+static void
+cc_wwan_apn_db_init (CcWwanApnDb *self)
+{
+  self->pending_lookups = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+/**
+ * cc_wwan_apn_db_new:
+ * @database: (nullable): The path of serviceproviders.xml
+ * @cache_file: (nullable): The path of the cache file
+ *
+ * Create a new APN database reading @database, or the
+ * system mobile-provider-info database if %NULL. The
+ * table isn't cached if @cache_file is %NULL. Names
+ * are in the current languages of the user.
+ *
+ * Returns: A #CcWwanApnDb
+ */
+CcWwanApnDb *
+cc_wwan_apn_db_new (const gchar *database,
+                    const gchar *cache_file)
+{
+  CcWwanApnDb *self;
+
+  self = g_object_new (CC_TYPE_WWAN_APN_DB, NULL);
+  self->database = g_strdup (database ? database : MOBILE_BROADBAND_PROVIDER_INFO_DATABASE);
+  self->cache_file = g_strdup (cache_file);
+  self->languages = g_strdupv ((GStrv) g_get_language_names ());
+
+  return self;
+}
+
+/**
+ * cc_wwan_apn_db_get_default:
+ *
+ * Get the database shared by all the modems, cached
+ * in the user cache directory.
+ *
+ * Returns: (transfer none): The default #CcWwanApnDb
+ */
+CcWwanApnDb *
+cc_wwan_apn_db_get_default (void)
+{
+  static CcWwanApnDb *default_db = NULL;
+
+  if (g_once_init_enter (&default_db))
+    {
+      g_autofree gchar *cache_file = NULL;
+
+      cache_file = g_build_filename (g_get_user_cache_dir (),
+                                     "gnome-control-center",
+                                     "wwan-apn-db.cache",
+                                     NULL);
+      g_once_init_leave (&default_db, cc_wwan_apn_db_new (NULL, cache_file));
+    }
+
+  return default_db;
+}
+
+/**
+ * cc_wwan_apn_db_lookup_async:
+ * @self: A #CcWwanApnDb
+ * @mcc_mnc: The MCCMNC of the operator
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: The callback to run when done
+ * @user_data: The data for @callback
+ *
+ * Look up the APNs of the provider of @mcc_mnc. The
+ * database is loaded by the first lookup.
+ */
+void
+cc_wwan_apn_db_lookup_async (CcWwanApnDb         *self,
+                             const gchar         *mcc_mnc,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+  g_autoptr(GTask) task = NULL;
+
+  g_return_if_fail (CC_IS_WWAN_APN_DB (self));
+  g_return_if_fail (mcc_mnc != NULL);
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cc_wwan_apn_db_lookup_async);
+  g_task_set_task_data (task, g_strdup (mcc_mnc), g_free);
+
+  if (self->table || self->error)
+    {
+      wwan_apn_db_complete_lookup (self, task);
+      return;
+    }
+
+  g_ptr_array_add (self->pending_lookups, g_steal_pointer (&task));
+
+  if (!self->loading)
+    {
+      g_autoptr(GTask) load_task = NULL;
+
+      self->loading = TRUE;
+      load_task = g_task_new (self, NULL, load_table_cb, NULL);
+      g_task_run_in_thread (load_task, load_table_thread);
+    }
+}
+
+/**
+ * cc_wwan_apn_db_lookup_finish:
+ * @self: A #CcWwanApnDb
+ * @result: A #GAsyncResult
+ * @error: A location for a #GError
+ *
+ * Finish looking up the APNs of a provider.
+ *
+ * Returns: (transfer container) (element-type CcWwanProviderApn):
+ * The APNs of the provider, which is empty if it isn't in the
+ * database, or %NULL on error.
+ */
+GPtrArray *
+cc_wwan_apn_db_lookup_finish (CcWwanApnDb   *self,
+                              GAsyncResult  *result,
+                              GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
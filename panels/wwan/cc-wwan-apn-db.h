@@ -0,0 +1,52 @@
+/* -*- Mode: C; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/* cc-wwan-apn-db.h
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* An APN of the mobile-provider-info database, owned by the database */
+typedef struct
+{
+  const gchar *name;
+  const gchar *apn;
+  const gchar *username;
+  const gchar *password;
+} CcWwanProviderApn;
+
+#define CC_TYPE_WWAN_APN_DB (cc_wwan_apn_db_get_type())
+G_DECLARE_FINAL_TYPE (CcWwanApnDb, cc_wwan_apn_db, CC, WWAN_APN_DB, GObject)
+
+CcWwanApnDb *cc_wwan_apn_db_new          (const gchar          *database,
+                                          const gchar          *cache_file);
+CcWwanApnDb *cc_wwan_apn_db_get_default  (void);
+void         cc_wwan_apn_db_lookup_async (CcWwanApnDb          *self,
+                                          const gchar          *mcc_mnc,
+                                          GCancellable         *cancellable,
+                                          GAsyncReadyCallback   callback,
+                                          gpointer              user_data);
+GPtrArray   *cc_wwan_apn_db_lookup_finish (CcWwanApnDb         *self,
+                                           GAsyncResult        *result,
+                                           GError             **error);
+
+G_END_DECLS
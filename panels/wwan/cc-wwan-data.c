@@ -32,9 +32,9 @@
 #define _GNU_SOURCE
 #include <string.h>
 #include <glib/gi18n.h>
-#include <nma-mobile-providers.h>
 #include <gio/gio.h>
 
+#include "cc-wwan-apn-db.h"
 #include "cc-wwan-data.h"
 
 /**
@@ -81,8 +81,6 @@ struct _CcWwanData
 
   NMClient           *nm_client;
   NMDevice           *nm_device;
-  NMAMobileProvidersDatabase *apn_db;
-  NMAMobileProvider  *apn_provider;
   CcWwanDataApn      *default_apn;
   CcWwanDataApn      *old_default_apn;
   GListStore         *apn_list;
@@ -92,6 +90,7 @@ struct _CcWwanData
   gboolean data_enabled; /* autoconnect enabled */
   gboolean home_only;    /* Data roaming */
   gboolean apn_list_updated;    /* APN list updated from mobile-provider-info */
+  gboolean apn_list_updating;   /* Lookup in mobile-provider-info in progress */
 };
 
 G_DEFINE_TYPE (CcWwanData, cc_wwan_data, G_TYPE_OBJECT)
@@ -135,8 +134,9 @@ G_DEFINE_TYPE (CcWwanData, cc_wwan_data, G_TYPE_OBJECT)
 struct _CcWwanDataApn {
   GObject parent_instance;
 
-  /* Set if the APN is from the mobile-provider-info database */
-  NMAMobileAccessMethod *access_method;
+  /* Set if the APN is from the mobile-provider-info database,
+   * which is never freed */
+  const CcWwanProviderApn *provider_apn;
 
   /* Set if the APN is saved in NetworkManager */
   NMConnection *nm_connection;
@@ -204,8 +204,8 @@ wwan_data_get_nm_connection (CcWwanDataApn *apn)
 }
 
 static gboolean
-wwan_data_apn_are_same (CcWwanDataApn         *apn,
-                        NMAMobileAccessMethod *access_method)
+wwan_data_apn_are_same (CcWwanDataApn           *apn,
+                        const CcWwanProviderApn *provider_apn)
 {
   NMConnection *connection;
   NMSetting *setting;
@@ -216,15 +216,15 @@ wwan_data_apn_are_same (CcWwanDataApn         *apn,
   connection = NM_CONNECTION (apn->remote_connection);
   setting = NM_SETTING (nm_connection_get_setting_gsm (connection));
 
-  if (g_strcmp0 (nma_mobile_access_method_get_3gpp_apn (access_method),
+  if (g_strcmp0 (provider_apn->apn,
                  nm_setting_gsm_get_apn (NM_SETTING_GSM (setting))) != 0)
     return FALSE;
 
-  if (g_strcmp0 (nma_mobile_access_method_get_username (access_method),
+  if (g_strcmp0 (provider_apn->username,
                  nm_setting_gsm_get_username (NM_SETTING_GSM (setting))) != 0)
     return FALSE;
 
-  if (g_strcmp0 (nma_mobile_access_method_get_password (access_method),
+  if (g_strcmp0 (provider_apn->password,
                  cc_wwan_data_apn_get_password (apn)) != 0)
     return FALSE;
 
@@ -232,8 +232,8 @@ wwan_data_apn_are_same (CcWwanDataApn         *apn,
 }
 
 static CcWwanDataApn *
-wwan_data_find_matching_apn (CcWwanData            *self,
-                             NMAMobileAccessMethod *access_method)
+wwan_data_find_matching_apn (CcWwanData              *self,
+                             const CcWwanProviderApn *provider_apn)
 {
   CcWwanDataApn *apn;
   guint i, n_items;
@@ -244,10 +244,10 @@ wwan_data_find_matching_apn (CcWwanData            *self,
     {
       apn = g_list_model_get_item (G_LIST_MODEL (self->apn_list), i);
 
-      if (apn->access_method == access_method)
+      if (apn->provider_apn == provider_apn)
         return apn;
 
-      if (wwan_data_apn_are_same (apn, access_method))
+      if (wwan_data_apn_are_same (apn, provider_apn))
         return apn;
 
       g_object_unref (apn);
@@ -257,15 +257,15 @@ wwan_data_find_matching_apn (CcWwanData            *self,
 }
 
 static gboolean
-wwan_data_nma_method_is_mms (NMAMobileAccessMethod *method)
+wwan_data_provider_apn_is_mms (const CcWwanProviderApn *provider_apn)
 {
   const char *str;
 
-  str = nma_mobile_access_method_get_3gpp_apn (method);
+  str = provider_apn->apn;
   if (str && strcasestr (str, "mms"))
     return TRUE;
 
-  str = nma_mobile_access_method_get_name (method);
+  str = provider_apn->name;
   if (str && strcasestr (str, "mms"))
     return TRUE;
 
@@ -273,58 +273,75 @@ wwan_data_nma_method_is_mms (NMAMobileAccessMethod *method)
 }
 
 static void
-wwan_data_update_apn_list_db (CcWwanData *self)
+wwan_data_apn_db_lookup_cb (GObject      *object,
+                            GAsyncResult *result,
+                            gpointer      user_data)
 {
-  GSList *apn_methods = NULL, *l;
+  g_autoptr(CcWwanData) self = user_data;
+  g_autoptr(GPtrArray) provider_apns = NULL;
   g_autoptr(GError) error = NULL;
-  guint i = 0;
-
-  if (!self->sim || !self->operator_code || self->apn_list_updated)
-    return;
-
-  if (!self->apn_list)
-    return;
+  guint i, position = 0;
 
-  if (!self->apn_db)
-    self->apn_db = nma_mobile_providers_database_new_sync (NULL, NULL, NULL, &error);
+  provider_apns = cc_wwan_apn_db_lookup_finish (CC_WWAN_APN_DB (object), result, &error);
+  self->apn_list_updating = FALSE;
 
+  /* Looked up again the next time the list is asked for */
   if (error)
     {
       g_warning ("%s", error->message);
       return;
     }
 
-  if (!self->apn_provider)
-    self->apn_provider = nma_mobile_providers_database_lookup_3gpp_mcc_mnc (self->apn_db,
-                                                                            self->operator_code);
-
-  if (self->apn_provider)
-    apn_methods = nma_mobile_provider_get_methods (self->apn_provider);
+  /* The list may have been dropped in the mean time */
+  if (!self->apn_list)
+    return;
 
   self->apn_list_updated = TRUE;
 
-  for (l = apn_methods; l; l = l->next, i++)
+  for (i = 0; i < provider_apns->len; i++)
     {
+      const CcWwanProviderApn *provider_apn = g_ptr_array_index (provider_apns, i);
       g_autoptr(CcWwanDataApn) apn = NULL;
 
       /* We don’t list MMS APNs */
-      if (wwan_data_nma_method_is_mms (l->data))
+      if (wwan_data_provider_apn_is_mms (provider_apn))
         continue;
 
-      apn = wwan_data_find_matching_apn (self, l->data);
+      apn = wwan_data_find_matching_apn (self, provider_apn);
 
       /* Prepend the item in order */
       if (!apn)
         {
           apn = cc_wwan_data_apn_new ();
-          apn->access_method = l->data;
-          g_list_store_insert (self->apn_list, i, apn);
+          apn->provider_apn = provider_apn;
+          g_list_store_insert (self->apn_list, position, apn);
         }
 
-      apn->access_method = l->data;
+      apn->provider_apn = provider_apn;
+      position++;
     }
 }
 
+static void
+wwan_data_update_apn_list_db (CcWwanData *self)
+{
+  if (!self->sim || !self->operator_code ||
+      self->apn_list_updated || self->apn_list_updating)
+    return;
+
+  if (!self->apn_list)
+    return;
+
+  self->apn_list_updating = TRUE;
+
+  /* The database is shared by all the modems, and loaded by the first lookup */
+  cc_wwan_apn_db_lookup_async (cc_wwan_apn_db_get_default (),
+                               self->operator_code,
+                               NULL,
+                               wwan_data_apn_db_lookup_cb,
+                               g_object_ref (self));
+}
+
 static void
 wwan_data_update_apn_list (CcWwanData *self)
 {
@@ -438,10 +455,10 @@ cc_wwan_data_dispose (GObject *object)
   g_clear_error (&self->error);
   g_clear_object (&self->apn_list);
   g_clear_object (&self->modem);
+  g_clear_object (&self->sim);
   g_clear_object (&self->mm_object);
   g_clear_object (&self->nm_client);
   g_clear_object (&self->active_connection);
-  g_clear_object (&self->apn_db);
 
   G_OBJECT_CLASS (cc_wwan_data_parent_class)->dispose (object);
 }
@@ -482,16 +499,20 @@ cc_wwan_data_init (CcWwanData *self)
  * cc_wwan_data_new:
  * @mm_object: An #MMObject
  * @nm_client: An #NMClient
+ * @sim: The #MMSim of @mm_object
  *
  * Create a new device data representing the given
  * @mm_object. If @mm_object isn’t a 3G/CDMA/LTE
- * modem, %NULL will be returned
+ * modem, %NULL will be returned.  @sim is the one
+ * already fetched by the #CcWwanDevice, so that the
+ * modem isn’t queried again.
  *
  * Returns: A #CcWwanData or %NULL.
  */
 CcWwanData *
 cc_wwan_data_new (MMObject *mm_object,
-                  NMClient *nm_client)
+                  NMClient *nm_client,
+                  MMSim    *sim)
 {
   CcWwanData *self;
   NMDevice *nm_device = NULL;
@@ -500,6 +521,7 @@ cc_wwan_data_new (MMObject *mm_object,
 
   g_return_val_if_fail (MM_IS_OBJECT (mm_object), NULL);
   g_return_val_if_fail (NM_CLIENT (nm_client), NULL);
+  g_return_val_if_fail (MM_IS_SIM (sim), NULL);
 
   modem = mm_object_get_modem (mm_object);
 
@@ -519,7 +541,7 @@ cc_wwan_data_new (MMObject *mm_object,
   self->nm_client = g_object_ref (nm_client);
   self->mm_object = g_object_ref (mm_object);
   self->modem = g_steal_pointer (&modem);
-  self->sim = mm_modem_get_sim_sync (self->modem, NULL, NULL);
+  self->sim = g_object_ref (sim);
   self->sim_id = mm_sim_dup_identifier (self->sim);
   self->operator_code = mm_sim_dup_operator_identifier (self->sim);
   self->nm_device = g_object_ref (nm_device);
@@ -588,6 +610,8 @@ cc_wwan_data_get_apn_list (CcWwanData *self)
   if (!self->apn_list)
     wwan_data_update_apn_list (self);
 
+  wwan_data_update_apn_list_db (self);
+
   return G_LIST_MODEL (self->apn_list);
 }
 
@@ -636,12 +660,12 @@ wwan_data_update_apn (CcWwanData    *self,
                 NM_SETTING_IP_CONFIG_ROUTE_METRIC, (gint64)route_metric,
                 NULL);
 
-  if (apn->access_method && !apn->remote_connection)
+  if (apn->provider_apn && !apn->remote_connection)
     {
-      name = nma_mobile_access_method_get_name (apn->access_method);
-      username = nma_mobile_access_method_get_username (apn->access_method);
-      password = nma_mobile_access_method_get_password (apn->access_method);
-      apn_name = nma_mobile_access_method_get_3gpp_apn (apn->access_method);
+      name = apn->provider_apn->name;
+      username = apn->provider_apn->username;
+      password = apn->provider_apn->password;
+      apn_name = apn->provider_apn->apn;
     }
   else
     {
@@ -740,7 +764,7 @@ cc_wwan_data_new_connection_added_cb (GObject      *object,
       apn->modified = FALSE;
 
       /* If APN has access method, it’s already on the list */
-      if (!apn->access_method)
+      if (!apn->provider_apn)
         {
           g_list_store_append (self->apn_list, apn);
           g_object_unref (apn);
@@ -1022,7 +1046,7 @@ cc_wwan_data_delete_apn (CcWwanData     *self,
   g_object_unref (connection);
 
   /* We remove the item only if it's not in the mobile provider database */
-  if (!apn->access_method)
+  if (!apn->provider_apn)
     {
       if (self->default_apn == apn)
         self->default_apn = NULL;
@@ -1218,8 +1242,6 @@ cc_wwan_data_apn_finalize (GObject *object)
   CcWwanDataApn *apn = CC_WWAN_DATA_APN (object);
 
   wwan_data_apn_reset (apn);
-  g_clear_pointer (&apn->access_method,
-                   nma_mobile_access_method_unref);
 
   G_OBJECT_CLASS (cc_wwan_data_parent_class)->finalize (object);
 }
@@ -1259,8 +1281,8 @@ cc_wwan_data_apn_get_name (CcWwanDataApn *apn)
   if (apn->remote_connection)
     return nm_connection_get_id (NM_CONNECTION (apn->remote_connection));
 
-  if (apn->access_method)
-    return nma_mobile_access_method_get_name (apn->access_method);
+  if (apn->provider_apn)
+    return apn->provider_apn->name;
 
   return "";
 }
@@ -1320,9 +1342,9 @@ cc_wwan_data_apn_get_apn (CcWwanDataApn *apn)
       setting = nm_connection_get_setting_gsm (NM_CONNECTION (apn->remote_connection));
       apn_name = nm_setting_gsm_get_apn (setting);
     }
-  else if (apn->access_method)
+  else if (apn->provider_apn)
     {
-      apn_name = nma_mobile_access_method_get_3gpp_apn (apn->access_method);
+      apn_name = apn->provider_apn->apn;
     }
 
   return apn_name ? apn_name : "";
@@ -1385,9 +1407,9 @@ cc_wwan_data_apn_get_username (CcWwanDataApn *apn)
       setting = nm_connection_get_setting_gsm (NM_CONNECTION (apn->remote_connection));
       username = nm_setting_gsm_get_username (setting);
     }
-  else if (apn->access_method)
+  else if (apn->provider_apn)
     {
-      username = nma_mobile_access_method_get_username (apn->access_method);
+      username = apn->provider_apn->username;
     }
 
   return username ? username : "";
@@ -1467,9 +1489,9 @@ cc_wwan_data_apn_get_password (CcWwanDataApn *apn)
       setting = nm_connection_get_setting_gsm (NM_CONNECTION (apn->remote_connection));
       password = nm_setting_gsm_get_password (setting);
     }
-  else if (apn->access_method)
+  else if (apn->provider_apn)
     {
-      password = nma_mobile_access_method_get_password (apn->access_method);
+      password = apn->provider_apn->password;
     }
 
   return password ? password : "";
@@ -40,7 +40,8 @@ G_DECLARE_FINAL_TYPE (CcWwanDataApn, cc_wwan_data_apn, CC, WWAN_DATA_APN, GObjec
 G_DECLARE_FINAL_TYPE (CcWwanData, cc_wwan_data, CC, WWAN_DATA, GObject)
 
 CcWwanData    *cc_wwan_data_new                   (MMObject             *mm_object,
-                                                   NMClient             *nm_client);
+                                                   NMClient             *nm_client,
+                                                   MMSim                *sim);
 GError        *cc_wwan_data_get_error             (CcWwanData           *self);
 const gchar   *cc_wwan_data_get_simple_html_error (CcWwanData           *self);
 GListModel    *cc_wwan_data_get_apn_list          (CcWwanData           *self);
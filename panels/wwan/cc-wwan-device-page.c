@@ -92,6 +92,7 @@ struct _CcWwanDevicePage
    */
   gboolean is_self_change;
   gboolean is_retry;
+  gboolean suspended;
 
   CcListRow     *stk_row;
 };
@@ -241,7 +242,8 @@ static void
 wwan_update_unlock_button (CcWwanDevicePage *self)
 {
   gtk_button_set_label (self->unlock_button, _("Unlock"));
-  gtk_widget_set_sensitive (GTK_WIDGET (self->unlock_button), TRUE);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->unlock_button),
+                            cc_wwan_device_is_ready (self->device));
 }
 
 static void
@@ -263,6 +265,10 @@ wwan_device_unlock_clicked_cb (CcWwanDevicePage *self)
   const gchar *puk = "";
   MMModemLock lock;
 
+  /* The PIN can only be sent once the SIM is known */
+  if (!cc_wwan_device_is_ready (self->device))
+    return;
+
   lock = cc_wwan_device_get_lock (self->device);
   password = "";
 
@@ -478,6 +484,17 @@ cc_wwan_device_page_update (CcWwanDevicePage *self)
     gtk_stack_set_visible_child_name (main_stack, "settings-view");
 }
 
+/* PIN actions need the SIM, which is fetched after the device is made */
+static void
+cc_wwan_device_page_ready_cb (CcWwanDevicePage *self)
+{
+  gboolean ready;
+
+  ready = cc_wwan_device_is_ready (self->device);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->unlock_button), ready);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->sim_lock_row), ready);
+}
+
 static void
 cc_wwan_locks_changed_cb (CcWwanDevicePage *self)
 {
@@ -536,8 +553,13 @@ cc_wwan_device_page_constructed (GObject *object)
                            (GCallback)cc_wwan_device_page_update_data,
                            self, G_CONNECT_SWAPPED);
 
+  g_signal_connect_object (self->device, "ready",
+                           (GCallback)cc_wwan_device_page_ready_cb,
+                           self, G_CONNECT_SWAPPED);
+
   cc_wwan_device_page_update (self);
   cc_wwan_locks_changed_cb (self);
+  cc_wwan_device_page_ready_cb (self);
 }
 
 static void
@@ -661,3 +683,34 @@ cc_wwan_device_page_set_sim_index (CcWwanDevicePage *self,
 
   self->sim_index = sim_index;
 }
+
+/* Stops following the device while the panel is hidden, the page is
+ * brought up to date in cc_wwan_device_page_resume().
+ */
+void
+cc_wwan_device_page_suspend (CcWwanDevicePage *self)
+{
+  g_return_if_fail (CC_IS_WWAN_DEVICE_PAGE (self));
+
+  if (self->suspended)
+    return;
+
+  self->suspended = TRUE;
+  g_signal_handlers_block_matched (self->device, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+}
+
+void
+cc_wwan_device_page_resume (CcWwanDevicePage *self)
+{
+  g_return_if_fail (CC_IS_WWAN_DEVICE_PAGE (self));
+
+  if (!self->suspended)
+    return;
+
+  self->suspended = FALSE;
+  g_signal_handlers_unblock_matched (self->device, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, self);
+
+  cc_wwan_device_page_update_data (self);
+  cc_wwan_locks_changed_cb (self);
+  cc_wwan_device_page_ready_cb (self);
+}
@@ -38,5 +38,7 @@ CcWwanDevicePage *cc_wwan_device_page_new           (CcWwanDevice     *device,
 CcWwanDevice     *cc_wwan_device_page_get_device    (CcWwanDevicePage *self);
 void              cc_wwan_device_page_set_sim_index (CcWwanDevicePage *self,
                                                      gint              sim_index);
+void              cc_wwan_device_page_suspend       (CcWwanDevicePage *self);
+void              cc_wwan_device_page_resume        (CcWwanDevicePage *self);
 
 G_END_DECLS
@@ -53,6 +53,7 @@ struct _CcWwanDevice
   MMModem     *modem;
   MMSim       *sim;
   MMModem3gpp *modem_3gpp;
+  GCancellable *cancellable;
 
   const char  *operator_code; /* MCCMNC */
   GError      *error;
@@ -71,6 +72,7 @@ struct _CcWwanDevice
 
   CcWwanState  registration_state;
   gboolean     network_is_manual;
+  gboolean     ready;
 };
 
 G_DEFINE_TYPE (CcWwanDevice, cc_wwan_device, G_TYPE_OBJECT)
@@ -91,6 +93,13 @@ enum {
 
 static GParamSpec *properties[N_PROPS];
 
+enum {
+  READY,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
 static void
 cc_wwan_device_state_changed_cb (CcWwanDevice *self)
 {
@@ -218,11 +227,13 @@ cc_wwan_device_nm_device_added_cb (CcWwanDevice *self,
   if (!NM_IS_DEVICE_MODEM (nm_device))
     return;
 
-  if(!self->sim || !cc_wwan_device_is_nm_device (self, G_OBJECT (nm_device)))
+  if (self->wwan_data || !self->sim ||
+      !cc_wwan_device_is_nm_device (self, G_OBJECT (nm_device)))
     return;
 
   self->wwan_data = cc_wwan_data_new (self->mm_object,
-                                      NM_CLIENT (self->nm_client));
+                                      NM_CLIENT (self->nm_client),
+                                      self->sim);
 
   if (self->wwan_data)
     {
@@ -234,6 +245,51 @@ cc_wwan_device_nm_device_added_cb (CcWwanDevice *self,
 }
 #endif
 
+static void
+wwan_device_sim_ready_cb (GObject      *object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  CcWwanDevice *self;
+  g_autoptr(MMSim) sim = NULL;
+  g_autoptr(GError) error = NULL;
+
+  sim = mm_modem_get_sim_finish (MM_MODEM (object), result, &error);
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WWAN_DEVICE (user_data);
+
+  /* A modem without SIM is still usable, eg: for emergency calls */
+  if (error)
+    g_debug ("Failed to get SIM of modem %s: %s",
+             mm_object_get_path (self->mm_object), error->message);
+
+  self->sim = g_steal_pointer (&sim);
+
+  if (self->sim)
+    {
+      self->operator_code = mm_sim_get_operator_identifier (self->sim);
+#if defined(HAVE_NETWORK_MANAGER) && defined(BUILD_NETWORK)
+      self->wwan_data = cc_wwan_data_new (self->mm_object,
+                                          NM_CLIENT (self->nm_client),
+                                          self->sim);
+#endif
+    }
+
+  if (self->wwan_data)
+    g_signal_connect_object (self->wwan_data, "notify::enabled",
+                             G_CALLBACK (wwan_device_emit_data_changed),
+                             self, G_CONNECT_SWAPPED);
+
+  self->ready = TRUE;
+  g_signal_emit (self, signals[READY], 0);
+
+  if (self->wwan_data)
+    wwan_device_emit_data_changed (self);
+}
+
 static void
 cc_wwan_device_get_property (GObject    *object,
                              guint       prop_id,
@@ -284,6 +340,9 @@ cc_wwan_device_dispose (GObject *object)
 {
   CcWwanDevice *self = (CcWwanDevice *)object;
 
+  g_cancellable_cancel (self->cancellable);
+  g_clear_object (&self->cancellable);
+
   g_clear_error (&self->error);
   g_clear_object (&self->modem);
   g_clear_object (&self->mm_object);
@@ -367,11 +426,25 @@ cc_wwan_device_class_init (CcWwanDeviceClass *klass)
                       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, N_PROPS, properties);
+
+  /**
+   * CcWwanDevice::ready:
+   *
+   * Emitted once the SIM of the modem has been fetched,
+   * after which the SIM and data details are available.
+   */
+  signals[READY] =
+    g_signal_new ("ready",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 0);
 }
 
 static void
 cc_wwan_device_init (CcWwanDevice *self)
 {
+  self->cancellable = g_cancellable_new ();
 }
 
 /**
@@ -379,7 +452,10 @@ cc_wwan_device_init (CcWwanDevice *self)
  * @mm_object: (transfer full): An #MMObject
  *
  * Create a new device representing the given
- * @mm_object.
+ * @mm_object.  The modem details available from
+ * ModemManager’s cached properties can be used right
+ * away, the SIM is fetched in the background and
+ * #CcWwanDevice::ready is emitted once it’s done.
  *
  * Returns: A #CcWwanDevice
  */
@@ -400,24 +476,14 @@ cc_wwan_device_new (MMObject *mm_object,
 
   self->mm_object = g_object_ref (mm_object);
   self->modem = mm_object_get_modem (mm_object);
-  self->sim = mm_modem_get_sim_sync (self->modem, NULL, NULL);
   g_set_object (&self->nm_client, nm_client);
-  if (self->sim)
-    {
-      self->operator_code = mm_sim_get_operator_identifier (self->sim);
-#if defined(HAVE_NETWORK_MANAGER) && defined(BUILD_NETWORK)
-      self->wwan_data = cc_wwan_data_new (mm_object,
-                                          NM_CLIENT (self->nm_client));
-#endif
-    }
+
+  mm_modem_get_sim (self->modem, self->cancellable,
+                    wwan_device_sim_ready_cb, self);
 
   g_signal_connect_object (self->mm_object, "notify::unlock-required",
                            G_CALLBACK (cc_wwan_device_unlock_required_cb),
                            self, G_CONNECT_SWAPPED);
-  if (self->wwan_data)
-    g_signal_connect_object (self->wwan_data, "notify::enabled",
-                             G_CALLBACK (wwan_device_emit_data_changed),
-                             self, G_CONNECT_SWAPPED);
 
 #if defined(HAVE_NETWORK_MANAGER) && defined(BUILD_NETWORK)
   g_signal_connect_object (self->nm_client, "notify::nm-running" ,
@@ -444,6 +510,23 @@ cc_wwan_device_new (MMObject *mm_object,
   return self;
 }
 
+/**
+ * cc_wwan_device_is_ready:
+ * @self: a #CcWwanDevice
+ *
+ * Get if the SIM of the device has been fetched,
+ * see #CcWwanDevice::ready.
+ *
+ * Returns: %TRUE if the device is ready, %FALSE otherwise.
+ */
+gboolean
+cc_wwan_device_is_ready (CcWwanDevice *self)
+{
+  g_return_val_if_fail (CC_IS_WWAN_DEVICE (self), FALSE);
+
+  return self->ready;
+}
+
 gboolean
 cc_wwan_device_has_sim (CcWwanDevice *self)
 {
@@ -50,6 +50,7 @@ G_DECLARE_FINAL_TYPE (CcWwanDevice, cc_wwan_device, CC, WWAN_DEVICE, GObject)
 
 CcWwanDevice  *cc_wwan_device_new                (MMObject            *mm_object,
                                                   GObject             *nm_client);
+gboolean       cc_wwan_device_is_ready           (CcWwanDevice        *self);
 gboolean       cc_wwan_device_has_sim            (CcWwanDevice        *self);
 MMModemLock    cc_wwan_device_get_lock           (CcWwanDevice        *self);
 gboolean       cc_wwan_device_get_sim_lock       (CcWwanDevice        *self);
@@ -448,6 +448,8 @@ cc_wwan_panel_add_device (CcWwanPanel  *self,
 
   device_page = cc_wwan_device_page_new (device, GTK_WIDGET (self->toast_overlay));
   cc_wwan_device_page_set_sim_index (device_page, n_items);
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    cc_wwan_device_page_suspend (device_page);
   gtk_stack_add_titled (self->devices_stack,
                         GTK_WIDGET (device_page), stack_name, operator_name);
 }
@@ -481,20 +483,14 @@ cc_wwan_panel_update_page_title (CcWwanDevicePage *device_page,
 }
 
 static void
-cc_wwan_panel_remove_mm_object (CcWwanPanel *self,
-                                MMObject    *mm_object)
+cc_wwan_panel_remove_device (CcWwanPanel  *self,
+                             CcWwanDevice *device)
 {
-  g_autoptr(CcWwanDevice) device = NULL;
   GtkWidget *device_page;
   g_autofree gchar *stack_name = NULL;
   guint n_items;
   gint index;
 
-  device = wwan_model_get_item_from_mm_object (G_LIST_MODEL (self->devices), mm_object);
-
-  if (!device)
-    return;
-
   index = wwan_model_get_item_index (G_LIST_MODEL (self->data_devices), device);
   if (index != -1) {
     g_list_store_remove (self->data_devices, index);
@@ -519,6 +515,20 @@ cc_wwan_panel_remove_mm_object (CcWwanPanel *self,
     cc_wwan_panel_update_page_title (CC_WWAN_DEVICE_PAGE (child), self);
 }
 
+static void
+cc_wwan_panel_remove_mm_object (CcWwanPanel *self,
+                                MMObject    *mm_object)
+{
+  g_autoptr(CcWwanDevice) device = NULL;
+
+  device = wwan_model_get_item_from_mm_object (G_LIST_MODEL (self->devices), mm_object);
+
+  if (!device)
+    return;
+
+  cc_wwan_panel_remove_device (self, device);
+}
+
 static void
 wwan_panel_add_data_device_to_list (CcWwanPanel  *self,
                                     CcWwanDevice *device)
@@ -582,6 +592,29 @@ cc_wwan_panel_update_data_connections (CcWwanPanel *self)
     cc_wwan_panel_update_data_selection (self);
 }
 
+/*
+ * Devices are shown as soon as the modem appears, using the
+ * properties ModemManager already sent us.  The SIM is fetched
+ * in the background, and #CcWwanDevice:has-data is notified
+ * once the data details are known, so a slow modem can’t block
+ * the UI.
+ */
+static void
+wwan_panel_add_mm_object (CcWwanPanel *self,
+                          MMObject    *mm_object)
+{
+  g_autoptr(CcWwanDevice) device = NULL;
+
+  device = cc_wwan_device_new (mm_object, G_OBJECT (self->nm_client));
+  cc_wwan_panel_add_device (self, device);
+  g_signal_connect_object (device, "notify::has-data",
+                           G_CALLBACK (cc_wwan_panel_update_data_connections),
+                           self, G_CONNECT_SWAPPED);
+
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    g_signal_handlers_block_by_func (device, cc_wwan_panel_update_data_connections, self);
+}
+
 static void
 cc_wwan_panel_update_devices (CcWwanPanel *self)
 {
@@ -591,22 +624,14 @@ cc_wwan_panel_update_devices (CcWwanPanel *self)
 
   for (iter = devices; iter; iter = iter->next)
     {
-      MMObject *mm_object = iter->data;
-      CcWwanDevice *device;
-
       if(!wwan_panel_device_is_supported (iter->data))
         continue;
 
-      device = cc_wwan_device_new (mm_object, G_OBJECT (self->nm_client));
-      cc_wwan_panel_add_device (self, device);
-      g_signal_connect_object (device, "notify::has-data",
-                               G_CALLBACK (cc_wwan_panel_update_data_connections),
-                               self, G_CONNECT_SWAPPED);
-
-      if (cc_wwan_device_get_data (device))
-        wwan_panel_add_data_device_to_list (self, device);
+      wwan_panel_add_mm_object (self, MM_OBJECT (iter->data));
     }
 
+  g_list_free_full (devices, g_object_unref);
+
   cc_wwan_panel_update_data_connections (self);
   handle_argv (self);
 }
@@ -615,16 +640,10 @@ static void
 wwan_panel_device_added_cb (CcWwanPanel *self,
                             GDBusObject *object)
 {
-  CcWwanDevice *device;
-
   if(!wwan_panel_device_is_supported (object))
     return;
 
-  device = cc_wwan_device_new (MM_OBJECT (object), G_OBJECT (self->nm_client));
-  cc_wwan_panel_add_device (self, device);
-  g_signal_connect_object (device, "notify::has-data",
-                           G_CALLBACK (cc_wwan_panel_update_data_connections),
-                           self, G_CONNECT_SWAPPED);
+  wwan_panel_add_mm_object (self, MM_OBJECT (object));
   cc_wwan_panel_update_view (self);
   handle_argv (self);
 }
@@ -710,6 +729,119 @@ cc_wwan_panel_set_property (GObject      *object,
     }
 }
 
+/* Catches up with the modems that came or went while suspended */
+static void
+cc_wwan_panel_sync_devices (CcWwanPanel *self)
+{
+  GList *objects, *iter;
+  gint i;
+
+  for (i = g_list_model_get_n_items (G_LIST_MODEL (self->devices)) - 1; i >= 0; i--)
+    {
+      g_autoptr(CcWwanDevice) device = NULL;
+      g_autoptr(GDBusObject) object = NULL;
+
+      device = g_list_model_get_item (G_LIST_MODEL (self->devices), i);
+      object = g_dbus_object_manager_get_object (G_DBUS_OBJECT_MANAGER (self->mm_manager),
+                                                 cc_wwan_device_get_path (device));
+      if (!object)
+        cc_wwan_panel_remove_device (self, device);
+    }
+
+  objects = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (self->mm_manager));
+
+  for (iter = objects; iter; iter = iter->next)
+    {
+      g_autoptr(CcWwanDevice) device = NULL;
+
+      if (!wwan_panel_device_is_supported (iter->data))
+        continue;
+
+      device = wwan_model_get_item_from_mm_object (G_LIST_MODEL (self->devices), iter->data);
+      if (!device)
+        wwan_panel_add_mm_object (self, MM_OBJECT (iter->data));
+    }
+
+  g_list_free_full (objects, g_object_unref);
+}
+
+/* Blocks or unblocks the handlers the panel has on ModemManager,
+ * NetworkManager, the rfkill proxy and its devices. */
+static void
+cc_wwan_panel_block_handlers (CcWwanPanel *self,
+                              gboolean     block)
+{
+  guint i, n_items;
+
+  if (block)
+    {
+      if (self->mm_manager)
+        {
+          g_signal_handlers_block_by_func (self->mm_manager, wwan_panel_device_added_cb, self);
+          g_signal_handlers_block_by_func (self->mm_manager, wwan_panel_device_removed_cb, self);
+        }
+      if (self->nm_client)
+        g_signal_handlers_block_by_func (self->nm_client, cc_wwan_panel_update_view, self);
+      if (self->rfkill_proxy)
+        g_signal_handlers_block_by_func (self->rfkill_proxy, cc_wwan_panel_update_view, self);
+    }
+  else
+    {
+      if (self->mm_manager)
+        {
+          g_signal_handlers_unblock_by_func (self->mm_manager, wwan_panel_device_added_cb, self);
+          g_signal_handlers_unblock_by_func (self->mm_manager, wwan_panel_device_removed_cb, self);
+        }
+      if (self->nm_client)
+        g_signal_handlers_unblock_by_func (self->nm_client, cc_wwan_panel_update_view, self);
+      if (self->rfkill_proxy)
+        g_signal_handlers_unblock_by_func (self->rfkill_proxy, cc_wwan_panel_update_view, self);
+    }
+
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->devices));
+  for (i = 0; i < n_items; i++)
+    {
+      g_autoptr(CcWwanDevice) device = g_list_model_get_item (G_LIST_MODEL (self->devices), i);
+
+      if (block)
+        g_signal_handlers_block_by_func (device, cc_wwan_panel_update_data_connections, self);
+      else
+        g_signal_handlers_unblock_by_func (device, cc_wwan_panel_update_data_connections, self);
+    }
+
+  for (GtkWidget *child = gtk_widget_get_first_child (GTK_WIDGET (self->devices_stack));
+       child;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (block)
+        cc_wwan_device_page_suspend (CC_WWAN_DEVICE_PAGE (child));
+      else
+        cc_wwan_device_page_resume (CC_WWAN_DEVICE_PAGE (child));
+    }
+}
+
+static void
+cc_wwan_panel_suspend (CcPanel *panel)
+{
+  cc_wwan_panel_block_handlers (CC_WWAN_PANEL (panel), TRUE);
+}
+
+static void
+cc_wwan_panel_resume (CcPanel *panel)
+{
+  CcWwanPanel *self = CC_WWAN_PANEL (panel);
+
+  cc_wwan_panel_block_handlers (self, FALSE);
+
+  if (self->mm_manager)
+    cc_wwan_panel_sync_devices (self);
+
+  cc_wwan_panel_update_data_connections (self);
+  cc_wwan_panel_update_view (self);
+  gtk_revealer_set_reveal_child (self->multi_device_revealer,
+                                 g_list_model_get_n_items (G_LIST_MODEL (self->devices)) > 1);
+}
+
 static void
 cc_wwan_panel_dispose (GObject *object)
 {
@@ -734,10 +866,14 @@ cc_wwan_panel_class_init (CcWwanPanelClass *klass)
 {
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  CcPanelClass *panel_class = CC_PANEL_CLASS (klass);
 
   object_class->set_property = cc_wwan_panel_set_property;
   object_class->dispose = cc_wwan_panel_dispose;
 
+  panel_class->suspend = cc_wwan_panel_suspend;
+  panel_class->resume = cc_wwan_panel_resume;
+
   g_object_class_override_property (object_class, PROP_PARAMETERS, "parameters");
 
   gtk_widget_class_set_template_from_resource (widget_class,
@@ -758,58 +894,185 @@ cc_wwan_panel_class_init (CcWwanPanelClass *klass)
 }
 
 static void
-cc_wwan_panel_init (CcWwanPanel *self)
+wwan_panel_set_mm_manager (CcWwanPanel *self,
+                           MMManager   *mm_manager)
+{
+  self->mm_manager = g_object_ref (mm_manager);
+
+  g_signal_connect_object (self->mm_manager, "object-added",
+                           G_CALLBACK (wwan_panel_device_added_cb),
+                           self, G_CONNECT_SWAPPED);
+  g_signal_connect_object (self->mm_manager, "object-removed",
+                           G_CALLBACK (wwan_panel_device_removed_cb),
+                           self, G_CONNECT_SWAPPED);
+
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    {
+      g_signal_handlers_block_by_func (self->mm_manager, wwan_panel_device_added_cb, self);
+      g_signal_handlers_block_by_func (self->mm_manager, wwan_panel_device_removed_cb, self);
+    }
+
+  cc_wwan_panel_update_devices (self);
+  cc_wwan_panel_update_view (self);
+}
+
+static void
+wwan_panel_mm_manager_ready_cb (GObject      *object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
 {
+  CcWwanPanel *self;
+  g_autoptr(MMManager) mm_manager = NULL;
   g_autoptr(GError) error = NULL;
 
-  g_resources_register (cc_wwan_get_resource ());
+  mm_manager = mm_manager_new_finish (result, &error);
 
-  gtk_widget_init_template (GTK_WIDGET (self));
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
 
-  self->cancellable = g_cancellable_new ();
-  self->devices = g_list_store_new (CC_TYPE_WWAN_DEVICE);
-  self->data_devices = g_list_store_new (CC_TYPE_WWAN_DEVICE);
-  self->data_devices_name_list = g_list_store_new (GTK_TYPE_STRING_OBJECT);
-  adw_combo_row_set_model (ADW_COMBO_ROW (self->data_list_row),
-                           G_LIST_MODEL (self->data_devices_name_list));
+  self = CC_WWAN_PANEL (user_data);
 
-  if (cc_object_storage_has_object (CC_OBJECT_NMCLIENT))
+  if (!mm_manager)
     {
-      self->nm_client = cc_object_storage_get_object (CC_OBJECT_NMCLIENT);
-      g_signal_connect_object (self->nm_client,
-                               "notify::wwan-enabled",
-                               G_CALLBACK (cc_wwan_panel_update_view),
-                               self, G_CONNECT_SWAPPED);
+      g_warning ("Error connecting to ModemManager: %s", error->message);
+      return;
+    }
 
+  /* The static init function may have won the race */
+  if (cc_object_storage_has_object (CC_OBJECT_MMMANAGER))
+    {
+      g_clear_object (&mm_manager);
+      mm_manager = cc_object_storage_get_object (CC_OBJECT_MMMANAGER);
     }
   else
     {
-      g_warn_if_reached ();
+      cc_object_storage_add_object (CC_OBJECT_MMMANAGER, mm_manager);
     }
 
-  if (self->nm_client)
+  wwan_panel_set_mm_manager (self, mm_manager);
+}
+
+static void
+wwan_panel_system_bus_ready_cb (GObject      *object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  CcWwanPanel *self;
+  g_autoptr(GDBusConnection) system_bus = NULL;
+  g_autoptr(GError) error = NULL;
+
+  system_bus = g_bus_get_finish (result, &error);
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WWAN_PANEL (user_data);
+
+  if (!system_bus)
     {
-      g_object_bind_property (self->nm_client, "wwan-enabled",
-                              self->enable_switch, "active",
-                              G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+      g_warning ("Error connecting to system D-Bus: %s", error->message);
+      return;
     }
 
+  mm_manager_new (system_bus,
+                  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
+                  self->cancellable,
+                  wwan_panel_mm_manager_ready_cb,
+                  self);
+}
+
+static void
+wwan_panel_set_nm_client (CcWwanPanel *self,
+                          NMClient    *client)
+{
+  self->nm_client = g_object_ref (client);
+
+  g_signal_connect_object (self->nm_client,
+                           "notify::wwan-enabled",
+                           G_CALLBACK (cc_wwan_panel_update_view),
+                           self, G_CONNECT_SWAPPED);
+  if (cc_panel_is_suspended (CC_PANEL (self)))
+    g_signal_handlers_block_by_func (self->nm_client, cc_wwan_panel_update_view, self);
+  g_object_bind_property (self->nm_client, "wwan-enabled",
+                          self->enable_switch, "active",
+                          G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+
+  /* Devices are created with the NMClient, so only list them now */
   if (cc_object_storage_has_object (CC_OBJECT_MMMANAGER))
     {
-      self->mm_manager = cc_object_storage_get_object (CC_OBJECT_MMMANAGER);
+      g_autoptr(MMManager) mm_manager = cc_object_storage_get_object (CC_OBJECT_MMMANAGER);
 
-      g_signal_connect_object (self->mm_manager, "object-added",
-                               G_CALLBACK (wwan_panel_device_added_cb),
-                               self, G_CONNECT_SWAPPED);
-      g_signal_connect_object (self->mm_manager, "object-removed",
-                               G_CALLBACK (wwan_panel_device_removed_cb),
-                               self, G_CONNECT_SWAPPED);
+      wwan_panel_set_mm_manager (self, mm_manager);
+    }
+  else
+    {
+      g_bus_get (G_BUS_TYPE_SYSTEM, self->cancellable,
+                 wwan_panel_system_bus_ready_cb, self);
+    }
+}
+
+static void
+wwan_panel_nm_client_ready_cb (GObject      *object,
+                               GAsyncResult *result,
+                               gpointer      user_data)
+{
+  CcWwanPanel *self;
+  g_autoptr(NMClient) client = NULL;
+  g_autoptr(GError) error = NULL;
+
+  client = nm_client_new_finish (result, &error);
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    return;
+
+  self = CC_WWAN_PANEL (user_data);
+
+  if (!client)
+    {
+      g_warning ("Error connecting to NetworkManager: %s", error->message);
+      return;
+    }
+
+  if (cc_object_storage_has_object (CC_OBJECT_NMCLIENT))
+    {
+      g_clear_object (&client);
+      client = cc_object_storage_get_object (CC_OBJECT_NMCLIENT);
+    }
+  else
+    {
+      cc_object_storage_add_object (CC_OBJECT_NMCLIENT, client);
+    }
+
+  wwan_panel_set_nm_client (self, client);
+}
+
+static void
+cc_wwan_panel_init (CcWwanPanel *self)
+{
+  g_autoptr(GError) error = NULL;
 
-      cc_wwan_panel_update_devices (self);
+  g_resources_register (cc_wwan_get_resource ());
+
+  gtk_widget_init_template (GTK_WIDGET (self));
+
+  self->cancellable = g_cancellable_new ();
+  self->devices = g_list_store_new (CC_TYPE_WWAN_DEVICE);
+  self->data_devices = g_list_store_new (CC_TYPE_WWAN_DEVICE);
+  self->data_devices_name_list = g_list_store_new (GTK_TYPE_STRING_OBJECT);
+  adw_combo_row_set_model (ADW_COMBO_ROW (self->data_list_row),
+                           G_LIST_MODEL (self->data_devices_name_list));
+
+  /* The panel may be opened before the static init functions ran,
+   * create the clients ourselves then but don't block on them */
+  if (cc_object_storage_has_object (CC_OBJECT_NMCLIENT))
+    {
+      g_autoptr(NMClient) client = cc_object_storage_get_object (CC_OBJECT_NMCLIENT);
+
+      wwan_panel_set_nm_client (self, client);
     }
   else
     {
-      g_warn_if_reached ();
+      nm_client_new_async (self->cancellable, wwan_panel_nm_client_ready_cb, self);
     }
 
   /* Acquire Airplane Mode proxy */
@@ -871,38 +1134,39 @@ wwan_update_panel_visibility (MMManager *mm_manager)
   g_list_free_full (devices, (GDestroyNotify)g_object_unref);
 }
 
-void
-cc_wwan_panel_static_init_func (void)
+static void
+wwan_hide_panel (void)
+{
+  CcApplication *application;
+
+  application = CC_APPLICATION (g_application_get_default ());
+  cc_shell_model_set_panel_visibility (cc_application_get_model (application),
+                                       "wwan", FALSE);
+}
+
+static void
+wwan_mm_manager_ready_cb (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
 {
-  g_autoptr(GDBusConnection) system_bus = NULL;
   g_autoptr(MMManager) mm_manager = NULL;
   g_autoptr(GError) error = NULL;
 
-  /*
-   * There could be other modems that are only handled by rfkill,
-   * and not available via ModemManager.  But as this panel
-   * makes use of ModemManager APIs, we only care devices
-   * supported by ModemManager.
-   */
-  system_bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
-  if (system_bus == NULL)
-    g_warning ("Error connecting to system D-Bus: %s", error->message);
-  else
-    mm_manager = mm_manager_new_sync (system_bus,
-                                      G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
-                                      NULL, &error);
+  mm_manager = mm_manager_new_finish (result, &error);
 
   if (mm_manager == NULL)
     {
-      CcApplication *application;
-
       g_warning ("Error connecting to ModemManager: %s", error->message);
-
-      application = CC_APPLICATION (g_application_get_default ());
-      cc_shell_model_set_panel_visibility (cc_application_get_model (application),
-                                           "wwan", FALSE);
+      wwan_hide_panel ();
       return;
     }
+
+  /* The panel may have stored its own manager in the meantime */
+  if (cc_object_storage_has_object (CC_OBJECT_MMMANAGER))
+    {
+      g_clear_object (&mm_manager);
+      mm_manager = cc_object_storage_get_object (CC_OBJECT_MMMANAGER);
+    }
   else
     {
       cc_object_storage_add_object (CC_OBJECT_MMMANAGER, mm_manager);
@@ -915,3 +1179,39 @@ cc_wwan_panel_static_init_func (void)
 
   wwan_update_panel_visibility (mm_manager);
 }
+
+static void
+wwan_system_bus_ready_cb (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  g_autoptr(GDBusConnection) system_bus = NULL;
+  g_autoptr(GError) error = NULL;
+
+  system_bus = g_bus_get_finish (result, &error);
+
+  if (system_bus == NULL)
+    {
+      g_warning ("Error connecting to system D-Bus: %s", error->message);
+      wwan_hide_panel ();
+      return;
+    }
+
+  mm_manager_new (system_bus,
+                  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE,
+                  NULL,
+                  wwan_mm_manager_ready_cb,
+                  NULL);
+}
+
+void
+cc_wwan_panel_static_init_func (void)
+{
+  /*
+   * There could be other modems that are only handled by rfkill,
+   * and not available via ModemManager.  But as this panel
+   * makes use of ModemManager APIs, we only care devices
+   * supported by ModemManager.
+   */
+  g_bus_get (G_BUS_TYPE_SYSTEM, NULL, wwan_system_bus_ready_cb, NULL);
+}
@@ -96,6 +96,10 @@ cc_wwan_pin_apply_clicked_cb (CcWwanSimLockDialog *self)
   const gchar *pin, *new_pin;
   gboolean row_enabled, lock_enabled;
 
+  /* The button is insensitive until the SIM is known */
+  if (!cc_wwan_device_is_ready (self->device))
+    return;
+
   gtk_widget_set_visible (GTK_WIDGET (self), FALSE);
 
   lock_enabled = cc_wwan_device_get_sim_lock (self->device);
@@ -184,7 +188,8 @@ cc_wwan_pin_entered_cb (CcWwanSimLockDialog *self)
     }
 
   len = strlen (pin);
-  enable_apply = len >= PIN_MINIMUM_LENGTH && len <= PIN_MAXIMUM_LENGTH;
+  enable_apply = len >= PIN_MINIMUM_LENGTH && len <= PIN_MAXIMUM_LENGTH &&
+                 cc_wwan_device_is_ready (self->device);
 
   gtk_widget_set_sensitive (GTK_WIDGET (self->apply_button), enable_apply);
 }
@@ -201,6 +206,9 @@ cc_wwan_sim_lock_dialog_set_property (GObject      *object,
     {
     case PROP_DEVICE:
       self->device = g_value_dup_object (value);
+      g_signal_connect_object (self->device, "ready",
+                               G_CALLBACK (cc_wwan_pin_entered_cb),
+                               self, G_CONNECT_SWAPPED);
       break;
 
     default:
@@ -40,7 +40,9 @@ struct _CcSearchProvider
 
   CcShellSearchProvider2 *skeleton;
 
-  GHashTable *iter_table; /* COL_ID -> GtkTreeIter */
+  /* The terms of the last search, and their casefolded version */
+  GStrv terms;
+  GStrv casefolded_terms;
 };
 
 typedef enum {
@@ -52,37 +54,36 @@ typedef enum {
 G_DEFINE_TYPE (CcSearchProvider, cc_search_provider, G_TYPE_OBJECT)
 
 static char **
-get_casefolded_terms (char **terms)
+get_casefolded_terms (CcSearchProvider  *self,
+                      char             **terms)
 {
   char **casefolded_terms;
-  int i, n;
+  guint i, n, n_cached;
+
+  if (self->terms && g_strv_equal ((const char * const *) self->terms, (const char * const *) terms))
+    return self->casefolded_terms;
 
   n = g_strv_length ((char**) terms);
+  n_cached = self->terms ? g_strv_length (self->terms) : 0;
   casefolded_terms = g_new (char*, n + 1);
 
   for (i = 0; i < n; i++)
-    casefolded_terms[i] = cc_util_normalize_casefold_and_unaccent (terms[i]);
+    {
+      /* When narrowing down a search, most terms are the same as before */
+      if (i < n_cached && g_str_equal (terms[i], self->terms[i]))
+        casefolded_terms[i] = g_strdup (self->casefolded_terms[i]);
+      else
+        casefolded_terms[i] = cc_util_normalize_casefold_and_unaccent (terms[i]);
+    }
   casefolded_terms[n] = NULL;
 
-  return casefolded_terms;
-}
+  g_strfreev (self->terms);
+  self->terms = g_strdupv (terms);
 
-static gboolean
-matches_all_terms (GtkTreeModel  *model,
-                   GtkTreeIter   *iter,
-                   char         **terms)
-{
-  int i;
+  g_strfreev (self->casefolded_terms);
+  self->casefolded_terms = casefolded_terms;
 
-  for (i = 0; terms[i]; i++)
-    {
-      if (!cc_shell_model_iter_matches_search (CC_SHELL_MODEL (model),
-                                               iter,
-                                               terms[i]))
-        return FALSE;
-    }
-
-  return TRUE;
+  return self->casefolded_terms;
 }
 
 static GtkTreeModel *
@@ -95,32 +96,26 @@ get_model (void)
 }
 
 static gchar **
-get_results (gchar **terms)
+get_results (CcSearchProvider  *self,
+             gchar            **terms,
+             gchar            **previous_results)
 {
-  g_auto(GStrv) casefolded_terms = NULL;
-  GtkTreeModel *model = get_model ();
-  GtkTreeIter iter;
+  g_autoptr(GPtrArray) matches = NULL;
+  CcShellModel *model = CC_SHELL_MODEL (get_model ());
   GPtrArray *results;
-  gboolean ok;
-
-  casefolded_terms = get_casefolded_terms (terms);
-  results = g_ptr_array_new ();
+  char **casefolded_terms;
+  guint i;
 
-  cc_shell_model_set_sort_terms (CC_SHELL_MODEL (model), casefolded_terms);
+  casefolded_terms = get_casefolded_terms (self, terms);
 
-  ok = gtk_tree_model_get_iter_first (model, &iter);
-  while (ok)
-    {
-      if (matches_all_terms (model, &iter, casefolded_terms))
-        {
-          gchar *id;
-          gtk_tree_model_get (model, &iter, COL_ID, &id, -1);
-          g_ptr_array_add (results, id);
-        }
-
-      ok = gtk_tree_model_iter_next (model, &iter);
-    }
+  if (previous_results)
+    matches = cc_shell_model_search_subset (model, casefolded_terms, (const gchar * const *) previous_results);
+  else
+    matches = cc_shell_model_search (model, casefolded_terms);
 
+  results = g_ptr_array_sized_new (matches->len + 1);
+  for (i = 0; i < matches->len; i++)
+    g_ptr_array_add (results, g_strdup (g_ptr_array_index (matches, i)));
   g_ptr_array_add (results, NULL);
 
   return (char**) g_ptr_array_free (results, FALSE);
@@ -131,7 +126,7 @@ handle_get_initial_result_set (CcSearchProvider        *self,
                                GDBusMethodInvocation   *invocation,
                                char                   **terms)
 {
-  g_auto(GStrv) results = get_results (terms);
+  g_auto(GStrv) results = get_results (self, terms, NULL);
   cc_shell_search_provider2_complete_get_initial_result_set (self->skeleton,
                                                              invocation,
                                                              (const char* const*) results);
@@ -144,64 +139,27 @@ handle_get_subsearch_result_set (CcSearchProvider        *self,
                                  char                   **previous_results,
                                  char                   **terms)
 {
-  /* We ignore the previous results here since the model re-sorts for
-   * the new terms. This means that we're not really doing a subsearch
-   * but, on the other hand, the results are consistent with the
-   * control center's own search. In any case, the number of elements
-   * in the model is always small enough that we don't need to worry
-   * about this taking too long.
+  /* The shell only asks for a subsearch when the new terms narrow down
+   * the previous ones, so only the previous results need to be checked.
+   * They are sorted the same way as in a full search, which keeps the
+   * results consistent with the control center's own search.
    */
-  g_auto(GStrv) results = get_results (terms);
+  g_auto(GStrv) results = get_results (self, terms, previous_results);
   cc_shell_search_provider2_complete_get_subsearch_result_set (self->skeleton,
                                                                invocation,
                                                                (const char* const*) results);
   return TRUE;
 }
 
-static GtkTreeIter *
-get_iter_for_result (CcSearchProvider *self,
-                     const gchar      *result)
-{
-  GtkTreeModel *model;
-  GtkTreeIter iter;
-  gboolean ok;
-  gchar *id;
-
-  /* Caching GtkTreeIters in this way is only OK because the model is
-   * a GtkListStore which guarantees that while a row exists, the iter
-   * is persistent.
-   */
-  if (self->iter_table)
-    goto lookup;
-
-  self->iter_table = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                            g_free, (GDestroyNotify) gtk_tree_iter_free);
-
-  model = get_model ();
-  ok = gtk_tree_model_get_iter_first (model, &iter);
-  while (ok)
-    {
-      gtk_tree_model_get (model, &iter, COL_ID, &id, -1);
-
-      g_hash_table_replace (self->iter_table, id, gtk_tree_iter_copy (&iter));
-
-      ok = gtk_tree_model_iter_next (model, &iter);
-    }
-
- lookup:
-  return g_hash_table_lookup (self->iter_table, result);
-}
-
 static gboolean
 handle_get_result_metas (CcSearchProvider        *self,
                          GDBusMethodInvocation   *invocation,
                          char                   **results)
 {
   GtkTreeModel *model = get_model ();
-  GtkTreeIter *iter;
+  GtkTreeIter iter;
   int i;
   GVariantBuilder builder;
-  const char *id;
 
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
 
@@ -209,20 +167,21 @@ handle_get_result_metas (CcSearchProvider        *self,
     {
       g_autofree gchar *description = NULL;
       g_autofree gchar *name = NULL;
-      g_autoptr(GAppInfo) app = NULL;
+      g_autofree gchar *id = NULL;
       g_autoptr(GIcon) icon = NULL;
 
-      iter = get_iter_for_result (self, results[i]);
-      if (!iter)
+      if (!cc_shell_model_get_iter_for_id (CC_SHELL_MODEL (model), results[i], &iter))
         continue;
 
-      gtk_tree_model_get (model, iter,
-                          COL_APP, &app,
+      gtk_tree_model_get (model, &iter,
                           COL_NAME, &name,
                           COL_GICON, &icon,
                           COL_DESCRIPTION, &description,
                           -1);
-      id = g_app_info_get_id (app);
+
+      /* Panels loaded from the panel cache have no GAppInfo, but the
+       * desktop id is always derived from the panel id */
+      id = g_strconcat ("gnome-", results[i], "-panel.desktop", NULL);
 
       g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{sv}"));
       g_variant_builder_add (&builder, "{sv}",
@@ -351,7 +310,8 @@ cc_search_provider_dispose (GObject *object)
   self = CC_SEARCH_PROVIDER (object);
 
   g_clear_object (&self->skeleton);
-  g_clear_pointer (&self->iter_table, g_hash_table_destroy);
+  g_clear_pointer (&self->terms, g_strfreev);
+  g_clear_pointer (&self->casefolded_terms, g_strfreev);
 
   G_OBJECT_CLASS (cc_search_provider_parent_class)->dispose (object);
 }
@@ -26,6 +26,7 @@
 
 #include <shell/cc-panel-loader.h>
 #include <shell/cc-shell-model.h>
+#include <shell/cc-trace.h>
 #include "cc-search-provider.h"
 #include "control-center-search-provider.h"
 
@@ -145,7 +146,14 @@ cc_search_provider_app_get ()
 int main (int argc, char **argv)
 {
   GApplication *app;
+  int status;
+
+  cc_trace_mark ("search-provider", "main");
 
   app = G_APPLICATION (cc_search_provider_app_get ());
-  return g_application_run (app, argc, argv);
+  status = g_application_run (app, argc, argv);
+
+  cc_trace_shutdown ();
+
+  return status;
 }
@@ -69,6 +69,7 @@ const GOptionEntry all_options[] = {
   { "verbose", 'v', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, cmd_verbose_cb, N_("Enable verbose mode. Specify multiple times to increase verbosity"), NULL },
   { "search", 's', 0, G_OPTION_ARG_STRING, NULL, N_("Search for the string"), "SEARCH" },
   { "list", 'l', 0, G_OPTION_ARG_NONE, NULL, N_("List possible panel names and exit"), NULL },
+  { "timings", 0, 0, G_OPTION_ARG_NONE, NULL, N_("Show how long it took to load the panels"), NULL },
   { G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY, NULL, N_("Panel to display"), N_("[PANEL] [ARGUMENT…]") },
   { NULL, 0, 0, 0, NULL, NULL, NULL } /* end the list */
 };
@@ -210,6 +211,30 @@ cc_application_handle_local_options (GApplication *application,
   return -1;
 }
 
+static void
+print_timings (GApplicationCommandLine *command_line)
+{
+  gboolean from_cache;
+  gint64 cold_fill_time;
+  gint64 fill_time;
+
+  cc_panel_loader_get_fill_timings (&from_cache, &fill_time, &cold_fill_time);
+
+  if (from_cache)
+    {
+      g_application_command_line_print (command_line,
+                                        "Loaded panels from the cache in %.2f ms, saving %.2f ms of desktop file parsing\n",
+                                        fill_time / 1000.0,
+                                        (cold_fill_time - fill_time) / 1000.0);
+    }
+  else
+    {
+      g_application_command_line_print (command_line,
+                                        "Loaded panels from their desktop files in %.2f ms\n",
+                                        fill_time / 1000.0);
+    }
+}
+
 static int
 cc_application_command_line (GApplication            *application,
                              GApplicationCommandLine *command_line)
@@ -229,6 +254,9 @@ cc_application_command_line (GApplication            *application,
   if (debug)
     cc_log_init ();
 
+  if (g_variant_dict_contains (options, "timings"))
+    print_timings (command_line);
+
   gtk_window_present (GTK_WINDOW (self->window));
 
   if (g_variant_dict_lookup (options, "search", "&s", &search_str))
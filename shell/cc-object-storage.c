@@ -19,6 +19,7 @@
 #define G_LOG_DOMAIN "cc-object-storage"
 
 #include "cc-object-storage.h"
+#include "cc-trace.h"
 
 struct _CcObjectStorage
 {
@@ -79,6 +80,9 @@ create_dbus_proxy_in_thread_cb (GTask        *task,
   g_autoptr(GDBusProxy) proxy = NULL;
   g_autoptr(GError) local_error = NULL;
   TaskData *data = task_data;
+  gint64 trace_time;
+
+  trace_time = cc_trace_begin ();
 
   proxy = g_dbus_proxy_new_for_bus_sync (data->bus_type,
                                          data->flags,
@@ -89,6 +93,8 @@ create_dbus_proxy_in_thread_cb (GTask        *task,
                                          cancellable,
                                          &local_error);
 
+  cc_trace_end (trace_time, "dbus", "proxy %s %s", data->name, data->interface);
+
   if (local_error)
     {
       g_task_return_error (task, g_steal_pointer (&local_error));
@@ -230,6 +236,7 @@ cc_object_storage_create_dbus_proxy_sync (GBusType          bus_type,
   g_autoptr(GDBusProxy) proxy = NULL;
   g_autoptr(GError) local_error = NULL;
   g_autofree gchar *key = NULL;
+  gint64 trace_time;
 
   g_assert (CC_IS_OBJECT_STORAGE (_instance));
   g_assert (name && *name);
@@ -247,6 +254,8 @@ cc_object_storage_create_dbus_proxy_sync (GBusType          bus_type,
   if (g_hash_table_contains (_instance->id_to_object, key))
     return cc_object_storage_get_object (key);
 
+  trace_time = cc_trace_begin ();
+
   proxy = g_dbus_proxy_new_for_bus_sync (bus_type,
                                          flags,
                                          NULL,
@@ -256,6 +265,8 @@ cc_object_storage_create_dbus_proxy_sync (GBusType          bus_type,
                                          cancellable,
                                          &local_error);
 
+  cc_trace_end (trace_time, "dbus", "proxy %s %s (sync)", name, interface);
+
   if (local_error)
     {
       g_propagate_error (error, g_steal_pointer (&local_error));
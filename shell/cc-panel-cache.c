@@ -0,0 +1,415 @@
+/* cc-panel-cache.c
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "cc-panel-cache"
+
+#include <config.h>
+
+#include <glib/gstdio.h>
+
+#include "cc-panel-cache.h"
+
+/*
+ * The panel cache stores everything CcShellModel needs to know about the
+ * panels, so that both GNOME Settings and its search provider can skip
+ * looking up and parsing the desktop files of every panel on startup.
+ *
+ * It is a single serialized GVariant, memory-mapped when loaded:
+ *
+ *   u           version of the format
+ *   s           languages the names and descriptions are translated to
+ *   a(sx)       the "applications" data directories and their mtimes (ns)
+ *   as          the panel names the cache was generated for
+ *   x           time it took to fill the model from the desktop files (µs)
+ *   a(...)      one entry per panel:
+ *                 s   id
+ *                 u   category
+ *                 s   name
+ *                 s   casefolded name
+ *                 ms  description
+ *                 ms  casefolded description
+ *                 as  casefolded keywords
+ *                 v   serialized icon
+ *                 s   desktop file
+ *                 x   desktop file mtime (ns)
+ *                 t   desktop file size
+ *
+ * The cache is only used if all of these still match; any mismatch means
+ * the desktop files are parsed again and the cache regenerated.
+ */
+
+#define CACHE_VERSION 2
+#define CACHE_TYPE    "(usa(sx)asxa(sussmsmsasvsxt))"
+#define ENTRY_TYPE    "(sussmsmsasvsxt)"
+#define ENTRY_FORMAT  "(sussmsms^asvsxt)"
+
+static gchar *
+get_cache_filename (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "gnome-control-center", "panels.cache", NULL);
+}
+
+static gchar *
+get_languages (void)
+{
+  return g_strjoinv (":", (gchar **) g_get_language_names ());
+}
+
+/* Whole seconds miss files modified twice within the same second */
+static gint64
+get_mtime (const gchar *filename,
+           guint64     *out_size)
+{
+  GStatBuf buf;
+
+  if (g_stat (filename, &buf) < 0)
+    {
+      if (out_size)
+        *out_size = 0;
+      return 0;
+    }
+
+  if (out_size)
+    *out_size = buf.st_size;
+
+  return (gint64) buf.st_mtim.tv_sec * G_GINT64_CONSTANT (1000000000) + buf.st_mtim.tv_nsec;
+}
+
+static GPtrArray *
+get_application_dirs (void)
+{
+  const gchar * const *data_dirs;
+  GPtrArray *dirs;
+  guint i;
+
+  dirs = g_ptr_array_new_with_free_func (g_free);
+  g_ptr_array_add (dirs, g_build_filename (g_get_user_data_dir (), "applications", NULL));
+
+  data_dirs = g_get_system_data_dirs ();
+  for (i = 0; data_dirs[i]; i++)
+    g_ptr_array_add (dirs, g_build_filename (data_dirs[i], "applications", NULL));
+
+  return dirs;
+}
+
+static gboolean
+validate_cache (GVariant            *cache,
+                const gchar * const *names)
+{
+  g_autoptr(GVariant) dirs_variant = NULL;
+  g_autoptr(GVariant) entries = NULL;
+  g_autoptr(GPtrArray) dirs = NULL;
+  g_autofree const gchar **cached_names = NULL;
+  g_autofree gchar *languages = NULL;
+  const gchar *cached_languages;
+  GVariantIter iter;
+  const gchar *filename;
+  guint64 size;
+  gint64 mtime;
+  guint32 version;
+  guint i;
+
+  g_variant_get_child (cache, 0, "u", &version);
+  if (version != CACHE_VERSION)
+    return FALSE;
+
+  /* Names and descriptions are translated */
+  languages = get_languages ();
+  g_variant_get_child (cache, 1, "&s", &cached_languages);
+  if (!g_str_equal (languages, cached_languages))
+    return FALSE;
+
+  /* Desktop files added to, or removed from, any of the data dirs */
+  dirs = get_application_dirs ();
+  dirs_variant = g_variant_get_child_value (cache, 2);
+  if (g_variant_n_children (dirs_variant) != dirs->len)
+    return FALSE;
+
+  g_variant_iter_init (&iter, dirs_variant);
+  for (i = 0; g_variant_iter_next (&iter, "(&sx)", &filename, &mtime); i++)
+    {
+      if (!g_str_equal (filename, g_ptr_array_index (dirs, i)) || get_mtime (filename, NULL) != mtime)
+        return FALSE;
+    }
+
+  /* Panels added or removed from the build */
+  g_variant_get_child (cache, 3, "^a&s", &cached_names);
+  if (!g_strv_equal ((const gchar * const *) cached_names, names))
+    return FALSE;
+
+  /* Modified desktop files */
+  entries = g_variant_get_child_value (cache, 5);
+  g_variant_iter_init (&iter, entries);
+  while (g_variant_iter_next (&iter, "(&su&s&sm&sm&s@asv&sxt)",
+                              NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                              &filename, &mtime, &size))
+    {
+      guint64 current_size;
+
+      if (get_mtime (filename, &current_size) != mtime || current_size != size)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * cc_panel_cache_load:
+ * @names: the names of the panels that are going to be loaded
+ *
+ * Loads the panel cache, and checks that it is still up to date with
+ * the desktop files of the panels.
+ *
+ * Returns: (transfer full) (nullable): the cache, or %NULL if it does
+ * not exist or is outdated.
+ */
+GVariant *
+cc_panel_cache_load (const gchar * const *names)
+{
+  g_autoptr(GMappedFile) mapped_file = NULL;
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GBytes) bytes = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *filename = NULL;
+
+  filename = get_cache_filename ();
+  mapped_file = g_mapped_file_new (filename, FALSE, &error);
+
+  if (!mapped_file)
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_warning ("Could not load panel cache '%s': %s", filename, error->message);
+      return NULL;
+    }
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  cache = g_variant_new_from_bytes (G_VARIANT_TYPE (CACHE_TYPE), bytes, FALSE);
+  g_variant_ref_sink (cache);
+
+  if (!validate_cache (cache, names))
+    {
+      g_debug ("Panel cache '%s' is outdated", filename);
+      return NULL;
+    }
+
+  return g_steal_pointer (&cache);
+}
+
+/**
+ * cc_panel_cache_fill_model:
+ * @cache: a panel cache returned by cc_panel_cache_load()
+ * @model: a #CcShellModel
+ *
+ * Adds all the panels stored in @cache to @model.
+ */
+void
+cc_panel_cache_fill_model (GVariant     *cache,
+                           CcShellModel *model)
+{
+  g_autoptr(GVariant) entries = NULL;
+  GVariantIter iter;
+  GVariant *entry;
+
+  g_return_if_fail (cache != NULL);
+  g_return_if_fail (CC_IS_SHELL_MODEL (model));
+
+  entries = g_variant_get_child_value (cache, 5);
+  g_variant_iter_init (&iter, entries);
+
+  while ((entry = g_variant_iter_next_value (&iter)) != NULL)
+    {
+      g_autoptr(GVariant) icon_variant = NULL;
+      g_autoptr(GIcon) icon = NULL;
+      g_autofree const gchar **keywords = NULL;
+      const gchar *casefolded_description;
+      const gchar *casefolded_name;
+      const gchar *description;
+      const gchar *name;
+      const gchar *id;
+      guint32 category;
+
+      g_variant_get (entry, "(&su&s&sm&sm&s^a&svsxt)",
+                     &id,
+                     &category,
+                     &name,
+                     &casefolded_name,
+                     &description,
+                     &casefolded_description,
+                     &keywords,
+                     &icon_variant,
+                     NULL,
+                     NULL,
+                     NULL);
+
+      icon = g_icon_deserialize (icon_variant);
+
+      cc_shell_model_add_cached_item (model,
+                                      category,
+                                      id,
+                                      name,
+                                      casefolded_name,
+                                      description,
+                                      casefolded_description,
+                                      (GStrv) keywords,
+                                      icon);
+
+      g_variant_unref (entry);
+    }
+}
+
+/**
+ * cc_panel_cache_get_cold_fill_time:
+ * @cache: a panel cache returned by cc_panel_cache_load()
+ *
+ * Returns: the time, in microseconds, that it took to fill the model
+ * from the desktop files when @cache was generated.
+ */
+gint64
+cc_panel_cache_get_cold_fill_time (GVariant *cache)
+{
+  gint64 fill_time;
+
+  g_return_val_if_fail (cache != NULL, 0);
+
+  g_variant_get_child (cache, 4, "x", &fill_time);
+
+  return fill_time;
+}
+
+/**
+ * cc_panel_cache_save:
+ * @model: a #CcShellModel filled from the desktop files
+ * @names: the names of the panels that were requested
+ * @filenames: a map from panel ids to the desktop file they were loaded from
+ * @fill_time: the time it took to fill @model, in microseconds
+ *
+ * Stores the contents of @model in the panel cache.
+ */
+void
+cc_panel_cache_save (CcShellModel        *model,
+                     const gchar * const *names,
+                     GHashTable          *filenames,
+                     gint64               fill_time)
+{
+  g_autoptr(GPtrArray) dirs = NULL;
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *languages = NULL;
+  g_autofree gchar *filename = NULL;
+  g_autofree gchar *dirname = NULL;
+  GVariantBuilder dirs_builder;
+  GVariantBuilder builder;
+  GtkTreeIter iter;
+  gboolean valid;
+  guint i;
+
+  g_return_if_fail (CC_IS_SHELL_MODEL (model));
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" ENTRY_TYPE));
+
+  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
+  while (valid)
+    {
+      g_autofree gchar *casefolded_description = NULL;
+      g_autofree gchar *casefolded_name = NULL;
+      g_autofree gchar *description = NULL;
+      g_autofree gchar *name = NULL;
+      g_autofree gchar *id = NULL;
+      g_auto(GStrv) keywords = NULL;
+      g_autoptr(GVariant) icon_variant = NULL;
+      g_autoptr(GIcon) icon = NULL;
+      const gchar *desktop_file;
+      CcPanelCategory category;
+      guint64 size;
+      gint64 mtime;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (model), &iter,
+                          COL_ID, &id,
+                          COL_CATEGORY, &category,
+                          COL_NAME, &name,
+                          COL_CASEFOLDED_NAME, &casefolded_name,
+                          COL_DESCRIPTION, &description,
+                          COL_CASEFOLDED_DESCRIPTION, &casefolded_description,
+                          COL_KEYWORDS, &keywords,
+                          COL_GICON, &icon,
+                          -1);
+
+      desktop_file = g_hash_table_lookup (filenames, id);
+      icon_variant = icon ? g_icon_serialize (icon) : NULL;
+
+      /* Not worth caching something we can't restore */
+      if (!desktop_file || !icon_variant)
+        {
+          g_debug ("Not caching panels, '%s' can't be serialized", id);
+          g_variant_builder_clear (&builder);
+          return;
+        }
+
+      mtime = get_mtime (desktop_file, &size);
+      g_variant_builder_add (&builder, ENTRY_FORMAT,
+                             id,
+                             category,
+                             name,
+                             casefolded_name,
+                             description,
+                             casefolded_description,
+                             keywords,
+                             icon_variant,
+                             desktop_file,
+                             mtime,
+                             size);
+
+      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (model), &iter);
+    }
+
+  g_variant_builder_init (&dirs_builder, G_VARIANT_TYPE ("a(sx)"));
+
+  dirs = get_application_dirs ();
+  for (i = 0; i < dirs->len; i++)
+    {
+      const gchar *dir = g_ptr_array_index (dirs, i);
+      g_variant_builder_add (&dirs_builder, "(sx)", dir, get_mtime (dir, NULL));
+    }
+
+  languages = get_languages ();
+  cache = g_variant_new ("(usa(sx)^asxa" ENTRY_TYPE ")",
+                         CACHE_VERSION,
+                         languages,
+                         &dirs_builder,
+                         names,
+                         fill_time,
+                         &builder);
+  g_variant_ref_sink (cache);
+
+  filename = get_cache_filename ();
+  dirname = g_path_get_dirname (filename);
+
+  if (g_mkdir_with_parents (dirname, USER_DIR_MODE) < 0)
+    {
+      g_warning ("Could not create directory '%s': %m", dirname);
+      return;
+    }
+
+  if (!g_file_set_contents (filename,
+                            g_variant_get_data (cache),
+                            g_variant_get_size (cache),
+                            &error))
+    {
+      g_warning ("Could not save panel cache '%s': %s", filename, error->message);
+    }
+}
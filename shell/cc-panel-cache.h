@@ -0,0 +1,39 @@
+/* cc-panel-cache.h
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "cc-shell-model.h"
+
+G_BEGIN_DECLS
+
+GVariant *cc_panel_cache_load        (const gchar * const *names);
+
+void      cc_panel_cache_fill_model  (GVariant            *cache,
+                                      CcShellModel        *model);
+
+gint64    cc_panel_cache_get_cold_fill_time (GVariant     *cache);
+
+void      cc_panel_cache_save        (CcShellModel        *model,
+                                      const gchar * const *names,
+                                      GHashTable          *filenames,
+                                      gint64               fill_time);
+
+G_END_DECLS
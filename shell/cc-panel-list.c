@@ -60,6 +60,11 @@ struct _CcPanelList
   GHashTable         *id_to_data;
   GHashTable         *id_to_search_data;
 
+  /* Panel ids matching the current search words, mapped to their
+   * (1-based) position in the results of cc_shell_model_search() */
+  CcShellModel       *model;
+  GHashTable         *search_ranks;
+
   /* When true, the next row being activated will be vertically centered on
    * the visible part of panel list. Currently we do that for panels activated
    * from Search or from the set_active_panel_from_id() CcShell iface */
@@ -208,6 +213,25 @@ update_search (CcPanelList *self)
   gtk_list_box_unselect_all (GTK_LIST_BOX (self->search_listbox));
 }
 
+static void
+update_search_ranks (CcPanelList *self)
+{
+  g_autoptr(GPtrArray) results = NULL;
+  guint i;
+
+  g_clear_pointer (&self->search_ranks, g_hash_table_destroy);
+
+  if (!self->model || !self->search_words)
+    return;
+
+  results = cc_shell_model_search (self->model, self->search_words);
+
+  /* The ids are owned by the model, which outlives the ranks */
+  self->search_ranks = g_hash_table_new (g_str_hash, g_str_equal);
+  for (i = 0; i < results->len; i++)
+    g_hash_table_insert (self->search_ranks, g_ptr_array_index (results, i), GUINT_TO_POINTER (i + 1));
+}
+
 static const gchar*
 get_panel_id_from_row (CcPanelList   *self,
                        GtkListBoxRow *row)
@@ -313,10 +337,6 @@ filter_func (GtkListBoxRow *row,
 {
   CcPanelList *self;
   RowData *data;
-  g_autofree gchar *panel_text = NULL;
-  g_autofree gchar *panel_description = NULL;
-  gboolean retval = TRUE;
-  gint i, j;
 
   self = CC_PANEL_LIST (user_data);
   data = g_object_get_data (G_OBJECT (row), "data");
@@ -324,38 +344,17 @@ filter_func (GtkListBoxRow *row,
   if (!self->search_words)
     return TRUE;
 
-  panel_text = cc_util_normalize_casefold_and_unaccent (data->name);
-  panel_description = cc_util_normalize_casefold_and_unaccent (data->description);
-
-  g_strstrip (panel_text);
-  g_strstrip (panel_description);
-
   /*
    * The description label is only visible when the search is
    * happening.
    */
   gtk_widget_set_visible (data->description_label, self->view == CC_PANEL_LIST_SEARCH);
 
-  for (j = 0; retval && self->search_words[j] != NULL; j++) {
-    const gchar *search_word = self->search_words[j];
-    gboolean match = FALSE;
-
-    if (search_word[0] == '\0')
-      continue;
-
-    // Compare keywords
-    for (i = 0; !match && data->keywords[i] != NULL; i++)
-      match = (strstr (data->keywords[i], search_word) == data->keywords[i]);
-
-    // Compare panel title and description
-    match = match || (g_strstr_len (panel_text, -1, search_word) != NULL ||
-                      g_strstr_len (panel_description, -1, search_word) != NULL);
-
-    // All search words must match
-    retval = retval && match;
-  }
+  /* The matching itself is done by the shell model's search index */
+  if (!self->search_ranks)
+    return TRUE;
 
-  return retval;
+  return g_hash_table_contains (self->search_ranks, data->id);
 }
 
 static const gchar * const panel_order[] = {
@@ -434,8 +433,17 @@ sort_function (GtkListBoxRow *a,
 }
 
 
-/* FIXME: This is now different from the "match all words" search.
-          Maybe add a search score based on number of matches in filter_func()? */
+static guint
+get_search_rank (CcPanelList *self,
+                 RowData     *data)
+{
+  guint rank;
+
+  rank = GPOINTER_TO_UINT (g_hash_table_lookup (self->search_ranks, data->id));
+
+  return rank > 0 ? rank : G_MAXUINT;
+}
+
 static gint
 search_sort_function (GtkListBoxRow *a,
                       GtkListBoxRow *b,
@@ -445,42 +453,29 @@ search_sort_function (GtkListBoxRow *a,
   RowData *a_data, *b_data;
   g_autofree gchar *a_name = NULL;
   g_autofree gchar *b_name = NULL;
-  g_autofree gchar *search = NULL;
-  gchar *a_strstr, *b_strstr;
-  gint a_distance, b_distance;
+  guint a_rank, b_rank;
 
   self = CC_PANEL_LIST (user_data);
-  search = NULL;
   a_data = g_object_get_data (G_OBJECT (a), "data");
   b_data = g_object_get_data (G_OBJECT (b), "data");
 
-  a_distance = b_distance = G_MAXINT;
+  /* Results are already sorted by relevance by the search index */
+  if (self->search_ranks)
+    {
+      a_rank = get_search_rank (self, a_data);
+      b_rank = get_search_rank (self, b_data);
+
+      if (a_rank != b_rank)
+        return a_rank < b_rank ? -1 : 1;
+    }
 
+  /* Default result for empty search */
   a_name = cc_util_normalize_casefold_and_unaccent (a_data->name);
   b_name = cc_util_normalize_casefold_and_unaccent (b_data->name);
   g_strstrip (a_name);
   g_strstrip (b_name);
 
-  if (self->search_query)
-    {
-      search = cc_util_normalize_casefold_and_unaccent (self->search_query);
-      g_strstrip (search);
-    }
-
-  /* Default result for empty search */
-  if (!search || g_utf8_strlen (search, -1) == 0)
-    return g_strcmp0 (a_name, b_name);
-
-  a_strstr = g_strstr_len (a_name, -1, search);
-  b_strstr = g_strstr_len (b_name, -1, search);
-
-  if (a_strstr)
-    a_distance = g_strstr_len (a_name, -1, search) - a_name;
-
-  if (b_strstr)
-    b_distance = g_strstr_len (b_name, -1, search) - b_name;
-
-  return a_distance - b_distance;
+  return g_strcmp0 (a_name, b_name);
 }
 
 static void
@@ -603,6 +598,8 @@ cc_panel_list_finalize (GObject *object)
   g_clear_pointer (&self->current_panel_id, g_free);
   g_clear_pointer (&self->id_to_data, g_hash_table_destroy);
   g_clear_pointer (&self->id_to_search_data, g_hash_table_destroy);
+  g_clear_pointer (&self->search_ranks, g_hash_table_destroy);
+  g_clear_object (&self->model);
 
   G_OBJECT_CLASS (cc_panel_list_parent_class)->finalize (object);
 }
@@ -835,6 +832,29 @@ cc_panel_list_activate (CcPanelList *self)
   CC_RETURN (row != NULL);
 }
 
+/**
+ * cc_panel_list_set_model:
+ * @self: a #CcPanelList
+ * @model: the #CcShellModel holding the panels of @self
+ *
+ * Sets the model used to look up the panels matching the search query.
+ */
+void
+cc_panel_list_set_model (CcPanelList  *self,
+                         CcShellModel *model)
+{
+  g_return_if_fail (CC_IS_PANEL_LIST (self));
+  g_return_if_fail (CC_IS_SHELL_MODEL (model));
+
+  if (!g_set_object (&self->model, model))
+    return;
+
+  update_search_ranks (self);
+
+  gtk_list_box_invalidate_filter (GTK_LIST_BOX (self->search_listbox));
+  gtk_list_box_invalidate_sort (GTK_LIST_BOX (self->search_listbox));
+}
+
 const gchar*
 cc_panel_list_get_search_query (CcPanelList *self)
 {
@@ -862,6 +882,7 @@ cc_panel_list_set_search_query (CcPanelList *self,
       search_query_normalized = cc_util_normalize_casefold_and_unaccent (search);
       self->search_words = g_strsplit (g_strstrip (search_query_normalized), " ", 0);
 
+      update_search_ranks (self);
       update_search (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SEARCH_QUERY]);
@@ -41,6 +41,9 @@ GtkWidget*           cc_panel_list_new                           (void);
 
 gboolean             cc_panel_list_activate                      (CcPanelList        *self);
 
+void                 cc_panel_list_set_model                     (CcPanelList        *self,
+                                                                  CcShellModel       *model);
+
 const gchar*         cc_panel_list_get_search_query              (CcPanelList        *self);
 
 void                 cc_panel_list_set_search_query              (CcPanelList        *self,
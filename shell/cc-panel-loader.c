@@ -26,7 +26,9 @@
 #include <glib/gi18n.h>
 
 #include "cc-panel.h"
+#include "cc-panel-cache.h"
 #include "cc-panel-loader.h"
+#include "cc-trace.h"
 
 #ifndef CC_PANEL_LOADER_NO_GTYPES
 
@@ -153,6 +155,11 @@ static CcSubpageLoaderVtable default_subpages[] =
 static CcSubpageLoaderVtable *subpages_vtable = default_subpages;
 static gsize supages_vtable_len = G_N_ELEMENTS (default_subpages);
 
+/* How long the last cc_panel_loader_fill_model() call took */
+static gboolean fill_from_cache = FALSE;
+static gint64 fill_time = 0;
+static gint64 cold_fill_time = 0;
+
 static int
 parse_categories (GDesktopAppInfo *app)
 {
@@ -228,32 +235,51 @@ cc_panel_loader_load_by_name (CcShell     *shell,
                               GVariant    *parameters)
 {
   GType (*get_type) (void);
+  CcPanel *panel;
+  gint64 trace_time;
+
+  trace_time = cc_trace_begin ();
 
   ensure_panel_types ();
 
   get_type = g_hash_table_lookup (panel_types, name);
   g_assert (get_type != NULL);
 
-  return g_object_new (get_type (),
-                       "shell", shell,
-                       "parameters", parameters,
-                       "title", title,
-                       NULL);
+  panel = g_object_new (get_type (),
+                        "shell", shell,
+                        "parameters", parameters,
+                        "title", title,
+                        NULL);
+
+  cc_trace_end (trace_time, "panel", "load %s", name);
+
+  return panel;
 }
 
 #endif /* CC_PANEL_LOADER_NO_GTYPES */
 
-/**
- * cc_panel_loader_fill_model:
- * @model: a #CcShellModel
- *
- * Fills @model with information from the available panels. It
- * iterates over the panel vtable, gathering the panel names,
- * build the desktop filename from it, and retrieves additional
- * information from it.
- */
-void
-cc_panel_loader_fill_model (CcShellModel *model)
+static GPtrArray *
+get_panel_names (void)
+{
+  GPtrArray *names;
+  guint i;
+
+  names = g_ptr_array_new ();
+
+  for (i = 0; i < panels_vtable_len; i++)
+    g_ptr_array_add (names, (gchar *) panels_vtable[i].name);
+
+  for (i = 0; i < supages_vtable_len; i++)
+    g_ptr_array_add (names, (gchar *) subpages_vtable[i].name);
+
+  g_ptr_array_add (names, NULL);
+
+  return names;
+}
+
+static void
+fill_model_from_desktop_files (CcShellModel *model,
+                               GHashTable   *filenames)
 {
   guint i;
 
@@ -277,6 +303,9 @@ cc_panel_loader_fill_model (CcShellModel *model)
         continue;
 
       cc_shell_model_add_item (model, category, G_APP_INFO (app), panels_vtable[i].name);
+      g_hash_table_insert (filenames,
+                           (gchar *) panels_vtable[i].name,
+                           g_strdup (g_desktop_app_info_get_filename (app)));
     }
 
   for (i = 0; i < supages_vtable_len; i++)
@@ -294,20 +323,184 @@ cc_panel_loader_fill_model (CcShellModel *model)
         }
 
       cc_shell_model_add_item (model, subpages_vtable[i].category, G_APP_INFO (app), subpages_vtable[i].name);
-      cc_shell_model_set_panel_visibility (model, subpages_vtable[i].name, CC_PANEL_VISIBLE_IN_SEARCH);
+      g_hash_table_insert (filenames,
+                           (gchar *) subpages_vtable[i].name,
+                           g_strdup (g_desktop_app_info_get_filename (app)));
+    }
+}
+
+/**
+ * cc_panel_loader_fill_model:
+ * @model: a #CcShellModel
+ *
+ * Fills @model with information from the available panels. It
+ * iterates over the panel vtable, gathering the panel names,
+ * build the desktop filename from it, and retrieves additional
+ * information from it.
+ *
+ * The information is then stored in the panel cache, so that the
+ * next calls don't need to look up and parse the desktop files
+ * unless they changed.
+ */
+void
+cc_panel_loader_fill_model (CcShellModel *model)
+{
+  g_autoptr(GHashTable) filenames = NULL;
+  g_autoptr(GVariant) cache = NULL;
+  g_autoptr(GPtrArray) names = NULL;
+  gint64 start_time;
+  gint64 trace_time;
+  guint i;
+
+  trace_time = cc_trace_begin ();
+  start_time = g_get_monotonic_time ();
+
+  names = get_panel_names ();
+  cache = cc_panel_cache_load ((const gchar * const *) names->pdata);
+
+  if (cache)
+    {
+      cc_panel_cache_fill_model (cache, model);
+      cold_fill_time = cc_panel_cache_get_cold_fill_time (cache);
+    }
+  else
+    {
+      filenames = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+      fill_model_from_desktop_files (model, filenames);
+    }
+
+  for (i = 0; i < supages_vtable_len; i++)
+    {
+      if (cc_shell_model_has_panel (model, subpages_vtable[i].name))
+        cc_shell_model_set_panel_visibility (model, subpages_vtable[i].name, CC_PANEL_VISIBLE_IN_SEARCH);
     }
 
-  /* If there's an static init function, execute it after adding all panels to
-   * the model. This will allow the panels to show or hide themselves without
-   * having an instance running.
-   */
 #ifndef CC_PANEL_LOADER_NO_GTYPES
+  /* Panels with a static init function probe whether they should be in
+   * the sidebar. Keep them out of it until their probe tells otherwise,
+   * so that they don't show up and then disappear.
+   */
   for (i = 0; i < panels_vtable_len; i++)
     {
-      if (panels_vtable[i].static_init_func)
-        panels_vtable[i].static_init_func ();
+      if (panels_vtable[i].static_init_func && cc_shell_model_has_panel (model, panels_vtable[i].name))
+        cc_shell_model_set_panel_visibility (model, panels_vtable[i].name, CC_PANEL_VISIBLE_IN_SEARCH);
     }
 #endif
+
+  fill_from_cache = cache != NULL;
+  fill_time = g_get_monotonic_time () - start_time;
+
+  if (!cache)
+    {
+      cold_fill_time = fill_time;
+      cc_panel_cache_save (model, (const gchar * const *) names->pdata, filenames, fill_time);
+    }
+
+  g_debug ("Filled the model %s in %" G_GINT64_FORMAT "µs",
+           fill_from_cache ? "from the panel cache" : "from the desktop files",
+           fill_time);
+
+  cc_trace_end (trace_time, "shell", "fill model (%s)", fill_from_cache ? "cache" : "desktop files");
+}
+
+#ifndef CC_PANEL_LOADER_NO_GTYPES
+
+static guint static_init_idle_id = 0;
+static guint next_static_init = 0;
+
+static gboolean
+run_next_static_init_cb (gpointer user_data)
+{
+  while (next_static_init < panels_vtable_len)
+    {
+      CcPanelLoaderVtable *vtable = &panels_vtable[next_static_init++];
+      gint64 trace_time;
+
+      if (!vtable->static_init_func)
+        continue;
+
+      trace_time = cc_trace_begin ();
+      vtable->static_init_func ();
+      cc_trace_end (trace_time, "panel", "static init %s", vtable->name);
+
+      return G_SOURCE_CONTINUE;
+    }
+
+  g_debug ("All static init functions ran");
+
+  static_init_idle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * cc_panel_loader_schedule_static_init:
+ *
+ * Schedules the static init functions of the panels to run when the
+ * main loop is idle, one function per iteration. This allows the panels
+ * to show or hide themselves in the model filled by
+ * cc_panel_loader_fill_model() without having an instance running.
+ *
+ * Static init functions usually probe devices or D-Bus services, so
+ * this should be called after the window is first drawn to not delay
+ * startup. Only the first call has an effect.
+ */
+void
+cc_panel_loader_schedule_static_init (void)
+{
+  if (static_init_idle_id > 0 || next_static_init > 0)
+    return;
+
+  static_init_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                         run_next_static_init_cb,
+                                         NULL,
+                                         NULL);
+}
+
+/**
+ * cc_panel_loader_is_static_init_pending:
+ * @name: the id of a panel
+ *
+ * Returns whether the static init function of the panel @name is yet to
+ * run. Until then, its visibility in the model may not be accurate.
+ *
+ * Returns: %TRUE if @name has a static init function that didn't run yet
+ */
+gboolean
+cc_panel_loader_is_static_init_pending (const gchar *name)
+{
+  guint i;
+
+  for (i = next_static_init; i < panels_vtable_len; i++)
+    {
+      if (g_strcmp0 (panels_vtable[i].name, name) == 0)
+        return panels_vtable[i].static_init_func != NULL;
+    }
+
+  return FALSE;
+}
+
+#endif /* CC_PANEL_LOADER_NO_GTYPES */
+
+/**
+ * cc_panel_loader_get_fill_timings:
+ * @out_from_cache: (out) (optional): whether the model was filled from the panel cache
+ * @out_fill_time: (out) (optional): the time it took to fill the model, in microseconds
+ * @out_cold_fill_time: (out) (optional): the time it takes to fill the model from the
+ *   desktop files, in microseconds
+ *
+ * Retrieves how long the last call to cc_panel_loader_fill_model() took.
+ */
+void
+cc_panel_loader_get_fill_timings (gboolean *out_from_cache,
+                                  gint64   *out_fill_time,
+                                  gint64   *out_cold_fill_time)
+{
+  if (out_from_cache)
+    *out_from_cache = fill_from_cache;
+  if (out_fill_time)
+    *out_fill_time = fill_time;
+  if (out_cold_fill_time)
+    *out_cold_fill_time = cold_fill_time;
 }
 
 /**
@@ -40,7 +40,12 @@ typedef struct
 } CcPanelLoaderVtable;
 
 void     cc_panel_loader_fill_model     (CcShellModel  *model);
+void     cc_panel_loader_schedule_static_init (void);
+gboolean cc_panel_loader_is_static_init_pending (const gchar *name);
 void     cc_panel_loader_list_panels    (void);
+void     cc_panel_loader_get_fill_timings (gboolean *out_from_cache,
+                                           gint64   *out_fill_time,
+                                           gint64   *out_cold_fill_time);
 CcPanel *cc_panel_loader_load_by_name   (CcShell       *shell,
                                          const char    *name,
                                          const gchar   *title,
@@ -33,6 +33,7 @@
 #include "config.h"
 
 #include "cc-panel.h"
+#include "cc-trace.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -48,6 +49,12 @@ typedef struct
   AdwNavigationView *navigation;
 
   GHashTable *subpages;
+
+  gboolean suspended;
+
+  /* When the panel started being constructed, for tracing */
+  gint64 trace_init_time;
+  gint64 trace_snapshot_time;
 } CcPanelPrivate;
 
 static GtkBuildableIface *parent_buildable_iface;
@@ -208,6 +215,32 @@ cc_panel_get_property (GObject    *object,
     }
 }
 
+static void
+cc_panel_constructed (GObject *object)
+{
+  CcPanelPrivate *priv = cc_panel_get_instance_private (CC_PANEL (object));
+
+  G_OBJECT_CLASS (cc_panel_parent_class)->constructed (object);
+
+  /* By now, the templates of the panel and its parent classes are built */
+  cc_trace_end (priv->trace_init_time, "panel", "init %s", G_OBJECT_TYPE_NAME (object));
+}
+
+static void
+cc_panel_snapshot (GtkWidget   *widget,
+                   GtkSnapshot *snapshot)
+{
+  CcPanelPrivate *priv = cc_panel_get_instance_private (CC_PANEL (widget));
+
+  if (priv->trace_snapshot_time != 0)
+    {
+      cc_trace_end (priv->trace_snapshot_time, "panel", "first snapshot %s", G_OBJECT_TYPE_NAME (widget));
+      priv->trace_snapshot_time = 0;
+    }
+
+  GTK_WIDGET_CLASS (cc_panel_parent_class)->snapshot (widget, snapshot);
+}
+
 static void
 cc_panel_finalize (GObject *object)
 {
@@ -228,8 +261,11 @@ cc_panel_class_init (CcPanelClass *klass)
 
   object_class->get_property = cc_panel_get_property;
   object_class->set_property = cc_panel_set_property;
+  object_class->constructed = cc_panel_constructed;
   object_class->finalize = cc_panel_finalize;
 
+  widget_class->snapshot = cc_panel_snapshot;
+
   properties[PROP_SHELL] = g_param_spec_object ("shell",
                                                 "Shell",
                                                 "Shell the Panel resides in",
@@ -258,6 +294,9 @@ cc_panel_init (CcPanel *panel)
 {
   CcPanelPrivate *priv = cc_panel_get_instance_private (panel);
 
+  priv->trace_init_time = cc_trace_begin ();
+  priv->trace_snapshot_time = priv->trace_init_time;
+
   gtk_widget_init_template (GTK_WIDGET (panel));
 
   priv->subpages = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
@@ -315,6 +354,91 @@ cc_panel_deactivate (CcPanel *panel)
   g_cancellable_cancel (priv->cancellable);
 }
 
+/**
+ * cc_panel_suspend:
+ * @panel: A #CcPanel
+ *
+ * Called by the shell when @panel is hidden but kept around to be shown
+ * again later. Panels can implement the #CcPanelClass.suspend vfunc to
+ * stop processing D-Bus signals, polling devices or monitoring streams
+ * while they are not visible.
+ */
+void
+cc_panel_suspend (CcPanel *panel)
+{
+  CcPanelPrivate *priv = cc_panel_get_instance_private (panel);
+  CcPanelClass *class;
+
+  g_return_if_fail (CC_IS_PANEL (panel));
+
+  if (priv->suspended)
+    return;
+
+  priv->suspended = TRUE;
+
+  class = CC_PANEL_GET_CLASS (panel);
+  if (class->suspend)
+    class->suspend (panel);
+}
+
+/**
+ * cc_panel_resume:
+ * @panel: A #CcPanel
+ *
+ * Called by the shell when a panel suspended with cc_panel_suspend() is
+ * shown again. Panels implementing the #CcPanelClass.resume vfunc must
+ * bring their state up to date, since they may have missed changes.
+ */
+void
+cc_panel_resume (CcPanel *panel)
+{
+  CcPanelPrivate *priv = cc_panel_get_instance_private (panel);
+  CcPanelClass *class;
+
+  g_return_if_fail (CC_IS_PANEL (panel));
+
+  if (!priv->suspended)
+    return;
+
+  priv->suspended = FALSE;
+
+  class = CC_PANEL_GET_CLASS (panel);
+  if (class->resume)
+    class->resume (panel);
+}
+
+/**
+ * cc_panel_can_suspend:
+ * @panel: A #CcPanel
+ *
+ * Whether @panel implements the #CcPanelClass.suspend and
+ * #CcPanelClass.resume vfuncs. Other panels keep running while hidden,
+ * so the shell deactivates them instead of keeping them around.
+ *
+ * Returns: %TRUE if @panel can be suspended
+ */
+gboolean
+cc_panel_can_suspend (CcPanel *panel)
+{
+  CcPanelClass *class;
+
+  g_return_val_if_fail (CC_IS_PANEL (panel), FALSE);
+
+  class = CC_PANEL_GET_CLASS (panel);
+
+  return class->suspend != NULL && class->resume != NULL;
+}
+
+gboolean
+cc_panel_is_suspended (CcPanel *panel)
+{
+  CcPanelPrivate *priv = cc_panel_get_instance_private (panel);
+
+  g_return_val_if_fail (CC_IS_PANEL (panel), FALSE);
+
+  return priv->suspended;
+}
+
 void
 cc_panel_add_subpage (CcPanel     *panel,
                       const gchar *page_tag,
@@ -78,6 +78,9 @@ struct _CcPanelClass
   AdwNavigationPageClass parent_class;
 
   const gchar* (*get_help_uri)       (CcPanel *panel);
+
+  void         (*suspend)            (CcPanel *panel);
+  void         (*resume)             (CcPanel *panel);
 };
 
 CcShell*      cc_panel_get_shell          (CcPanel     *panel);
@@ -90,6 +93,14 @@ GCancellable *cc_panel_get_cancellable    (CcPanel     *panel);
 
 void          cc_panel_deactivate         (CcPanel     *panel);
 
+void          cc_panel_suspend            (CcPanel     *panel);
+
+void          cc_panel_resume             (CcPanel     *panel);
+
+gboolean      cc_panel_can_suspend        (CcPanel     *panel);
+
+gboolean      cc_panel_is_suspended       (CcPanel     *panel);
+
 void          cc_panel_add_subpage        (CcPanel     *panel,
                                            const gchar *page_tag,
                                            AdwNavigationPage *subpage);
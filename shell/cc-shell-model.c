@@ -26,11 +26,44 @@
 
 #include <gio/gdesktopappinfo.h>
 
+/* Search index
+ *
+ * Every panel added to the model gets an IndexEntry holding the casefolded
+ * strings that searches match against, so queries never have to copy them
+ * out of the GtkListStore. On top of that, a trigram index maps every 3-byte
+ * sequence found in those strings to the (sorted) list of entries containing
+ * it; a term is then only checked against the entries that contain all of
+ * its trigrams.
+ */
+typedef struct
+{
+  gchar       *id;
+  gchar       *casefolded_name;
+  gchar       *casefolded_description;
+  GStrv        casefolded_description_words;
+  GStrv        keywords;
+  GtkTreeIter  iter;
+} IndexEntry;
+
+typedef struct
+{
+  IndexEntry *entry;
+  guint32     name_matches;
+  guint       keyword_matches;
+  guint       description_matches;
+} ScoredEntry;
+
+#define TRIGRAM(s) (((guint32) (guchar) (s)[0] << 16) | ((guint32) (guchar) (s)[1] << 8) | (guint32) (guchar) (s)[2])
+
 struct _CcShellModel
 {
   GtkListStore parent;
 
   GStrv        sort_terms;
+
+  GPtrArray   *entries;       /* IndexEntry, in insertion order */
+  GHashTable  *id_to_entry;   /* id -> IndexEntry */
+  GHashTable  *trigrams;      /* trigram -> GArray of entry indexes */
 };
 
 G_DEFINE_TYPE (CcShellModel, cc_shell_model, GTK_TYPE_LIST_STORE)
@@ -193,12 +226,267 @@ cc_shell_model_sort_func (GtkTreeModel *model,
     return sort_with_terms (model, a, b, self->sort_terms);
 }
 
+static void
+index_entry_free (IndexEntry *entry)
+{
+  g_free (entry->id);
+  g_free (entry->casefolded_name);
+  g_free (entry->casefolded_description);
+  g_strfreev (entry->casefolded_description_words);
+  g_strfreev (entry->keywords);
+  g_free (entry);
+}
+
+static void
+index_add_trigrams (CcShellModel *self,
+                    const gchar  *str,
+                    guint         entry_index)
+{
+  gsize len, i;
+
+  if (!str)
+    return;
+
+  len = strlen (str);
+
+  for (i = 0; i + 3 <= len; i++)
+    {
+      gpointer key = GUINT_TO_POINTER (TRIGRAM (str + i));
+      GArray *postings;
+
+      postings = g_hash_table_lookup (self->trigrams, key);
+      if (!postings)
+        {
+          postings = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_hash_table_insert (self->trigrams, key, postings);
+        }
+
+      /* Entries are indexed in increasing order, so this keeps the
+       * posting lists sorted and free of duplicates.
+       */
+      if (postings->len == 0 || g_array_index (postings, guint, postings->len - 1) != entry_index)
+        g_array_append_val (postings, entry_index);
+    }
+}
+
+static void
+index_add_entry (CcShellModel *self,
+                 IndexEntry   *entry)
+{
+  guint entry_index;
+  gint i;
+
+  entry_index = self->entries->len;
+  g_ptr_array_add (self->entries, entry);
+  g_hash_table_insert (self->id_to_entry, entry->id, entry);
+
+  index_add_trigrams (self, entry->casefolded_name, entry_index);
+  index_add_trigrams (self, entry->casefolded_description, entry_index);
+
+  for (i = 0; entry->keywords[i]; i++)
+    index_add_trigrams (self, entry->keywords[i], entry_index);
+}
+
+static gboolean
+index_entry_matches_term (IndexEntry  *entry,
+                          const gchar *term)
+{
+  gint i;
+
+  if (strstr (entry->casefolded_name, term) != NULL)
+    return TRUE;
+
+  if (entry->casefolded_description && strstr (entry->casefolded_description, term) != NULL)
+    return TRUE;
+
+  for (i = 0; entry->keywords[i]; i++)
+    {
+      if (g_str_has_prefix (entry->keywords[i], term))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Narrows down @candidates (or all entries, when %NULL) to the entries
+ * containing every trigram of @term. Returns %NULL if @term is too short
+ * to be looked up in the index.
+ */
+static GArray *
+index_lookup_term (CcShellModel *self,
+                   const gchar  *term,
+                   GArray       *candidates)
+{
+  GArray *result = candidates;
+  gsize len, i;
+
+  len = strlen (term);
+  if (len < 3)
+    return candidates;
+
+  for (i = 0; i + 3 <= len; i++)
+    {
+      GArray *postings;
+      GArray *intersection;
+      guint a, b;
+
+      postings = g_hash_table_lookup (self->trigrams, GUINT_TO_POINTER (TRIGRAM (term + i)));
+
+      intersection = g_array_new (FALSE, FALSE, sizeof (guint));
+
+      if (postings && !result)
+        {
+          g_array_append_vals (intersection, postings->data, postings->len);
+        }
+      else if (postings)
+        {
+          a = b = 0;
+          while (a < result->len && b < postings->len)
+            {
+              guint x = g_array_index (result, guint, a);
+              guint y = g_array_index (postings, guint, b);
+
+              if (x == y)
+                {
+                  g_array_append_val (intersection, x);
+                  a++;
+                  b++;
+                }
+              else if (x < y)
+                {
+                  a++;
+                }
+              else
+                {
+                  b++;
+                }
+            }
+        }
+
+      if (result)
+        g_array_unref (result);
+      result = intersection;
+
+      if (result->len == 0)
+        break;
+    }
+
+  return result;
+}
+
+static void
+score_entry (ScoredEntry  *scored,
+             IndexEntry   *entry,
+             gchar       **terms)
+{
+  guint n_terms, i;
+
+  scored->entry = entry;
+  scored->name_matches = 0;
+  scored->keyword_matches = count_matches (entry->keywords, terms);
+  scored->description_matches = count_matches (entry->casefolded_description_words, terms);
+
+  /* Name matches are compared term by term, with the first terms being
+   * the most relevant ones, just like sort_by_name_with_terms() does.
+   */
+  n_terms = MIN (g_strv_length (terms), 32);
+  for (i = 0; i < n_terms; i++)
+    {
+      if (strstr (entry->casefolded_name, terms[i]) != NULL)
+        scored->name_matches |= 1u << (31 - i);
+    }
+}
+
+static gint
+compare_scored_entries (gconstpointer a,
+                        gconstpointer b)
+{
+  const ScoredEntry *sa = a;
+  const ScoredEntry *sb = b;
+  gboolean a_has_description, b_has_description;
+
+  if (sa->name_matches != sb->name_matches)
+    return sa->name_matches > sb->name_matches ? -1 : 1;
+
+  if (sa->keyword_matches != sb->keyword_matches)
+    return sa->keyword_matches > sb->keyword_matches ? -1 : 1;
+
+  a_has_description = sa->entry->casefolded_description != NULL;
+  b_has_description = sb->entry->casefolded_description != NULL;
+  if (a_has_description != b_has_description)
+    return a_has_description ? -1 : 1;
+
+  if (sa->description_matches != sb->description_matches)
+    return sa->description_matches > sb->description_matches ? -1 : 1;
+
+  return g_strcmp0 (sa->entry->casefolded_name, sb->entry->casefolded_name);
+}
+
+/* Returns the non-empty terms of @terms, as a %NULL-terminated array */
+static GPtrArray *
+get_valid_terms (gchar **terms)
+{
+  GPtrArray *valid_terms;
+  guint i;
+
+  valid_terms = g_ptr_array_new ();
+  for (i = 0; terms && terms[i]; i++)
+    {
+      if (terms[i][0] != '\0')
+        g_ptr_array_add (valid_terms, terms[i]);
+    }
+  g_ptr_array_add (valid_terms, NULL);
+
+  return valid_terms;
+}
+
+/* Checks every entry of @candidates against all of @valid_terms, and
+ * returns the ids of the matching ones, sorted by relevance.
+ */
+static GPtrArray *
+search_entries (GPtrArray *candidates,
+                GPtrArray *valid_terms)
+{
+  g_autoptr(GArray) scored = NULL;
+  GPtrArray *results;
+  guint i, j;
+
+  scored = g_array_sized_new (FALSE, FALSE, sizeof (ScoredEntry), candidates->len);
+
+  for (i = 0; i < candidates->len; i++)
+    {
+      ScoredEntry scored_entry;
+      IndexEntry *entry = g_ptr_array_index (candidates, i);
+      gboolean matches = TRUE;
+
+      for (j = 0; matches && g_ptr_array_index (valid_terms, j) != NULL; j++)
+        matches = index_entry_matches_term (entry, g_ptr_array_index (valid_terms, j));
+
+      if (!matches)
+        continue;
+
+      score_entry (&scored_entry, entry, (gchar **) valid_terms->pdata);
+      g_array_append_val (scored, scored_entry);
+    }
+
+  g_array_sort (scored, compare_scored_entries);
+
+  results = g_ptr_array_sized_new (scored->len);
+  for (i = 0; i < scored->len; i++)
+    g_ptr_array_add (results, g_array_index (scored, ScoredEntry, i).entry->id);
+
+  return results;
+}
+
 static void
 cc_shell_model_finalize (GObject *object)
 {
   CcShellModel *self = CC_SHELL_MODEL (object);
 
   g_clear_pointer (&self->sort_terms, g_strfreev);
+  g_clear_pointer (&self->trigrams, g_hash_table_destroy);
+  g_clear_pointer (&self->id_to_entry, g_hash_table_destroy);
+  g_clear_pointer (&self->entries, g_ptr_array_unref);
 
   G_OBJECT_CLASS (cc_shell_model_parent_class)->finalize (object);
 }
@@ -220,6 +508,11 @@ cc_shell_model_init (CcShellModel *self)
   gtk_list_store_set_column_types (GTK_LIST_STORE (self),
                                    N_COLS, types);
 
+  self->entries = g_ptr_array_new_with_free_func ((GDestroyNotify) index_entry_free);
+  self->id_to_entry = g_hash_table_new (g_str_hash, g_str_equal);
+  self->trigrams = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          NULL, (GDestroyNotify) g_array_unref);
+
   gtk_tree_sortable_set_default_sort_func (GTK_TREE_SORTABLE (self),
                                            cc_shell_model_sort_func,
                                            self, NULL);
@@ -270,6 +563,46 @@ symbolicize_g_icon (GIcon *gicon)
   return g_themed_icon_new_with_default_fallbacks (new_name);
 }
 
+static void
+add_item (CcShellModel     *model,
+          CcPanelCategory   category,
+          GAppInfo         *appinfo,
+          const char       *id,
+          const char       *name,
+          gchar            *casefolded_name,
+          const char       *description,
+          gchar            *casefolded_description,
+          GStrv             keywords,
+          GIcon            *icon)
+{
+  IndexEntry *entry;
+
+  /* Takes ownership of the casefolded strings and keywords */
+  entry = g_new0 (IndexEntry, 1);
+  entry->id = g_strdup (id);
+  entry->casefolded_name = casefolded_name;
+  entry->casefolded_description = casefolded_description;
+  entry->keywords = keywords;
+
+  if (entry->casefolded_description)
+    entry->casefolded_description_words = g_strsplit (entry->casefolded_description, " ", -1);
+
+  gtk_list_store_insert_with_values (GTK_LIST_STORE (model), &entry->iter, 0,
+                                     COL_NAME, name,
+                                     COL_CASEFOLDED_NAME, entry->casefolded_name,
+                                     COL_APP, appinfo,
+                                     COL_ID, id,
+                                     COL_CATEGORY, category,
+                                     COL_DESCRIPTION, description,
+                                     COL_CASEFOLDED_DESCRIPTION, entry->casefolded_description,
+                                     COL_GICON, icon,
+                                     COL_KEYWORDS, entry->keywords,
+                                     COL_VISIBILITY, CC_PANEL_VISIBLE,
+                                     -1);
+
+  index_add_entry (model, entry);
+}
+
 void
 cc_shell_model_add_item (CcShellModel    *model,
                          CcPanelCategory  category,
@@ -279,83 +612,191 @@ cc_shell_model_add_item (CcShellModel    *model,
   g_autoptr(GIcon) icon = NULL;
   const gchar *name = g_app_info_get_name (appinfo);
   const gchar *comment = g_app_info_get_description (appinfo);
-  g_auto(GStrv) keywords = NULL;
-  g_autofree gchar *casefolded_name = NULL;
-  g_autofree gchar *casefolded_description = NULL;
 
-  casefolded_name = cc_util_normalize_casefold_and_unaccent (name);
-  casefolded_description = cc_util_normalize_casefold_and_unaccent (comment);
-  keywords = get_casefolded_keywords (appinfo);
   icon = symbolicize_g_icon (g_app_info_get_icon (appinfo));
 
-  gtk_list_store_insert_with_values (GTK_LIST_STORE (model), NULL, 0,
-                                     COL_NAME, name,
-                                     COL_CASEFOLDED_NAME, casefolded_name,
-                                     COL_APP, appinfo,
-                                     COL_ID, id,
-                                     COL_CATEGORY, category,
-                                     COL_DESCRIPTION, comment,
-                                     COL_CASEFOLDED_DESCRIPTION, casefolded_description,
-                                     COL_GICON, icon,
-                                     COL_KEYWORDS, keywords,
-                                     COL_VISIBILITY, CC_PANEL_VISIBLE,
-                                     -1);
+  add_item (model,
+            category,
+            appinfo,
+            id,
+            name,
+            cc_util_normalize_casefold_and_unaccent (name),
+            comment,
+            cc_util_normalize_casefold_and_unaccent (comment),
+            get_casefolded_keywords (appinfo),
+            icon);
+}
+
+/**
+ * cc_shell_model_add_cached_item:
+ * @model: a #CcShellModel
+ * @category: the category of the panel
+ * @id: the id of the panel
+ * @name: the name of the panel
+ * @casefolded_name: @name, casefolded and unaccented
+ * @description: (nullable): the description of the panel
+ * @casefolded_description: (nullable): @description, casefolded and unaccented
+ * @keywords: the casefolded and unaccented keywords of the panel
+ * @icon: the (already symbolic) icon of the panel
+ *
+ * Adds a panel whose information was previously extracted from its
+ * desktop file by cc_shell_model_add_item(). The %COL_APP column of
+ * panels added this way is %NULL.
+ */
+void
+cc_shell_model_add_cached_item (CcShellModel    *model,
+                                CcPanelCategory  category,
+                                const char      *id,
+                                const char      *name,
+                                const char      *casefolded_name,
+                                const char      *description,
+                                const char      *casefolded_description,
+                                GStrv            keywords,
+                                GIcon           *icon)
+{
+  g_return_if_fail (CC_IS_SHELL_MODEL (model));
+
+  add_item (model,
+            category,
+            NULL,
+            id,
+            name,
+            g_strdup (casefolded_name),
+            description,
+            g_strdup (casefolded_description),
+            g_strdupv (keywords),
+            icon);
 }
 
 gboolean
 cc_shell_model_has_panel (CcShellModel *model,
                           const char   *id)
 {
-  GtkTreeIter iter;
-  gboolean valid;
-
   g_assert (id);
 
-  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter);
-  while (valid)
-    {
-      g_autofree gchar *panel_id = NULL;
+  return g_hash_table_contains (model->id_to_entry, id);
+}
 
-      gtk_tree_model_get (GTK_TREE_MODEL (model), &iter, COL_ID, &panel_id, -1);
-      if (g_str_equal (id, panel_id))
-        return TRUE;
+/**
+ * cc_shell_model_get_iter_for_id:
+ * @model: a #CcShellModel
+ * @id: the id of a panel
+ * @out_iter: (out): return location for the iter of the panel
+ *
+ * Looks up the row of the panel with @id without walking the model.
+ * This is only possible because the model is a #GtkListStore, which
+ * guarantees that iters are persistent while the row exists.
+ *
+ * Returns: %TRUE if the panel was found and @out_iter was set.
+ */
+gboolean
+cc_shell_model_get_iter_for_id (CcShellModel *model,
+                                const char   *id,
+                                GtkTreeIter  *out_iter)
+{
+  IndexEntry *entry;
 
-      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (model), &iter);
-    }
+  g_return_val_if_fail (CC_IS_SHELL_MODEL (model), FALSE);
+  g_return_val_if_fail (id != NULL, FALSE);
+  g_return_val_if_fail (out_iter != NULL, FALSE);
 
-  return FALSE;
+  entry = g_hash_table_lookup (model->id_to_entry, id);
+  if (!entry)
+    return FALSE;
+
+  *out_iter = entry->iter;
+  return TRUE;
 }
 
-gboolean
-cc_shell_model_iter_matches_search (CcShellModel *model,
-                                    GtkTreeIter  *iter,
-                                    const char   *term)
+/**
+ * cc_shell_model_search:
+ * @model: a #CcShellModel
+ * @terms: casefolded and unaccented search terms
+ *
+ * Finds the panels matching all of @terms, using the search index built
+ * when the panels were added. A term matches a panel if it is a substring
+ * of its name or description, or a prefix of one of its keywords. Empty
+ * terms are ignored.
+ *
+ * The results are sorted by relevance, the same way the model itself is
+ * sorted by cc_shell_model_set_sort_terms().
+ *
+ * Returns: (transfer container) (element-type utf8): the ids of the
+ * matching panels. The ids are owned by @model.
+ */
+GPtrArray *
+cc_shell_model_search (CcShellModel  *model,
+                       gchar        **terms)
 {
-  g_autofree gchar *name = NULL;
-  g_autofree gchar *description = NULL;
-  gboolean result;
-  g_auto(GStrv) keywords = NULL;
+  g_autoptr(GPtrArray) candidates = NULL;
+  g_autoptr(GArray) indexes = NULL;
+  g_autoptr(GPtrArray) valid_terms = NULL;
+  guint i;
+
+  g_return_val_if_fail (CC_IS_SHELL_MODEL (model), NULL);
+
+  valid_terms = get_valid_terms (terms);
+
+  for (i = 0; g_ptr_array_index (valid_terms, i) != NULL; i++)
+    {
+      indexes = index_lookup_term (model, g_ptr_array_index (valid_terms, i), g_steal_pointer (&indexes));
+      if (indexes && indexes->len == 0)
+        break;
+    }
+
+  if (!indexes)
+    return search_entries (model->entries, valid_terms);
+
+  candidates = g_ptr_array_sized_new (indexes->len);
+  for (i = 0; i < indexes->len; i++)
+    g_ptr_array_add (candidates, g_ptr_array_index (model->entries, g_array_index (indexes, guint, i)));
+
+  return search_entries (candidates, valid_terms);
+}
 
-  gtk_tree_model_get (GTK_TREE_MODEL (model), iter,
-                      COL_CASEFOLDED_NAME, &name,
-                      COL_CASEFOLDED_DESCRIPTION, &description,
-                      COL_KEYWORDS, &keywords,
-                      -1);
+/**
+ * cc_shell_model_search_subset:
+ * @model: a #CcShellModel
+ * @terms: casefolded and unaccented search terms
+ * @ids: the ids of the panels to search in
+ *
+ * Like cc_shell_model_search(), but only looks at the panels in @ids,
+ * which usually are the results of a previous, broader search. This
+ * makes narrowing down a search cost O(ids) instead of O(model). Ids
+ * that are not in @model are ignored.
+ *
+ * When @ids is a superset of the results of cc_shell_model_search()
+ * for @terms, both functions return the same results, in the same
+ * order.
+ *
+ * Returns: (transfer container) (element-type utf8): the ids of the
+ * matching panels. The ids are owned by @model.
+ */
+GPtrArray *
+cc_shell_model_search_subset (CcShellModel        *model,
+                              gchar              **terms,
+                              const gchar * const *ids)
+{
+  g_autoptr(GPtrArray) candidates = NULL;
+  g_autoptr(GPtrArray) valid_terms = NULL;
+  g_autoptr(GHashTable) seen = NULL;
+  guint i;
 
-  result = (strstr (name, term) != NULL);
+  g_return_val_if_fail (CC_IS_SHELL_MODEL (model), NULL);
 
-  if (!result && description)
-    result = (strstr (description, term) != NULL);
+  valid_terms = get_valid_terms (terms);
+  candidates = g_ptr_array_new ();
+  seen = g_hash_table_new (NULL, NULL);
 
-  if (!result && keywords)
+  for (i = 0; ids && ids[i]; i++)
     {
-      gint i;
+      IndexEntry *entry = g_hash_table_lookup (model->id_to_entry, ids[i]);
 
-      for (i = 0; !result && keywords[i]; i++)
-        result = (strstr (keywords[i], term) == keywords[i]);
+      if (entry && g_hash_table_add (seen, entry))
+        g_ptr_array_add (candidates, entry);
     }
 
-  return result;
+  return search_entries (candidates, valid_terms);
 }
 
 void
@@ -379,36 +820,15 @@ cc_shell_model_set_panel_visibility (CcShellModel      *self,
                                      const gchar       *id,
                                      CcPanelVisibility  visibility)
 {
-  GtkTreeModel *model;
   GtkTreeIter iter;
   gboolean valid;
 
   g_return_if_fail (CC_IS_SHELL_MODEL (self));
 
-  model = GTK_TREE_MODEL (self);
-
-  /* Find the iter for the panel with the given id */
-  valid = gtk_tree_model_get_iter_first (model, &iter);
-
-  while (valid)
-    {
-      g_autofree gchar *item_id = NULL;
-
-      gtk_tree_model_get (model, &iter, COL_ID, &item_id, -1);
-
-      /* Found the iter */
-      if (g_str_equal (id, item_id))
-        break;
-
-      /* If not found, continue */
-      valid = gtk_tree_model_iter_next (model, &iter);
-    }
-
-  /* If we don't find any panel with the given id, we'll iterate until
-   * valid == FALSE, so we can use this variable to determine if the
-   * panel was found or not. It is a programming error to try to set
-   * the visibility of a non-existent panel.
+  /* It is a programming error to try to set the visibility of a
+   * non-existent panel.
    */
+  valid = cc_shell_model_get_iter_for_id (self, id, &iter);
   g_assert (valid);
 
   gtk_list_store_set (GTK_LIST_STORE (self), &iter, COL_VISIBILITY, visibility, -1);
@@ -67,12 +67,29 @@ void          cc_shell_model_add_item            (CcShellModel       *model,
                                                   GAppInfo           *appinfo,
                                                   const char         *id);
 
+void          cc_shell_model_add_cached_item     (CcShellModel       *model,
+                                                  CcPanelCategory     category,
+                                                  const char         *id,
+                                                  const char         *name,
+                                                  const char         *casefolded_name,
+                                                  const char         *description,
+                                                  const char         *casefolded_description,
+                                                  GStrv               keywords,
+                                                  GIcon              *icon);
+
 gboolean      cc_shell_model_has_panel           (CcShellModel       *model,
                                                   const char         *id);
 
-gboolean      cc_shell_model_iter_matches_search (CcShellModel       *model,
-                                                  GtkTreeIter        *iter,
-                                                  const char         *term);
+gboolean      cc_shell_model_get_iter_for_id     (CcShellModel       *model,
+                                                  const char         *id,
+                                                  GtkTreeIter        *out_iter);
+
+GPtrArray*    cc_shell_model_search              (CcShellModel       *model,
+                                                  GStrv               terms);
+
+GPtrArray*    cc_shell_model_search_subset       (CcShellModel        *model,
+                                                  GStrv                terms,
+                                                  const gchar * const *ids);
 
 void          cc_shell_model_set_sort_terms       (CcShellModel      *model,
                                                    GStrv              terms);
@@ -0,0 +1,310 @@
+/* cc-trace.c
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define G_LOG_DOMAIN "cc-trace"
+
+#include <config.h>
+
+#include <string.h>
+#include <unistd.h>
+
+#include "cc-trace.h"
+
+/*
+ * Lightweight tracing of where time goes in Settings.
+ *
+ * When the CC_TRACE environment variable is set to a file name, spans,
+ * marks and counters are collected in memory and written to that file
+ * in the Chrome trace event format on cc_trace_shutdown(). The result
+ * can be loaded in chrome://tracing, Perfetto or Speedscope.
+ *
+ * Settings and its search provider both read CC_TRACE, so the program
+ * name and process ID are added to the file name before its extension,
+ * e.g. trace-gnome-control-center-1234.json for CC_TRACE=trace.json.
+ *
+ * When CC_TRACE is not set, every call returns right away.
+ */
+
+static gchar *trace_filename = NULL;
+static GString *trace_events = NULL;
+static gint64 trace_start_time = 0;
+static GMutex trace_mutex;
+
+static gint next_thread_id = 1;
+static GPrivate thread_id_key;
+
+static gboolean
+ensure_initialized (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      const gchar *filename = g_getenv ("CC_TRACE");
+
+      if (filename && *filename)
+        {
+          trace_filename = g_strdup (filename);
+          trace_events = g_string_new (NULL);
+          trace_start_time = g_get_monotonic_time ();
+        }
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return trace_filename != NULL;
+}
+
+static gint
+get_thread_id (void)
+{
+  gint id = GPOINTER_TO_INT (g_private_get (&thread_id_key));
+
+  if (id == 0)
+    {
+      id = g_atomic_int_add (&next_thread_id, 1);
+      g_private_set (&thread_id_key, GINT_TO_POINTER (id));
+    }
+
+  return id;
+}
+
+static void
+append_json_string (GString     *str,
+                    const gchar *value)
+{
+  const gchar *p;
+
+  g_string_append_c (str, '"');
+
+  for (p = value; *p; p++)
+    {
+      switch (*p)
+        {
+        case '"':
+          g_string_append (str, "\\\"");
+          break;
+
+        case '\\':
+          g_string_append (str, "\\\\");
+          break;
+
+        default:
+          if ((guchar) *p < 0x20)
+            g_string_append_printf (str, "\\u%04x", (guchar) *p);
+          else
+            g_string_append_c (str, *p);
+        }
+    }
+
+  g_string_append_c (str, '"');
+}
+
+/* Appends the common part of an event; the caller must hold the mutex,
+ * and close the object.
+ */
+static void
+append_event (const gchar *phase,
+              const gchar *category,
+              const gchar *name,
+              gint64       timestamp)
+{
+  if (trace_events->len > 0)
+    g_string_append (trace_events, ",\n");
+
+  g_string_append (trace_events, "{\"name\":");
+  append_json_string (trace_events, name);
+  g_string_append (trace_events, ",\"cat\":");
+  append_json_string (trace_events, category);
+  g_string_append_printf (trace_events,
+                          ",\"ph\":\"%s\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":%d,\"tid\":%d",
+                          phase,
+                          timestamp - trace_start_time,
+                          (gint) getpid (),
+                          get_thread_id ());
+}
+
+/**
+ * cc_trace_is_enabled:
+ *
+ * Returns: whether tracing was enabled with the CC_TRACE environment variable.
+ */
+gboolean
+cc_trace_is_enabled (void)
+{
+  return ensure_initialized ();
+}
+
+/**
+ * cc_trace_begin:
+ *
+ * Starts a span, to be finished with cc_trace_end().
+ *
+ * Returns: the start time of the span, or 0 if tracing is disabled.
+ */
+gint64
+cc_trace_begin (void)
+{
+  if (!ensure_initialized ())
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+/**
+ * cc_trace_end:
+ * @begin_time: the value returned by cc_trace_begin()
+ * @category: the category of the span, e.g. "panel"
+ * @name_format: printf-style format for the name of the span
+ *
+ * Finishes a span started with cc_trace_begin(), and records it.
+ */
+void
+cc_trace_end (gint64       begin_time,
+              const gchar *category,
+              const gchar *name_format,
+              ...)
+{
+  g_autofree gchar *name = NULL;
+  gint64 end_time;
+  va_list args;
+
+  if (begin_time == 0 || !ensure_initialized ())
+    return;
+
+  end_time = g_get_monotonic_time ();
+
+  va_start (args, name_format);
+  name = g_strdup_vprintf (name_format, args);
+  va_end (args);
+
+  g_mutex_lock (&trace_mutex);
+  append_event ("X", category, name, begin_time);
+  g_string_append_printf (trace_events, ",\"dur\":%" G_GINT64_FORMAT "}", end_time - begin_time);
+  g_mutex_unlock (&trace_mutex);
+}
+
+/**
+ * cc_trace_mark:
+ * @category: the category of the mark
+ * @name_format: printf-style format for the name of the mark
+ *
+ * Records an instant event, such as the first frame of a window.
+ */
+void
+cc_trace_mark (const gchar *category,
+               const gchar *name_format,
+               ...)
+{
+  g_autofree gchar *name = NULL;
+  gint64 time;
+  va_list args;
+
+  if (!ensure_initialized ())
+    return;
+
+  time = g_get_monotonic_time ();
+
+  va_start (args, name_format);
+  name = g_strdup_vprintf (name_format, args);
+  va_end (args);
+
+  g_mutex_lock (&trace_mutex);
+  append_event ("i", category, name, time);
+  g_string_append (trace_events, ",\"s\":\"p\"}");
+  g_mutex_unlock (&trace_mutex);
+}
+
+/**
+ * cc_trace_counter:
+ * @name: the name of the counter
+ * @key: the name of the series within the counter
+ * @value: the current value
+ *
+ * Records the current value of a counter.
+ */
+void
+cc_trace_counter (const gchar *name,
+                  const gchar *key,
+                  gdouble      value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  if (!ensure_initialized ())
+    return;
+
+  g_mutex_lock (&trace_mutex);
+  append_event ("C", "counter", name, g_get_monotonic_time ());
+  g_string_append (trace_events, ",\"args\":{");
+  append_json_string (trace_events, key);
+  g_string_append_printf (trace_events, ":%s}}", g_ascii_dtostr (buf, sizeof (buf), value));
+  g_mutex_unlock (&trace_mutex);
+}
+
+/* The program name is only known once the arguments are parsed */
+static gchar *
+get_process_filename (void)
+{
+  g_autofree gchar *basename = g_path_get_basename (trace_filename);
+  const gchar *prgname = g_get_prgname ();
+  const gchar *extension;
+  gsize prefix_len;
+
+  extension = strrchr (basename, '.');
+  if (extension == NULL || extension == basename)
+    extension = "";
+
+  prefix_len = strlen (trace_filename) - strlen (extension);
+
+  return g_strdup_printf ("%.*s-%s-%d%s",
+                          (gint) prefix_len,
+                          trace_filename,
+                          prgname ? prgname : "unknown",
+                          (gint) getpid (),
+                          extension);
+}
+
+/**
+ * cc_trace_shutdown:
+ *
+ * Writes the collected events to the file set in CC_TRACE, with the
+ * name and ID of the process added to its name.
+ */
+void
+cc_trace_shutdown (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GString) contents = NULL;
+  g_autofree gchar *filename = NULL;
+
+  if (!ensure_initialized ())
+    return;
+
+  g_mutex_lock (&trace_mutex);
+  contents = g_string_new ("{\"traceEvents\":[\n");
+  g_string_append_len (contents, trace_events->str, trace_events->len);
+  g_string_append (contents, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  g_mutex_unlock (&trace_mutex);
+
+  filename = get_process_filename ();
+
+  if (!g_file_set_contents (filename, contents->str, contents->len, &error))
+    g_warning ("Could not write trace to '%s': %s", filename, error->message);
+  else
+    g_message ("Trace written to '%s'", filename);
+}
@@ -0,0 +1,44 @@
+/* cc-trace.h
+ *
+ * Copyright 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gboolean cc_trace_is_enabled (void);
+
+gint64   cc_trace_begin      (void);
+
+void     cc_trace_end        (gint64       begin_time,
+                              const gchar *category,
+                              const gchar *name_format,
+                              ...) G_GNUC_PRINTF (3, 4);
+
+void     cc_trace_mark       (const gchar *category,
+                              const gchar *name_format,
+                              ...) G_GNUC_PRINTF (2, 3);
+
+void     cc_trace_counter    (const gchar *name,
+                              const gchar *key,
+                              gdouble      value);
+
+void     cc_trace_shutdown   (void);
+
+G_END_DECLS
@@ -40,12 +40,29 @@
 #include "cc-shell-model.h"
 #include "cc-panel-list.h"
 #include "cc-panel-loader.h"
+#include "cc-trace.h"
 #include "cc-util.h"
 
 #define MOUSE_BACK_BUTTON 8
 
 #define DEFAULT_WINDOW_ICON_NAME "gnome-control-center"
 
+/* Limits of the cache of recently used panels */
+#define PANEL_CACHE_MAX_PANELS 4
+#define PANEL_CACHE_MAX_SIZE (16 * 1024 * 1024)
+
+/* Rough cost of a widget on top of its instance struct: CSS node,
+ * style, layout and accessibility data.
+ */
+#define PANEL_CACHE_WIDGET_OVERHEAD 2048
+
+typedef struct
+{
+  gchar   *id;
+  CcPanel *panel;
+  gsize    size;
+} CachedPanel;
+
 struct _CcWindow
 {
   AdwApplicationWindow parent;
@@ -61,6 +78,12 @@ struct _CcWindow
   char       *current_panel_id;
   GQueue     *previous_panels;
 
+  /* Recently used panels, most recent first */
+  GQueue     *panel_cache;
+  gsize       panel_cache_size;
+  guint       panel_cache_hits;
+  guint       panel_cache_misses;
+
   GtkWidget  *custom_titlebar;
 
   CcShellModel *store;
@@ -69,6 +92,8 @@ struct _CcWindow
   GSettings *settings;
 
   CcPanelListView previous_list_view;
+
+  gboolean first_snapshot_done;
 };
 
 static void     cc_shell_iface_init         (CcShellInterface      *iface);
@@ -111,6 +136,110 @@ in_flatpak_sandbox (void)
   return g_strcmp0 (PROFILE, "development") == 0;
 }
 
+static void
+cached_panel_free (CachedPanel *cached)
+{
+  cc_panel_deactivate (cached->panel);
+  g_object_unref (cached->panel);
+  g_free (cached->id);
+  g_free (cached);
+}
+
+static gsize
+estimate_widget_size (GtkWidget *widget)
+{
+  GtkWidget *child;
+  GTypeQuery query;
+  gsize size;
+
+  g_type_query (G_OBJECT_TYPE (widget), &query);
+  size = query.instance_size + PANEL_CACHE_WIDGET_OVERHEAD;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      size += estimate_widget_size (child);
+    }
+
+  return size;
+}
+
+static void
+trace_panel_cache (CcWindow *self)
+{
+  guint lookups;
+
+  if (!cc_trace_is_enabled ())
+    return;
+
+  lookups = self->panel_cache_hits + self->panel_cache_misses;
+
+  cc_trace_counter ("panel cache hit rate", "hit rate",
+                    lookups > 0 ? (gdouble) self->panel_cache_hits / lookups : 0.0);
+  cc_trace_counter ("panel cache size", "KiB", self->panel_cache_size / 1024.0);
+  cc_trace_counter ("panel cache panels", "panels", g_queue_get_length (self->panel_cache));
+}
+
+static void
+cache_panel (CcWindow    *self,
+             const gchar *id,
+             CcPanel     *panel)
+{
+  CachedPanel *cached;
+
+  cached = g_new0 (CachedPanel, 1);
+  cached->id = g_strdup (id);
+  cached->panel = g_object_ref (panel);
+  cached->size = estimate_widget_size (GTK_WIDGET (panel));
+
+  cc_panel_suspend (panel);
+
+  g_queue_push_head (self->panel_cache, cached);
+  self->panel_cache_size += cached->size;
+
+  g_debug ("Cached panel '%s' (~%" G_GSIZE_FORMAT " KiB)", id, cached->size / 1024);
+
+  /* Evict the least recently used panels */
+  while (g_queue_get_length (self->panel_cache) > PANEL_CACHE_MAX_PANELS ||
+         self->panel_cache_size > PANEL_CACHE_MAX_SIZE)
+    {
+      cached = g_queue_pop_tail (self->panel_cache);
+      self->panel_cache_size -= cached->size;
+
+      g_debug ("Evicting panel '%s' from the cache", cached->id);
+
+      cached_panel_free (cached);
+    }
+}
+
+static CcPanel *
+take_cached_panel (CcWindow    *self,
+                   const gchar *id)
+{
+  GList *l;
+
+  for (l = self->panel_cache->head; l != NULL; l = l->next)
+    {
+      CachedPanel *cached = l->data;
+      CcPanel *panel;
+
+      if (g_strcmp0 (cached->id, id) != 0)
+        continue;
+
+      g_queue_delete_link (self->panel_cache, l);
+      self->panel_cache_size -= cached->size;
+
+      panel = g_steal_pointer (&cached->panel);
+      g_free (cached->id);
+      g_free (cached);
+
+      return panel;
+    }
+
+  return NULL;
+}
+
 static gboolean
 activate_panel (CcWindow          *self,
                 const gchar       *id,
@@ -119,8 +248,10 @@ activate_panel (CcWindow          *self,
                 GIcon             *gicon,
                 CcPanelVisibility  visibility)
 {
+  g_autoptr(CcPanel) cached_panel = NULL;
   g_autoptr(GTimer) timer = NULL;
   gdouble elapsed_time;
+  gint64 trace_time;
 
   CC_ENTRY;
 
@@ -134,16 +265,37 @@ activate_panel (CcWindow          *self,
 
   /* Begin the profile */
   g_timer_start (timer);
+  trace_time = cc_trace_begin ();
 
   if (self->current_panel)
     g_signal_handlers_disconnect_by_data (self->current_panel, self);
-  self->current_panel = GTK_WIDGET (cc_panel_loader_load_by_name (CC_SHELL (self), id, name, parameters));
+
+  /* Reuse the panel instance if it was recently shown */
+  cached_panel = take_cached_panel (self, id);
+
+  if (cached_panel)
+    {
+      self->panel_cache_hits++;
+
+      cc_panel_resume (cached_panel);
+      if (parameters)
+        g_object_set (cached_panel, "parameters", parameters, NULL);
+
+      self->current_panel = GTK_WIDGET (cached_panel);
+    }
+  else
+    {
+      self->panel_cache_misses++;
+      self->current_panel = GTK_WIDGET (cc_panel_loader_load_by_name (CC_SHELL (self), id, name, parameters));
+    }
+
   cc_shell_set_active_panel (CC_SHELL (self), CC_PANEL (self->current_panel));
 
   adw_navigation_split_view_set_content (self->split_view, ADW_NAVIGATION_PAGE (self->current_panel));
 
   /* Finish profiling */
   g_timer_stop (timer);
+  cc_trace_end (trace_time, "shell", "activate panel %s%s", id, cached_panel ? " (cached)" : "");
 
   elapsed_time = g_timer_elapsed (timer, NULL);
 
@@ -172,30 +324,12 @@ find_iter_for_panel_id (CcWindow    *self,
                         const gchar *panel_id,
                         GtkTreeIter *out_iter)
 {
-  GtkTreeIter iter;
-  gboolean valid;
-
-  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (self->store), &iter);
-
-  while (valid)
-    {
-      g_autofree gchar *id = NULL;
-
-      gtk_tree_model_get (GTK_TREE_MODEL (self->store),
-                          &iter,
-                          COL_ID, &id,
-                          -1);
-
-      if (g_strcmp0 (id, panel_id) == 0)
-        break;
-
-      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (self->store), &iter);
-    }
-
   g_assert (out_iter != NULL);
-  *out_iter = iter;
 
-  return valid;
+  if (!panel_id)
+    return FALSE;
+
+  return cc_shell_model_get_iter_for_id (self->store, panel_id, out_iter);
 }
 
 static void
@@ -228,6 +362,7 @@ setup_model (CcWindow *self)
   model = GTK_TREE_MODEL (self->store);
 
   cc_panel_loader_fill_model (self->store);
+  cc_panel_list_set_model (self->panel_list, self->store);
 
   /* Create a row for each panel */
   valid = gtk_tree_model_get_iter_first (model, &iter);
@@ -311,8 +446,10 @@ set_active_panel_from_id (CcWindow     *self,
       CC_RETURN (TRUE);
     }
 
-  self->old_panel = self->current_panel;
-  if (self->old_panel)
+  /* Keep the old panel alive until it is added to the panel cache,
+   * panels that can't be suspended are deactivated right away */
+  self->old_panel = self->current_panel ? g_object_ref (self->current_panel) : NULL;
+  if (self->old_panel && !cc_panel_can_suspend (CC_PANEL (self->old_panel)))
     cc_panel_deactivate (CC_PANEL (self->old_panel));
 
   gtk_tree_model_get (GTK_TREE_MODEL (self->store),
@@ -351,9 +488,18 @@ set_active_panel_from_id (CcWindow     *self,
   if (!activated)
     {
       g_debug ("Failed to activate panel");
+      g_clear_object (&self->old_panel);
       CC_RETURN (TRUE);
     }
 
+  /* Keep the old panel around, so that going back to it is fast */
+  if (self->old_panel && self->current_panel_id &&
+      cc_panel_can_suspend (CC_PANEL (self->old_panel)))
+    cache_panel (self, self->current_panel_id, CC_PANEL (self->old_panel));
+  g_clear_object (&self->old_panel);
+
+  trace_panel_cache (self);
+
   if (add_to_history)
     add_current_panel_to_history (self, start_id);
 
@@ -550,6 +696,26 @@ cc_window_map (GtkWidget *widget)
     adw_dialog_present (self->development_warning_dialog, GTK_WIDGET (self));
 }
 
+static void
+cc_window_snapshot (GtkWidget   *widget,
+                    GtkSnapshot *snapshot)
+{
+  CcWindow *self = CC_WINDOW (widget);
+
+  if (!self->first_snapshot_done)
+    {
+      cc_trace_mark ("shell", "window first snapshot");
+      self->first_snapshot_done = TRUE;
+
+      /* Panels probing devices and services to update their visibility
+       * shouldn't delay the first frame.
+       */
+      cc_panel_loader_schedule_static_init ();
+    }
+
+  GTK_WIDGET_CLASS (cc_window_parent_class)->snapshot (widget, snapshot);
+}
+
 static void
 cc_window_unmap (GtkWidget *widget)
 {
@@ -632,8 +798,12 @@ maybe_load_last_panel (CcWindow *self)
   if (cc_panel_list_get_current_panel (self->panel_list))
     return;
 
-  /* select the last used panel, if any, or the first visible panel */
-  if (id != NULL && cc_shell_model_has_panel (self->store, id))
+  /* select the last used panel, if any, or the first visible panel. Panels
+   * still waiting for their probes may turn out to be unavailable, so they
+   * aren't restored. */
+  if (id != NULL &&
+      cc_shell_model_has_panel (self->store, id) &&
+      !cc_panel_loader_is_static_init_pending (id))
     {
       cc_panel_list_center_activated_row (self->panel_list, TRUE);
       cc_panel_list_set_active_panel (self->panel_list, id);
@@ -646,11 +816,14 @@ static void
 cc_window_constructed (GObject *object)
 {
   CcWindow *self = CC_WINDOW (object);
+  gint64 trace_time;
 
   load_window_state (self);
 
   /* Add the panels */
+  trace_time = cc_trace_begin ();
   setup_model (self);
+  cc_trace_end (trace_time, "shell", "setup model");
 
   /* After everything is loaded, select the last used panel, if any,
    * or the first visible panel. We do that in an idle handler so we
@@ -667,6 +840,13 @@ cc_window_dispose (GObject *object)
   CcWindow *self = CC_WINDOW (object);
 
   g_clear_pointer (&self->current_panel_id, g_free);
+  g_clear_object (&self->old_panel);
+  if (self->panel_cache)
+    {
+      g_queue_free_full (self->panel_cache, (GDestroyNotify) cached_panel_free);
+      self->panel_cache = NULL;
+      self->panel_cache_size = 0;
+    }
   g_clear_object (&self->store);
   g_clear_object (&self->active_panel);
 
@@ -726,6 +906,7 @@ cc_window_class_init (CcWindowClass *klass)
 
   widget_class->map = cc_window_map;
   widget_class->unmap = cc_window_unmap;
+  widget_class->snapshot = cc_window_snapshot;
 
   g_object_class_override_property (object_class, PROP_ACTIVE_PANEL, "active-panel");
 
@@ -777,6 +958,7 @@ cc_window_init (CcWindow *self)
 
   self->settings = g_settings_new ("org.gnome.Settings");
   self->previous_panels = g_queue_new ();
+  self->panel_cache = g_queue_new ();
   self->previous_list_view = cc_panel_list_get_view (self->panel_list);
 
   /* Add a custom CSS class on development builds */
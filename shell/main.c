@@ -32,12 +32,16 @@
 
 #include "cc-log.h"
 #include "cc-application.h"
+#include "cc-trace.h"
 
 int
 main (gint    argc,
       gchar **argv)
 {
   g_autoptr(GtkApplication) application = NULL;
+  int status;
+
+  cc_trace_mark ("shell", "main");
 
   bindtextdomain (GETTEXT_PACKAGE, GNOMELOCALEDIR);
   bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
@@ -48,5 +52,9 @@ main (gint    argc,
 
   application = cc_application_new ();
 
-  return g_application_run (G_APPLICATION (application), argc, argv);
+  status = g_application_run (G_APPLICATION (application), argc, argv);
+
+  cc_trace_shutdown ();
+
+  return status;
 }
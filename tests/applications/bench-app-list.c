@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Creates a data directory with a thousand apps, or as many as set in
+ * BENCH_APP_LIST_APPS, and compares how long it takes to refresh the list
+ * of apps by clearing it and inserting every app sorted, and by updating
+ * it with update_app_list().
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "utils.h"
+
+#define DEFAULT_N_APPS 1000
+#define N_RUNS 5
+
+static char *apps_dir;
+
+static void
+write_app (guint       n,
+           const char *name)
+{
+  g_autofree char *filename = NULL;
+  g_autofree char *contents = NULL;
+  g_autoptr(GError) error = NULL;
+
+  filename = g_strdup_printf ("%s/org.example.App%u.desktop", apps_dir, n);
+  contents = g_strdup_printf ("[Desktop Entry]\n"
+                              "Type=Application\n"
+                              "Name=%s\n"
+                              "Exec=app%u\n"
+                              "Icon=org.example.App%u\n",
+                              name, n, n);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+}
+
+/* How the list was sorted before, computing the keys on each comparison */
+static gint
+compare_rows (gconstpointer a,
+              gconstpointer b,
+              gpointer      data)
+{
+  g_autofree gchar *key1 = NULL;
+  g_autofree gchar *key2 = NULL;
+  g_autofree gchar *sort_key1 = NULL;
+  g_autofree gchar *sort_key2 = NULL;
+
+  key1 = g_utf8_casefold (g_app_info_get_display_name (G_APP_INFO (a)), -1);
+  key2 = g_utf8_casefold (g_app_info_get_display_name (G_APP_INFO (b)), -1);
+  sort_key1 = g_utf8_collate_key (key1, -1);
+  sort_key2 = g_utf8_collate_key (key2, -1);
+
+  return strcmp (sort_key1, sort_key2);
+}
+
+static void
+clear_and_insert (GListStore *store,
+                  GList      *infos)
+{
+  GList *l;
+
+  g_list_store_remove_all (store);
+  for (l = infos; l != NULL; l = l->next)
+    g_list_store_insert_sorted (store, l->data, compare_rows, NULL);
+}
+
+static void
+items_changed_cb (GListModel *model,
+                  guint       position,
+                  guint       removed,
+                  guint       added,
+                  guint      *n_changed)
+{
+  *n_changed += added;
+}
+
+static void
+measure (const char *label,
+         gboolean    rename_one,
+         gboolean    use_diff,
+         guint       n_apps)
+{
+  g_autoptr(GListStore) store = g_list_store_new (G_TYPE_APP_INFO);
+  gint64 best = G_MAXINT64;
+  guint n_changed = 0;
+  guint i;
+
+  /* The list is full when the apps change */
+  {
+    g_autolist(GObject) infos = g_app_info_get_all ();
+    update_app_list (store, infos);
+  }
+
+  g_signal_connect (store, "items-changed", G_CALLBACK (items_changed_cb), &n_changed);
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      g_autolist(GObject) infos = NULL;
+      g_autofree char *name = NULL;
+      gint64 start;
+
+      if (rename_one)
+        {
+          name = g_strdup_printf ("Renamed app %s %u", use_diff ? "diff" : "insert", i);
+          write_app (n_apps / 2, name);
+        }
+
+      infos = g_app_info_get_all ();
+
+      n_changed = 0;
+      start = g_get_monotonic_time ();
+      if (use_diff)
+        update_app_list (store, infos);
+      else
+        clear_and_insert (store, infos);
+      best = MIN (best, g_get_monotonic_time () - start);
+    }
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (store)), ==, n_apps);
+  g_print ("%-40s %8.2f ms, %u rows created\n", label, best / 1000.0, n_changed);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autofree char *data_dir = NULL;
+  g_autoptr(GError) error = NULL;
+  const char *n_apps_env;
+  const char *name;
+  gint64 start;
+  guint n_apps;
+  GDir *dir;
+  guint i;
+
+  n_apps_env = g_getenv ("BENCH_APP_LIST_APPS");
+  n_apps = n_apps_env ? g_ascii_strtoull (n_apps_env, NULL, 10) : DEFAULT_N_APPS;
+
+  data_dir = g_dir_make_tmp ("bench-app-list-XXXXXX", &error);
+  g_assert_no_error (error);
+  apps_dir = g_build_filename (data_dir, "applications", NULL);
+  g_assert_cmpint (g_mkdir (apps_dir, 0700), ==, 0);
+
+  /* Only the synthetic apps are listed */
+  g_setenv ("XDG_DATA_HOME", data_dir, TRUE);
+  g_setenv ("XDG_DATA_DIRS", data_dir, TRUE);
+
+  for (i = 0; i < n_apps; i++)
+    {
+      g_autofree char *app_name = g_strdup_printf ("App %u", g_random_int ());
+      write_app (i, app_name);
+    }
+
+  start = g_get_monotonic_time ();
+  g_list_free_full (g_app_info_get_all (), g_object_unref);
+  g_print ("Loaded %u apps in %.2f ms\n", n_apps, (g_get_monotonic_time () - start) / 1000.0);
+
+  /* The initial population, from an empty list */
+  {
+    g_autoptr(GListStore) store = g_list_store_new (G_TYPE_APP_INFO);
+    g_autolist(GObject) infos = g_app_info_get_all ();
+
+    start = g_get_monotonic_time ();
+    clear_and_insert (store, infos);
+    g_print ("%-40s %8.2f ms\n", "Initial, insert sorted", (g_get_monotonic_time () - start) / 1000.0);
+
+    g_list_store_remove_all (store);
+    g_list_free_full (g_steal_pointer (&infos), g_object_unref);
+    infos = g_app_info_get_all ();
+
+    start = g_get_monotonic_time ();
+    update_app_list (store, infos);
+    g_print ("%-40s %8.2f ms\n", "Initial, sort and splice", (g_get_monotonic_time () - start) / 1000.0);
+  }
+
+  measure ("Refresh, unchanged, insert sorted", FALSE, FALSE, n_apps);
+  measure ("Refresh, unchanged, diff", FALSE, TRUE, n_apps);
+  measure ("Refresh, one renamed, insert sorted", TRUE, FALSE, n_apps);
+  measure ("Refresh, one renamed, diff", TRUE, TRUE, n_apps);
+
+  dir = g_dir_open (apps_dir, 0, NULL);
+  while (dir && (name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *filename = g_build_filename (apps_dir, name, NULL);
+      g_unlink (filename);
+    }
+  g_clear_pointer (&dir, g_dir_close);
+  g_rmdir (apps_dir);
+  g_rmdir (data_dir);
+  g_free (apps_dir);
+
+  return 0;
+}
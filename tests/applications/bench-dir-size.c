@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Creates synthetic trees of files, a million by default, or as many as
+ * set in BENCH_DIR_SIZE_FILES, and compares how long it takes to compute
+ * their size with get_dir_size() and with a single threaded nftw(). The
+ * wide tree has many directories at the top, the narrow one has the same
+ * files under a single chain of directories, like ~/.var/app/<id>.
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "test-utils.h"
+#include "utils.h"
+
+#define DEFAULT_N_FILES 1000000
+#define FILES_PER_DIR 100
+#define DIRS_PER_DIR 32
+#define NARROW_DEPTH 4
+#define N_RUNS 3
+
+static guint64 nftw_size;
+
+static int
+nftw_size_cb (const char        *path,
+              const struct stat *sb,
+              int                typeflags,
+              struct FTW        *ftwbuf)
+{
+  if (typeflags == FTW_F)
+    nftw_size += sb->st_size;
+  return 0;
+}
+
+static void
+create_tree (const char *path,
+             guint       n_files)
+{
+  guint i;
+
+  for (i = 0; i < n_files; i++)
+    {
+      g_autofree char *dir = NULL;
+      g_autofree char *filename = NULL;
+      guint n_dir = i / FILES_PER_DIR;
+      int fd;
+
+      /* Spread the directories over two levels */
+      dir = g_strdup_printf ("%s/%u/%u", path, n_dir % DIRS_PER_DIR, n_dir / DIRS_PER_DIR);
+      if (i % FILES_PER_DIR == 0)
+        g_assert_cmpint (g_mkdir_with_parents (dir, 0700), ==, 0);
+
+      filename = g_strdup_printf ("%s/%u", dir, i);
+      fd = open (filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+      g_assert_cmpint (fd, >=, 0);
+      g_assert_cmpint (write (fd, "0123456789", 1 + i % 10), ==, 1 + i % 10);
+      close (fd);
+    }
+}
+
+static void
+bench_tree (const char *name,
+            const char *path)
+{
+  guint64 size = 0;
+  gint64 best_nftw = G_MAXINT64;
+  gint64 best_walk = G_MAXINT64;
+  gint64 start;
+  guint i;
+
+  /* Both start from a warm cache, after a first walk */
+  for (i = 0; i < N_RUNS + 1; i++)
+    {
+      nftw_size = 0;
+      start = g_get_monotonic_time ();
+      nftw (path, nftw_size_cb, 20, FTW_PHYS | FTW_DEPTH);
+      if (i > 0)
+        best_nftw = MIN (best_nftw, g_get_monotonic_time () - start);
+
+      start = g_get_monotonic_time ();
+      size = get_dir_size (path, NULL, NULL, NULL, NULL);
+      if (i > 0)
+        best_walk = MIN (best_walk, g_get_monotonic_time () - start);
+
+      g_assert_cmpuint (size, ==, nftw_size);
+    }
+
+  g_print ("%s tree:\n", name);
+  g_print ("  Total size: %" G_GUINT64_FORMAT " bytes\n", size);
+  g_print ("  nftw: %.1f ms\n", best_nftw / 1000.0);
+  g_print ("  get_dir_size: %.1f ms (%u processors)\n", best_walk / 1000.0, g_get_num_processors ());
+  g_print ("  Speedup: %.2fx\n", (double) best_nftw / best_walk);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autofree char *path = NULL;
+  g_autofree char *wide_path = NULL;
+  g_autofree char *narrow_root = NULL;
+  g_autoptr(GString) narrow_path = NULL;
+  g_autoptr(GError) error = NULL;
+  const char *n_files_env;
+  gint64 start;
+  guint n_files;
+  guint i;
+
+  n_files_env = g_getenv ("BENCH_DIR_SIZE_FILES");
+  n_files = n_files_env ? g_ascii_strtoull (n_files_env, NULL, 10) : DEFAULT_N_FILES;
+
+  path = g_dir_make_tmp ("bench-dir-size-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  wide_path = g_build_filename (path, "wide", NULL);
+  narrow_root = g_build_filename (path, "narrow", NULL);
+  narrow_path = g_string_new (narrow_root);
+  for (i = 0; i < NARROW_DEPTH; i++)
+    g_string_append_printf (narrow_path, "/%u", i);
+
+  start = g_get_monotonic_time ();
+  create_tree (wide_path, n_files);
+  create_tree (narrow_path->str, n_files);
+  g_print ("Created 2 × %u files in %.1f s\n", n_files, (g_get_monotonic_time () - start) / (double) G_USEC_PER_SEC);
+
+  bench_tree ("Wide", wide_path);
+  bench_tree ("Narrow", narrow_root);
+
+  test_utils_remove_dir (path);
+
+  return 0;
+}
@@ -0,0 +1,230 @@
+#include "config.h"
+
+#include <gio/gdesktopappinfo.h>
+#include <glib/gstdio.h>
+
+#include "test-utils.h"
+#include "utils.h"
+
+static char *test_dir;
+
+static void
+write_app (const char *id,
+           const char *name)
+{
+  g_autofree char *filename = NULL;
+  g_autofree char *contents = NULL;
+  g_autoptr(GError) error = NULL;
+
+  filename = g_strdup_printf ("%s/applications/%s.desktop", test_dir, id);
+  contents = g_strdup_printf ("[Desktop Entry]\nType=Application\nName=%s\nExec=true\n", name);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+}
+
+static GList *
+load_apps (const char * const *ids)
+{
+  GList *infos = NULL;
+  guint i;
+
+  for (i = 0; ids[i] != NULL; i++)
+    {
+      g_autofree char *desktop_id = g_strdup_printf ("%s.desktop", ids[i]);
+      GDesktopAppInfo *info = g_desktop_app_info_new (desktop_id);
+
+      g_assert_nonnull (info);
+      infos = g_list_prepend (infos, info);
+    }
+
+  return infos;
+}
+
+static void
+assert_names (GListModel         *model,
+              const char * const *names)
+{
+  guint i;
+
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, g_strv_length ((GStrv) names));
+
+  for (i = 0; names[i] != NULL; i++)
+    {
+      g_autoptr(GAppInfo) info = g_list_model_get_item (model, i);
+
+      g_assert_cmpstr (g_app_info_get_name (info), ==, names[i]);
+    }
+}
+
+typedef struct
+{
+  guint n_signals;
+  guint n_removed;
+  guint n_added;
+} ItemsChanged;
+
+static void
+items_changed_cb (GListModel   *model,
+                  guint         position,
+                  guint         removed,
+                  guint         added,
+                  ItemsChanged *changes)
+{
+  changes->n_signals++;
+  changes->n_removed += removed;
+  changes->n_added += added;
+}
+
+static void
+test_populate (void)
+{
+  g_autoptr(GListStore) store = g_list_store_new (G_TYPE_APP_INFO);
+  g_autolist(GObject) infos = NULL;
+  ItemsChanged changes = { 0, };
+
+  g_signal_connect (store, "items-changed", G_CALLBACK (items_changed_cb), &changes);
+
+  infos = load_apps ((const char *[]) { "org.example.Charlie", "org.example.alpha", "org.example.Bravo", NULL });
+  update_app_list (store, infos);
+
+  /* Sorted by name, ignoring the case, at once */
+  assert_names (G_LIST_MODEL (store), (const char *[]) { "alpha", "Bravo", "Charlie", NULL });
+  g_assert_cmpuint (changes.n_signals, ==, 1);
+}
+
+static void
+test_diff (void)
+{
+  g_autoptr(GListStore) store = g_list_store_new (G_TYPE_APP_INFO);
+  g_autolist(GObject) infos = NULL;
+  g_autoptr(GAppInfo) bravo = NULL;
+  g_autoptr(GAppInfo) bravo_again = NULL;
+  ItemsChanged changes = { 0, };
+
+  infos = load_apps ((const char *[]) { "org.example.alpha", "org.example.Bravo", "org.example.Charlie", NULL });
+  update_app_list (store, infos);
+  bravo = g_list_model_get_item (G_LIST_MODEL (store), 1);
+
+  g_signal_connect (store, "items-changed", G_CALLBACK (items_changed_cb), &changes);
+
+  /* Nothing changes when the same apps are loaded again */
+  g_list_free_full (g_steal_pointer (&infos), g_object_unref);
+  infos = load_apps ((const char *[]) { "org.example.alpha", "org.example.Bravo", "org.example.Charlie", NULL });
+  update_app_list (store, infos);
+  g_assert_cmpuint (changes.n_signals, ==, 0);
+
+  /* Only the apps that were added or removed change */
+  g_list_free_full (g_steal_pointer (&infos), g_object_unref);
+  infos = load_apps ((const char *[]) { "org.example.Bravo", "org.example.Charlie", "org.example.Delta", NULL });
+  update_app_list (store, infos);
+  assert_names (G_LIST_MODEL (store), (const char *[]) { "Bravo", "Charlie", "Delta", NULL });
+  g_assert_cmpuint (changes.n_removed, ==, 1);
+  g_assert_cmpuint (changes.n_added, ==, 1);
+
+  bravo_again = g_list_model_get_item (G_LIST_MODEL (store), 0);
+  g_assert_true (bravo == bravo_again);
+  g_clear_object (&bravo_again);
+
+  /* And a renamed app moves to its new place */
+  changes = (ItemsChanged) { 0, };
+  write_app ("org.example.Bravo", "Echo");
+  g_list_free_full (g_steal_pointer (&infos), g_object_unref);
+  infos = load_apps ((const char *[]) { "org.example.Bravo", "org.example.Charlie", "org.example.Delta", NULL });
+  update_app_list (store, infos);
+  assert_names (G_LIST_MODEL (store), (const char *[]) { "Charlie", "Delta", "Echo", NULL });
+  g_assert_cmpuint (changes.n_removed, ==, 1);
+  g_assert_cmpuint (changes.n_added, ==, 1);
+}
+
+static void
+test_changed (void)
+{
+  g_autoptr(GListStore) store = g_list_store_new (G_TYPE_APP_INFO);
+  g_autolist(GObject) infos = NULL;
+  g_autoptr(GAppInfo) before = NULL;
+  g_autoptr(GAppInfo) after = NULL;
+  g_autofree char *filename = NULL;
+  g_autoptr(GError) error = NULL;
+  ItemsChanged changes = { 0, };
+
+  infos = load_apps ((const char *[]) { "org.example.Foxtrot", NULL });
+  update_app_list (store, infos);
+  before = g_list_model_get_item (G_LIST_MODEL (store), 0);
+
+  g_signal_connect (store, "items-changed", G_CALLBACK (items_changed_cb), &changes);
+
+  /* Same name, different command */
+  filename = g_build_filename (test_dir, "applications", "org.example.Foxtrot.desktop", NULL);
+  g_file_set_contents (filename, "[Desktop Entry]\nType=Application\nName=Foxtrot\nExec=false\n", -1, &error);
+  g_assert_no_error (error);
+
+  g_list_free_full (g_steal_pointer (&infos), g_object_unref);
+  infos = load_apps ((const char *[]) { "org.example.Foxtrot", NULL });
+  update_app_list (store, infos);
+
+  after = g_list_model_get_item (G_LIST_MODEL (store), 0);
+  g_assert_true (before != after);
+  g_assert_cmpstr (g_app_info_get_executable (after), ==, "false");
+  g_assert_cmpuint (changes.n_signals, ==, 1);
+}
+
+static void
+test_other_keys (void)
+{
+  g_autoptr(GListStore) store = g_list_store_new (G_TYPE_APP_INFO);
+  g_autolist(GObject) infos = NULL;
+  g_autoptr(GAppInfo) before = NULL;
+  g_autoptr(GAppInfo) after = NULL;
+  g_autofree char *filename = NULL;
+  g_autoptr(GError) error = NULL;
+  const char **types;
+
+  infos = load_apps ((const char *[]) { "org.example.Golf", NULL });
+  update_app_list (store, infos);
+  before = g_list_model_get_item (G_LIST_MODEL (store), 0);
+  g_assert_null (g_app_info_get_supported_types (before));
+
+  /* Same name, command and icon, only the file types change */
+  filename = g_build_filename (test_dir, "applications", "org.example.Golf.desktop", NULL);
+  g_file_set_contents (filename, "[Desktop Entry]\nType=Application\nName=Golf\nExec=true\nMimeType=text/plain;\n", -1, &error);
+  g_assert_no_error (error);
+
+  g_list_free_full (g_steal_pointer (&infos), g_object_unref);
+  infos = load_apps ((const char *[]) { "org.example.Golf", NULL });
+  update_app_list (store, infos);
+
+  after = g_list_model_get_item (G_LIST_MODEL (store), 0);
+  g_assert_true (before != after);
+  types = g_app_info_get_supported_types (after);
+  g_assert_nonnull (types);
+  g_assert_cmpstr (types[0], ==, "text/plain");
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autofree char *apps_dir = NULL;
+
+  test_dir = test_utils_init (&argc, &argv, "test-app-list");
+
+  apps_dir = g_build_filename (test_dir, "applications", NULL);
+  g_assert_cmpint (g_mkdir (apps_dir, 0700), ==, 0);
+
+  /* Before anything looks up apps */
+  g_setenv ("XDG_DATA_HOME", test_dir, TRUE);
+  g_setenv ("XDG_DATA_DIRS", test_dir, TRUE);
+
+  write_app ("org.example.alpha", "alpha");
+  write_app ("org.example.Bravo", "Bravo");
+  write_app ("org.example.Charlie", "Charlie");
+  write_app ("org.example.Delta", "Delta");
+  write_app ("org.example.Foxtrot", "Foxtrot");
+  write_app ("org.example.Golf", "Golf");
+
+  g_test_add_func ("/applications/app-list/populate", test_populate);
+  g_test_add_func ("/applications/app-list/diff", test_diff);
+  g_test_add_func ("/applications/app-list/changed", test_changed);
+  g_test_add_func ("/applications/app-list/other-keys", test_other_keys);
+
+  return test_utils_run (test_dir);
+}
@@ -0,0 +1,172 @@
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "cc-app-size-cache.h"
+#include "test-utils.h"
+
+#define APP_ID "org.example.App"
+
+static char *home_dir;
+
+typedef struct
+{
+  gboolean done;
+  guint64  size;
+} SizeData;
+
+static void
+size_cb (GObject      *source,
+         GAsyncResult *result,
+         gpointer      user_data)
+{
+  SizeData *data = user_data;
+  g_autoptr(GError) error = NULL;
+
+  g_assert_true (cc_app_size_cache_get_size_finish (CC_APP_SIZE_CACHE (source), result, &data->size, &error));
+  g_assert_no_error (error);
+  data->done = TRUE;
+}
+
+static guint64
+get_size (CcAppSizeCache *cache,
+          const char     *app_id,
+          CcAppSizeKind   kind)
+{
+  SizeData data = { FALSE, 0 };
+
+  cc_app_size_cache_get_size_async (cache, app_id, kind, NULL, size_cb, &data);
+  while (!data.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  return data.size;
+}
+
+/* Gets the size until it's @expected, giving the directory monitors
+ * some time to notice changes */
+static guint64
+wait_for_size (CcAppSizeCache *cache,
+               const char     *app_id,
+               CcAppSizeKind   kind,
+               guint64         expected)
+{
+  gint64 deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+  guint64 size;
+
+  while ((size = get_size (cache, app_id, kind)) != expected &&
+         g_get_monotonic_time () < deadline)
+    {
+      g_usleep (G_USEC_PER_SEC / 100);
+      while (g_main_context_iteration (NULL, FALSE));
+    }
+
+  return size;
+}
+
+static void
+write_file (const char *subdir,
+            const char *name,
+            gsize       size)
+{
+  g_autofree char *dir = g_build_filename (home_dir, ".var", "app", APP_ID, subdir, NULL);
+  g_autofree char *filename = g_build_filename (dir, name, NULL);
+  g_autofree char *contents = g_malloc0 (size);
+  g_autofree char *parent = g_path_get_dirname (filename);
+  g_autoptr(GError) error = NULL;
+
+  g_assert_cmpint (g_mkdir_with_parents (parent, 0700), ==, 0);
+  g_file_set_contents (filename, contents, size, &error);
+  g_assert_no_error (error);
+}
+
+static void
+grow_file (const char *subdir,
+           const char *name,
+           gsize       size)
+{
+  g_autofree char *filename = g_build_filename (home_dir, ".var", "app", APP_ID, subdir, name, NULL);
+  g_autofree char *contents = g_malloc0 (size);
+  FILE *file;
+
+  /* Appending in place, without going through a temporary file */
+  file = g_fopen (filename, "ab");
+  g_assert_nonnull (file);
+  g_assert_cmpuint (fwrite (contents, 1, size, file), ==, size);
+  fclose (file);
+}
+
+static void
+test_sizes (void)
+{
+  g_autoptr(CcAppSizeCache) cache = cc_app_size_cache_new ();
+
+  write_file ("data", "a", 1000);
+  write_file ("data", "nested/b", 200);
+  write_file ("cache", "c", 30);
+
+  g_assert_cmpuint (get_size (cache, APP_ID, CC_APP_SIZE_DATA), ==, 1200);
+  g_assert_cmpuint (get_size (cache, APP_ID, CC_APP_SIZE_CACHE), ==, 30);
+
+  /* Apps without data have no size */
+  g_assert_cmpuint (get_size (cache, "org.example.Missing", CC_APP_SIZE_DATA), ==, 0);
+}
+
+static void
+test_invalidation (void)
+{
+  g_autoptr(CcAppSizeCache) cache = cc_app_size_cache_new ();
+
+  write_file ("data", "a", 1000);
+  write_file ("data", "nested/b", 200);
+
+  g_assert_cmpuint (get_size (cache, APP_ID, CC_APP_SIZE_DATA), ==, 1200);
+
+  /* New files in any of the directories are noticed */
+  write_file ("data", "nested/deeper/c", 4);
+  g_assert_cmpuint (get_size (cache, APP_ID, CC_APP_SIZE_DATA), ==, 1204);
+
+  /* A file growing in place doesn't touch the directories, but the
+   * directory it's in is monitored
+   */
+  grow_file ("data", "nested/deeper/c", 100);
+  g_assert_cmpuint (wait_for_size (cache, APP_ID, CC_APP_SIZE_DATA, 1304), ==, 1304);
+
+  grow_file ("data", "nested/b", 10);
+  g_assert_cmpuint (wait_for_size (cache, APP_ID, CC_APP_SIZE_DATA, 1314), ==, 1314);
+
+  cc_app_size_cache_invalidate (cache, APP_ID);
+  g_assert_cmpuint (get_size (cache, APP_ID, CC_APP_SIZE_DATA), ==, 1314);
+}
+
+static void
+test_created (void)
+{
+  g_autoptr(CcAppSizeCache) cache = cc_app_size_cache_new ();
+  g_autofree char *dir = g_build_filename (home_dir, ".var", "app", "org.example.Created", "cache", NULL);
+  g_autofree char *filename = g_build_filename (dir, "d", NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_assert_cmpuint (get_size (cache, "org.example.Created", CC_APP_SIZE_CACHE), ==, 0);
+
+  /* The size of an app without a directory isn't kept */
+  g_assert_cmpint (g_mkdir_with_parents (dir, 0700), ==, 0);
+  g_file_set_contents (filename, "data", 4, &error);
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (get_size (cache, "org.example.Created", CC_APP_SIZE_CACHE), ==, 4);
+}
+
+int
+main (int argc, char **argv)
+{
+  home_dir = test_utils_init (&argc, &argv, "test-app-size-cache");
+
+  /* The data and cache directories are looked up in the home directory */
+  g_setenv ("HOME", home_dir, TRUE);
+
+  g_test_add_func ("/applications/app-size-cache/sizes", test_sizes);
+  g_test_add_func ("/applications/app-size-cache/invalidation", test_invalidation);
+  g_test_add_func ("/applications/app-size-cache/created", test_created);
+
+  return test_utils_run (home_dir);
+}
@@ -0,0 +1,100 @@
+#include "config.h"
+
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "utils.h"
+#include "test-utils.h"
+
+static char *test_dir;
+
+static void
+write_file (const char *name,
+            gsize       size)
+{
+  g_autofree char *filename = g_build_filename (test_dir, name, NULL);
+  g_autofree char *parent = g_path_get_dirname (filename);
+  g_autofree char *contents = g_malloc0 (size);
+  g_autoptr(GError) error = NULL;
+
+  g_assert_cmpint (g_mkdir_with_parents (parent, 0700), ==, 0);
+  g_file_set_contents (filename, contents, size, &error);
+  g_assert_no_error (error);
+}
+
+static void
+create_tree (void)
+{
+  guint i, j;
+
+  for (i = 0; i < 16; i++)
+    {
+      for (j = 0; j < 8; j++)
+        {
+          g_autofree char *name = g_strdup_printf ("tree/%u/sub/%u", i, j);
+
+          write_file (name, 10);
+        }
+    }
+}
+
+static void
+test_size (void)
+{
+  g_autofree char *path = g_build_filename (test_dir, "tree", NULL);
+  g_autoptr(GPtrArray) dirs = g_ptr_array_new_with_free_func (g_free);
+
+  create_tree ();
+
+  g_assert_cmpuint (get_dir_size (path, dirs, NULL, NULL, NULL), ==, 16 * 8 * 10);
+
+  /* The top directory, and two levels for each of the 16 subdirectories */
+  g_assert_cmpuint (dirs->len, ==, 1 + 16 * 2);
+  g_assert_true (g_ptr_array_find_with_equal_func (dirs, path, g_str_equal, NULL));
+}
+
+static void
+test_links (void)
+{
+  g_autofree char *path = g_build_filename (test_dir, "links", NULL);
+  g_autofree char *target = g_build_filename (path, "file", NULL);
+  g_autofree char *hardlink = g_build_filename (path, "dir", "hardlink", NULL);
+  g_autofree char *symlink_path = g_build_filename (path, "symlink", NULL);
+
+  write_file ("links/file", 1000);
+  write_file ("links/dir/other", 1);
+
+  /* Hard links are only counted once, and symbolic links aren't followed */
+  g_assert_cmpint (link (target, hardlink), ==, 0);
+  g_assert_cmpint (symlink (target, symlink_path), ==, 0);
+
+  g_assert_cmpuint (get_dir_size (path, NULL, NULL, NULL, NULL), ==, 1001);
+
+  /* A file is its own size */
+  g_assert_cmpuint (get_dir_size (target, NULL, NULL, NULL, NULL), ==, 1000);
+}
+
+static void
+test_cancelled (void)
+{
+  g_autofree char *path = g_build_filename (test_dir, "tree", NULL);
+  g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+
+  create_tree ();
+
+  /* Nothing beyond the top directory is walked */
+  g_cancellable_cancel (cancellable);
+  g_assert_cmpuint (get_dir_size (path, NULL, cancellable, NULL, NULL), ==, 0);
+}
+
+int
+main (int argc, char **argv)
+{
+  test_dir = test_utils_init (&argc, &argv, "test-dir-size");
+
+  g_test_add_func ("/applications/dir-size/size", test_size);
+  g_test_add_func ("/applications/dir-size/links", test_links);
+  g_test_add_func ("/applications/dir-size/cancelled", test_cancelled);
+
+  return test_utils_run (test_dir);
+}
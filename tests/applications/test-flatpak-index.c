@@ -0,0 +1,176 @@
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "cc-flatpak-index.h"
+#include "test-utils.h"
+
+static char *test_dir;
+static char *config_dir;
+
+static void
+install_app (const char *installation,
+             const char *app_id,
+             const char *sockets,
+             guint64     installed_size)
+{
+  g_autofree char *deploy_dir = NULL;
+  g_autofree char *metadata_path = NULL;
+  g_autofree char *metadata = NULL;
+  g_autofree char *deploy_path = NULL;
+  g_autoptr(GVariant) deploy_data = NULL;
+  g_autoptr(GError) error = NULL;
+  const char * const no_subpaths[] = { NULL };
+
+  deploy_dir = g_build_filename (test_dir, installation, "app", app_id, "current", "active", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (deploy_dir, 0700), ==, 0);
+
+  metadata = g_strdup_printf ("[Application]\nname=%s\n\n[Context]\nsockets=%s;\n", app_id, sockets);
+  metadata_path = g_build_filename (deploy_dir, "metadata", NULL);
+  g_file_set_contents (metadata_path, metadata, -1, &error);
+  g_assert_no_error (error);
+
+  deploy_data = g_variant_ref_sink (g_variant_new ("(ss^ast@a{sv})",
+                                                   "origin",
+                                                   "commit",
+                                                   no_subpaths,
+                                                   GUINT64_TO_BE (installed_size),
+                                                   g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0)));
+  deploy_path = g_build_filename (deploy_dir, "deploy", NULL);
+  g_file_set_contents (deploy_path,
+                       g_variant_get_data (deploy_data),
+                       g_variant_get_size (deploy_data),
+                       &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_lookup (void)
+{
+  g_autoptr(CcFlatpakIndex) index = NULL;
+  g_autoptr(GKeyFile) metadata = NULL;
+  g_auto(GStrv) sockets = NULL;
+  guint64 size = 0;
+
+  install_app ("user", "org.example.User", "wayland", 1234);
+  install_app ("system", "org.example.System", "x11", 5678);
+
+  /* The user installation is looked up first */
+  install_app ("user", "org.example.Both", "pulseaudio", 1);
+  install_app ("system", "org.example.Both", "session-bus", 2);
+
+  index = cc_flatpak_index_new (config_dir);
+
+  metadata = cc_flatpak_index_get_metadata (index, "org.example.User");
+  g_assert_nonnull (metadata);
+  sockets = g_key_file_get_string_list (metadata, "Context", "sockets", NULL, NULL);
+  g_assert_cmpstrv (sockets, ((const char *[]) { "wayland", NULL }));
+  g_assert_true (cc_flatpak_index_get_installed_size (index, "org.example.User", &size));
+  g_assert_cmpuint (size, ==, 1234);
+
+  g_assert_true (cc_flatpak_index_get_installed_size (index, "org.example.System", &size));
+  g_assert_cmpuint (size, ==, 5678);
+
+  g_assert_true (cc_flatpak_index_get_installed_size (index, "org.example.Both", &size));
+  g_assert_cmpuint (size, ==, 1);
+
+  g_assert_null (cc_flatpak_index_get_metadata (index, "org.example.Missing"));
+  g_assert_false (cc_flatpak_index_get_installed_size (index, "org.example.Missing", &size));
+}
+
+static void
+test_extra_installation (void)
+{
+  g_autoptr(CcFlatpakIndex) index = NULL;
+  g_autofree char *extra_dir = NULL;
+  g_autofree char *config = NULL;
+  g_autofree char *config_path = NULL;
+  g_autoptr(GError) error = NULL;
+  GPtrArray *installations;
+  guint64 size = 0;
+
+  install_app ("extra", "org.example.Extra", "wayland", 99);
+
+  extra_dir = g_build_filename (test_dir, "extra", NULL);
+  config = g_strdup_printf ("[Installation \"extra\"]\nPath=%s\n", extra_dir);
+  config_path = g_build_filename (config_dir, "extra.conf", NULL);
+  g_file_set_contents (config_path, config, -1, &error);
+  g_assert_no_error (error);
+
+  index = cc_flatpak_index_new (config_dir);
+
+  installations = cc_flatpak_index_get_installations (index);
+  g_assert_cmpuint (installations->len, ==, 3);
+  g_assert_cmpstr (g_ptr_array_index (installations, 2), ==, extra_dir);
+
+  g_assert_true (cc_flatpak_index_get_installed_size (index, "org.example.Extra", &size));
+  g_assert_cmpuint (size, ==, 99);
+
+  g_unlink (config_path);
+}
+
+static void
+changed_cb (CcFlatpakIndex *index,
+            gboolean       *changed)
+{
+  *changed = TRUE;
+}
+
+static void
+test_changed (void)
+{
+  g_autoptr(CcFlatpakIndex) index = NULL;
+  g_autofree char *changed_path = NULL;
+  g_autoptr(GError) error = NULL;
+  gboolean changed = FALSE;
+  guint64 size = 0;
+
+  changed_path = g_build_filename (test_dir, "user", ".changed", NULL);
+  g_file_set_contents (changed_path, "", 0, &error);
+  g_assert_no_error (error);
+
+  index = cc_flatpak_index_new (config_dir);
+  g_signal_connect (index, "changed", G_CALLBACK (changed_cb), &changed);
+
+  g_assert_false (cc_flatpak_index_get_installed_size (index, "org.example.New", &size));
+
+  /* Installing touches the .changed file of the installation */
+  install_app ("user", "org.example.New", "wayland", 42);
+  g_file_set_contents (changed_path, "", 0, &error);
+  g_assert_no_error (error);
+
+  while (!changed)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_true (cc_flatpak_index_get_installed_size (index, "org.example.New", &size));
+  g_assert_cmpuint (size, ==, 42);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autofree char *user_dir = NULL;
+  g_autofree char *system_dir = NULL;
+  int ret;
+
+  test_dir = test_utils_init (&argc, &argv, "test-flatpak-index");
+
+  user_dir = g_build_filename (test_dir, "user", NULL);
+  system_dir = g_build_filename (test_dir, "system", NULL);
+  config_dir = g_build_filename (test_dir, "installations.d", NULL);
+  g_mkdir (user_dir, 0700);
+  g_mkdir (system_dir, 0700);
+  g_mkdir (config_dir, 0700);
+  g_setenv ("FLATPAK_USER_DIR", user_dir, TRUE);
+  g_setenv ("FLATPAK_SYSTEM_DIR", system_dir, TRUE);
+
+  g_test_add_func ("/applications/flatpak-index/lookup", test_lookup);
+  g_test_add_func ("/applications/flatpak-index/extra-installation", test_extra_installation);
+  g_test_add_func ("/applications/flatpak-index/changed", test_changed);
+
+  ret = test_utils_run (test_dir);
+
+  g_free (config_dir);
+
+  return ret;
+}
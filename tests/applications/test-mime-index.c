@@ -0,0 +1,177 @@
+#include "config.h"
+
+#include <gio/gdesktopappinfo.h>
+#include <glib/gstdio.h>
+
+#include "cc-mime-index.h"
+#include "test-utils.h"
+
+static char *test_dir;
+
+static void
+write_file (const char *name,
+            const char *contents)
+{
+  g_autofree char *filename = g_build_filename (test_dir, name, NULL);
+  g_autofree char *parent = g_path_get_dirname (filename);
+  g_autoptr(GError) error = NULL;
+
+  g_assert_cmpint (g_mkdir_with_parents (parent, 0700), ==, 0);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_globs (void)
+{
+  g_autoptr(CcMimeIndex) index = cc_mime_index_new ();
+
+  /* The glob with the highest weight, from the data directory looked up first */
+  g_assert_cmpstr (cc_mime_index_get_glob (index, "image/png"), ==, "*.png");
+  g_assert_cmpstr (cc_mime_index_get_glob (index, "image/jpeg"), ==, "*.jpg");
+  g_assert_cmpstr (cc_mime_index_get_glob (index, "text/plain"), ==, "*.text");
+  g_assert_null (cc_mime_index_get_glob (index, "application/x-unknown"));
+}
+
+static gboolean
+gio_recommends (GAppInfo   *info,
+                const char *content_type)
+{
+  g_autolist(GObject) recommended = g_app_info_get_recommended_for_type (content_type);
+  GList *l;
+
+  for (l = recommended; l != NULL; l = l->next)
+    {
+      if (g_app_info_equal (info, l->data))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+assert_recommended (CcMimeIndex *index,
+                    GAppInfo    *info,
+                    const char  *content_type,
+                    gboolean     expected)
+{
+  g_assert_cmpint (cc_mime_index_is_recommended_for (index, info, content_type), ==, expected);
+
+  /* The same as GIO tells */
+  g_assert_cmpint (gio_recommends (info, content_type), ==, expected);
+}
+
+static void
+test_associations (void)
+{
+  g_autoptr(CcMimeIndex) index = cc_mime_index_new ();
+  g_autoptr(GDesktopAppInfo) viewer = g_desktop_app_info_new ("org.example.Viewer.desktop");
+  g_autoptr(GDesktopAppInfo) editor = g_desktop_app_info_new ("org.example.Editor.desktop");
+  g_autoptr(GDesktopAppInfo) player = g_desktop_app_info_new ("org.example.Player.desktop");
+
+  g_assert_nonnull (viewer);
+  g_assert_nonnull (editor);
+  g_assert_nonnull (player);
+
+  assert_recommended (index, G_APP_INFO (viewer), "image/png", TRUE);
+  assert_recommended (index, G_APP_INFO (editor), "text/x-csrc", TRUE);
+
+  /* Removed in the user configuration */
+  assert_recommended (index, G_APP_INFO (viewer), "image/jpeg", FALSE);
+
+  /* Removed in the system data, but added back for the current desktop */
+  assert_recommended (index, G_APP_INFO (editor), "text/plain", TRUE);
+
+  /* Removed in the system configuration, but added in the user data, read before */
+  assert_recommended (index, G_APP_INFO (editor), "text/x-csrc", TRUE);
+
+  /* Removed in the system configuration, read after the user data the app is in */
+  assert_recommended (index, G_APP_INFO (player), "audio/ogg", TRUE);
+}
+
+static void
+test_invalidate (void)
+{
+  g_autoptr(CcMimeIndex) index = cc_mime_index_new ();
+  g_autoptr(GDesktopAppInfo) viewer = g_desktop_app_info_new ("org.example.Viewer.desktop");
+  g_autoptr(GError) error = NULL;
+
+  g_assert_true (cc_mime_index_is_recommended_for (index, G_APP_INFO (viewer), "image/gif"));
+
+  g_app_info_remove_supports_type (G_APP_INFO (viewer), "image/gif", &error);
+  g_assert_no_error (error);
+
+  /* Until told, or until GIO notices */
+  g_assert_true (cc_mime_index_is_recommended_for (index, G_APP_INFO (viewer), "image/gif"));
+  cc_mime_index_invalidate (index);
+  g_assert_false (cc_mime_index_is_recommended_for (index, G_APP_INFO (viewer), "image/gif"));
+
+  g_app_info_add_supports_type (G_APP_INFO (viewer), "image/gif", &error);
+  g_assert_no_error (error);
+  g_signal_emit_by_name (g_app_info_monitor_get (), "changed");
+  g_assert_true (cc_mime_index_is_recommended_for (index, G_APP_INFO (viewer), "image/gif"));
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autofree char *config_home = NULL;
+  g_autofree char *config_dir = NULL;
+  g_autofree char *data_home = NULL;
+  g_autofree char *data_dir = NULL;
+
+  test_dir = test_utils_init (&argc, &argv, "test-mime-index");
+
+  config_home = g_build_filename (test_dir, "config", NULL);
+  config_dir = g_build_filename (test_dir, "config-dirs", NULL);
+  data_home = g_build_filename (test_dir, "data-home", NULL);
+  data_dir = g_build_filename (test_dir, "data", NULL);
+
+  /* Before anything looks up apps */
+  g_setenv ("XDG_CONFIG_HOME", config_home, TRUE);
+  g_setenv ("XDG_CONFIG_DIRS", config_dir, TRUE);
+  g_setenv ("XDG_DATA_HOME", data_home, TRUE);
+  g_setenv ("XDG_DATA_DIRS", data_dir, TRUE);
+  g_setenv ("XDG_CURRENT_DESKTOP", "Example", TRUE);
+
+  write_file ("data-home/mime/globs2",
+              "# Generated\n"
+              "50:text/plain:*.text\n");
+  write_file ("data/mime/globs2",
+              "# Generated\n"
+              "55:image/jpeg:*.jpg\n"
+              "50:image/png:*.png\n"
+              "50:image/jpeg:*.jpeg\n"
+              "50:text/plain:*.txt\n"
+              "50:text/x-csrc:*.c:cs\n");
+
+  write_file ("data/applications/org.example.Viewer.desktop",
+              "[Desktop Entry]\nType=Application\nName=Viewer\nExec=true\n"
+              "MimeType=image/png;image/jpeg;image/gif;\n");
+  write_file ("data/applications/org.example.Editor.desktop",
+              "[Desktop Entry]\nType=Application\nName=Editor\nExec=true\n"
+              "MimeType=text/plain;text/x-csrc;\n");
+  write_file ("data/applications/mimeapps.list",
+              "[Removed Associations]\ntext/plain=org.example.Editor.desktop;\n");
+  write_file ("config/example-mimeapps.list",
+              "[Added Associations]\ntext/plain=org.example.Editor.desktop;\n");
+  write_file ("config/mimeapps.list",
+              "[Removed Associations]\nimage/jpeg=org.example.Viewer.desktop;\n");
+
+  /* Conflicting with the user data, which GIO reads before the system configuration */
+  write_file ("data-home/applications/org.example.Player.desktop",
+              "[Desktop Entry]\nType=Application\nName=Player\nExec=true\n"
+              "MimeType=audio/ogg;\n");
+  write_file ("data-home/applications/mimeapps.list",
+              "[Added Associations]\ntext/x-csrc=org.example.Editor.desktop;\n");
+  write_file ("config-dirs/mimeapps.list",
+              "[Removed Associations]\n"
+              "text/x-csrc=org.example.Editor.desktop;\n"
+              "audio/ogg=org.example.Player.desktop;\n");
+
+  g_test_add_func ("/applications/mime-index/globs", test_globs);
+  g_test_add_func ("/applications/mime-index/associations", test_associations);
+  g_test_add_func ("/applications/mime-index/invalidate", test_invalidate);
+
+  return test_utils_run (test_dir);
+}
@@ -0,0 +1,504 @@
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "cc-snapd-client.h"
+#include "test-utils.h"
+
+/* A stand-in for snapd, answering HTTP requests on a Unix socket with
+ * canned responses, and counting the connections and requests it gets.
+ */
+
+typedef struct
+{
+  GSocketService *service;
+  char           *socket_path;
+  guint           n_connections;
+  GHashTable     *n_requests; /* path → number of requests */
+} FakeSnapd;
+
+typedef struct
+{
+  FakeSnapd         *snapd;
+  GSocketConnection *connection;
+  GDataInputStream  *input;
+  char              *method;
+  char              *path;
+  gsize              content_length;
+  char              *body;
+} FakeSnapdClient;
+
+static FakeSnapd *snapd;
+
+static void read_request_line (FakeSnapdClient *client);
+
+static void
+fake_snapd_client_free (FakeSnapdClient *client)
+{
+  g_clear_object (&client->input);
+  g_clear_object (&client->connection);
+  g_clear_pointer (&client->method, g_free);
+  g_clear_pointer (&client->path, g_free);
+  g_clear_pointer (&client->body, g_free);
+  g_free (client);
+}
+
+static char *
+make_response_body (const char *method,
+                    const char *path,
+                    guint      *status)
+{
+  *status = 200;
+
+  if (g_str_equal (method, "GET") && g_str_has_prefix (path, "/v2/snaps/"))
+    return g_strdup_printf ("{\"type\": \"sync\", \"status-code\": 200, \"status\": \"OK\", "
+                            "\"result\": {\"name\": \"%s\", \"installed-size\": 12345}}",
+                            path + strlen ("/v2/snaps/"));
+
+  if (g_str_equal (method, "GET") && g_str_equal (path, "/v2/connections?select=all"))
+    return g_strdup ("{\"type\": \"sync\", \"status-code\": 200, \"status\": \"OK\", \"result\": {"
+                     "\"plugs\": [{\"snap\": \"app\", \"plug\": \"camera\", \"interface\": \"camera\"}], "
+                     "\"slots\": [{\"snap\": \"system\", \"slot\": \"camera\", \"interface\": \"camera\"}]}}");
+
+  if (g_str_equal (method, "POST") && g_str_equal (path, "/v2/interfaces"))
+    {
+      *status = 202;
+      return g_strdup ("{\"type\": \"async\", \"status-code\": 202, \"status\": \"Accepted\", \"change\": \"42\"}");
+    }
+
+  if (g_str_equal (method, "GET") && g_str_equal (path, "/v2/changes/42"))
+    return g_strdup ("{\"type\": \"sync\", \"status-code\": 200, \"status\": \"OK\", "
+                     "\"result\": {\"id\": \"42\", \"ready\": true, \"status\": \"Done\"}}");
+
+  *status = 404;
+  return g_strdup ("{\"type\": \"error\", \"status-code\": 404, \"status\": \"Not Found\", "
+                   "\"result\": {\"message\": \"not found\"}}");
+}
+
+static void
+send_response (FakeSnapdClient *client)
+{
+  g_autofree char *body = NULL;
+  g_autofree char *response = NULL;
+  g_autoptr(GError) error = NULL;
+  GOutputStream *output;
+  guint *n_requests;
+  guint status;
+
+  n_requests = g_hash_table_lookup (client->snapd->n_requests, client->path);
+  if (n_requests == NULL)
+    {
+      n_requests = g_new0 (guint, 1);
+      g_hash_table_insert (client->snapd->n_requests, g_strdup (client->path), n_requests);
+    }
+  (*n_requests)++;
+
+  body = make_response_body (client->method, client->path, &status);
+  response = g_strdup_printf ("HTTP/1.1 %u %s\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                              "\r\n"
+                              "%s",
+                              status, status == 404 ? "Not Found" : "OK",
+                              strlen (body),
+                              body);
+
+  output = g_io_stream_get_output_stream (G_IO_STREAM (client->connection));
+  g_output_stream_write_all (output, response, strlen (response), NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  g_clear_pointer (&client->method, g_free);
+  g_clear_pointer (&client->path, g_free);
+  g_clear_pointer (&client->body, g_free);
+  client->content_length = 0;
+
+  /* Wait for the next request on the same connection */
+  read_request_line (client);
+}
+
+static void
+read_body_cb (GObject      *object,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  FakeSnapdClient *client = user_data;
+  gsize bytes_read;
+
+  if (!g_input_stream_read_all_finish (G_INPUT_STREAM (object), result, &bytes_read, NULL) ||
+      bytes_read != client->content_length)
+    {
+      fake_snapd_client_free (client);
+      return;
+    }
+
+  send_response (client);
+}
+
+static void
+read_line_cb (GObject      *object,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  FakeSnapdClient *client = user_data;
+  g_autofree char *line = NULL;
+
+  line = g_data_input_stream_read_line_finish (client->input, result, NULL, NULL);
+
+  /* The client closed the connection */
+  if (line == NULL)
+    {
+      fake_snapd_client_free (client);
+      return;
+    }
+
+  if (client->method == NULL)
+    {
+      g_auto(GStrv) tokens = g_strsplit (line, " ", 3);
+
+      g_assert_cmpuint (g_strv_length (tokens), ==, 3);
+      client->method = g_strdup (tokens[0]);
+      client->path = g_strdup (tokens[1]);
+    }
+  else if (*line == '\0')
+    {
+      /* End of the headers */
+      if (client->content_length == 0)
+        {
+          send_response (client);
+          return;
+        }
+
+      client->body = g_malloc0 (client->content_length + 1);
+      g_input_stream_read_all_async (G_INPUT_STREAM (client->input),
+                                     client->body,
+                                     client->content_length,
+                                     G_PRIORITY_DEFAULT,
+                                     NULL,
+                                     read_body_cb,
+                                     client);
+      return;
+    }
+  else if (g_ascii_strncasecmp (line, "Content-Length:", strlen ("Content-Length:")) == 0)
+    {
+      client->content_length = g_ascii_strtoull (line + strlen ("Content-Length:"), NULL, 10);
+    }
+
+  read_request_line (client);
+}
+
+static void
+read_request_line (FakeSnapdClient *client)
+{
+  g_data_input_stream_read_line_async (client->input,
+                                       G_PRIORITY_DEFAULT,
+                                       NULL,
+                                       read_line_cb,
+                                       client);
+}
+
+static gboolean
+incoming_cb (GSocketService    *service,
+             GSocketConnection *connection,
+             GObject           *source_object,
+             FakeSnapd         *self)
+{
+  FakeSnapdClient *client;
+
+  self->n_connections++;
+
+  client = g_new0 (FakeSnapdClient, 1);
+  client->snapd = self;
+  client->connection = g_object_ref (connection);
+  client->input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+  g_data_input_stream_set_newline_type (client->input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+  read_request_line (client);
+
+  return TRUE;
+}
+
+static FakeSnapd *
+fake_snapd_new (const char *socket_path)
+{
+  g_autoptr(GSocketAddress) address = NULL;
+  g_autoptr(GError) error = NULL;
+  FakeSnapd *self;
+
+  self = g_new0 (FakeSnapd, 1);
+  self->socket_path = g_strdup (socket_path);
+  self->n_requests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->service = g_socket_service_new ();
+
+  address = g_unix_socket_address_new (socket_path);
+  g_socket_listener_add_address (G_SOCKET_LISTENER (self->service),
+                                 address,
+                                 G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_DEFAULT,
+                                 NULL, NULL,
+                                 &error);
+  g_assert_no_error (error);
+
+  g_signal_connect (self->service, "incoming", G_CALLBACK (incoming_cb), self);
+  g_socket_service_start (self->service);
+
+  return self;
+}
+
+static void
+fake_snapd_free (FakeSnapd *self)
+{
+  g_socket_service_stop (self->service);
+  g_socket_listener_close (G_SOCKET_LISTENER (self->service));
+  g_clear_object (&self->service);
+  g_unlink (self->socket_path);
+  g_free (self->socket_path);
+  g_hash_table_unref (self->n_requests);
+  g_free (self);
+}
+
+static void
+fake_snapd_reset (FakeSnapd *self)
+{
+  self->n_connections = 0;
+  g_hash_table_remove_all (self->n_requests);
+}
+
+static guint
+fake_snapd_get_n_requests (FakeSnapd  *self,
+                           const char *path)
+{
+  guint *n_requests = g_hash_table_lookup (self->n_requests, path);
+
+  return n_requests ? *n_requests : 0;
+}
+
+/* Tests */
+
+typedef struct
+{
+  guint       n_pending;
+  JsonObject *object;
+  JsonArray  *plugs;
+  JsonArray  *slots;
+  char       *change_id;
+  GError     *error;
+} TestData;
+
+static void
+test_data_clear (TestData *data)
+{
+  g_clear_pointer (&data->object, json_object_unref);
+  g_clear_pointer (&data->plugs, json_array_unref);
+  g_clear_pointer (&data->slots, json_array_unref);
+  g_clear_pointer (&data->change_id, g_free);
+  g_clear_error (&data->error);
+}
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC (TestData, test_data_clear)
+
+static void
+wait_for_replies (TestData *data)
+{
+  while (data->n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+get_snap_cb (GObject      *object,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  TestData *data = user_data;
+
+  g_clear_pointer (&data->object, json_object_unref);
+  data->object = cc_snapd_client_get_snap_finish (CC_SNAPD_CLIENT (object), result, &data->error);
+  data->n_pending--;
+}
+
+static void
+get_change_cb (GObject      *object,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  TestData *data = user_data;
+
+  g_clear_pointer (&data->object, json_object_unref);
+  data->object = cc_snapd_client_get_change_finish (CC_SNAPD_CLIENT (object), result, &data->error);
+  data->n_pending--;
+}
+
+static void
+get_all_connections_cb (GObject      *object,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+  TestData *data = user_data;
+  JsonArray *plugs, *slots;
+
+  if (cc_snapd_client_get_all_connections_finish (CC_SNAPD_CLIENT (object), result,
+                                                  &plugs, &slots, &data->error))
+    {
+      g_clear_pointer (&data->plugs, json_array_unref);
+      g_clear_pointer (&data->slots, json_array_unref);
+      data->plugs = plugs;
+      data->slots = slots;
+    }
+  data->n_pending--;
+}
+
+static void
+connect_interface_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  TestData *data = user_data;
+
+  g_clear_pointer (&data->change_id, g_free);
+  data->change_id = cc_snapd_client_connect_interface_finish (CC_SNAPD_CLIENT (object), result, &data->error);
+  data->n_pending--;
+}
+
+static void
+test_get_snap (void)
+{
+  g_autoptr(CcSnapdClient) client = NULL;
+  g_auto(TestData) data = { 0, };
+
+  fake_snapd_reset (snapd);
+  client = cc_snapd_client_new_for_socket (snapd->socket_path);
+
+  data.n_pending = 1;
+  cc_snapd_client_get_snap_async (client, "app", NULL, get_snap_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpstr (json_object_get_string_member (data.object, "name"), ==, "app");
+  g_assert_cmpint (json_object_get_int_member (data.object, "installed-size"), ==, 12345);
+
+  /* The connection is kept alive for the next requests */
+  data.n_pending = 1;
+  cc_snapd_client_get_snap_async (client, "other", NULL, get_snap_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpstr (json_object_get_string_member (data.object, "name"), ==, "other");
+
+  g_assert_cmpuint (snapd->n_connections, ==, 1);
+  g_assert_cmpuint (fake_snapd_get_n_requests (snapd, "/v2/snaps/app"), ==, 1);
+  g_assert_cmpuint (fake_snapd_get_n_requests (snapd, "/v2/snaps/other"), ==, 1);
+}
+
+static void
+test_error (void)
+{
+  g_autoptr(CcSnapdClient) client = NULL;
+  g_auto(TestData) data = { 0, };
+
+  fake_snapd_reset (snapd);
+  client = cc_snapd_client_new_for_socket (snapd->socket_path);
+
+  data.n_pending = 1;
+  cc_snapd_client_get_change_async (client, "1", NULL, get_change_cb, &data);
+  wait_for_replies (&data);
+  g_assert_error (data.error, G_IO_ERROR, G_IO_ERROR_FAILED);
+  g_assert_null (data.object);
+}
+
+static void
+test_connections_cache (void)
+{
+  g_autoptr(CcSnapdClient) client = NULL;
+  g_auto(TestData) data = { 0, };
+  guint i;
+
+  fake_snapd_reset (snapd);
+  client = cc_snapd_client_new_for_socket (snapd->socket_path);
+
+  /* Requests made while one is in flight wait for it */
+  data.n_pending = 3;
+  for (i = 0; i < 3; i++)
+    cc_snapd_client_get_all_connections_async (client, NULL, get_all_connections_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpuint (json_array_get_length (data.plugs), ==, 1);
+  g_assert_cmpuint (json_array_get_length (data.slots), ==, 1);
+  g_assert_cmpuint (fake_snapd_get_n_requests (snapd, "/v2/connections?select=all"), ==, 1);
+
+  /* And the response is reused for a while */
+  data.n_pending = 1;
+  cc_snapd_client_get_all_connections_async (client, NULL, get_all_connections_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpuint (fake_snapd_get_n_requests (snapd, "/v2/connections?select=all"), ==, 1);
+
+  /* Unless interfaces are connected meanwhile */
+  data.n_pending = 1;
+  cc_snapd_client_connect_interface_async (client, "app", "camera", "system", "camera",
+                                           NULL, connect_interface_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpstr (data.change_id, ==, "42");
+
+  data.n_pending = 1;
+  cc_snapd_client_get_all_connections_async (client, NULL, get_all_connections_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpuint (fake_snapd_get_n_requests (snapd, "/v2/connections?select=all"), ==, 2);
+
+  /* Or a change completes */
+  data.n_pending = 1;
+  cc_snapd_client_get_change_async (client, "42", NULL, get_change_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_true (json_object_get_boolean_member (data.object, "ready"));
+
+  data.n_pending = 1;
+  cc_snapd_client_get_all_connections_async (client, NULL, get_all_connections_cb, &data);
+  wait_for_replies (&data);
+  g_assert_no_error (data.error);
+  g_assert_cmpuint (fake_snapd_get_n_requests (snapd, "/v2/connections?select=all"), ==, 3);
+
+  g_assert_cmpuint (snapd->n_connections, ==, 1);
+}
+
+static void
+test_cancelled (void)
+{
+  g_autoptr(CcSnapdClient) client = NULL;
+  g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+  g_auto(TestData) data = { 0, };
+
+  fake_snapd_reset (snapd);
+  client = cc_snapd_client_new_for_socket (snapd->socket_path);
+
+  /* Only the cancelled caller is affected by the cancellation */
+  data.n_pending = 2;
+  cc_snapd_client_get_all_connections_async (client, cancellable, get_all_connections_cb, &data);
+  cc_snapd_client_get_all_connections_async (client, NULL, get_all_connections_cb, &data);
+  g_cancellable_cancel (cancellable);
+  wait_for_replies (&data);
+  g_assert_error (data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_nonnull (data.plugs);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autofree char *socket_path = NULL;
+  char *test_dir;
+  int ret;
+
+  test_dir = test_utils_init (&argc, &argv, "test-snapd-client");
+
+  socket_path = g_build_filename (test_dir, "snapd.socket", NULL);
+  snapd = fake_snapd_new (socket_path);
+
+  g_test_add_func ("/applications/snapd-client/get-snap", test_get_snap);
+  g_test_add_func ("/applications/snapd-client/error", test_error);
+  g_test_add_func ("/applications/snapd-client/connections-cache", test_connections_cache);
+  g_test_add_func ("/applications/snapd-client/cancelled", test_cancelled);
+
+  ret = test_utils_run (test_dir);
+
+  fake_snapd_free (snapd);
+
+  return ret;
+}
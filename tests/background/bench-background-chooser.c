@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Fills the recent backgrounds directory with a synthetic collection of
+ * images, shows the background chooser, and reports how long it takes to
+ * load and scroll through it, along with how many tiles and how much
+ * memory it uses. With a recycling grid, the number of tiles must not
+ * depend on the number of images.
+ */
+
+#include "config.h"
+
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "cc-background-chooser.h"
+#include "test-utils.h"
+
+#define N_IMAGES 5000
+#define IMAGE_WIDTH 64
+#define IMAGE_HEIGHT 48
+
+static char *
+create_data_dir (void)
+{
+  g_autoptr(GdkPixbuf) pixbuf = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *backgrounds_dir = NULL;
+  char *data_dir;
+  guint i;
+
+  data_dir = g_dir_make_tmp ("bench-background-chooser-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  backgrounds_dir = g_build_filename (data_dir, "backgrounds", NULL);
+  g_assert_cmpint (g_mkdir (backgrounds_dir, 0700), ==, 0);
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, IMAGE_WIDTH, IMAGE_HEIGHT);
+
+  for (i = 0; i < N_IMAGES; i++)
+    {
+      g_autofree char *basename = g_strdup_printf ("image-%04u.png", i);
+      g_autofree char *filename = g_build_filename (backgrounds_dir, basename, NULL);
+
+      gdk_pixbuf_fill (pixbuf, g_random_int ());
+      gdk_pixbuf_save (pixbuf, filename, "png", &error, NULL);
+      g_assert_no_error (error);
+    }
+
+  return data_dir;
+}
+
+static GtkWidget *
+find_descendant (GtkWidget *widget,
+                 GType      type)
+{
+  GtkWidget *child;
+
+  if (G_TYPE_CHECK_INSTANCE_TYPE (widget, type))
+    return widget;
+
+  for (child = gtk_widget_get_first_child (widget); child; child = gtk_widget_get_next_sibling (child))
+    {
+      GtkWidget *found = find_descendant (child, type);
+
+      if (found)
+        return found;
+    }
+
+  return NULL;
+}
+
+static guint
+count_tiles (GtkWidget *grid_view)
+{
+  GtkWidget *child;
+  guint n_tiles = 0;
+
+  for (child = gtk_widget_get_first_child (grid_view); child; child = gtk_widget_get_next_sibling (child))
+    {
+      if (find_descendant (child, GTK_TYPE_PICTURE))
+        n_tiles++;
+    }
+
+  return n_tiles;
+}
+
+static gsize
+get_rss (void)
+{
+  g_autofree char *contents = NULL;
+  g_auto(GStrv) fields = NULL;
+
+  if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    return 0;
+
+  fields = g_strsplit (contents, " ", -1);
+  if (g_strv_length (fields) < 2)
+    return 0;
+
+  return g_ascii_strtoull (fields[1], NULL, 10) * sysconf (_SC_PAGESIZE);
+}
+
+static void
+iterate_until_idle (void)
+{
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+}
+
+static gint64
+wait_for_frame (GtkWidget *widget)
+{
+  GdkFrameClock *frame_clock;
+  gint64 start = g_get_monotonic_time ();
+  gint64 frame;
+
+  frame_clock = gtk_widget_get_frame_clock (widget);
+  frame = gdk_frame_clock_get_frame_counter (frame_clock);
+
+  gtk_widget_queue_draw (widget);
+  while (gdk_frame_clock_get_frame_counter (frame_clock) == frame)
+    g_main_context_iteration (NULL, TRUE);
+
+  return g_get_monotonic_time () - start;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autofree char *data_dir = NULL;
+  g_autofree char *cache_dir = NULL;
+  GtkAdjustment *vadjustment;
+  GtkWidget *chooser;
+  GtkWidget *scrolled_window;
+  GtkWidget *grid_view;
+  GtkWidget *window;
+  GListModel *model;
+  gsize rss_before;
+  gint64 scroll_time = 0;
+  gint64 start;
+  guint max_tiles = 0;
+  guint n_frames = 0;
+
+  g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+  g_setenv ("GTK_A11Y", "none", TRUE);
+
+  data_dir = create_data_dir ();
+  cache_dir = g_build_filename (data_dir, "cache", NULL);
+  g_setenv ("XDG_DATA_HOME", data_dir, TRUE);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  if (!gtk_init_check ())
+    {
+      g_print ("No display available, skipping\n");
+      test_utils_remove_dir (data_dir);
+      return 77;
+    }
+
+  rss_before = get_rss ();
+
+  start = g_get_monotonic_time ();
+
+  window = gtk_window_new ();
+  gtk_window_set_default_size (GTK_WINDOW (window), 800, 600);
+
+  chooser = g_object_new (CC_TYPE_BACKGROUND_CHOOSER, NULL);
+  gtk_window_set_child (GTK_WINDOW (window), chooser);
+  gtk_window_present (GTK_WINDOW (window));
+
+  grid_view = find_descendant (chooser, GTK_TYPE_GRID_VIEW);
+  g_assert_nonnull (grid_view);
+
+  model = G_LIST_MODEL (gtk_grid_view_get_model (GTK_GRID_VIEW (grid_view)));
+  while (g_list_model_get_n_items (model) < N_IMAGES)
+    g_main_context_iteration (NULL, TRUE);
+
+  wait_for_frame (window);
+  iterate_until_idle ();
+
+  g_print ("Loaded %u backgrounds in %.1f ms\n",
+           g_list_model_get_n_items (model),
+           (g_get_monotonic_time () - start) / 1000.0);
+  g_print ("Tiles after loading: %u\n", count_tiles (grid_view));
+
+  /* Scroll through the whole collection, a page per frame */
+  scrolled_window = gtk_widget_get_ancestor (grid_view, GTK_TYPE_SCROLLED_WINDOW);
+  vadjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (scrolled_window));
+
+  while (gtk_adjustment_get_value (vadjustment) + gtk_adjustment_get_page_size (vadjustment) <
+         gtk_adjustment_get_upper (vadjustment))
+    {
+      double value = gtk_adjustment_get_value (vadjustment);
+
+      gtk_adjustment_set_value (vadjustment, value + gtk_adjustment_get_page_size (vadjustment));
+      if (gtk_adjustment_get_value (vadjustment) <= value)
+        break;
+
+      scroll_time += wait_for_frame (window);
+      max_tiles = MAX (max_tiles, count_tiles (grid_view));
+      n_frames++;
+    }
+
+  iterate_until_idle ();
+
+  g_print ("Scrolled through %u pages, %.2f ms per page\n",
+           n_frames,
+           n_frames > 0 ? scroll_time / 1000.0 / n_frames : 0.0);
+  g_print ("Maximum tiles while scrolling: %u\n", max_tiles);
+  g_print ("Resident memory growth: %.1f MiB\n",
+           (get_rss () - rss_before) / (1024.0 * 1024.0));
+
+  /* Only the tiles in view should exist, not one per background */
+  g_assert_cmpuint (max_tiles, <, N_IMAGES / 10);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  iterate_until_idle ();
+
+  test_utils_remove_dir (data_dir);
+
+  return 0;
+}
@@ -0,0 +1,344 @@
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "cc-background-item.h"
+#include "cc-background-xml.h"
+
+#define WALLPAPER_TEMPLATE \
+  "  <wallpaper deleted=\"false\">\n" \
+  "    <name>%s</name>\n" \
+  "    <filename>%s</filename>\n" \
+  "    <options>zoom</options>\n" \
+  "    <shade_type>solid</shade_type>\n" \
+  "    <pcolor>%s</pcolor>\n" \
+  "    <scolor>#000000</scolor>\n" \
+  "  </wallpaper>\n"
+
+static char *test_dir;
+
+typedef struct
+{
+  GPtrArray *added;
+  GPtrArray *removed;
+} Changes;
+
+static void
+on_added_cb (CcBackgroundXml  *xml,
+             CcBackgroundItem *item,
+             Changes          *changes)
+{
+  g_ptr_array_add (changes->added, g_strdup (cc_background_item_get_name (item)));
+}
+
+static void
+on_removed_cb (CcBackgroundXml  *xml,
+               CcBackgroundItem *item,
+               Changes          *changes)
+{
+  g_ptr_array_add (changes->removed, g_strdup (cc_background_item_get_name (item)));
+}
+
+static CcBackgroundXml *
+create_xml (Changes *changes)
+{
+  CcBackgroundXml *xml;
+
+  changes->added = g_ptr_array_new_with_free_func (g_free);
+  changes->removed = g_ptr_array_new_with_free_func (g_free);
+
+  xml = cc_background_xml_new ();
+  g_signal_connect (xml, "added", G_CALLBACK (on_added_cb), changes);
+  g_signal_connect (xml, "removed", G_CALLBACK (on_removed_cb), changes);
+
+  return xml;
+}
+
+static void
+changes_clear (Changes *changes)
+{
+  g_clear_pointer (&changes->added, g_ptr_array_unref);
+  g_clear_pointer (&changes->removed, g_ptr_array_unref);
+}
+
+static void
+changes_reset (Changes *changes)
+{
+  g_ptr_array_set_size (changes->added, 0);
+  g_ptr_array_set_size (changes->removed, 0);
+}
+
+static void
+touch_image (const char *basename)
+{
+  g_autofree char *filename = g_build_filename (test_dir, basename, NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_file_set_contents (filename, "", 0, &error);
+  g_assert_no_error (error);
+}
+
+static char *
+write_xml_valist (guint64      mtime,
+                  const char  *pcolor,
+                  const char  *first_name,
+                  va_list      args)
+{
+  g_autoptr(GString) contents = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GFile) file = NULL;
+  const char *name;
+  char *filename;
+
+  contents = g_string_new ("<?xml version=\"1.0\"?>\n<wallpapers>\n");
+
+  for (name = first_name; name != NULL; name = va_arg (args, const char *))
+    {
+      const char *image = va_arg (args, const char *);
+      g_string_append_printf (contents, WALLPAPER_TEMPLATE, name, image, pcolor);
+    }
+
+  g_string_append (contents, "</wallpapers>\n");
+
+  filename = g_build_filename (test_dir, "wallpapers.xml", NULL);
+  g_file_set_contents (filename, contents->str, contents->len, &error);
+  g_assert_no_error (error);
+
+  file = g_file_new_for_path (filename);
+  g_file_set_attribute_uint64 (file, G_FILE_ATTRIBUTE_TIME_MODIFIED, mtime,
+                               G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+  g_file_set_attribute_uint32 (file, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC, 0,
+                               G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+
+  return filename;
+}
+
+/* Writes the wallpapers, given as name and filename pairs, and sets the
+ * modification time of the file to @mtime */
+static char *
+write_xml (guint64      mtime,
+           const char  *first_name,
+           ...)
+{
+  char *filename;
+  va_list args;
+
+  va_start (args, first_name);
+  filename = write_xml_valist (mtime, "#3465a4", first_name, args);
+  va_end (args);
+
+  return filename;
+}
+
+/* Same as write_xml(), with @pcolor as the primary color of all the
+ * wallpapers */
+static char *
+write_xml_with_color (guint64      mtime,
+                      const char  *pcolor,
+                      const char  *first_name,
+                      ...)
+{
+  char *filename;
+  va_list args;
+
+  va_start (args, first_name);
+  filename = write_xml_valist (mtime, pcolor, first_name, args);
+  va_end (args);
+
+  return filename;
+}
+
+static gboolean
+contains (GPtrArray  *names,
+          const char *name)
+{
+  return g_ptr_array_find_with_equal_func (names, name, g_str_equal, NULL);
+}
+
+static void
+test_reload_diff (void)
+{
+  g_autoptr(CcBackgroundXml) xml = NULL;
+  g_autofree char *filename = NULL;
+  Changes changes;
+
+  touch_image ("a.png");
+  touch_image ("b.png");
+  touch_image ("c.png");
+
+  xml = create_xml (&changes);
+
+  filename = write_xml (1000000, "Alpha", "a.png", "Bravo", "b.png", NULL);
+  g_assert_true (cc_background_xml_load_xml (xml, filename));
+  g_assert_cmpuint (changes.added->len, ==, 2);
+  g_assert_cmpuint (changes.removed->len, ==, 0);
+
+  /* Loading the same file again doesn't signal anything */
+  changes_reset (&changes);
+  g_assert_false (cc_background_xml_load_xml (xml, filename));
+  g_assert_cmpuint (changes.added->len, ==, 0);
+  g_assert_cmpuint (changes.removed->len, ==, 0);
+
+  /* Only the differences are signalled when the file changes */
+  changes_reset (&changes);
+  g_free (write_xml (2000000, "Bravo", "b.png", "Charlie", "c.png", NULL));
+  g_assert_true (cc_background_xml_load_xml (xml, filename));
+  g_assert_cmpuint (changes.added->len, ==, 1);
+  g_assert_true (contains (changes.added, "Charlie"));
+  g_assert_cmpuint (changes.removed->len, ==, 1);
+  g_assert_true (contains (changes.removed, "Alpha"));
+
+  changes_clear (&changes);
+}
+
+static void
+test_reload_changed (void)
+{
+  g_autoptr(CcBackgroundXml) xml = NULL;
+  g_autofree char *filename = NULL;
+  Changes changes;
+
+  touch_image ("a.png");
+
+  xml = create_xml (&changes);
+
+  filename = write_xml (5000000, "Hotel", "a.png", NULL);
+  g_assert_true (cc_background_xml_load_xml (xml, filename));
+  g_assert_cmpuint (changes.added->len, ==, 1);
+
+  /* The id doesn't depend on the colors, but the item is replaced */
+  changes_reset (&changes);
+  g_free (write_xml_with_color (6000000, "#ff0000", "Hotel", "a.png", NULL));
+  g_assert_true (cc_background_xml_load_xml (xml, filename));
+  g_assert_cmpuint (changes.removed->len, ==, 1);
+  g_assert_true (contains (changes.removed, "Hotel"));
+  g_assert_cmpuint (changes.added->len, ==, 1);
+  g_assert_true (contains (changes.added, "Hotel"));
+
+  changes_clear (&changes);
+}
+
+static void
+test_cache_lookup (void)
+{
+  g_autoptr(CcBackgroundXml) xml = NULL;
+  g_autoptr(CcBackgroundXml) other_xml = NULL;
+  g_autofree char *filename = NULL;
+  Changes changes;
+  Changes other_changes;
+
+  touch_image ("a.png");
+
+  xml = create_xml (&changes);
+  filename = write_xml (3000000, "Delta", "a.png", NULL);
+  g_assert_true (cc_background_xml_load_xml (xml, filename));
+  g_assert_true (contains (changes.added, "Delta"));
+
+  /* A file with the same path, size and modification time isn't parsed
+   * again, so the new name isn't seen
+   */
+  g_free (write_xml (3000000, "Gamma", "a.png", NULL));
+
+  other_xml = create_xml (&other_changes);
+  g_assert_true (cc_background_xml_load_xml (other_xml, filename));
+  g_assert_cmpuint (other_changes.added->len, ==, 1);
+  g_assert_true (contains (other_changes.added, "Delta"));
+
+  changes_clear (&changes);
+  changes_clear (&other_changes);
+}
+
+static void
+test_cache_persistence (void)
+{
+  g_autoptr(CcBackgroundXml) xml = NULL;
+  g_autofree char *filename = NULL;
+  Changes changes;
+
+  /* A new process only sees the file through the cache on disk, so it
+   * gets the name from before the change
+   */
+  if (g_test_subprocess ())
+    {
+      filename = g_build_filename (test_dir, "wallpapers.xml", NULL);
+
+      xml = create_xml (&changes);
+      g_assert_true (cc_background_xml_load_xml (xml, filename));
+      g_assert_cmpuint (changes.added->len, ==, 1);
+      g_assert_true (contains (changes.added, "Echo"));
+
+      changes_clear (&changes);
+      return;
+    }
+
+  touch_image ("a.png");
+
+  xml = create_xml (&changes);
+  filename = write_xml (4000000, "Echo", "a.png", NULL);
+  g_assert_true (cc_background_xml_load_xml (xml, filename));
+
+  g_free (write_xml (4000000, "Golf", "a.png", NULL));
+
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_DEFAULT);
+  g_test_trap_assert_passed ();
+
+  changes_clear (&changes);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autofree char *cache_dir = NULL;
+  int ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* Subprocesses share the directory of the parent */
+  if (g_test_subprocess ())
+    {
+      test_dir = g_strdup (g_getenv ("TEST_BACKGROUND_XML_DIR"));
+    }
+  else
+    {
+      g_autoptr(GError) error = NULL;
+
+      test_dir = g_dir_make_tmp ("test-background-xml-XXXXXX", &error);
+      g_assert_no_error (error);
+      g_setenv ("TEST_BACKGROUND_XML_DIR", test_dir, TRUE);
+    }
+
+  cache_dir = g_build_filename (test_dir, "cache", NULL);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  g_test_add_func ("/background/xml/reload-diff", test_reload_diff);
+  g_test_add_func ("/background/xml/reload-changed", test_reload_changed);
+  g_test_add_func ("/background/xml/cache-lookup", test_cache_lookup);
+  g_test_add_func ("/background/xml/cache-persistence", test_cache_persistence);
+
+  ret = g_test_run ();
+
+  if (!g_test_subprocess ())
+    {
+      const char *names[] = { "a.png", "b.png", "c.png", "wallpapers.xml" };
+      g_autofree char *cache_file = g_build_filename (cache_dir, "gnome-control-center", "background-properties.cache", NULL);
+      g_autofree char *cache_subdir = g_build_filename (cache_dir, "gnome-control-center", NULL);
+      guint i;
+
+      for (i = 0; i < G_N_ELEMENTS (names); i++)
+        {
+          g_autofree char *filename = g_build_filename (test_dir, names[i], NULL);
+          g_unlink (filename);
+        }
+
+      g_unlink (cache_file);
+      g_rmdir (cache_subdir);
+      g_rmdir (cache_dir);
+      g_rmdir (test_dir);
+    }
+
+  g_free (test_dir);
+
+  return ret;
+}
@@ -0,0 +1,163 @@
+#include "config.h"
+
+#include <utime.h>
+#include <glib/gstdio.h>
+
+#include "cc-background-thumbnail-cache.h"
+
+static GdkPixbuf *
+create_noise_pixbuf (int size)
+{
+  GdkPixbuf *pixbuf;
+  guchar *pixels;
+  int rowstride;
+  int x, y;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, size, size);
+  pixels = gdk_pixbuf_get_pixels (pixbuf);
+  rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+
+  /* Noise doesn't compress, so the entries have a predictable size */
+  for (y = 0; y < size; y++)
+    for (x = 0; x < size * 3; x++)
+      pixels[y * rowstride + x] = g_random_int_range (0, 256);
+
+  return pixbuf;
+}
+
+static char *
+create_cache_dir (void)
+{
+  g_autoptr(GError) error = NULL;
+  char *path;
+
+  path = g_dir_make_tmp ("test-thumbnail-cache-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  return path;
+}
+
+static void
+remove_cache_dir (const char *path)
+{
+  g_autoptr(GDir) dir = NULL;
+  const char *name;
+
+  dir = g_dir_open (path, 0, NULL);
+  while (dir && (name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *filename = g_build_filename (path, name, NULL);
+      g_unlink (filename);
+    }
+
+  g_rmdir (path);
+}
+
+static void
+test_store_lookup (void)
+{
+  g_autoptr(CcBackgroundThumbnailCache) cache = NULL;
+  g_autoptr(GdkPixbuf) pixbuf = NULL;
+  g_autoptr(GdkPixbuf) cached = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *path = NULL;
+
+  path = create_cache_dir ();
+  cache = cc_background_thumbnail_cache_new (path, 1024 * 1024);
+
+  g_assert_null (cc_background_thumbnail_cache_lookup (cache, "file:///a.jpg\n1\n64x64@1\nlight"));
+
+  pixbuf = create_noise_pixbuf (64);
+  cc_background_thumbnail_cache_store (cache, "file:///a.jpg\n1\n64x64@1\nlight", pixbuf, &error);
+  g_assert_no_error (error);
+
+  cached = cc_background_thumbnail_cache_lookup (cache, "file:///a.jpg\n1\n64x64@1\nlight");
+  g_assert_nonnull (cached);
+  g_assert_cmpint (gdk_pixbuf_get_width (cached), ==, 64);
+  g_assert_cmpint (gdk_pixbuf_get_height (cached), ==, 64);
+  g_assert_cmpmem (gdk_pixbuf_read_pixels (cached), 64 * gdk_pixbuf_get_rowstride (cached),
+                   gdk_pixbuf_read_pixels (pixbuf), 64 * gdk_pixbuf_get_rowstride (pixbuf));
+
+  /* Any change in the key is a different thumbnail */
+  g_assert_null (cc_background_thumbnail_cache_lookup (cache, "file:///a.jpg\n2\n64x64@1\nlight"));
+  g_assert_null (cc_background_thumbnail_cache_lookup (cache, "file:///a.jpg\n1\n64x64@1\ndark"));
+
+  remove_cache_dir (path);
+}
+
+static void
+test_eviction (void)
+{
+  g_autoptr(CcBackgroundThumbnailCache) cache = NULL;
+  g_autoptr(GdkPixbuf) pixbuf = NULL;
+  g_autofree char *path = NULL;
+  guint64 entry_size;
+  gint64 now;
+  guint i;
+
+  path = create_cache_dir ();
+  pixbuf = create_noise_pixbuf (64);
+
+  /* Measure the size of an entry */
+  cache = cc_background_thumbnail_cache_new (path, G_MAXUINT64);
+  g_assert_true (cc_background_thumbnail_cache_store (cache, "probe", pixbuf, NULL));
+  entry_size = cc_background_thumbnail_cache_get_size (cache);
+  g_assert_cmpuint (entry_size, >, 0);
+  g_clear_object (&cache);
+  remove_cache_dir (path);
+
+  /* Room for 4 entries and a half */
+  cache = cc_background_thumbnail_cache_new (path, entry_size * 9 / 2);
+  now = g_get_real_time () / G_USEC_PER_SEC;
+
+  for (i = 0; i < 10; i++)
+    {
+      g_autofree char *key = g_strdup_printf ("entry %u", i);
+      g_autofree char *filename = NULL;
+      g_autofree char *checksum = NULL;
+      g_autofree char *basename = NULL;
+      struct utimbuf times;
+
+      g_assert_true (cc_background_thumbnail_cache_store (cache, key, pixbuf, NULL));
+      g_assert_cmpuint (cc_background_thumbnail_cache_get_size (cache), <=, entry_size * 9 / 2);
+
+      /* Make the entries used in order, the mtime resolution is too coarse */
+      checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+      basename = g_strconcat (checksum, ".png", NULL);
+      filename = g_build_filename (path, basename, NULL);
+      times.actime = times.modtime = now - 100 + i;
+      g_assert_cmpint (g_utime (filename, &times), ==, 0);
+
+      /* Looking up an entry makes it the most recently used */
+      if (i == 7)
+        {
+          g_autoptr(GdkPixbuf) cached = cc_background_thumbnail_cache_lookup (cache, "entry 4");
+          g_assert_nonnull (cached);
+        }
+    }
+
+  /* Each eviction keeps 3 entries, so 4, 7, 8 and 9 are left */
+  for (i = 0; i < 10; i++)
+    {
+      g_autofree char *key = g_strdup_printf ("entry %u", i);
+      g_autoptr(GdkPixbuf) cached = cc_background_thumbnail_cache_lookup (cache, key);
+
+      if (i == 4 || i >= 7)
+        g_assert_nonnull (cached);
+      else
+        g_assert_null (cached);
+    }
+
+  remove_cache_dir (path);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/background/thumbnail-cache/store-lookup", test_store_lookup);
+  g_test_add_func ("/background/thumbnail-cache/eviction", test_eviction);
+
+  return g_test_run ();
+}
@@ -0,0 +1,233 @@
+#include "config.h"
+
+#include "cc-background-thumbnail-scheduler.h"
+
+static GMutex mutex;
+static GCond cond;
+static gboolean blocker_running;
+static gboolean blocker_released;
+static GPtrArray *rendered;
+
+static GdkPixbuf *
+render_func (GTask   *task,
+             GError **error)
+{
+  const char *name = g_task_get_task_data (task);
+
+  g_mutex_lock (&mutex);
+
+  g_ptr_array_add (rendered, g_strdup (name));
+
+  /* The first job holds the only thread until the test releases it */
+  if (g_str_equal (name, "blocker"))
+    {
+      blocker_running = TRUE;
+      g_cond_broadcast (&cond);
+
+      while (!blocker_released)
+        g_cond_wait (&cond, &mutex);
+    }
+
+  g_mutex_unlock (&mutex);
+
+  return gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, 1, 1);
+}
+
+typedef struct
+{
+  guint      n_pending;
+  GdkPixbuf *pixbufs[8];
+  GError    *errors[8];
+} Results;
+
+static void
+task_done_cb (GObject      *object,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  Results *results = user_data;
+  guint index = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (result), "index"));
+
+  results->pixbufs[index] = g_task_propagate_pointer (G_TASK (result), &results->errors[index]);
+  results->n_pending--;
+}
+
+static void
+push (CcBackgroundThumbnailScheduler *scheduler,
+      Results                        *results,
+      guint                           index,
+      const char                     *name,
+      GCancellable                   *cancellable)
+{
+  g_autoptr(GTask) task = NULL;
+
+  task = g_task_new (NULL, cancellable, task_done_cb, results);
+  g_task_set_task_data (task, g_strdup (name), g_free);
+  g_object_set_data (G_OBJECT (task), "index", GUINT_TO_POINTER (index));
+
+  results->n_pending++;
+  cc_background_thumbnail_scheduler_push (scheduler, task, name, render_func);
+}
+
+static void
+start_blocker (CcBackgroundThumbnailScheduler *scheduler,
+               Results                        *results)
+{
+  blocker_running = FALSE;
+  blocker_released = FALSE;
+  g_ptr_array_set_size (rendered, 0);
+
+  push (scheduler, results, 0, "blocker", NULL);
+
+  g_mutex_lock (&mutex);
+  while (!blocker_running)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+}
+
+static void
+release_blocker_and_wait (Results *results)
+{
+  g_mutex_lock (&mutex);
+  blocker_released = TRUE;
+  g_cond_broadcast (&cond);
+  g_mutex_unlock (&mutex);
+
+  while (results->n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+results_clear (Results *results)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (results->pixbufs); i++)
+    {
+      g_clear_object (&results->pixbufs[i]);
+      g_clear_error (&results->errors[i]);
+    }
+}
+
+static void
+test_order (void)
+{
+  g_autoptr(CcBackgroundThumbnailScheduler) scheduler = NULL;
+  Results results = { 0, };
+
+  scheduler = cc_background_thumbnail_scheduler_new (1);
+  start_blocker (scheduler, &results);
+
+  push (scheduler, &results, 1, "first", NULL);
+  push (scheduler, &results, 2, "second", NULL);
+  push (scheduler, &results, 3, "third", NULL);
+
+  /* Asking again doesn't move the job */
+  push (scheduler, &results, 4, "first", NULL);
+
+  g_assert_cmpuint (cc_background_thumbnail_scheduler_get_n_queued (scheduler), ==, 3);
+
+  release_blocker_and_wait (&results);
+
+  g_assert_cmpuint (rendered->len, ==, 4);
+  g_assert_cmpstr (g_ptr_array_index (rendered, 0), ==, "blocker");
+  g_assert_cmpstr (g_ptr_array_index (rendered, 1), ==, "first");
+  g_assert_cmpstr (g_ptr_array_index (rendered, 2), ==, "second");
+  g_assert_cmpstr (g_ptr_array_index (rendered, 3), ==, "third");
+
+  results_clear (&results);
+}
+
+static void
+test_coalescing (void)
+{
+  g_autoptr(CcBackgroundThumbnailScheduler) scheduler = NULL;
+  Results results = { 0, };
+
+  scheduler = cc_background_thumbnail_scheduler_new (1);
+  start_blocker (scheduler, &results);
+
+  push (scheduler, &results, 1, "light", NULL);
+  push (scheduler, &results, 2, "dark", NULL);
+  push (scheduler, &results, 3, "light", NULL);
+  push (scheduler, &results, 4, "dark", NULL);
+
+  g_assert_cmpuint (cc_background_thumbnail_scheduler_get_n_queued (scheduler), ==, 2);
+
+  release_blocker_and_wait (&results);
+
+  /* Each thumbnail is rendered once, and shared by the requests */
+  g_assert_cmpuint (rendered->len, ==, 3);
+  g_assert_nonnull (results.pixbufs[1]);
+  g_assert_true (results.pixbufs[1] == results.pixbufs[3]);
+  g_assert_nonnull (results.pixbufs[2]);
+  g_assert_true (results.pixbufs[2] == results.pixbufs[4]);
+  g_assert_true (results.pixbufs[1] != results.pixbufs[2]);
+
+  results_clear (&results);
+}
+
+static void
+test_cancellation (void)
+{
+  g_autoptr(CcBackgroundThumbnailScheduler) scheduler = NULL;
+  g_autoptr(GCancellable) cancellable = NULL;
+  g_autoptr(GCancellable) shared_cancellable = NULL;
+  g_autoptr(GCancellable) cancelled = NULL;
+  Results results = { 0, };
+
+  scheduler = cc_background_thumbnail_scheduler_new (1);
+  start_blocker (scheduler, &results);
+
+  cancellable = g_cancellable_new ();
+  shared_cancellable = g_cancellable_new ();
+  cancelled = g_cancellable_new ();
+  g_cancellable_cancel (cancelled);
+
+  push (scheduler, &results, 1, "scrolled-out", cancellable);
+  push (scheduler, &results, 2, "shared", shared_cancellable);
+  push (scheduler, &results, 3, "shared", NULL);
+  push (scheduler, &results, 4, "already-cancelled", cancelled);
+
+  g_assert_cmpuint (cc_background_thumbnail_scheduler_get_n_queued (scheduler), ==, 2);
+
+  /* Dropping the only request drops the job, but a job is kept as
+   * long as one of its requests is still interested
+   */
+  g_cancellable_cancel (cancellable);
+  g_cancellable_cancel (shared_cancellable);
+
+  g_assert_cmpuint (cc_background_thumbnail_scheduler_get_n_queued (scheduler), ==, 1);
+
+  release_blocker_and_wait (&results);
+
+  g_assert_cmpuint (rendered->len, ==, 2);
+  g_assert_cmpstr (g_ptr_array_index (rendered, 1), ==, "shared");
+
+  g_assert_error (results.errors[1], G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_error (results.errors[2], G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_nonnull (results.pixbufs[3]);
+  g_assert_error (results.errors[4], G_IO_ERROR, G_IO_ERROR_CANCELLED);
+
+  results_clear (&results);
+}
+
+int
+main (int argc, char **argv)
+{
+  int ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  rendered = g_ptr_array_new_with_free_func (g_free);
+
+  g_test_add_func ("/background/thumbnail-scheduler/order", test_order);
+  g_test_add_func ("/background/thumbnail-scheduler/coalescing", test_coalescing);
+  g_test_add_func ("/background/thumbnail-scheduler/cancellation", test_cancellation);
+
+  ret = g_test_run ();
+
+  g_ptr_array_unref (rendered);
+
+  return ret;
+}
@@ -0,0 +1,73 @@
+#include "config.h"
+
+#include <string.h>
+#include <gio/gdesktopappinfo.h>
+
+#include "test-shell-model.h"
+
+static void
+add_panels_from_dir (CcShellModel *model,
+                     const gchar  *panel_dir)
+{
+  g_autoptr(GDir) dir = NULL;
+  const gchar *name;
+
+  dir = g_dir_open (panel_dir, 0, NULL);
+  if (!dir)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autoptr(GDesktopAppInfo) app = NULL;
+      g_autoptr(GKeyFile) keyfile = NULL;
+      g_autofree gchar *path = NULL;
+      g_autofree gchar *id = NULL;
+
+      if (!g_str_has_prefix (name, "gnome-") || !g_str_has_suffix (name, "-panel.desktop.in"))
+        continue;
+
+      path = g_build_filename (panel_dir, name, NULL);
+      keyfile = g_key_file_new ();
+      if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, NULL))
+        continue;
+
+      app = g_desktop_app_info_new_from_keyfile (keyfile);
+      if (!app)
+        continue;
+
+      id = g_strndup (name + strlen ("gnome-"),
+                      strlen (name) - strlen ("gnome-") - strlen ("-panel.desktop.in"));
+      cc_shell_model_add_item (model, CC_CATEGORY_SYSTEM, G_APP_INFO (app), id);
+    }
+}
+
+/**
+ * test_shell_model_new:
+ *
+ * Creates a #CcShellModel holding every panel shipped in the source
+ * tree, read from the untranslated desktop files of the panels.
+ *
+ * Returns: (transfer full): a new #CcShellModel
+ */
+CcShellModel *
+test_shell_model_new (void)
+{
+  g_autoptr(GDir) dir = NULL;
+  g_autofree gchar *panels_dir = NULL;
+  CcShellModel *model;
+  const gchar *name;
+
+  model = cc_shell_model_new ();
+  panels_dir = g_build_filename (TEST_TOPSRCDIR, "panels", NULL);
+
+  dir = g_dir_open (panels_dir, 0, NULL);
+  g_assert_nonnull (dir);
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree gchar *panel_dir = g_build_filename (panels_dir, name, NULL);
+      add_panels_from_dir (model, panel_dir);
+    }
+
+  return model;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "cc-shell-model.h"
+
+G_BEGIN_DECLS
+
+CcShellModel *test_shell_model_new (void);
+
+G_END_DECLS
@@ -0,0 +1,85 @@
+#include "config.h"
+
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+
+#include "test-utils.h"
+
+/**
+ * test_utils_remove_dir:
+ * @path: the directory to remove
+ *
+ * Removes @path and everything below it. Symbolic links are removed
+ * themselves and never followed, so a test linking to a directory
+ * outside of its temporary one doesn't empty it.
+ */
+void
+test_utils_remove_dir (const char *path)
+{
+  g_autoptr(GDir) dir = NULL;
+  const char *name;
+
+  dir = g_dir_open (path, 0, NULL);
+  while (dir && (name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *filename = g_build_filename (path, name, NULL);
+      GStatBuf buf;
+
+      if (g_lstat (filename, &buf) == 0 && S_ISDIR (buf.st_mode))
+        test_utils_remove_dir (filename);
+      else
+        g_unlink (filename);
+    }
+
+  g_rmdir (path);
+}
+
+/**
+ * test_utils_init:
+ * @argc: the address of the argc parameter of main()
+ * @argv: the address of the argv parameter of main()
+ * @name: the name of the test
+ *
+ * Initializes the GLib testing framework and creates a temporary
+ * directory for the test, named after @name.
+ *
+ * Returns: (transfer full): the path of the temporary directory
+ */
+char *
+test_utils_init (int          *argc,
+                 char       ***argv,
+                 const char   *name)
+{
+  g_autoptr(GError) error = NULL;
+  g_autofree char *tmpl = NULL;
+  char *test_dir;
+
+  g_test_init (argc, argv, NULL);
+
+  tmpl = g_strdup_printf ("%s-XXXXXX", name);
+  test_dir = g_dir_make_tmp (tmpl, &error);
+  g_assert_no_error (error);
+
+  return test_dir;
+}
+
+/**
+ * test_utils_run:
+ * @test_dir: (transfer full): the directory from test_utils_init()
+ *
+ * Runs the tests, then removes @test_dir.
+ *
+ * Returns: the exit status of the tests
+ */
+int
+test_utils_run (char *test_dir)
+{
+  int ret;
+
+  ret = g_test_run ();
+
+  test_utils_remove_dir (test_dir);
+  g_free (test_dir);
+
+  return ret;
+}
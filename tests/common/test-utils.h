@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void  test_utils_remove_dir (const char   *path);
+
+char *test_utils_init       (int          *argc,
+                             char       ***argv,
+                             const char   *name);
+
+int   test_utils_run        (char         *test_dir);
+
+G_END_DECLS
@@ -34,6 +34,8 @@
 #include <gtk/gtk.h>
 
 #include "cc-test-window.h"
+#include "cc-wifi-connection-list.h"
+#include "cc-wifi-connection-row.h"
 #include "shell/cc-object-storage.h"
 
 #include "nmtst-helpers.h"
@@ -43,6 +45,7 @@ typedef struct {
   NMClient *client;
 
   NMDevice *main_ether;
+  NMDevice *main_wifi;
 
   GtkWindow *shell;
   CcPanel *panel;
@@ -116,6 +119,18 @@ fixture_set_up_wired (NetworkPanelFixture  *fixture,
   nmtst_remove_device (fixture->sinfo, fixture->client, second);
 }
 
+static void
+fixture_set_up_wifi (NetworkPanelFixture  *fixture,
+                     gconstpointer         user_data)
+{
+  fixture_set_up_empty (fixture, user_data);
+
+  fixture->main_wifi = nmtstc_service_add_device (fixture->sinfo,
+                                                  fixture->client,
+                                                  "AddWifiDevice",
+                                                  "wlan1000");
+}
+
 /*****************************************************************************/
 
 static GtkWidget *
@@ -417,6 +432,223 @@ test_connection_add (NetworkPanelFixture  *fixture,
   g_assert_nonnull (find_label (GTK_WIDGET (fixture->shell), "Cable unplugged"));
 }
 
+static void
+add_access_point (NetworkPanelFixture *fixture,
+                  const gchar         *ssid,
+                  const gchar         *bssid)
+{
+  g_autoptr(GVariant) ret = NULL;
+  g_autoptr(GError) error = NULL;
+  WAIT_DECL()
+
+  WAIT_DEVICE(fixture->main_wifi, 1, "access-point-added")
+
+  ret = g_dbus_proxy_call_sync (fixture->sinfo->proxy,
+                                "AddWifiAp",
+                                g_variant_new ("(sss)", "wlan1000", ssid, bssid),
+                                G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                                3000,
+                                NULL,
+                                &error);
+  g_assert_no_error (error);
+
+  WAIT_FINISHED(5)
+}
+
+static GPtrArray *
+list_rows (CcWifiConnectionList *list)
+{
+  GtkListBox *listbox = cc_wifi_connection_list_get_list_box (list);
+  GPtrArray *rows = g_ptr_array_new ();
+  GtkWidget *child;
+
+  for (child = gtk_widget_get_first_child (GTK_WIDGET (listbox));
+       child;
+       child = gtk_widget_get_next_sibling (child)) {
+    if (CC_IS_WIFI_CONNECTION_ROW (child))
+      g_ptr_array_add (rows, child);
+  }
+
+  return rows;
+}
+
+static CcWifiConnectionRow *
+find_row_for_ssid (CcWifiConnectionList *list,
+                   const gchar          *ssid)
+{
+  g_autoptr(GPtrArray) rows = list_rows (list);
+  guint i;
+
+  for (i = 0; i < rows->len; i++) {
+    CcWifiConnectionRow *row = g_ptr_array_index (rows, i);
+    NMAccessPoint *ap = cc_wifi_connection_row_best_access_point (row);
+    GBytes *ap_ssid = ap ? nm_access_point_get_ssid (ap) : NULL;
+
+    if (ap_ssid && nm_utils_same_ssid (g_bytes_get_data (ap_ssid, NULL), g_bytes_get_size (ap_ssid),
+                                       (const guint8 *) ssid, strlen (ssid), TRUE))
+      return row;
+  }
+
+  return NULL;
+}
+
+static void
+count_row_cb (CcWifiConnectionList *list,
+              CcWifiConnectionRow  *row,
+              guint                *count)
+{
+  (*count)++;
+}
+
+static NMConnection *
+create_wifi_connection (const gchar *ssid)
+{
+  g_autoptr(GBytes) ssid_bytes = NULL;
+  NMConnection *conn;
+  NMSettingWireless *s_wifi;
+  NMSettingWirelessSecurity *s_wsec;
+
+  conn = nmtst_create_minimal_connection ("test-wifi", NULL, NM_SETTING_WIRELESS_SETTING_NAME, NULL);
+  s_wifi = nm_connection_get_setting_wireless (conn);
+  ssid_bytes = g_bytes_new (ssid, strlen (ssid));
+  g_object_set (s_wifi, NM_SETTING_WIRELESS_SSID, ssid_bytes, NULL);
+  s_wsec = NM_SETTING_WIRELESS_SECURITY (nm_setting_wireless_security_new ());
+  g_object_set (s_wsec,
+                NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+                NM_SETTING_WIRELESS_SECURITY_PSK, "password",
+                NULL);
+  nm_connection_add_setting (conn, NM_SETTING (s_wsec));
+
+  return conn;
+}
+
+static void
+test_wifi_list_connection_add (NetworkPanelFixture  *fixture,
+                               gconstpointer         user_data)
+{
+  g_autoptr(CcWifiConnectionList) list = NULL;
+  g_autoptr(GPtrArray) rows = NULL;
+  NMConnection *conn;
+  CcWifiConnectionRow *other_row;
+  CcWifiConnectionRow *row;
+  guint added = 0, removed = 0;
+  WAIT_DECL()
+
+  add_access_point (fixture, "test-a", "52:54:00:ab:db:30");
+  add_access_point (fixture, "test-a", "52:54:00:ab:db:31");
+  add_access_point (fixture, "test-b", "52:54:00:ab:db:32");
+
+  list = g_object_ref_sink (cc_wifi_connection_list_new (fixture->client,
+                                                         NM_DEVICE_WIFI (fixture->main_wifi),
+                                                         TRUE, TRUE, FALSE, FALSE));
+  g_signal_connect (list, "add-row", G_CALLBACK (count_row_cb), &added);
+  g_signal_connect (list, "remove-row", G_CALLBACK (count_row_cb), &removed);
+
+  /* The APs are grouped by SSID */
+  rows = list_rows (list);
+  g_assert_cmpuint (rows->len, ==, 2);
+  g_assert_cmpuint (cc_wifi_connection_row_get_access_points (find_row_for_ssid (list, "test-a"))->len, ==, 2);
+  other_row = find_row_for_ssid (list, "test-b");
+  g_assert_nonnull (other_row);
+
+  /* Add a connection for the first SSID */
+  conn = create_wifi_connection ("test-a");
+
+  nm_client_add_connection_async (fixture->client, conn, TRUE, NULL, add_cb, &info);
+
+  info.other_remaining = 1;
+  WAIT_CLIENT(fixture->client, 2, NM_CLIENT_CONNECTIONS, NM_CLIENT_CONNECTION_ADDED);
+
+  WAIT_FINISHED(5)
+
+  /* Only the row of the SSID was replaced by one for the connection */
+  g_assert_cmpuint (added, ==, 1);
+  g_assert_cmpuint (removed, ==, 1);
+
+  g_clear_pointer (&rows, g_ptr_array_unref);
+  rows = list_rows (list);
+  g_assert_cmpuint (rows->len, ==, 2);
+  g_assert_true (find_row_for_ssid (list, "test-b") == other_row);
+
+  row = find_row_for_ssid (list, "test-a");
+  g_assert_nonnull (cc_wifi_connection_row_get_connection (row));
+  g_assert_cmpuint (cc_wifi_connection_row_get_access_points (row)->len, ==, 2);
+
+  /* And back once it is deleted */
+  nm_remote_connection_delete_async (info.rc, NULL, delete_cb, &info);
+
+  info.other_remaining = 1;
+  WAIT_CLIENT(fixture->client, 2, NM_CLIENT_CONNECTIONS, NM_CLIENT_CONNECTION_REMOVED);
+
+  WAIT_FINISHED(5)
+
+  g_assert_cmpuint (added, ==, 2);
+  g_assert_cmpuint (removed, ==, 2);
+  g_assert_true (find_row_for_ssid (list, "test-b") == other_row);
+  g_assert_null (cc_wifi_connection_row_get_connection (find_row_for_ssid (list, "test-a")));
+
+  g_clear_object (&info.rc);
+  g_object_unref (conn);
+}
+
+static void
+test_wifi_list_connection_edit (NetworkPanelFixture  *fixture,
+                                gconstpointer         user_data)
+{
+  g_autoptr(CcWifiConnectionList) list = NULL;
+  g_autoptr(NMConnection) edited = NULL;
+  g_autoptr(GBytes) ssid = NULL;
+  NMConnection *conn;
+  CcWifiConnectionRow *row;
+  WAIT_DECL()
+
+  add_access_point (fixture, "test-a", "52:54:00:ab:db:30");
+  add_access_point (fixture, "test-a", "52:54:00:ab:db:31");
+  add_access_point (fixture, "test-b", "52:54:00:ab:db:32");
+
+  list = g_object_ref_sink (cc_wifi_connection_list_new (fixture->client,
+                                                         NM_DEVICE_WIFI (fixture->main_wifi),
+                                                         TRUE, TRUE, FALSE, FALSE));
+
+  conn = create_wifi_connection ("test-a");
+  nm_client_add_connection_async (fixture->client, conn, TRUE, NULL, add_cb, &info);
+
+  info.other_remaining = 1;
+  WAIT_CLIENT(fixture->client, 2, NM_CLIENT_CONNECTIONS, NM_CLIENT_CONNECTION_ADDED);
+
+  WAIT_FINISHED(5)
+
+  row = find_row_for_ssid (list, "test-a");
+  g_assert_true (cc_wifi_connection_row_get_connection (row) == NM_CONNECTION (info.rc));
+
+  /* Point the connection to the other SSID */
+  edited = nm_simple_connection_new_clone (NM_CONNECTION (info.rc));
+  ssid = g_bytes_new_static ("test-b", strlen ("test-b"));
+  g_object_set (nm_connection_get_setting_wireless (edited), NM_SETTING_WIRELESS_SSID, ssid, NULL);
+
+  nmtstc_service_update_connection (fixture->sinfo,
+                                    nm_object_get_path (NM_OBJECT (info.rc)),
+                                    edited,
+                                    FALSE);
+
+  WAIT_CONNECTION(info.rc, 1, "changed");
+
+  WAIT_FINISHED(5)
+
+  /* The APs of the old SSID are grouped again, and the connection took
+   * the AP of the new one */
+  row = find_row_for_ssid (list, "test-a");
+  g_assert_null (cc_wifi_connection_row_get_connection (row));
+  g_assert_cmpuint (cc_wifi_connection_row_get_access_points (row)->len, ==, 2);
+
+  row = find_row_for_ssid (list, "test-b");
+  g_assert_true (cc_wifi_connection_row_get_connection (row) == NM_CONNECTION (info.rc));
+  g_assert_cmpuint (cc_wifi_connection_row_get_access_points (row)->len, ==, 1);
+
+  g_clear_object (&info.rc);
+  g_object_unref (conn);
+}
+
 /*****************************************************************************/
 
 static void
@@ -857,6 +1089,20 @@ main (int argc, char **argv)
               test_vpn_updating,
               fixture_tear_down);
 
+  g_test_add ("/network-panel-wifi/list-connection-add",
+              NetworkPanelFixture,
+              NULL,
+              fixture_set_up_wifi,
+              test_wifi_list_connection_add,
+              fixture_tear_down);
+
+  g_test_add ("/network-panel-wifi/list-connection-edit",
+              NetworkPanelFixture,
+              NULL,
+              fixture_set_up_wifi,
+              test_wifi_list_connection_edit,
+              fixture_tear_down);
+
 #if 0
   /*
    * FIXME: Currently broken, so test is disabled. Test will likely need
@@ -0,0 +1,228 @@
+#include "config.h"
+
+#include "cc-batman-config.h"
+#include "test-utils.h"
+
+static const char config_contents[] =
+  "# Managed by batman\n"
+  "[Settings]\n"
+  "OFFLINE=false\n"
+  "POWERSAVE=true\n"
+  "MAX_CPU_USAGE=80\n"
+  "WIFI=false\n"
+  "UNKNOWN_OPTION=kept\n";
+
+static char *test_dir;
+
+static char *
+write_config (const char *contents)
+{
+  g_autofree char *path = g_build_filename (test_dir, "config", NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_file_set_contents (path, contents, -1, &error);
+  g_assert_no_error (error);
+
+  return g_steal_pointer (&path);
+}
+
+static GKeyFile *
+load_keyfile (const char *path)
+{
+  g_autoptr(GKeyFile) keyfile = g_key_file_new ();
+  g_autoptr(GError) error = NULL;
+
+  g_key_file_load_from_file (keyfile, path, G_KEY_FILE_KEEP_COMMENTS, &error);
+  g_assert_no_error (error);
+
+  return g_steal_pointer (&keyfile);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  g_error ("Timed out");
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_load (void)
+{
+  g_autofree char *path = write_config (config_contents);
+  g_autoptr(CcBatmanConfig) config = NULL;
+  gboolean offline, powersave, wifisave, gpusave;
+  gint max_cpu_usage;
+
+  config = cc_batman_config_new (path);
+  g_object_get (config,
+                "offline", &offline,
+                "powersave", &powersave,
+                "max-cpu-usage", &max_cpu_usage,
+                "wifisave", &wifisave,
+                "gpusave", &gpusave,
+                NULL);
+
+  g_assert_false (offline);
+  g_assert_true (powersave);
+  g_assert_cmpint (max_cpu_usage, ==, 80);
+  g_assert_false (wifisave);
+  /* Missing from the file */
+  g_assert_false (gpusave);
+}
+
+static gboolean
+settled_cb (gpointer user_data)
+{
+  gboolean *settled = user_data;
+
+  *settled = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+/* The config is replaced through a temporary file renamed over it, so
+ * each write shows up as the file being renamed to, or created */
+static void
+config_written_cb (GFileMonitor      *monitor,
+                   GFile             *file,
+                   GFile             *other_file,
+                   GFileMonitorEvent  event_type,
+                   gpointer           user_data)
+{
+  guint *n_writes = user_data;
+  g_autofree char *basename = NULL;
+
+  if (event_type == G_FILE_MONITOR_EVENT_RENAMED)
+    basename = g_file_get_basename (other_file);
+  else if (event_type == G_FILE_MONITOR_EVENT_CREATED ||
+           event_type == G_FILE_MONITOR_EVENT_MOVED_IN)
+    basename = g_file_get_basename (file);
+
+  if (g_strcmp0 (basename, "config") == 0)
+    (*n_writes)++;
+}
+
+static void
+test_batched_write (void)
+{
+  g_autofree char *path = write_config (config_contents);
+  g_autoptr(CcBatmanConfig) config = NULL;
+  g_autoptr(GFile) dir = g_file_new_for_path (test_dir);
+  g_autoptr(GFileMonitor) monitor = NULL;
+  g_autoptr(GKeyFile) keyfile = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *contents = NULL;
+  g_autofree char *unknown = NULL;
+  gboolean settled = FALSE;
+  guint n_writes = 0;
+  guint timeout_id;
+
+  monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+  g_assert_no_error (error);
+  g_signal_connect (monitor, "changed", G_CALLBACK (config_written_cb), &n_writes);
+
+  config = cc_batman_config_new (path);
+  g_object_set (config,
+                "offline", TRUE,
+                "wifisave", TRUE,
+                "gpusave", TRUE,
+                "max-cpu-usage", 50,
+                NULL);
+
+  /* Nothing written until the toggles settle */
+  g_file_get_contents (path, &contents, NULL, NULL);
+  g_assert_cmpstr (contents, ==, config_contents);
+
+  timeout_id = g_timeout_add_seconds (5, timeout_cb, NULL);
+  while (n_writes == 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_source_remove (timeout_id);
+
+  /* All of them in one go, and nothing more once the config reloads
+   * what it wrote */
+  g_timeout_add_seconds (1, settled_cb, &settled);
+  while (!settled)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (n_writes, ==, 1);
+
+  /* Keeping what we don't know about */
+  g_clear_pointer (&contents, g_free);
+  g_file_get_contents (path, &contents, NULL, &error);
+  g_assert_no_error (error);
+  keyfile = load_keyfile (path);
+  g_assert_true (g_key_file_get_boolean (keyfile, "Settings", "OFFLINE", NULL));
+  g_assert_true (g_key_file_get_boolean (keyfile, "Settings", "WIFI", NULL));
+  g_assert_true (g_key_file_get_boolean (keyfile, "Settings", "GPUSAVE", NULL));
+  g_assert_true (g_key_file_get_boolean (keyfile, "Settings", "POWERSAVE", NULL));
+  g_assert_cmpint (g_key_file_get_integer (keyfile, "Settings", "MAX_CPU_USAGE", NULL), ==, 50);
+  unknown = g_key_file_get_value (keyfile, "Settings", "UNKNOWN_OPTION", NULL);
+  g_assert_cmpstr (unknown, ==, "kept");
+  g_assert_true (g_str_has_prefix (contents, "# Managed by batman\n"));
+}
+
+static void
+test_flush_on_dispose (void)
+{
+  g_autofree char *path = write_config (config_contents);
+  g_autoptr(GKeyFile) keyfile = NULL;
+  CcBatmanConfig *config;
+
+  config = cc_batman_config_new (path);
+  g_object_set (config, "btsave", TRUE, NULL);
+  g_object_unref (config);
+
+  keyfile = load_keyfile (path);
+  g_assert_true (g_key_file_get_boolean (keyfile, "Settings", "BTSAVE", NULL));
+}
+
+static void
+notify_cb (GObject    *object,
+           GParamSpec *pspec,
+           gpointer    user_data)
+{
+  GPtrArray *notified = user_data;
+
+  g_ptr_array_add (notified, g_strdup (pspec->name));
+}
+
+static void
+test_external_edit (void)
+{
+  g_autofree char *path = write_config (config_contents);
+  g_autoptr(CcBatmanConfig) config = NULL;
+  g_autoptr(GPtrArray) notified = g_ptr_array_new_with_free_func (g_free);
+  g_autoptr(GString) edited = NULL;
+  gboolean powersave;
+  guint timeout_id;
+
+  config = cc_batman_config_new (path);
+  g_signal_connect (config, "notify", G_CALLBACK (notify_cb), notified);
+
+  /* Written by batman itself, or by hand */
+  edited = g_string_new (config_contents);
+  g_string_replace (edited, "POWERSAVE=true", "POWERSAVE=false", 1);
+  g_free (write_config (edited->str));
+
+  timeout_id = g_timeout_add_seconds (5, timeout_cb, NULL);
+  while (notified->len == 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_source_remove (timeout_id);
+
+  g_assert_cmpuint (notified->len, ==, 1);
+  g_assert_cmpstr (g_ptr_array_index (notified, 0), ==, "powersave");
+
+  g_object_get (config, "powersave", &powersave, NULL);
+  g_assert_false (powersave);
+}
+
+int
+main (int argc, char **argv)
+{
+  test_dir = test_utils_init (&argc, &argv, "test-batman-config");
+
+  g_test_add_func ("/power/batman-config/load", test_load);
+  g_test_add_func ("/power/batman-config/batched-write", test_batched_write);
+  g_test_add_func ("/power/batman-config/flush-on-dispose", test_flush_on_dispose);
+  g_test_add_func ("/power/batman-config/external-edit", test_external_edit);
+
+  return test_utils_run (test_dir);
+}
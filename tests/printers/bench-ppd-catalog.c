@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Records a CUPS-Get-PPDs response listing ten thousand PPDs, or as many
+ * as set in BENCH_PPD_CATALOG_PPDS, and replays it from a stand-in CUPS
+ * server on a Unix socket. Compares how long it takes to get the list of
+ * all PPDs when it has to be requested, and when it is loaded from the
+ * catalog kept by the previous request.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "pp-utils.h"
+
+#define DEFAULT_N_PPDS 10000
+#define N_RUNS 5
+
+static const char * const manufacturers[] = {
+  "HP", "Hewlett-Packard", "Canon", "Epson", "Brother", "Samsung", "Ricoh",
+  "Lexmark", "Kyocera", "Kyocera Mita", "Xerox", "Konica Minolta", "Sharp",
+  "Toshiba", "Oki", "Dell", "Gestetner", "Lanier", "Savin", "InfoPrint",
+  "Generic", "Zebra", "Dymo", "Citizen", "Star",
+};
+
+static GBytes *recorded_response;
+
+static ssize_t
+write_cb (void        *context,
+          ipp_uchar_t *buffer,
+          size_t       bytes)
+{
+  g_byte_array_append (context, buffer, bytes);
+
+  return bytes;
+}
+
+static GBytes *
+record_response (guint n_ppds)
+{
+  g_autoptr(GByteArray) data = g_byte_array_new ();
+  ipp_t *response;
+  ipp_state_t state;
+  guint i;
+
+  response = ippNew ();
+  ippSetVersion (response, 2, 0);
+  ippSetStatusCode (response, IPP_STATUS_OK);
+  ippSetRequestId (response, 1);
+  ippAddString (response, IPP_TAG_OPERATION, IPP_TAG_CHARSET, "attributes-charset", NULL, "utf-8");
+  ippAddString (response, IPP_TAG_OPERATION, IPP_TAG_LANGUAGE, "attributes-natural-language", NULL, "en");
+
+  for (i = 0; i < n_ppds; i++)
+    {
+      const char *manufacturer = manufacturers[g_random_int_range (0, G_N_ELEMENTS (manufacturers))];
+      g_autofree char *name = g_strdup_printf ("driver:%s/model-%u.ppd", manufacturer, i);
+      g_autofree char *model = g_strdup_printf ("%s Model %u", manufacturer, i);
+      g_autofree char *device_id = g_strdup_printf ("MFG:%s;MDL:Model %u;", manufacturer, i);
+
+      if (i > 0)
+        ippAddSeparator (response);
+
+      ippAddString (response, IPP_TAG_PRINTER, IPP_TAG_NAME, "ppd-name", NULL, name);
+      ippAddString (response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "ppd-make", NULL, manufacturer);
+      ippAddString (response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "ppd-make-and-model", NULL, model);
+      ippAddString (response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "ppd-device-id", NULL, device_id);
+      ippAddString (response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "ppd-product", NULL, model);
+    }
+
+  while ((state = ippWriteIO (data, write_cb, 1, NULL, response)) != IPP_STATE_DATA)
+    g_assert_cmpint (state, !=, IPP_STATE_ERROR);
+
+  ippDelete (response);
+
+  return g_byte_array_free_to_bytes (g_steal_pointer (&data));
+}
+
+/* The stand-in CUPS server answers every request with the recorded
+ * response, on as many connections as it gets */
+static gboolean
+run_cb (GThreadedSocketService *service,
+        GSocketConnection      *connection,
+        GObject                *source_object,
+        gpointer                user_data)
+{
+  g_autoptr(GDataInputStream) input = NULL;
+  GOutputStream *output;
+
+  input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+  g_data_input_stream_set_newline_type (input, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+  output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+  while (TRUE)
+    {
+      g_autofree char *request_line = NULL;
+      g_autofree guchar *body = NULL;
+      g_autofree guchar *data = NULL;
+      g_autofree char *headers = NULL;
+      gboolean expect_continue = FALSE;
+      gsize content_length = 0;
+      gsize bytes_read;
+      gsize size;
+      char *line;
+
+      request_line = g_data_input_stream_read_line (input, NULL, NULL, NULL);
+      if (request_line == NULL)
+        break;
+
+      while ((line = g_data_input_stream_read_line (input, NULL, NULL, NULL)) != NULL && *line != '\0')
+        {
+          if (g_ascii_strncasecmp (line, "Content-Length:", strlen ("Content-Length:")) == 0)
+            content_length = g_ascii_strtoull (line + strlen ("Content-Length:"), NULL, 10);
+          else if (g_ascii_strncasecmp (line, "Expect:", strlen ("Expect:")) == 0)
+            expect_continue = TRUE;
+          g_free (line);
+        }
+
+      if (line == NULL)
+        break;
+      g_free (line);
+
+      if (expect_continue &&
+          !g_output_stream_write_all (output, "HTTP/1.1 100 Continue\r\n\r\n",
+                                      strlen ("HTTP/1.1 100 Continue\r\n\r\n"), NULL, NULL, NULL))
+        break;
+
+      /* The request id is the only part of the request that matters */
+      body = g_malloc (content_length);
+      if (content_length < 8 ||
+          !g_input_stream_read_all (G_INPUT_STREAM (input), body, content_length, &bytes_read, NULL, NULL) ||
+          bytes_read != content_length)
+        break;
+
+      data = g_bytes_unref_to_data (g_bytes_ref (recorded_response), &size);
+      memcpy (data + 4, body + 4, 4);
+
+      headers = g_strdup_printf ("HTTP/1.1 200 OK\r\n"
+                                 "Content-Type: application/ipp\r\n"
+                                 "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                                 "\r\n",
+                                 size);
+      if (!g_output_stream_write_all (output, headers, strlen (headers), NULL, NULL, NULL) ||
+          !g_output_stream_write_all (output, data, size, NULL, NULL, NULL))
+        break;
+    }
+
+  return TRUE;
+}
+
+typedef struct
+{
+  gboolean  done;
+  PPDList  *list;
+} GetAllPPDsData;
+
+static void
+get_all_ppds_cb (PPDList  *list,
+                 gpointer  user_data)
+{
+  GetAllPPDsData *data = user_data;
+
+  data->list = ppd_list_copy (list);
+  data->done = TRUE;
+}
+
+static PPDList *
+get_all_ppds (gint64 *duration)
+{
+  GetAllPPDsData data = { FALSE, NULL };
+  gint64 start;
+
+  start = g_get_monotonic_time ();
+  get_all_ppds_async (NULL, get_all_ppds_cb, &data);
+  while (!data.done)
+    g_main_context_iteration (NULL, TRUE);
+  *duration = g_get_monotonic_time () - start;
+
+  g_assert_nonnull (data.list);
+
+  return data.list;
+}
+
+static void
+assert_ppd_lists_equal (PPDList *a,
+                        PPDList *b)
+{
+  gsize i, j;
+
+  g_assert_cmpuint (a->num_of_manufacturers, ==, b->num_of_manufacturers);
+  for (i = 0; i < a->num_of_manufacturers; i++)
+    {
+      PPDManufacturerItem *item_a = a->manufacturers[i];
+      PPDManufacturerItem *item_b = b->manufacturers[i];
+
+      g_assert_cmpstr (item_a->manufacturer_name, ==, item_b->manufacturer_name);
+      g_assert_cmpstr (item_a->manufacturer_display_name, ==, item_b->manufacturer_display_name);
+      g_assert_cmpuint (item_a->num_of_ppds, ==, item_b->num_of_ppds);
+
+      for (j = 0; j < item_a->num_of_ppds; j++)
+        {
+          g_assert_cmpstr (item_a->ppds[j]->ppd_name, ==, item_b->ppds[j]->ppd_name);
+          g_assert_cmpstr (item_a->ppds[j]->ppd_display_name, ==, item_b->ppds[j]->ppd_display_name);
+        }
+    }
+}
+
+static gsize
+count_ppds (PPDList *list)
+{
+  gsize n_ppds = 0;
+  gsize i;
+
+  for (i = 0; i < list->num_of_manufacturers; i++)
+    n_ppds += list->manufacturers[i]->num_of_ppds;
+
+  return n_ppds;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr(GSocketService) service = NULL;
+  g_autoptr(GSocketAddress) address = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *test_dir = NULL;
+  g_autofree char *socket_path = NULL;
+  g_autofree char *cache_dir = NULL;
+  g_autofree char *cups_cache_dir = NULL;
+  g_autofree char *ppds_dat = NULL;
+  g_autofree char *catalog = NULL;
+  g_autofree char *catalog_dir = NULL;
+  PPDList *requested = NULL;
+  PPDList *loaded = NULL;
+  const char *n_ppds_env;
+  gint64 best_requested = G_MAXINT64;
+  gint64 best_loaded = G_MAXINT64;
+  gint64 duration;
+  guint n_ppds;
+  guint i;
+
+  n_ppds_env = g_getenv ("BENCH_PPD_CATALOG_PPDS");
+  n_ppds = n_ppds_env ? g_ascii_strtoull (n_ppds_env, NULL, 10) : DEFAULT_N_PPDS;
+
+  test_dir = g_dir_make_tmp ("bench-ppd-catalog-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  socket_path = g_build_filename (test_dir, "cups.sock", NULL);
+  cache_dir = g_build_filename (test_dir, "cache", NULL);
+  cups_cache_dir = g_build_filename (test_dir, "cups", NULL);
+  ppds_dat = g_build_filename (cups_cache_dir, "ppds.dat", NULL);
+  catalog_dir = g_build_filename (cache_dir, "gnome-control-center", NULL);
+  catalog = g_build_filename (catalog_dir, "printers-ppd-catalog.cache", NULL);
+
+  /* The PPD database of the stand-in server */
+  g_assert_cmpint (g_mkdir (cups_cache_dir, 0700), ==, 0);
+  g_file_set_contents (ppds_dat, "", 0, &error);
+  g_assert_no_error (error);
+
+  g_setenv ("CUPS_SERVER", socket_path, TRUE);
+  g_setenv ("CUPS_CACHEDIR", cups_cache_dir, TRUE);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+  recorded_response = record_response (n_ppds);
+  g_print ("Recorded a response of %" G_GSIZE_FORMAT " kB listing %u PPDs\n",
+           g_bytes_get_size (recorded_response) / 1024, n_ppds);
+
+  service = g_threaded_socket_service_new (1);
+  address = g_unix_socket_address_new (socket_path);
+  g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+                                 address,
+                                 G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_DEFAULT,
+                                 NULL, NULL,
+                                 &error);
+  g_assert_no_error (error);
+  g_signal_connect (service, "run", G_CALLBACK (run_cb), NULL);
+  g_socket_service_start (service);
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      g_unlink (catalog);
+
+      g_clear_pointer (&requested, ppd_list_free);
+      requested = get_all_ppds (&duration);
+      best_requested = MIN (best_requested, duration);
+    }
+
+  g_assert_true (g_file_test (catalog, G_FILE_TEST_EXISTS));
+  g_assert_cmpuint (count_ppds (requested), ==, n_ppds);
+
+  for (i = 0; i < N_RUNS; i++)
+    {
+      g_clear_pointer (&loaded, ppd_list_free);
+      loaded = get_all_ppds (&duration);
+      best_loaded = MIN (best_loaded, duration);
+    }
+
+  assert_ppd_lists_equal (requested, loaded);
+
+  g_print ("%-40s %8.2f ms, %" G_GSIZE_FORMAT " manufacturers\n", "Requested from CUPS",
+           best_requested / 1000.0, requested->num_of_manufacturers);
+  g_print ("%-40s %8.2f ms\n", "Loaded from the catalog", best_loaded / 1000.0);
+
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+
+  ppd_list_free (requested);
+  ppd_list_free (loaded);
+  g_bytes_unref (recorded_response);
+
+  g_unlink (catalog);
+  g_rmdir (catalog_dir);
+  g_rmdir (cache_dir);
+  g_unlink (ppds_dat);
+  g_rmdir (cups_cache_dir);
+  g_unlink (socket_path);
+  g_rmdir (test_dir);
+
+  return 0;
+}
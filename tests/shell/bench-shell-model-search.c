@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 The GNOME Settings contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Replays typed queries, one keystroke at a time, against a CcShellModel
+ * holding every panel shipped in the source tree, and reports the latency
+ * of each keystroke.
+ */
+
+#include "config.h"
+
+#include <locale.h>
+#include <string.h>
+
+#include "cc-shell-model.h"
+#include "cc-util.h"
+#include "test-shell-model.h"
+
+#define N_ITERATIONS 1000
+
+static const gchar *queries[] = {
+  "wi-fi",
+  "bluetooth",
+  "display resolution",
+  "sound volume",
+  "keyboard shortcuts",
+  "power battery",
+  "background wallpaper",
+  "mouse touchpad",
+  "date time",
+  "users password",
+  "printers",
+  "mobile network",
+  "nonexistent query",
+};
+
+/* The linear scan that the index replaced, used as a reference */
+static gboolean
+iter_matches_term (CcShellModel *model,
+                   GtkTreeIter  *iter,
+                   const gchar  *term)
+{
+  g_autofree gchar *name = NULL;
+  g_autofree gchar *description = NULL;
+  g_auto(GStrv) keywords = NULL;
+  gboolean result;
+
+  gtk_tree_model_get (GTK_TREE_MODEL (model), iter,
+                      COL_CASEFOLDED_NAME, &name,
+                      COL_CASEFOLDED_DESCRIPTION, &description,
+                      COL_KEYWORDS, &keywords,
+                      -1);
+
+  result = (strstr (name, term) != NULL);
+
+  if (!result && description)
+    result = (strstr (description, term) != NULL);
+
+  if (!result && keywords)
+    {
+      gint i;
+
+      for (i = 0; !result && keywords[i]; i++)
+        result = (strstr (keywords[i], term) == keywords[i]);
+    }
+
+  return result;
+}
+
+/* The results of the index must match a linear scan of the model */
+static void
+check_results (CcShellModel  *model,
+               gchar        **terms,
+               GPtrArray     *results)
+{
+  GtkTreeModel *tree_model = GTK_TREE_MODEL (model);
+  GtkTreeIter iter;
+  gboolean valid;
+  guint n_matches = 0;
+
+  valid = gtk_tree_model_get_iter_first (tree_model, &iter);
+  while (valid)
+    {
+      g_autofree gchar *id = NULL;
+      gboolean matches = TRUE;
+      guint i;
+
+      for (i = 0; matches && terms[i]; i++)
+        {
+          if (terms[i][0] != '\0')
+            matches = iter_matches_term (model, &iter, terms[i]);
+        }
+
+      gtk_tree_model_get (tree_model, &iter, COL_ID, &id, -1);
+      g_assert_true (matches == g_ptr_array_find_with_equal_func (results, id, g_str_equal, NULL));
+
+      if (matches)
+        n_matches++;
+
+      valid = gtk_tree_model_iter_next (tree_model, &iter);
+    }
+
+  g_assert_cmpuint (n_matches, ==, results->len);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr(CcShellModel) model = NULL;
+  gdouble total_time = 0.0;
+  guint n_keystrokes = 0;
+  gint64 start;
+  guint i;
+
+  setlocale (LC_ALL, "");
+
+  start = g_get_monotonic_time ();
+  model = test_shell_model_new ();
+
+  g_print ("Indexed %d panels in %.1f µs\n",
+           gtk_tree_model_iter_n_children (GTK_TREE_MODEL (model), NULL),
+           (gdouble) (g_get_monotonic_time () - start));
+
+  for (i = 0; i < G_N_ELEMENTS (queries); i++)
+    {
+      const gchar *query = queries[i];
+      const gchar *p;
+
+      /* Replay the query one character at a time, as if it was being typed */
+      for (p = g_utf8_next_char (query); ; p = g_utf8_next_char (p))
+        {
+          g_autofree gchar *typed = NULL;
+          g_autofree gchar *casefolded = NULL;
+          g_auto(GStrv) terms = NULL;
+          gdouble elapsed;
+          guint n_results = 0;
+          guint j;
+
+          typed = g_strndup (query, p - query);
+          casefolded = cc_util_normalize_casefold_and_unaccent (typed);
+          terms = g_strsplit (g_strstrip (casefolded), " ", 0);
+
+          start = g_get_monotonic_time ();
+          for (j = 0; j < N_ITERATIONS; j++)
+            {
+              g_autoptr(GPtrArray) results = cc_shell_model_search (model, terms);
+              n_results = results->len;
+
+              if (j == 0)
+                check_results (model, terms, results);
+            }
+          elapsed = (gdouble) (g_get_monotonic_time () - start) / N_ITERATIONS;
+
+          g_print ("%-24s %3u results  %8.2f µs\n", typed, n_results, elapsed);
+
+          total_time += elapsed;
+          n_keystrokes++;
+
+          if (*p == '\0')
+            break;
+        }
+    }
+
+  g_print ("Average latency per keystroke: %.2f µs\n", total_time / n_keystrokes);
+
+  return 0;
+}
@@ -0,0 +1,123 @@
+#include "config.h"
+
+#include <locale.h>
+
+#include "cc-shell-model.h"
+#include "cc-util.h"
+#include "test-shell-model.h"
+
+static gchar **
+to_strv (GPtrArray *results)
+{
+  GPtrArray *strv;
+  guint i;
+
+  strv = g_ptr_array_new ();
+  for (i = 0; i < results->len; i++)
+    g_ptr_array_add (strv, g_strdup (g_ptr_array_index (results, i)));
+  g_ptr_array_add (strv, NULL);
+
+  return (gchar **) g_ptr_array_free (strv, FALSE);
+}
+
+static void
+assert_results_equal (GPtrArray   *expected,
+                      GPtrArray   *results,
+                      const gchar *query)
+{
+  guint i;
+
+  if (expected->len != results->len)
+    g_error ("Subsearch for '%s' returned %u results, expected %u",
+             query, results->len, expected->len);
+
+  for (i = 0; i < expected->len; i++)
+    g_assert_cmpstr (g_ptr_array_index (results, i), ==, g_ptr_array_index (expected, i));
+}
+
+static void
+test_subsearch (void)
+{
+  g_autoptr(CcShellModel) model = NULL;
+  g_autofree gchar *contents = NULL;
+  g_auto(GStrv) lines = NULL;
+  guint i;
+
+  if (!g_file_get_contents (TEST_SRCDIR "/search-terms-test.txt", &contents, NULL, NULL))
+    {
+      g_warning ("Failed to load '%s'", TEST_SRCDIR "/search-terms-test.txt");
+      g_test_fail ();
+      return;
+    }
+
+  model = test_shell_model_new ();
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (model), NULL), >, 0);
+
+  lines = g_strsplit (contents, "\n", -1);
+
+  for (i = 0; lines[i] != NULL; i++)
+    {
+      g_auto(GStrv) previous_results = NULL;
+      const gchar *query = lines[i];
+      const gchar *p;
+
+      if (*query == '#' || *query == '\0')
+        continue;
+
+      /* Replay the query one character at a time, as if it was being typed */
+      for (p = g_utf8_next_char (query); ; p = g_utf8_next_char (p))
+        {
+          g_autoptr(GPtrArray) expected = NULL;
+          g_autoptr(GPtrArray) results = NULL;
+          g_autofree gchar *typed = NULL;
+          g_autofree gchar *casefolded = NULL;
+          g_auto(GStrv) terms = NULL;
+
+          typed = g_strndup (query, p - query);
+          casefolded = cc_util_normalize_casefold_and_unaccent (typed);
+          terms = g_strsplit (g_strstrip (casefolded), " ", 0);
+
+          expected = cc_shell_model_search (model, terms);
+
+          if (previous_results)
+            {
+              results = cc_shell_model_search_subset (model, terms, (const gchar * const *) previous_results);
+              assert_results_equal (expected, results, typed);
+            }
+
+          g_clear_pointer (&previous_results, g_strfreev);
+          previous_results = to_strv (expected);
+
+          if (*p == '\0')
+            break;
+        }
+    }
+}
+
+static void
+test_subsearch_unknown_ids (void)
+{
+  g_autoptr(CcShellModel) model = NULL;
+  g_autoptr(GPtrArray) results = NULL;
+  const gchar *ids[] = { "not-a-panel", "sound", "sound", NULL };
+  gchar *terms[] = { "sou", NULL };
+
+  model = test_shell_model_new ();
+  results = cc_shell_model_search_subset (model, terms, ids);
+
+  g_assert_cmpuint (results->len, ==, 1);
+  g_assert_cmpstr (g_ptr_array_index (results, 0), ==, "sound");
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  setlocale (LC_ALL, "");
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/shell/search/subsearch", test_subsearch);
+  g_test_add_func ("/shell/search/subsearch-unknown-ids", test_subsearch_unknown_ids);
+
+  return g_test_run ();
+}
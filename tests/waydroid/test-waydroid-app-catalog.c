@@ -0,0 +1,251 @@
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "cc-waydroid-app-catalog.h"
+#include "test-utils.h"
+
+static char *test_dir;
+
+static void
+write_icon (const char *filename)
+{
+  static const guchar pixel[] = { 0xff, 0x00, 0x00, 0xff };
+  g_autoptr(GBytes) bytes = g_bytes_new_static (pixel, sizeof (pixel));
+  g_autoptr(GdkTexture) texture = NULL;
+
+  texture = gdk_memory_texture_new (1, 1, GDK_MEMORY_R8G8B8A8, bytes, sizeof (pixel));
+  g_assert_true (gdk_texture_save_to_png (texture, filename));
+}
+
+static void
+write_desktop_file (const char *package_name,
+                    const char *name)
+{
+  g_autofree char *basename = g_strdup_printf ("waydroid.%s.desktop", package_name);
+  g_autofree char *filename = g_build_filename (test_dir, "applications", basename, NULL);
+  g_autofree char *icon = g_strdup_printf ("%s/waydroid/data/icons/%s.png", test_dir, package_name);
+  g_autofree char *contents = NULL;
+  g_autoptr(GError) error = NULL;
+
+  contents = g_strdup_printf ("[Desktop Entry]\n"
+                              "Type=Application\n"
+                              "Name=%s\n"
+                              "Exec=waydroid app launch %s\n"
+                              "Icon=%s\n",
+                              name, package_name, icon);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+
+  write_icon (icon);
+}
+
+static void
+remove_desktop_file (const char *package_name)
+{
+  g_autofree char *basename = g_strdup_printf ("waydroid.%s.desktop", package_name);
+  g_autofree char *filename = g_build_filename (test_dir, "applications", basename, NULL);
+
+  g_assert_cmpint (g_unlink (filename), ==, 0);
+}
+
+static void
+update_cb (GObject      *source_object,
+           GAsyncResult *res,
+           gpointer      user_data)
+{
+  gboolean *done = user_data;
+  g_autoptr(GError) error = NULL;
+
+  g_assert_true (cc_waydroid_app_catalog_update_finish (CC_WAYDROID_APP_CATALOG (source_object), res, &error));
+  g_assert_no_error (error);
+
+  *done = TRUE;
+}
+
+static void
+update (CcWaydroidAppCatalog *catalog,
+        const char * const   *names)
+{
+  gboolean done = FALSE;
+
+  cc_waydroid_app_catalog_update_async (catalog, names, NULL, update_cb, &done);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+refresh_not_connected_cb (GObject      *source_object,
+                          GAsyncResult *res,
+                          gpointer      user_data)
+{
+  gboolean *done = user_data;
+  g_autoptr(GError) error = NULL;
+
+  g_assert_false (cc_waydroid_app_catalog_refresh_finish (CC_WAYDROID_APP_CATALOG (source_object), res, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_CONNECTED);
+  g_assert_false (cc_waydroid_app_catalog_get_refreshing (CC_WAYDROID_APP_CATALOG (source_object)));
+
+  *done = TRUE;
+}
+
+static CcWaydroidApp *
+get_app (CcWaydroidAppCatalog *catalog,
+         guint                 position)
+{
+  g_autoptr(CcWaydroidApp) app = NULL;
+
+  app = g_list_model_get_item (cc_waydroid_app_catalog_get_model (catalog), position);
+  g_assert_nonnull (app);
+
+  return app;
+}
+
+static void
+items_changed_cb (GListModel *model,
+                  guint       position,
+                  guint       removed,
+                  guint       added,
+                  gpointer    user_data)
+{
+  guint *n_changes = user_data;
+
+  *n_changes += MAX (removed, added);
+}
+
+static void
+test_update (void)
+{
+  const char * const names[] = { "Files", "Camera", "Browser", "Camera", "", NULL };
+  g_autoptr(CcWaydroidAppCatalog) catalog = NULL;
+  CcWaydroidApp *app;
+  GListModel *model;
+
+  write_desktop_file ("org.example.browser", "Browser");
+  write_desktop_file ("org.example.camera", "Camera");
+
+  catalog = cc_waydroid_app_catalog_new (test_dir);
+  model = cc_waydroid_app_catalog_get_model (catalog);
+  update (catalog, names);
+
+  /* Sorted, without duplicates */
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, 3);
+  g_assert_cmpstr (cc_waydroid_app_get_name (get_app (catalog, 0)), ==, "Browser");
+  g_assert_cmpstr (cc_waydroid_app_get_name (get_app (catalog, 1)), ==, "Camera");
+  g_assert_cmpstr (cc_waydroid_app_get_name (get_app (catalog, 2)), ==, "Files");
+
+  app = cc_waydroid_app_catalog_lookup (catalog, "Camera");
+  g_assert_true (app == get_app (catalog, 1));
+  g_assert_cmpstr (cc_waydroid_app_get_package_name (app), ==, "org.example.camera");
+  g_assert_true (g_str_has_suffix (cc_waydroid_app_get_icon_path (app), "/org.example.camera.png"));
+
+  /* The icon is decoded by the catalog, not when a row shows it */
+  g_assert_true (GDK_IS_TEXTURE (cc_waydroid_app_get_icon (app)));
+  g_assert_cmpint (gdk_paintable_get_intrinsic_width (cc_waydroid_app_get_icon (app)), ==, 1);
+
+  /* Apps without a desktop file are still listed */
+  app = cc_waydroid_app_catalog_lookup (catalog, "Files");
+  g_assert_nonnull (app);
+  g_assert_null (cc_waydroid_app_get_package_name (app));
+  g_assert_null (cc_waydroid_app_get_icon_path (app));
+  g_assert_null (cc_waydroid_app_get_icon (app));
+
+  g_assert_null (cc_waydroid_app_catalog_lookup (catalog, "Maps"));
+
+  remove_desktop_file ("org.example.browser");
+  remove_desktop_file ("org.example.camera");
+}
+
+static void
+test_incremental (void)
+{
+  const char * const names[] = { "Browser", "Camera", "Files", NULL };
+  const char * const new_names[] = { "Browser", "Clock", "Files", NULL };
+  g_autoptr(CcWaydroidAppCatalog) catalog = NULL;
+  g_autoptr(CcWaydroidApp) browser = NULL;
+  g_autoptr(CcWaydroidApp) files = NULL;
+  GListModel *model;
+  guint n_changes = 0;
+
+  write_desktop_file ("org.example.browser", "Browser");
+  write_desktop_file ("org.example.camera", "Camera");
+
+  catalog = cc_waydroid_app_catalog_new (test_dir);
+  model = cc_waydroid_app_catalog_get_model (catalog);
+  update (catalog, names);
+
+  browser = g_object_ref (get_app (catalog, 0));
+  files = g_object_ref (get_app (catalog, 2));
+
+  /* A package name looked up over D-Bus is kept */
+  cc_waydroid_app_set_package_name (files, "org.example.files");
+
+  remove_desktop_file ("org.example.camera");
+  write_desktop_file ("org.example.clock", "Clock");
+
+  g_signal_connect (model, "items-changed", G_CALLBACK (items_changed_cb), &n_changes);
+  update (catalog, new_names);
+
+  /* Only the app that went away and the one that came are changed */
+  g_assert_cmpuint (n_changes, ==, 2);
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, 3);
+  g_assert_true (get_app (catalog, 0) == browser);
+  g_assert_cmpstr (cc_waydroid_app_get_name (get_app (catalog, 1)), ==, "Clock");
+  g_assert_cmpstr (cc_waydroid_app_get_package_name (get_app (catalog, 1)), ==, "org.example.clock");
+  g_assert_true (get_app (catalog, 2) == files);
+  g_assert_cmpstr (cc_waydroid_app_get_package_name (files), ==, "org.example.files");
+  g_assert_null (cc_waydroid_app_catalog_lookup (catalog, "Camera"));
+
+  /* Everything is removed when Waydroid lists nothing */
+  n_changes = 0;
+  update (catalog, NULL);
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, 0);
+  g_assert_cmpuint (n_changes, ==, 3);
+  g_assert_null (cc_waydroid_app_catalog_lookup (catalog, "Browser"));
+
+  remove_desktop_file ("org.example.browser");
+  remove_desktop_file ("org.example.clock");
+}
+
+static void
+test_refresh_not_connected (void)
+{
+  g_autoptr(CcWaydroidAppCatalog) catalog = NULL;
+  guint i;
+
+  catalog = cc_waydroid_app_catalog_new (test_dir);
+
+  /* Without a session nothing is left waiting, so refreshing again once
+   * Waydroid is up isn't ignored */
+  for (i = 0; i < 2; i++)
+    {
+      gboolean done = FALSE;
+
+      cc_waydroid_app_catalog_refresh_async (catalog, NULL, NULL, refresh_not_connected_cb, &done);
+      g_assert_false (cc_waydroid_app_catalog_get_refreshing (catalog));
+      while (!done)
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+  g_assert_cmpuint (g_list_model_get_n_items (cc_waydroid_app_catalog_get_model (catalog)), ==, 0);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_autofree char *applications_dir = NULL;
+  g_autofree char *icons_dir = NULL;
+
+  test_dir = test_utils_init (&argc, &argv, "test-waydroid-app-catalog");
+
+  applications_dir = g_build_filename (test_dir, "applications", NULL);
+  icons_dir = g_build_filename (test_dir, "waydroid", "data", "icons", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (applications_dir, 0700), ==, 0);
+  g_assert_cmpint (g_mkdir_with_parents (icons_dir, 0700), ==, 0);
+
+  g_test_add_func ("/waydroid/app-catalog/update", test_update);
+  g_test_add_func ("/waydroid/app-catalog/incremental", test_incremental);
+  g_test_add_func ("/waydroid/app-catalog/refresh-not-connected", test_refresh_not_connected);
+
+  return test_utils_run (test_dir);
+}
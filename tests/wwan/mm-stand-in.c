@@ -0,0 +1,328 @@
+#include "config.h"
+
+#include <libmm-glib.h>
+
+#include "mm-stand-in.h"
+
+struct _MmStandIn
+{
+  GThread                  *thread;
+  GMainContext             *context;
+  GMainLoop                *loop;
+
+  GMutex                    mutex;
+  GCond                     cond;
+  gboolean                  running;
+  GHashTable               *sim_requests; /* "sender:serial" → arrival time, under the mutex */
+
+  char                     *bus_address;
+  guint                     n_modems;
+  guint                     sim_delay_ms;
+  gint                      n_sim_requests; /* atomic */
+
+  /* Only used from the stand-in thread */
+  GDBusConnection          *connection;
+  GDBusObjectManagerServer *object_manager;
+  MmGdbusOrgFreedesktopModemManager1 *manager;
+  GPtrArray                *sims;
+  guint                     owner_id;
+};
+
+typedef struct
+{
+  MmStandIn    *self;
+  GDBusMessage *reply;
+} DelayedReply;
+
+static void
+delayed_reply_free (gpointer data)
+{
+  DelayedReply *delayed = data;
+
+  g_object_unref (delayed->reply);
+  g_free (delayed);
+}
+
+static gboolean
+send_delayed_reply_cb (gpointer user_data)
+{
+  DelayedReply *delayed = user_data;
+
+  g_atomic_int_inc (&delayed->self->n_sim_requests);
+
+  /* Passes through the filter again, no longer as a SIM reply */
+  g_dbus_connection_send_message (delayed->self->connection,
+                                  delayed->reply,
+                                  G_DBUS_SEND_MESSAGE_FLAGS_PRESERVE_SERIAL,
+                                  NULL, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static char *
+get_request_key (const char *sender,
+                 guint32     serial)
+{
+  return g_strdup_printf ("%s:%u", sender ? sender : "", serial);
+}
+
+static GDBusMessage *
+sim_delay_filter (GDBusConnection *connection,
+                  GDBusMessage    *message,
+                  gboolean         incoming,
+                  gpointer         user_data)
+{
+  MmStandIn *self = user_data;
+  GDBusMessageType type;
+  const char *path;
+
+  type = g_dbus_message_get_message_type (message);
+  path = g_dbus_message_get_path (message);
+
+  /* Remember when each SIM request arrived... */
+  if (incoming && type == G_DBUS_MESSAGE_TYPE_METHOD_CALL &&
+      path && g_str_has_prefix (path, MM_DBUS_SIM_PREFIX))
+    {
+      gint64 now = g_get_monotonic_time ();
+
+      g_mutex_lock (&self->mutex);
+      g_hash_table_insert (self->sim_requests,
+                           get_request_key (g_dbus_message_get_sender (message),
+                                            g_dbus_message_get_serial (message)),
+                           g_memdup2 (&now, sizeof (now)));
+      g_mutex_unlock (&self->mutex);
+    }
+
+  /* ...and hold its reply back until @sim_delay_ms after that, from a
+   * timeout on the stand-in context, so that requests made at the same
+   * time are answered at the same time, like a busy ModemManager */
+  else if (!incoming && (type == G_DBUS_MESSAGE_TYPE_METHOD_RETURN ||
+                         type == G_DBUS_MESSAGE_TYPE_ERROR))
+    {
+      g_autofree char *key = NULL;
+      g_autofree gint64 *arrival = NULL;
+      g_autoptr(GSource) source = NULL;
+      DelayedReply *delayed;
+      gint64 delay;
+
+      key = get_request_key (g_dbus_message_get_destination (message),
+                             g_dbus_message_get_reply_serial (message));
+
+      g_mutex_lock (&self->mutex);
+      g_hash_table_steal_extended (self->sim_requests, key, NULL, (gpointer *) &arrival);
+      g_mutex_unlock (&self->mutex);
+
+      if (!arrival)
+        return message;
+
+      delayed = g_new0 (DelayedReply, 1);
+      delayed->self = self;
+      /* The message passed to filters is locked */
+      delayed->reply = g_dbus_message_copy (message, NULL);
+      g_object_unref (message);
+
+      delay = *arrival + self->sim_delay_ms * G_TIME_SPAN_MILLISECOND - g_get_monotonic_time ();
+      source = g_timeout_source_new (MAX (delay, 0) / G_TIME_SPAN_MILLISECOND);
+      g_source_set_callback (source, send_delayed_reply_cb, delayed, delayed_reply_free);
+      g_source_attach (source, self->context);
+
+      return NULL;
+    }
+
+  return message;
+}
+
+static void
+name_acquired_cb (GDBusConnection *connection,
+                  const char      *name,
+                  gpointer         user_data)
+{
+  MmStandIn *self = user_data;
+
+  g_mutex_lock (&self->mutex);
+  self->running = TRUE;
+  g_cond_signal (&self->cond);
+  g_mutex_unlock (&self->mutex);
+}
+
+static void
+name_lost_cb (GDBusConnection *connection,
+              const char      *name,
+              gpointer         user_data)
+{
+  if (connection)
+    g_error ("Lost the name %s", name);
+}
+
+static void
+export_modem (MmStandIn *self,
+              guint      index)
+{
+  MmGdbusObjectSkeleton *object;
+  MmGdbusModem *modem;
+  MmGdbusModem3gpp *modem_3gpp;
+  MmGdbusSim *sim;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *modem_path = NULL;
+  g_autofree char *sim_path = NULL;
+  g_autofree char *port = NULL;
+  g_autofree char *identifier = NULL;
+
+  modem_path = g_strdup_printf (MM_DBUS_MODEM_PREFIX "/%u", index);
+  sim_path = g_strdup_printf (MM_DBUS_SIM_PREFIX "/%u", index);
+  port = g_strdup_printf ("ttyStandIn%u", index);
+  identifier = g_strdup_printf ("8900100000000000%04u", index);
+
+  sim = mm_gdbus_sim_skeleton_new ();
+  mm_gdbus_sim_set_active (sim, TRUE);
+  mm_gdbus_sim_set_sim_identifier (sim, identifier);
+  mm_gdbus_sim_set_imsi (sim, "001010000000000");
+  mm_gdbus_sim_set_operator_identifier (sim, "00101");
+  mm_gdbus_sim_set_operator_name (sim, "Stand-in Mobile");
+  g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (sim),
+                                    self->connection, sim_path, &error);
+  g_assert_no_error (error);
+
+  modem = mm_gdbus_modem_skeleton_new ();
+  mm_gdbus_modem_set_sim (modem, sim_path);
+  mm_gdbus_modem_set_primary_port (modem, port);
+  mm_gdbus_modem_set_state (modem, MM_MODEM_STATE_REGISTERED);
+  mm_gdbus_modem_set_unlock_required (modem, MM_MODEM_LOCK_NONE);
+  mm_gdbus_modem_set_current_capabilities (modem, MM_MODEM_CAPABILITY_GSM_UMTS | MM_MODEM_CAPABILITY_LTE);
+  mm_gdbus_modem_set_current_modes (modem, g_variant_new ("(uu)", MM_MODEM_MODE_ANY, MM_MODEM_MODE_NONE));
+  mm_gdbus_modem_set_signal_quality (modem, g_variant_new ("(ub)", 75, TRUE));
+
+  modem_3gpp = mm_gdbus_modem3gpp_skeleton_new ();
+  mm_gdbus_modem3gpp_set_registration_state (modem_3gpp, MM_MODEM_3GPP_REGISTRATION_STATE_HOME);
+  mm_gdbus_modem3gpp_set_operator_code (modem_3gpp, "00101");
+  mm_gdbus_modem3gpp_set_operator_name (modem_3gpp, "Stand-in Mobile");
+
+  object = mm_gdbus_object_skeleton_new (modem_path);
+  mm_gdbus_object_skeleton_set_modem (object, modem);
+  mm_gdbus_object_skeleton_set_modem3gpp (object, modem_3gpp);
+  g_dbus_object_manager_server_export (self->object_manager,
+                                       G_DBUS_OBJECT_SKELETON (object));
+
+  /* The object manager keeps the modem alive */
+  g_object_unref (object);
+  g_object_unref (modem_3gpp);
+  g_object_unref (modem);
+  g_ptr_array_add (self->sims, sim);
+}
+
+static gpointer
+mm_stand_in_thread (gpointer user_data)
+{
+  MmStandIn *self = user_data;
+  g_autoptr(GError) error = NULL;
+
+  g_main_context_push_thread_default (self->context);
+
+  self->connection = g_dbus_connection_new_for_address_sync (self->bus_address,
+                                                             G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                             G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                             NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_dbus_connection_add_filter (self->connection, sim_delay_filter, self, NULL);
+
+  self->manager = mm_gdbus_org_freedesktop_modem_manager1_skeleton_new ();
+  g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->manager),
+                                    self->connection, MM_DBUS_PATH, &error);
+  g_assert_no_error (error);
+
+  self->sims = g_ptr_array_new_with_free_func (g_object_unref);
+  self->object_manager = g_dbus_object_manager_server_new (MM_DBUS_PATH);
+  for (guint i = 0; i < self->n_modems; i++)
+    export_modem (self, i);
+  g_dbus_object_manager_server_set_connection (self->object_manager, self->connection);
+
+  self->owner_id = g_bus_own_name_on_connection (self->connection,
+                                                 MM_DBUS_SERVICE,
+                                                 G_BUS_NAME_OWNER_FLAGS_NONE,
+                                                 name_acquired_cb,
+                                                 name_lost_cb,
+                                                 self, NULL);
+
+  g_main_loop_run (self->loop);
+
+  g_bus_unown_name (self->owner_id);
+  for (guint i = 0; i < self->sims->len; i++)
+    g_dbus_interface_skeleton_unexport (g_ptr_array_index (self->sims, i));
+  g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self->manager));
+  g_clear_pointer (&self->sims, g_ptr_array_unref);
+  g_clear_object (&self->object_manager);
+  g_clear_object (&self->manager);
+  g_dbus_connection_close_sync (self->connection, NULL, NULL);
+  g_clear_object (&self->connection);
+
+  g_main_context_pop_thread_default (self->context);
+
+  return NULL;
+}
+
+/**
+ * mm_stand_in_new:
+ * @bus_address: The address of the bus to export the modems on
+ * @n_modems: The number of modems to export
+ * @sim_delay_ms: The delay before answering any SIM request
+ *
+ * Start a ModemManager stand-in, returning once it owns the
+ * ModemManager name on @bus_address.
+ *
+ * Returns: (transfer full): A #MmStandIn
+ */
+MmStandIn *
+mm_stand_in_new (const char *bus_address,
+                 guint       n_modems,
+                 guint       sim_delay_ms)
+{
+  MmStandIn *self;
+
+  self = g_new0 (MmStandIn, 1);
+  self->bus_address = g_strdup (bus_address);
+  self->n_modems = n_modems;
+  self->sim_delay_ms = sim_delay_ms;
+  self->context = g_main_context_new ();
+  self->loop = g_main_loop_new (self->context, FALSE);
+  g_mutex_init (&self->mutex);
+  g_cond_init (&self->cond);
+  self->sim_requests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  self->thread = g_thread_new ("mm-stand-in", mm_stand_in_thread, self);
+
+  g_mutex_lock (&self->mutex);
+  while (!self->running)
+    g_cond_wait (&self->cond, &self->mutex);
+  g_mutex_unlock (&self->mutex);
+
+  return self;
+}
+
+void
+mm_stand_in_free (MmStandIn *self)
+{
+  g_main_loop_quit (self->loop);
+  g_thread_join (self->thread);
+
+  g_main_loop_unref (self->loop);
+  g_main_context_unref (self->context);
+  g_mutex_clear (&self->mutex);
+  g_cond_clear (&self->cond);
+  g_hash_table_unref (self->sim_requests);
+  g_free (self->bus_address);
+  g_free (self);
+}
+
+/**
+ * mm_stand_in_get_n_sim_requests:
+ * @self: A #MmStandIn
+ *
+ * Get the number of SIM requests answered after their delay.
+ *
+ * Returns: The number of SIM requests answered
+ */
+guint
+mm_stand_in_get_n_sim_requests (MmStandIn *self)
+{
+  return g_atomic_int_get (&self->n_sim_requests);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A minimal ModemManager running on its own thread, exporting
+ * @n_modems modems with one SIM each.  Every request on a SIM
+ * object is answered after @sim_delay_ms milliseconds, like a
+ * modem that is still busy initializing.
+ */
+typedef struct _MmStandIn MmStandIn;
+
+MmStandIn *mm_stand_in_new  (const char *bus_address,
+                             guint       n_modems,
+                             guint       sim_delay_ms);
+
+void       mm_stand_in_free (MmStandIn  *self);
+
+guint      mm_stand_in_get_n_sim_requests (MmStandIn *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MmStandIn, mm_stand_in_free)
+
+G_END_DECLS
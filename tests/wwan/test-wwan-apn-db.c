@@ -0,0 +1,284 @@
+#include "config.h"
+
+#include <fcntl.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "cc-wwan-apn-db.h"
+#include "test-utils.h"
+
+static char *test_dir;
+
+static const char database_contents[] =
+  "<?xml version=\"1.0\"?>\n"
+  "<serviceproviders format=\"2.0\">\n"
+  "  <country code=\"xx\">\n"
+  "    <provider>\n"
+  "      <name>Example Mobile</name>\n"
+  "      <name xml:lang=\"fr\">Exemple Mobile</name>\n"
+  "      <gsm>\n"
+  "        <network-id mcc=\"001\" mnc=\"01\"/>\n"
+  "        <network-id mcc=\"001\" mnc=\"02\"/>\n"
+  "        <apn value=\"internet.example\">\n"
+  "          <usage type=\"internet\"/>\n"
+  "          <name>Internet</name>\n"
+  "          <name xml:lang=\"fr\">Internet FR</name>\n"
+  "          <username>user</username>\n"
+  "          <password>secret</password>\n"
+  "        </apn>\n"
+  "        <apn value=\"fast.example\"/>\n"
+  "      </gsm>\n"
+  "      <cdma>\n"
+  "        <sid value=\"1\"/>\n"
+  "      </cdma>\n"
+  "    </provider>\n"
+  "    <provider>\n"
+  "      <name>Other Mobile</name>\n"
+  "      <gsm>\n"
+  "        <network-id mcc=\"001\" mnc=\"02\"/>\n"
+  "        <network-id mcc=\"001\" mnc=\"03\"/>\n"
+  "        <network-id mcc=\"001\" mnc=\"004\"/>\n"
+  "        <apn value=\"other.example\">\n"
+  "          <name>Other</name>\n"
+  "        </apn>\n"
+  "      </gsm>\n"
+  "    </provider>\n"
+  "  </country>\n"
+  "</serviceproviders>\n";
+
+static void
+lookup_cb (GObject      *object,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  GPtrArray **apns = user_data;
+  g_autoptr(GError) error = NULL;
+
+  *apns = cc_wwan_apn_db_lookup_finish (CC_WWAN_APN_DB (object), result, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (*apns);
+}
+
+static GPtrArray *
+lookup (CcWwanApnDb *db,
+        const char  *mcc_mnc)
+{
+  GPtrArray *apns = NULL;
+
+  cc_wwan_apn_db_lookup_async (db, mcc_mnc, NULL, lookup_cb, &apns);
+  while (!apns)
+    g_main_context_iteration (NULL, TRUE);
+
+  return apns;
+}
+
+static void
+check_database (CcWwanApnDb *db)
+{
+  g_autoptr(GPtrArray) apns = NULL;
+  const CcWwanProviderApn *apn;
+
+  apns = lookup (db, "00101");
+  g_assert_cmpuint (apns->len, ==, 2);
+
+  apn = g_ptr_array_index (apns, 0);
+  g_assert_cmpstr (apn->name, ==, "Internet");
+  g_assert_cmpstr (apn->apn, ==, "internet.example");
+  g_assert_cmpstr (apn->username, ==, "user");
+  g_assert_cmpstr (apn->password, ==, "secret");
+
+  /* Named after the provider */
+  apn = g_ptr_array_index (apns, 1);
+  g_assert_cmpstr (apn->name, ==, "Example Mobile");
+  g_assert_cmpstr (apn->apn, ==, "fast.example");
+  g_assert_null (apn->username);
+  g_assert_null (apn->password);
+  g_clear_pointer (&apns, g_ptr_array_unref);
+
+  /* The first provider of a network wins */
+  apns = lookup (db, "00102");
+  g_assert_cmpuint (apns->len, ==, 2);
+  apn = g_ptr_array_index (apns, 0);
+  g_assert_cmpstr (apn->apn, ==, "internet.example");
+  g_clear_pointer (&apns, g_ptr_array_unref);
+
+  apns = lookup (db, "00103");
+  g_assert_cmpuint (apns->len, ==, 1);
+  apn = g_ptr_array_index (apns, 0);
+  g_assert_cmpstr (apn->name, ==, "Other");
+  g_clear_pointer (&apns, g_ptr_array_unref);
+
+  apns = lookup (db, "99999");
+  g_assert_cmpuint (apns->len, ==, 0);
+}
+
+static void
+test_lookup (void)
+{
+  g_autofree char *database = g_build_filename (test_dir, "serviceproviders.xml", NULL);
+  g_autofree char *cache_file = g_build_filename (test_dir, "cache", "apn-db.cache", NULL);
+  g_autoptr(CcWwanApnDb) db = NULL;
+  g_autoptr(GError) error = NULL;
+
+  g_file_set_contents (database, database_contents, -1, &error);
+  g_assert_no_error (error);
+
+  db = cc_wwan_apn_db_new (database, cache_file);
+  check_database (db);
+  g_assert_true (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+}
+
+static void
+test_mnc_length (void)
+{
+  g_autofree char *database = g_build_filename (test_dir, "mnc-serviceproviders.xml", NULL);
+  g_autoptr(CcWwanApnDb) db = NULL;
+  g_autoptr(GPtrArray) apns = NULL;
+  g_autoptr(GError) error = NULL;
+  const CcWwanProviderApn *apn;
+
+  g_file_set_contents (database, database_contents, -1, &error);
+  g_assert_no_error (error);
+
+  db = cc_wwan_apn_db_new (database, NULL);
+
+  /* A 3-digit MNC finds the network listed with 2 digits */
+  apns = lookup (db, "001001");
+  g_assert_cmpuint (apns->len, ==, 2);
+  apn = g_ptr_array_index (apns, 0);
+  g_assert_cmpstr (apn->apn, ==, "internet.example");
+  g_clear_pointer (&apns, g_ptr_array_unref);
+
+  /* A 2-digit MNC finds the network listed with 3 digits */
+  apns = lookup (db, "00104");
+  g_assert_cmpuint (apns->len, ==, 1);
+  apn = g_ptr_array_index (apns, 0);
+  g_assert_cmpstr (apn->apn, ==, "other.example");
+  g_clear_pointer (&apns, g_ptr_array_unref);
+
+  /* Only a leading zero is dropped */
+  apns = lookup (db, "001101");
+  g_assert_cmpuint (apns->len, ==, 0);
+}
+
+static void
+check_names (const char *database,
+             const char *cache_file,
+             const char *language,
+             const char *apn_name,
+             const char *provider_name)
+{
+  g_autoptr(CcWwanApnDb) db = NULL;
+  g_autoptr(GPtrArray) apns = NULL;
+  const CcWwanProviderApn *apn;
+
+  g_setenv ("LANGUAGE", language, TRUE);
+  db = cc_wwan_apn_db_new (database, cache_file);
+
+  apns = lookup (db, "00101");
+  g_assert_cmpuint (apns->len, ==, 2);
+  apn = g_ptr_array_index (apns, 0);
+  g_assert_cmpstr (apn->name, ==, apn_name);
+  apn = g_ptr_array_index (apns, 1);
+  g_assert_cmpstr (apn->name, ==, provider_name);
+}
+
+static void
+test_language (void)
+{
+  g_autofree char *database = g_build_filename (test_dir, "language-serviceproviders.xml", NULL);
+  g_autofree char *cache_file = g_build_filename (test_dir, "cache", "language-apn-db.cache", NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_file_set_contents (database, database_contents, -1, &error);
+  g_assert_no_error (error);
+
+  check_names (database, cache_file, "fr_FR", "Internet FR", "Exemple Mobile");
+
+  /* The names cached in French aren't taken for the English ones */
+  check_names (database, cache_file, "en_US", "Internet", "Example Mobile");
+  check_names (database, cache_file, "de_DE", "Internet", "Example Mobile");
+
+  g_setenv ("LANGUAGE", "en", TRUE);
+}
+
+static void
+write_database (const char *database,
+                const char *contents,
+                time_t      mtime,
+                long        mtime_nsec)
+{
+  struct timespec times[2] = { { mtime, mtime_nsec }, { mtime, mtime_nsec } };
+  g_autoptr(GError) error = NULL;
+
+  g_file_set_contents (database, contents, -1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (utimensat (AT_FDCWD, database, times, 0), ==, 0);
+}
+
+static char *
+lookup_other_apn (const char *database,
+                  const char *cache_file)
+{
+  g_autoptr(CcWwanApnDb) db = cc_wwan_apn_db_new (database, cache_file);
+  g_autoptr(GPtrArray) apns = NULL;
+
+  apns = lookup (db, "00103");
+  g_assert_cmpuint (apns->len, ==, 1);
+
+  return g_strdup (((CcWwanProviderApn *) g_ptr_array_index (apns, 0))->apn);
+}
+
+static void
+test_cache (void)
+{
+  g_autofree char *database = g_build_filename (test_dir, "cached-serviceproviders.xml", NULL);
+  g_autofree char *cache_file = g_build_filename (test_dir, "cache", "cached-apn-db.cache", NULL);
+  g_auto(GStrv) parts = NULL;
+  g_autofree char *contents = NULL;
+  g_autofree char *apn = NULL;
+  g_autofree char *cached_apn = NULL;
+  g_autofree char *changed_apn = NULL;
+  g_autofree char *replaced_apn = NULL;
+
+  write_database (database, database_contents, 1000000000, 0);
+  apn = lookup_other_apn (database, cache_file);
+  g_assert_cmpstr (apn, ==, "other.example");
+  g_assert_true (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+
+  /* Another database of the same size and modification time is taken
+   * for the one in the cache, which shows the cache is what's read */
+  parts = g_strsplit (database_contents, "other.example", -1);
+  contents = g_strjoinv ("other.changed", parts);
+  g_assert_cmpuint (strlen (contents), ==, strlen (database_contents));
+  write_database (database, contents, 1000000000, 0);
+  cached_apn = lookup_other_apn (database, cache_file);
+  g_assert_cmpstr (cached_apn, ==, "other.example");
+
+  /* A new modification time alone is enough to read the database again */
+  write_database (database, contents, 1000000001, 0);
+  changed_apn = lookup_other_apn (database, cache_file);
+  g_assert_cmpstr (changed_apn, ==, "other.changed");
+
+  /* Even when it's replaced within the same second */
+  write_database (database, database_contents, 1000000001, 500000000);
+  replaced_apn = lookup_other_apn (database, cache_file);
+  g_assert_cmpstr (replaced_apn, ==, "other.example");
+}
+
+int
+main (int argc, char **argv)
+{
+  test_dir = test_utils_init (&argc, &argv, "test-wwan-apn-db");
+
+  /* The names of the providers depend on the language */
+  g_setenv ("LANGUAGE", "en", TRUE);
+
+  g_test_add_func ("/wwan/apn-db/lookup", test_lookup);
+  g_test_add_func ("/wwan/apn-db/cache", test_cache);
+  g_test_add_func ("/wwan/apn-db/mnc-length", test_mnc_length);
+  g_test_add_func ("/wwan/apn-db/language", test_language);
+
+  return test_utils_run (test_dir);
+}
@@ -0,0 +1,205 @@
+#include "config.h"
+
+#if defined(HAVE_NETWORK_MANAGER) && defined(BUILD_NETWORK)
+# include <NetworkManager.h>
+#endif
+
+#include "cc-wwan-device.h"
+#include "mm-stand-in.h"
+
+#define N_MODEMS     4
+#define SIM_DELAY_MS 250
+
+static GTestDBus *bus;
+
+typedef struct
+{
+  MmStandIn *stand_in;
+  guint      n_ready;
+  gint64     last_tick;
+  gint64     longest_stall;
+} BringUpState;
+
+static void
+device_ready_cb (CcWwanDevice *device,
+                 BringUpState *state)
+{
+  g_assert_true (cc_wwan_device_is_ready (device));
+  state->n_ready++;
+
+  /* Each device is only ready once its SIM was answered */
+  g_assert_cmpuint (mm_stand_in_get_n_sim_requests (state->stand_in), >=, state->n_ready);
+}
+
+static gboolean
+tick_cb (gpointer user_data)
+{
+  BringUpState *state = user_data;
+  gint64 now = g_get_monotonic_time ();
+
+  state->longest_stall = MAX (state->longest_stall, now - state->last_tick);
+  state->last_tick = now;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+test_bring_up (void)
+{
+  g_autoptr(MmStandIn) stand_in = NULL;
+  g_autoptr(GDBusConnection) connection = NULL;
+  g_autoptr(MMManager) manager = NULL;
+  g_autoptr(GPtrArray) devices = NULL;
+  g_autoptr(GObject) nm_client = NULL;
+  g_autoptr(GError) error = NULL;
+  BringUpState state = { 0, };
+  GList *objects;
+  gint64 start, interactive, ready;
+  guint tick_id;
+
+  stand_in = mm_stand_in_new (g_test_dbus_get_bus_address (bus), N_MODEMS, SIM_DELAY_MS);
+  state.stand_in = stand_in;
+
+  connection = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (bus),
+                                                       G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                       G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                       NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  manager = mm_manager_new_sync (connection,
+                                 G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
+                                 NULL, &error);
+  g_assert_no_error (error);
+
+#if defined(HAVE_NETWORK_MANAGER) && defined(BUILD_NETWORK)
+  /* NetworkManager isn’t running on the test bus */
+  nm_client = G_OBJECT (nm_client_new (NULL, &error));
+  g_assert_no_error (error);
+#endif
+
+  objects = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (manager));
+  g_assert_cmpuint (g_list_length (objects), ==, N_MODEMS);
+
+  /* Time to interactive: how long creating the devices keeps
+   * the main loop busy, ModemManager details being already
+   * available from the cached properties.  Timings are only
+   * reported, they depend too much on the machine to assert */
+  devices = g_ptr_array_new_with_free_func (g_object_unref);
+  start = g_get_monotonic_time ();
+
+  for (GList *item = objects; item; item = item->next)
+    {
+      CcWwanDevice *device;
+
+      device = cc_wwan_device_new (MM_OBJECT (item->data), nm_client);
+      g_signal_connect (device, "ready", G_CALLBACK (device_ready_cb), &state);
+      g_ptr_array_add (devices, device);
+
+      g_assert_false (cc_wwan_device_is_ready (device));
+      g_assert_cmpstr (cc_wwan_device_get_operator_name (device), ==, "Stand-in Mobile");
+    }
+
+  interactive = g_get_monotonic_time () - start;
+  g_list_free_full (objects, g_object_unref);
+
+  state.last_tick = g_get_monotonic_time ();
+  tick_id = g_timeout_add (10, tick_cb, &state);
+
+  while (state.n_ready < N_MODEMS)
+    g_main_context_iteration (NULL, TRUE);
+
+  ready = g_get_monotonic_time () - start;
+  g_source_remove (tick_id);
+
+  g_test_message ("%d modems: ready after %" G_GINT64_FORMAT " ms, "
+                  "SIM requests delayed by %d ms",
+                  N_MODEMS, ready / G_TIME_SPAN_MILLISECOND, SIM_DELAY_MS);
+  g_test_minimized_result ((double) interactive / G_TIME_SPAN_MILLISECOND,
+                           "Interactive after %" G_GINT64_FORMAT " ms",
+                           interactive / G_TIME_SPAN_MILLISECOND);
+  g_test_minimized_result ((double) state.longest_stall / G_TIME_SPAN_MILLISECOND,
+                           "Longest main loop stall %" G_GINT64_FORMAT " ms",
+                           state.longest_stall / G_TIME_SPAN_MILLISECOND);
+
+  /* Each SIM request is delayed on its own, so fetching the SIMs in
+   * parallel takes about one delay, and one after the other, one per
+   * modem */
+  g_assert_cmpint (ready, <, N_MODEMS * SIM_DELAY_MS * G_TIME_SPAN_MILLISECOND);
+
+  for (guint i = 0; i < devices->len; i++)
+    g_assert_true (cc_wwan_device_has_sim (g_ptr_array_index (devices, i)));
+}
+
+static void
+set_done_cb (gpointer user_data)
+{
+  gboolean *done = user_data;
+
+  *done = TRUE;
+}
+
+static void
+test_dispose_before_ready (void)
+{
+  g_autoptr(MmStandIn) stand_in = NULL;
+  g_autoptr(GDBusConnection) connection = NULL;
+  g_autoptr(MMManager) manager = NULL;
+  g_autoptr(GObject) nm_client = NULL;
+  g_autoptr(GError) error = NULL;
+  GList *objects;
+  gboolean done = FALSE;
+
+  stand_in = mm_stand_in_new (g_test_dbus_get_bus_address (bus), 1, SIM_DELAY_MS);
+
+  connection = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (bus),
+                                                       G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                       G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                       NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  manager = mm_manager_new_sync (connection,
+                                 G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START,
+                                 NULL, &error);
+  g_assert_no_error (error);
+
+#if defined(HAVE_NETWORK_MANAGER) && defined(BUILD_NETWORK)
+  nm_client = G_OBJECT (nm_client_new (NULL, &error));
+  g_assert_no_error (error);
+#endif
+
+  objects = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (manager));
+  g_assert_cmpuint (g_list_length (objects), ==, 1);
+
+  /* A modem going away while its SIM is fetched */
+  g_object_unref (cc_wwan_device_new (MM_OBJECT (objects->data), nm_client));
+  g_list_free_full (objects, g_object_unref);
+
+  /* The late reply must not reach the disposed device */
+  g_timeout_add_once (2 * SIM_DELAY_MS, set_done_cb, &done);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+int
+main (int argc, char **argv)
+{
+  int ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+  g_test_dbus_up (bus);
+
+  /* NMClient is created on the system bus */
+  g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address (bus), TRUE);
+
+  g_test_add_func ("/wwan/device/bring-up", test_bring_up);
+  g_test_add_func ("/wwan/device/dispose-before-ready", test_dispose_before_ready);
+
+  ret = g_test_run ();
+
+  g_test_dbus_down (bus);
+  g_object_unref (bus);
+
+  return ret;
+}